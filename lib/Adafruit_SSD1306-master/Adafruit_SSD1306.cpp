@@ -333,6 +333,10 @@ Adafruit_SSD1306::~Adafruit_SSD1306(void) {
     free(buffer);
     buffer = NULL;
   }
+  if(shadow) {
+    free(shadow);
+    shadow = NULL;
+  }
 }
 
 // LOW-LEVEL UTILS ---------------------------------------------------------
@@ -467,6 +471,7 @@ boolean Adafruit_SSD1306::begin(uint8_t vcs, uint8_t addr, boolean reset,
   }
 
   vccstate = vcs;
+  shadowValid = false; // display RAM content unknown after init
 
   // Setup pin directions
   if(wire) { // Using I2C
@@ -903,17 +908,73 @@ void Adafruit_SSD1306::display(void) {
   yield();
 #endif
   uint16_t count = WIDTH * ((HEIGHT + 7) / 8);
-  uint8_t *ptr   = buffer;
+  sendData(buffer, count);
+  TRANSACTION_END
+  if(shadow) {
+    memcpy(shadow, buffer, count);
+    shadowValid = true;
+  }
+#if defined(ESP8266)
+  yield();
+#endif
+}
+
+/*!
+    @brief  Push only the pages (8 pixel rows) of the RAM buffer to the
+            SSD1306, which changed since the last transfer.
+    @return Number of bytes sent to the display (data + control bytes).
+    @note   Same as display(), but much less bus traffic if only small
+            parts of the screen change. First call transfers the whole
+            buffer.
+*/
+uint16_t Adafruit_SSD1306::displayChanged(void) {
+  uint8_t  pages = (HEIGHT + 7) / 8;
+  uint16_t count = WIDTH * pages;
+  if((!shadow) && !(shadow = (uint8_t *)malloc(count))) {
+    display(); // no memory for shadow --> full transfer
+    return count;
+  }
+  if(!shadowValid) {
+    display();
+    return count;
+  }
+  uint16_t bytesSent = 0;
+  TRANSACTION_START
+  for(uint8_t page = 0; page < pages; page++) {
+    uint8_t *ptr = &buffer[page * WIDTH];
+    if(!memcmp(ptr, &shadow[page * WIDTH], WIDTH)) continue;
+    uint8_t dlist[] = {
+      SSD1306_PAGEADDR,
+      page,                    // Page start address
+      page,                    // Page end address
+      SSD1306_COLUMNADDR,
+      0,                       // Column start address
+      (uint8_t)(WIDTH - 1) };  // Column end address
+    ssd1306_commandList(dlist, sizeof(dlist));
+    bytesSent += sizeof(dlist) + 1;
+    bytesSent += sendData(ptr, WIDTH);
+    memcpy(&shadow[page * WIDTH], ptr, WIDTH);
+  }
+  TRANSACTION_END
+  return bytesSent;
+}
+
+// Send display data, SPI transaction/selection must be performed in calling
+// function. Returns number of bytes on the bus (including I2C control bytes).
+uint16_t Adafruit_SSD1306::sendData(const uint8_t *ptr, uint16_t count) {
+  uint16_t bytesSent = count;
   if(wire) { // I2C
     wire->beginTransmission(i2caddr);
     WIRE_WRITE((uint8_t)0x40);
     uint8_t bytesOut = 1;
+    bytesSent++;
     while(count--) {
       if(bytesOut >= WIRE_MAX) {
         wire->endTransmission();
         wire->beginTransmission(i2caddr);
         WIRE_WRITE((uint8_t)0x40);
         bytesOut = 1;
+        bytesSent++;
       }
       WIRE_WRITE(*ptr++);
       bytesOut++;
@@ -923,10 +984,7 @@ void Adafruit_SSD1306::display(void) {
     SSD1306_MODE_DATA
     while(count--) SPIwrite(*ptr++);
   }
-  TRANSACTION_END
-#if defined(ESP8266)
-  yield();
-#endif
+  return bytesSent;
 }
 
 // SCROLLING FUNCTIONS -----------------------------------------------------
@@ -143,6 +143,7 @@ class Adafruit_SSD1306 : public Adafruit_GFX {
                  uint8_t i2caddr=0, boolean reset=true,
                  boolean periphBegin=true);
   void         display(void);
+  uint16_t     displayChanged(void);
   void         clearDisplay(void);
   void         invertDisplay(boolean i);
   void         dim(boolean dim);
@@ -166,10 +167,13 @@ class Adafruit_SSD1306 : public Adafruit_GFX {
                  uint16_t color);
   void         ssd1306_command1(uint8_t c);
   void         ssd1306_commandList(const uint8_t *c, uint8_t n);
+  uint16_t     sendData(const uint8_t *ptr, uint16_t count);
 
   SPIClass    *spi;
   TwoWire     *wire;
   uint8_t     *buffer;
+  uint8_t     *shadow = NULL;       // copy of display RAM (for displayChanged)
+  boolean      shadowValid = false; // shadow matches display RAM
   int8_t       i2caddr, vccstate, page_end;
   int8_t       mosiPin    ,  clkPin    ,  dcPin    ,  csPin, rstPin;
 #ifdef HAVE_PORTREG
@@ -1,4 +1,5 @@
 #include <Baro.h>
+#include <Trace.h>
 //#include <MPU6050.h>
 //#include "MPU6050_6Axis_MotionApps20.h"
 #include "MPU6050_6Axis_MotionApps_V6_12.h"
@@ -772,11 +773,13 @@ void Baro::run(void){
   static uint32_t tOld;  
   uint32_t tAct = millis();
 
+  trace.start(TRACE_BARO);
   if (sensorType == SENSORTYPE_MS5611){
     runMS5611(tAct);
   }else if (sensorType == SENSORTYPE_BME280){
     runBME280(tAct);
   }
+  trace.stop(TRACE_BARO);
 
   #ifdef BARO_DEBUG
   if (logData.newData){
@@ -0,0 +1,114 @@
+/*!
+ * @file BootSequence.cpp
+ *
+ *
+ */
+
+#include "BootSequence.h"
+
+BootSequence::BootSequence(){
+  xEvents = NULL;
+  count = 0;
+  mux = portMUX_INITIALIZER_UNLOCKED;
+  memset(stages,0,sizeof(stages));
+}
+
+void BootSequence::begin(void){
+  if (xEvents == NULL) xEvents = xEventGroupCreate();
+}
+
+void BootSequence::add(uint8_t id,const char *name,uint32_t depends){
+  if (id >= BOOT_MAXSTAGES){
+    log_e("wrong boot-stage %d %s",id,name);
+    return;
+  }
+  stages[id].name = name;
+  stages[id].depends = depends;
+  if (id >= count) count = id + 1;
+}
+
+bool BootSequence::start(uint8_t id,uint32_t timeout){
+  if ((id >= count) || (xEvents == NULL)) return false;
+  portENTER_CRITICAL(&mux);
+  stages[id].state = BOOT_WAITING;
+  stages[id].tWait = millis();
+  portEXIT_CRITICAL(&mux);
+  bool bRet = true;
+  uint32_t depends = stages[id].depends;
+  if (depends){
+    EventBits_t bits = xEventGroupWaitBits(xEvents,depends,pdFALSE,pdTRUE,pdMS_TO_TICKS(timeout));
+    bRet = ((bits & depends) == depends);
+  }
+  portENTER_CRITICAL(&mux);
+  stages[id].state = BOOT_RUNNING;
+  stages[id].bTimeout = !bRet;
+  stages[id].tStart = millis();
+  portEXIT_CRITICAL(&mux);
+  if (!bRet) log_e("boot %s: timeout waiting for dependencies",stages[id].name);
+  return bRet;
+}
+
+void BootSequence::setDone(uint8_t id,uint8_t state){
+  if ((id >= count) || (xEvents == NULL)) return;
+  if (stages[id].state >= BOOT_READY) return; //only the first signal counts (called cyclic by some stages)
+  uint32_t tAct = millis();
+  portENTER_CRITICAL(&mux);
+  if (stages[id].state >= BOOT_READY){
+    portEXIT_CRITICAL(&mux);
+    return;
+  }
+  if (stages[id].state == BOOT_IDLE){
+    //signal without start (e.g. first gps-sentence)
+    stages[id].tWait = tAct;
+    stages[id].tStart = tAct;
+  }
+  stages[id].state = state;
+  stages[id].tReady = tAct;
+  portEXIT_CRITICAL(&mux);
+  xEventGroupSetBits(xEvents,BOOT_BIT(id));
+  if (state == BOOT_READY) log_i("boot %s ready after %dms",stages[id].name,tAct);
+}
+
+void BootSequence::ready(uint8_t id){
+  setDone(id,BOOT_READY);
+}
+
+void BootSequence::skip(uint8_t id){
+  setDone(id,BOOT_SKIPPED);
+}
+
+bool BootSequence::isReady(uint8_t id){
+  if (id >= count) return false;
+  return (stages[id].state >= BOOT_READY);
+}
+
+bool BootSequence::waitReady(uint8_t id,uint32_t timeout){
+  if ((id >= count) || (xEvents == NULL)) return false;
+  EventBits_t bits = xEventGroupWaitBits(xEvents,BOOT_BIT(id),pdFALSE,pdTRUE,pdMS_TO_TICKS(timeout));
+  return ((bits & (BOOT_BIT(id))) != 0);
+}
+
+bool BootSequence::getStage(uint8_t id,stage *pStage){
+  if (id >= count) return false;
+  portENTER_CRITICAL(&mux);
+  *pStage = stages[id];
+  portEXIT_CRITICAL(&mux);
+  return true;
+}
+
+void BootSequence::getJson(JsonDocument &doc){
+  JsonObject jBoot = doc.createNestedObject("boot");
+  JsonArray jStages = jBoot.createNestedArray("stages");
+  for (int i = 0;i < count;i++){
+    stage st;
+    getStage(i,&st);
+    if (st.name == NULL) continue;
+    JsonObject jStage = jStages.createNestedObject();
+    jStage["name"] = st.name;
+    jStage["state"] = st.state;
+    jStage["wait"] = st.tWait;
+    jStage["start"] = st.tStart;
+    jStage["ready"] = st.tReady;
+    jStage["timeout"] = st.bTimeout;
+  }
+}
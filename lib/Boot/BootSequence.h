@@ -0,0 +1,58 @@
+/*!
+ * @file BootSequence.h
+ *
+ *
+ */
+
+#ifndef __BOOTSEQUENCE_H__
+#define __BOOTSEQUENCE_H__
+
+#include <Arduino.h>
+#include <string.h>
+#include <ArduinoJson.h>
+#include <freertos/event_groups.h>
+
+#define BOOT_MAXSTAGES 16
+#define BOOT_WAITMAX 10000 //max. time a stage waits for its dependencies [ms]
+#define BOOT_BIT(id) (1UL << (id))
+
+#define BOOT_IDLE 0
+#define BOOT_WAITING 1 //waits for dependencies
+#define BOOT_RUNNING 2
+#define BOOT_READY 3
+#define BOOT_SKIPPED 4 //not used in this configuration, counts as ready
+
+//stages of the start run in the tasks, which need them
+//a stage waits only for the stages it depends on, instead of fixed delays
+class BootSequence {
+public:
+  typedef struct {
+    const char *name;
+    uint32_t depends; //bits of the stages, which have to be ready before
+    uint8_t state;
+    bool bTimeout; //started without all dependencies
+    uint32_t tWait; //start was requested [ms since boot]
+    uint32_t tStart; //dependencies ready [ms since boot]
+    uint32_t tReady; //[ms since boot]
+  } stage;
+
+  BootSequence(); //constructor
+  void begin(void); //has to be called first in setup
+  void add(uint8_t id,const char *name,uint32_t depends); //only from setup, before the tasks are created
+  bool start(uint8_t id,uint32_t timeout = BOOT_WAITMAX); //waits for the dependencies, false on timeout
+  void ready(uint8_t id);
+  void skip(uint8_t id);
+  bool isReady(uint8_t id);
+  bool waitReady(uint8_t id,uint32_t timeout);
+  bool getStage(uint8_t id,stage *pStage);
+  void getJson(JsonDocument &doc);
+
+private:
+  void setDone(uint8_t id,uint8_t state);
+  EventGroupHandle_t xEvents;
+  stage stages[BOOT_MAXSTAGES];
+  uint8_t count;
+  portMUX_TYPE mux;
+};
+
+#endif
@@ -69,3 +69,32 @@ int CalcBearingA(double lat1, double lon1, double lat2, double lon2)
   return ((int) bearing + 360) % 360;
 }
 
+
+//sin(0..90deg) * SINTAB_SCALE
+static const int16_t sinTable[91] = {
+     0,  18,  36,  54,  71,  89, 107, 125, 143, 160,
+   178, 195, 213, 230, 248, 265, 282, 299, 316, 333,
+   350, 367, 384, 400, 416, 433, 449, 465, 481, 496,
+   512, 527, 543, 558, 573, 587, 602, 616, 630, 644,
+   658, 672, 685, 698, 711, 724, 737, 749, 761, 773,
+   784, 796, 807, 818, 828, 839, 849, 859, 868, 878,
+   887, 896, 904, 912, 920, 928, 935, 943, 949, 956,
+   962, 968, 974, 979, 984, 989, 994, 998,1002,1005,
+  1008,1011,1014,1016,1018,1020,1022,1023,1023,1024,
+  1024
+};
+
+int16_t sinDeg(int16_t deg)
+{
+  deg %= 360;
+  if (deg < 0) deg += 360;
+  if (deg <= 90) return sinTable[deg];
+  if (deg <= 180) return sinTable[180 - deg];
+  if (deg <= 270) return -sinTable[deg - 180];
+  return -sinTable[360 - deg];
+}
+
+int16_t cosDeg(int16_t deg)
+{
+  return sinDeg(deg + 90);
+}
@@ -2,6 +2,7 @@
 
 #define pi 3.14159265358979323846
 #define d2r 0.0174532925199433
+#define SINTAB_SCALE 1024 //result of sinDeg/cosDeg is scaled by this value
 
 /*
 byte getVal(char c);
@@ -23,6 +24,8 @@ double rad2deg(double rad);
 double dtorA(double fdegrees);
 double rtodA(double fradians);
 int CalcBearingA(double lat1, double lon1, double lat2, double lon2);
+int16_t sinDeg(int16_t deg); //table-based sine (integer degrees)
+int16_t cosDeg(int16_t deg); //table-based cosine (integer degrees)
 /*
 bool isNumeric( String inS);
 int isPilotNESW(char NS, char EW );
@@ -0,0 +1,169 @@
+/*!
+ * @file CoreBench.cpp
+ *
+ *
+ */
+
+#include "CoreBench.h"
+#include <esp_freertos_hooks.h>
+#include <esp_timer.h>
+
+static volatile uint32_t idleUs[BENCH_CORES]; //idle-time since last load-window
+static int64_t tLastIdle[BENCH_CORES];
+
+//the idle-task calls the hook in a loop, as long as nothing else is running on the core
+static bool countIdle(uint8_t core){
+  int64_t tAct = esp_timer_get_time();
+  int64_t gap = tAct - tLastIdle[core];
+  tLastIdle[core] = tAct;
+  if (gap < BENCH_IDLEGAP) __atomic_fetch_add(&idleUs[core],(uint32_t)gap,__ATOMIC_RELAXED);
+  return false; //no sleep until next interrupt, we want to be called again
+}
+
+static bool idleHook0(void){
+  return countIdle(0);
+}
+
+static bool idleHook1(void){
+  return countIdle(1);
+}
+
+CoreBench::CoreBench(){
+  bRunning = false;
+  tStart = 0;
+  tStop = millis() - BENCH_INTERVAL;
+  pTaskDiag = NULL;
+  diagId = DIAG_MAXTASKS;
+  mux = portMUX_INITIALIZER_UNLOCKED;
+  memset(&_result,0,sizeof(_result));
+  memset(&varioStart,0,sizeof(varioStart));
+}
+
+bool CoreBench::start(uint32_t duration,uint8_t targets,double lat,double lon,float alt,TaskDiag *pDiag){
+  if (bRunning) return false;
+  if (targets == 0) return false;
+  if (targets > BENCH_MAXTARGETS) targets = BENCH_MAXTARGETS;
+  lat0 = lat;
+  lon0 = lon;
+  alt0 = alt;
+  cosLat0 = cosf(lat * DEG_TO_RAD);
+  if (cosLat0 < 0.01) cosLat0 = 0.01;
+  pTaskDiag = pDiag;
+  diagId = (pDiag) ? pDiag->find("baro") : DIAG_MAXTASKS;
+  memset(&varioStart,0,sizeof(varioStart));
+  if (pTaskDiag) pTaskDiag->getTask(diagId,&varioStart);
+  memset(busySum,0,sizeof(busySum));
+  timeSum = 0;
+  memset(&_result,0,sizeof(_result));
+  _result.duration = duration;
+  _result.targets = targets;
+  for (int i = 0;i < BENCH_CORES;i++){
+    tLastIdle[i] = esp_timer_get_time();
+    idleUs[i] = 0;
+  }
+  esp_register_freertos_idle_hook_for_cpu(idleHook0,0);
+  esp_register_freertos_idle_hook_for_cpu(idleHook1,1);
+  tStart = millis();
+  tWindow = tStart;
+  _result.bRunning = true;
+  bRunning = true;
+  log_i("benchmark started %d targets %ds",targets,duration / 1000);
+  return true;
+}
+
+void CoreBench::stop(void){
+  if (!bRunning) return;
+  esp_deregister_freertos_idle_hook_for_cpu(idleHook0,0);
+  esp_deregister_freertos_idle_hook_for_cpu(idleHook1,1);
+  tStop = millis();
+  bRunning = false;
+  portENTER_CRITICAL(&mux);
+  _result.bRunning = false;
+  portEXIT_CRITICAL(&mux);
+  log_i("benchmark %d targets %d frames: core0=%d.%d%% core1=%d.%d%% vario loops=%d misses=%d",
+        _result.targets,_result.frames,_result.load[0] / 10,_result.load[0] % 10,_result.load[1] / 10,_result.load[1] % 10,
+        _result.varioLoops,_result.varioMisses);
+}
+
+bool CoreBench::isRunning(void){
+  return bRunning;
+}
+
+bool CoreBench::isSynthetic(uint32_t devId){
+  if ((!bRunning) && ((millis() - tStop) >= BENCH_INTERVAL)) return false;
+  return ((devId >= BENCH_DEVID) && (devId < BENCH_DEVID + BENCH_MAXTARGETS));
+}
+
+bool CoreBench::getTarget(uint32_t tAct,target *pTarget){
+  if (!bRunning) return false;
+  uint32_t tElapsed = tAct - tStart;
+  //frames of the targets are spread over the interval
+  if (((uint64_t)_result.frames * BENCH_INTERVAL / _result.targets) > tElapsed) return false;
+  uint8_t i = _result.frames % _result.targets;
+  float radius = 300.0 + i * 40.0; //[m]
+  float speed = 20.0 + (i % 5) * 5.0; //[km/h]
+  float angle = i * 2.4 + (speed / 3.6) * (tElapsed / 1000.0) / radius; //[rad] clockwise, 2.4rad spreads the start-positions
+  pTarget->devId = BENCH_DEVID + i;
+  pTarget->lat = lat0 + (radius * cosf(angle)) / 111320.0;
+  pTarget->lon = lon0 + (radius * sinf(angle)) / (111320.0 * cosLat0);
+  pTarget->alt = alt0 + 100.0 + i * 10.0;
+  pTarget->speed = speed;
+  pTarget->climb = ((int)(i % 7) - 3) * 0.5;
+  pTarget->heading = fmodf(angle * RAD_TO_DEG + 90.0,360.0);
+  portENTER_CRITICAL(&mux);
+  _result.frames++;
+  portEXIT_CRITICAL(&mux);
+  return true;
+}
+
+void CoreBench::update(uint32_t tAct){
+  uint32_t window = (tAct - tWindow) * 1000; //[us]
+  tWindow = tAct;
+  for (int i = 0;i < BENCH_CORES;i++){
+    uint32_t idle = __atomic_exchange_n(&idleUs[i],0,__ATOMIC_RELAXED);
+    if (idle > window) idle = window;
+    busySum[i] += window - idle;
+  }
+  timeSum += window;
+  TaskDiag::taskStats vario;
+  memset(&vario,0,sizeof(vario));
+  if (pTaskDiag) pTaskDiag->getTask(diagId,&vario);
+  portENTER_CRITICAL(&mux);
+  _result.elapsed = tAct - tStart;
+  for (int i = 0;i < BENCH_CORES;i++){
+    _result.load[i] = (timeSum) ? (uint16_t)(busySum[i] * 1000 / timeSum) : 0;
+  }
+  _result.varioLoops = vario.loops - varioStart.loops;
+  _result.varioMisses = vario.misses - varioStart.misses;
+  portEXIT_CRITICAL(&mux);
+}
+
+void CoreBench::run(uint32_t tAct){
+  if (!bRunning) return;
+  if ((tAct - tWindow) >= 1000) update(tAct); //load every second
+  if ((tAct - tStart) >= _result.duration){
+    update(tAct);
+    stop();
+  }
+}
+
+CoreBench::result CoreBench::getResult(void){
+  portENTER_CRITICAL(&mux);
+  result ret = _result;
+  portEXIT_CRITICAL(&mux);
+  return ret;
+}
+
+void CoreBench::getJson(JsonDocument &doc){
+  result res = getResult();
+  JsonObject jBench = doc.createNestedObject("bench");
+  jBench["run"] = res.bRunning;
+  jBench["t"] = res.elapsed / 1000;
+  jBench["dur"] = res.duration / 1000;
+  jBench["targets"] = res.targets;
+  jBench["frames"] = res.frames;
+  JsonArray jLoad = jBench.createNestedArray("load");
+  for (int i = 0;i < BENCH_CORES;i++) jLoad.add(res.load[i] / 10.0);
+  jBench["vLoops"] = res.varioLoops;
+  jBench["vMiss"] = res.varioMisses;
+}
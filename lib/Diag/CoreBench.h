@@ -0,0 +1,75 @@
+/*!
+ * @file CoreBench.h
+ *
+ *
+ */
+
+#ifndef __COREBENCH_H__
+#define __COREBENCH_H__
+
+#include <Arduino.h>
+#include <string.h>
+#include <ArduinoJson.h>
+#include "TaskDiag.h"
+
+#define BENCH_MAXTARGETS 64
+#define BENCH_INTERVAL 1000 //every target sends a tracking-frame every second [ms]
+#define BENCH_DEVID 0xFCBE00 //devIds of the synthetic targets (unregistered manufacturer)
+#define BENCH_IDLEGAP 50 //max. time between 2 calls of the idle-hook, which is counted as idle [us]
+#define BENCH_CORES 2
+
+//synthetic fanet-load: targets circle around our position, the application injects their frames
+//per-core load is measured with idle-hooks, vario deadline-misses come from TaskDiag
+class CoreBench {
+public:
+  typedef struct {
+    uint32_t devId;
+    float lat;
+    float lon;
+    float alt;
+    float speed; //km/h
+    float climb; //m/s
+    float heading; //deg
+  } target;
+
+  typedef struct {
+    bool bRunning;
+    uint32_t duration; //[ms]
+    uint32_t elapsed; //[ms]
+    uint8_t targets;
+    uint32_t frames; //injected frames
+    uint16_t load[BENCH_CORES]; //busy-time of the cores [0.1%]
+    uint32_t varioLoops;
+    uint32_t varioMisses; //loops of the baro-task longer than its deadline
+  } result;
+
+  CoreBench(); //constructor
+  bool start(uint32_t duration,uint8_t targets,double lat,double lon,float alt,TaskDiag *pDiag);
+  void stop(void);
+  bool isRunning(void);
+  bool isSynthetic(uint32_t devId); //also shortly after the end, frames can still be queued
+  bool getTarget(uint32_t tAct,target *pTarget); //next target, which has to send, false if none is due
+  void run(uint32_t tAct); //has to be called cyclic while running (load-measurement, end of benchmark)
+  result getResult(void);
+  void getJson(JsonDocument &doc);
+
+private:
+  void update(uint32_t tAct);
+  volatile bool bRunning;
+  uint32_t tStart;
+  uint32_t tStop;
+  uint32_t tWindow; //start of actual load-window [ms]
+  uint64_t busySum[BENCH_CORES]; //[us]
+  uint64_t timeSum; //[us]
+  double lat0;
+  double lon0;
+  float alt0;
+  float cosLat0;
+  TaskDiag *pTaskDiag;
+  uint8_t diagId; //baro-task
+  TaskDiag::taskStats varioStart;
+  result _result;
+  portMUX_TYPE mux;
+};
+
+#endif
@@ -0,0 +1,152 @@
+/*!
+ * @file TaskDiag.cpp
+ *
+ *
+ */
+
+#include "TaskDiag.h"
+#include <esp_heap_caps.h>
+
+//upper limits of histogram-buckets [ms], last bucket is everything above
+static const uint16_t bucketLimits[DIAG_BUCKETS - 1] = {2,5,10,20,50,100,200,500,1000};
+
+TaskDiag::TaskDiag(){
+  count = 0;
+  mux = portMUX_INITIALIZER_UNLOCKED;
+  tSample = micros();
+  tHeap = millis() - DIAG_HEAPINTERVALL;
+  heapPos = 0;
+  heapCount = 0;
+  memset(tasks,0,sizeof(tasks));
+  memset(timing,0,sizeof(timing));
+  memset(&heap,0,sizeof(heap));
+}
+
+uint8_t TaskDiag::add(const char *name,TaskHandle_t *pHandle,uint32_t deadline){
+  for (int i = 0;i < count;i++){
+    if (strcmp(tasks[i].name,name) == 0) return i;
+  }
+  if (count >= DIAG_MAXTASKS) return DIAG_MAXTASKS;
+  tasks[count].name = name;
+  tasks[count].pHandle = pHandle;
+  tasks[count].deadline = deadline;
+  tasks[count].core = xPortGetCoreID(); //tasks are pinned
+  count++;
+  return count - 1;
+}
+
+uint8_t TaskDiag::find(const char *name){
+  for (int i = 0;i < count;i++){
+    if (strcmp(tasks[i].name,name) == 0) return i;
+  }
+  return DIAG_MAXTASKS;
+}
+
+void TaskDiag::loopStart(uint8_t id){
+  if (id >= count) return;
+  uint32_t tAct = micros();
+  taskStats *pTask = &tasks[id];
+  taskTiming *pTiming = &timing[id];
+  portENTER_CRITICAL(&mux);
+  if (pTiming->tStart){
+    uint32_t period = tAct - pTiming->tStart;
+    if (pTiming->bRunning) pTiming->busy += period; //loop without loopEnd
+    pTask->loops++;
+    if (period > pTask->periodMax) pTask->periodMax = period;
+    uint32_t periodMs = period / 1000;
+    if (periodMs > pTask->deadline) pTask->misses++;
+    uint8_t bucket = 0;
+    while ((bucket < DIAG_BUCKETS - 1) && (periodMs >= bucketLimits[bucket])) bucket++;
+    pTask->histogram[bucket]++;
+  }
+  pTiming->tStart = tAct;
+  pTiming->bRunning = true;
+  portEXIT_CRITICAL(&mux);
+}
+
+void TaskDiag::loopEnd(uint8_t id){
+  if (id >= count) return;
+  uint32_t tAct = micros();
+  taskTiming *pTiming = &timing[id];
+  portENTER_CRITICAL(&mux);
+  if (pTiming->bRunning){
+    pTiming->busy += tAct - pTiming->tStart;
+    pTiming->bRunning = false;
+  }
+  portEXIT_CRITICAL(&mux);
+}
+
+void TaskDiag::run(void){
+  uint32_t tAct = micros();
+  uint32_t window = tAct - tSample;
+  if (window < 1000000) return; //cpu-load every second
+  tSample = tAct;
+  for (int i = 0;i < count;i++){
+    portENTER_CRITICAL(&mux);
+    uint32_t busy = timing[i].busy;
+    timing[i].busy = 0;
+    if (timing[i].bRunning){
+      //loop is running now --> count time until now
+      uint32_t tNow = micros();
+      busy += tNow - timing[i].tStart;
+      timing[i].tStart = tNow;
+      timing[i].busy = 0;
+    }
+    portEXIT_CRITICAL(&mux);
+    tasks[i].cpu = (uint16_t)((uint64_t)busy * 1000 / window);
+    if ((tasks[i].pHandle) && (*tasks[i].pHandle)){
+      tasks[i].stackFree = uxTaskGetStackHighWaterMark(*tasks[i].pHandle); //esp32 --> bytes
+    }
+  }
+  uint32_t tMs = millis();
+  if ((tMs - tHeap) < DIAG_HEAPINTERVALL) return;
+  tHeap = tMs;
+  heap.freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  heap.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  heap.minFree = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  heap.fragmentation = (heap.freeHeap) ? 100 - (uint8_t)((uint64_t)heap.largestBlock * 100 / heap.freeHeap) : 0;
+  heapHistory[heapPos] = heap;
+  heapPos = (heapPos + 1) % DIAG_HEAPHISTORY;
+  if (heapCount < DIAG_HEAPHISTORY) heapCount++;
+}
+
+bool TaskDiag::getTask(uint8_t id,taskStats *stats){
+  if (id >= count) return false;
+  portENTER_CRITICAL(&mux);
+  *stats = tasks[id];
+  portEXIT_CRITICAL(&mux);
+  return true;
+}
+
+TaskDiag::heapStats TaskDiag::getHeap(void){
+  return heap;
+}
+
+void TaskDiag::getJson(JsonDocument &doc){
+  JsonArray jTasks = doc.createNestedArray("tasks");
+  for (int i = 0;i < count;i++){
+    taskStats stat;
+    getTask(i,&stat);
+    JsonObject jTask = jTasks.createNestedObject();
+    jTask["name"] = stat.name;
+    jTask["core"] = stat.core;
+    jTask["cpu"] = stat.cpu / 10.0;
+    jTask["stack"] = stat.stackFree;
+    jTask["loops"] = stat.loops;
+    jTask["miss"] = stat.misses;
+    jTask["dl"] = stat.deadline;
+    jTask["max"] = stat.periodMax / 1000;
+    JsonArray jHist = jTask.createNestedArray("hist");
+    for (int j = 0;j < DIAG_BUCKETS;j++) jHist.add(stat.histogram[j]);
+  }
+  JsonObject jHeap = doc.createNestedObject("heap");
+  jHeap["free"] = heap.freeHeap;
+  jHeap["largest"] = heap.largestBlock;
+  jHeap["min"] = heap.minFree;
+  jHeap["frag"] = heap.fragmentation;
+  //history of largest block, oldest first
+  JsonArray jHist = jHeap.createNestedArray("hist");
+  for (int i = 0;i < heapCount;i++){
+    jHist.add(heapHistory[(heapPos + DIAG_HEAPHISTORY - heapCount + i) % DIAG_HEAPHISTORY].largestBlock);
+  }
+}
@@ -0,0 +1,71 @@
+/*!
+ * @file TaskDiag.h
+ *
+ *
+ */
+
+#ifndef __TASKDIAG_H__
+#define __TASKDIAG_H__
+
+#include <Arduino.h>
+#include <string.h>
+#include <ArduinoJson.h>
+
+#define DIAG_MAXTASKS 10
+#define DIAG_BUCKETS 10 //histogram of loop-periods
+#define DIAG_HEAPHISTORY 60 //heap-samples
+#define DIAG_HEAPINTERVALL 10000 //one heap-sample every 10s
+
+//every task calls loopStart at begin of its loop and loopEnd before waiting
+//busy-time includes time, where the task was preempted by higher-priority-tasks
+class TaskDiag {
+public:
+  typedef struct {
+    const char *name;
+    TaskHandle_t *pHandle;
+    uint32_t deadline; //max. loop-period [ms]
+    uint32_t loops;
+    uint32_t misses; //loops longer than deadline
+    uint32_t periodMax; //[us]
+    uint32_t histogram[DIAG_BUCKETS];
+    uint16_t cpu; //busy-time of last sample-window [0.1%]
+    uint32_t stackFree; //min. free stack [bytes]
+    uint8_t core; //core, the task is running on
+  } taskStats;
+
+  typedef struct {
+    uint32_t freeHeap;
+    uint32_t largestBlock;
+    uint32_t minFree;
+    uint8_t fragmentation; //100 - largestBlock / freeHeap [%]
+  } heapStats;
+
+  TaskDiag(); //constructor
+  uint8_t add(const char *name,TaskHandle_t *pHandle,uint32_t deadline); //returns id of task, has to be called from the task
+  uint8_t find(const char *name); //returns DIAG_MAXTASKS, if not found
+  void loopStart(uint8_t id);
+  void loopEnd(uint8_t id);
+  void run(void); //has to be called cyclic (cpu-load, stack and heap)
+  bool getTask(uint8_t id,taskStats *stats);
+  heapStats getHeap(void);
+  void getJson(JsonDocument &doc);
+
+private:
+  typedef struct {
+    uint32_t tStart; //[us]
+    uint32_t busy; //busy-time since last sample [us]
+    bool bRunning; //loopEnd not called yet
+  } taskTiming;
+  taskStats tasks[DIAG_MAXTASKS];
+  taskTiming timing[DIAG_MAXTASKS];
+  uint8_t count;
+  portMUX_TYPE mux;
+  uint32_t tSample; //[us]
+  uint32_t tHeap; //[ms]
+  heapStats heap;
+  heapStats heapHistory[DIAG_HEAPHISTORY];
+  uint8_t heapPos;
+  uint8_t heapCount;
+};
+
+#endif
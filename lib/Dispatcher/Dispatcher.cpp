@@ -0,0 +1,112 @@
+/*!
+ * @file Dispatcher.cpp
+ *
+ *
+ */
+
+#include "Dispatcher.h"
+
+Dispatcher::Dispatcher(){
+  count = 0;
+  xTask = NULL;
+  wakeups = 0;
+  mux = portMUX_INITIALIZER_UNLOCKED;
+  memset(stats,0,sizeof(stats));
+  memset(entries,0,sizeof(entries));
+}
+
+void Dispatcher::begin(TaskHandle_t task){
+  xTask = task;
+}
+
+uint8_t Dispatcher::add(const char *name,handler_t handler,uint32_t events,uint32_t period){
+  if (count >= DISPATCH_MAXHANDLERS){
+    log_e("too many handlers %s",name);
+    return DISPATCH_MAXHANDLERS;
+  }
+  stats[count].name = name;
+  stats[count].events = events;
+  stats[count].period = period;
+  entries[count].handler = handler;
+  entries[count].tLast = millis();
+  count++;
+  return count - 1;
+}
+
+void Dispatcher::setPeriod(handler_t handler,uint32_t period){
+  for (int i = 0;i < count;i++){
+    if (entries[i].handler != handler) continue;
+    portENTER_CRITICAL(&mux);
+    stats[i].period = period;
+    portEXIT_CRITICAL(&mux);
+  }
+}
+
+void Dispatcher::post(uint32_t events){
+  if (xTask) xTaskNotify(xTask,events,eSetBits);
+}
+
+void IRAM_ATTR Dispatcher::postFromISR(uint32_t events){
+  if (xTask == NULL) return;
+  BaseType_t xWoken = pdFALSE;
+  xTaskNotifyFromISR(xTask,events,eSetBits,&xWoken);
+  if (xWoken) portYIELD_FROM_ISR();
+}
+
+uint32_t Dispatcher::wait(void){
+  uint32_t tAct = millis();
+  uint32_t tWait = DISPATCH_MAXWAIT;
+  for (int i = 0;i < count;i++){
+    if (stats[i].period == 0) continue;
+    uint32_t tElapsed = tAct - entries[i].tLast;
+    uint32_t tRemain = (tElapsed >= stats[i].period) ? 0 : stats[i].period - tElapsed;
+    if (tRemain < tWait) tWait = tRemain;
+  }
+  uint32_t events = 0;
+  xTaskNotifyWait(0,0xFFFFFFFF,&events,pdMS_TO_TICKS(tWait));
+  wakeups++;
+  return events;
+}
+
+void Dispatcher::dispatch(uint32_t events){
+  uint32_t tAct = millis();
+  for (int i = 0;i < count;i++){
+    uint32_t myEvents = events & stats[i].events;
+    if ((myEvents == 0) && ((stats[i].period == 0) || ((tAct - entries[i].tLast) < stats[i].period))) continue;
+    entries[i].tLast = tAct;
+    uint32_t tStart = micros();
+    entries[i].handler(tAct,myEvents);
+    uint32_t tExec = micros() - tStart;
+    portENTER_CRITICAL(&mux);
+    stats[i].calls++;
+    stats[i].timeSum += tExec;
+    if (tExec > stats[i].timeMax) stats[i].timeMax = tExec;
+    portEXIT_CRITICAL(&mux);
+  }
+}
+
+bool Dispatcher::getStats(uint8_t id,handlerStats *pStats){
+  if (id >= count) return false;
+  portENTER_CRITICAL(&mux);
+  *pStats = stats[id];
+  portEXIT_CRITICAL(&mux);
+  return true;
+}
+
+uint32_t Dispatcher::getWakeups(void){
+  return wakeups;
+}
+
+void Dispatcher::getJson(JsonDocument &doc){
+  doc["wakeups"] = wakeups;
+  JsonArray jHandlers = doc.createNestedArray("handlers");
+  for (int i = 0;i < count;i++){
+    handlerStats stat;
+    getStats(i,&stat);
+    JsonObject jHandler = jHandlers.createNestedObject();
+    jHandler["name"] = stat.name;
+    jHandler["calls"] = stat.calls;
+    jHandler["avg"] = (stat.calls) ? (uint32_t)(stat.timeSum / stat.calls) : 0;
+    jHandler["max"] = stat.timeMax;
+  }
+}
@@ -0,0 +1,57 @@
+/*!
+ * @file Dispatcher.h
+ *
+ *
+ */
+
+#ifndef __DISPATCHER_H__
+#define __DISPATCHER_H__
+
+#include <Arduino.h>
+#include <string.h>
+#include <ArduinoJson.h>
+
+#define DISPATCH_MAXHANDLERS 16
+#define DISPATCH_MAXWAIT 100 //max. sleep-time [ms], so that the task can check its stop-flags
+
+//handlers are called from one task, when one of their events was posted or their period is over
+//events are bits of the task-notification-value, so they can be posted from isr
+class Dispatcher {
+public:
+  typedef void (*handler_t)(uint32_t tAct,uint32_t events);
+
+  typedef struct {
+    const char *name;
+    uint32_t events; //events the handler waits for
+    uint32_t period; //[ms] 0 --> only on events
+    uint32_t calls;
+    uint64_t timeSum; //execution-time [us]
+    uint32_t timeMax; //[us]
+  } handlerStats;
+
+  Dispatcher(); //constructor
+  void begin(TaskHandle_t task); //task which calls wait and dispatch
+  uint8_t add(const char *name,handler_t handler,uint32_t events,uint32_t period); //returns id of handler
+  void setPeriod(handler_t handler,uint32_t period); //only from the dispatching task (e.g. by the handler itself)
+  void post(uint32_t events);
+  void postFromISR(uint32_t events);
+  uint32_t wait(void); //sleeps until an event is posted or a period is over, returns the events
+  void dispatch(uint32_t events); //calls the handlers
+  bool getStats(uint8_t id,handlerStats *stats);
+  uint32_t getWakeups(void);
+  void getJson(JsonDocument &doc);
+
+private:
+  typedef struct {
+    handler_t handler;
+    uint32_t tLast; //last call [ms]
+  } handlerEntry;
+  handlerStats stats[DISPATCH_MAXHANDLERS];
+  handlerEntry entries[DISPATCH_MAXHANDLERS];
+  uint8_t count;
+  volatile TaskHandle_t xTask;
+  portMUX_TYPE mux;
+  uint32_t wakeups;
+};
+
+#endif
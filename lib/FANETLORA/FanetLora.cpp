@@ -8,6 +8,10 @@
 #include "Legacy/Legacy.h"
 
 FanetLora::FanetLora(){
+  neighbourMux = portMUX_INITIALIZER_UNLOCKED;
+  knownNameCount = 0;
+  neighbourChanges = 0;
+  bRadioEvent = false;
 }
 
 String FanetLora::uint64ToString(uint64_t input) {
@@ -63,14 +67,87 @@ bool FanetLora::begin(int8_t sck, int8_t miso, int8_t mosi, int8_t ss,int reset,
 
 
 String FanetLora::getNeighbourName(uint32_t devId){
+  FixedString<MAXNAMELEN> name;
+  lockNeighbours();
   for (int i = 0; i < MAXNEIGHBOURS; i++){
     if (neighbours[i].devId == devId){
-      return neighbours[i].name; //found entry
+      name = neighbours[i].name; //found entry
+      break;
     }
   }
+  unlockNeighbours();
+  return name; //String is created outside of the lock
+}
+
+bool FanetLora::getNeighbour(uint8_t index,neighbour *pNeighbour){
+  if (index >= MAXNEIGHBOURS) return false;
+  lockNeighbours();
+  bool bRet = (neighbours[index].devId != 0);
+  if (bRet) *pNeighbour = neighbours[index];
+  unlockNeighbours();
+  return bRet;
+}
+
+uint8_t FanetLora::getKnownNames(knownName *pNames,uint8_t maxCount){
+  uint8_t count = 0;
+  lockNeighbours();
+  for (int i = 0; i < MAXNEIGHBOURS; i++){
+    if (count >= maxCount) break;
+    if ((neighbours[i].devId) && (neighbours[i].name.length())){
+      pNames[count].devId = neighbours[i].devId;
+      pNames[count].name = neighbours[i].name;
+      count++;
+    }
+  }
+  unlockNeighbours();
+  for (int i = 0; i < MAXWEATHERDATAS; i++){
+    if (count >= maxCount) break;
+    if ((weatherDatas[i].devId) && (weatherDatas[i].name.length())){
+      pNames[count].devId = weatherDatas[i].devId;
+      pNames[count].name = weatherDatas[i].name;
+      count++;
+    }
+  }
+  //names from before, which were not received again
+  for (int i = 0; i < knownNameCount; i++){
+    if (count >= maxCount) break;
+    bool bFound = false;
+    for (int j = 0; j < count; j++){
+      if (pNames[j].devId == knownNames[i].devId){
+        bFound = true;
+        break;
+      }
+    }
+    if (!bFound) pNames[count++] = knownNames[i];
+  }
+  return count;
+}
+
+void FanetLora::setKnownNames(const knownName *pNames,uint8_t count){
+  if (count > MAXKNOWNNAMES) count = MAXKNOWNNAMES;
+  lockNeighbours();
+  for (int i = 0; i < count; i++){
+    knownNames[i] = pNames[i];
+  }
+  knownNameCount = count;
+  unlockNeighbours();
+}
+
+const char *FanetLora::getKnownName(uint32_t devId){
+  for (int i = 0; i < knownNameCount; i++){
+    if (knownNames[i].devId == devId) return knownNames[i].name.c_str();
+  }
   return "";
 }
 
+void FanetLora::lockNeighbours(void){
+  portENTER_CRITICAL(&neighbourMux);
+}
+
+void FanetLora::unlockNeighbours(void){
+  portEXIT_CRITICAL(&neighbourMux);
+}
+
 /* send msg: @typedest_manufacturer,msg */
 /*
 void FanetLora::fanet_sendMsg(char *ch_str){
@@ -326,23 +403,36 @@ void FanetLora::insertNameToNeighbour(uint32_t devId, String name){
   //log_i("name=%s",name.c_str());
   //log_i("index=%i",index);
   if (index < 0) return;
+  lockNeighbours();
   neighbours[index].tLastMsg = millis();
   neighbours[index].name = name;
+  unlockNeighbours();
 }
 
 void FanetLora::insertDataToWeatherStation(uint32_t devId, weatherData *Data){
   int16_t index = getWeatherIndex(devId,true);
   if (index < 0) return;
-  Data->name = weatherDatas[index].name; // we have to use existing name !!
+  if (weatherDatas[index].devId == devId){
+    Data->name = weatherDatas[index].name; // we have to use existing name !!
+  }else{
+    Data->name = getKnownName(devId); //new entry --> name from before, if known
+  }
   weatherDatas[index] = *Data;  
   weatherDatas[index].tLastMsg = millis();
 }
 
 void FanetLora::insertDataToNeighbour(uint32_t devId, trackingData *Data){
+  lockNeighbours();
   int16_t index = getneighbourIndex(devId,true);
   //log_i("devId=%06X",devId);
   //log_i("index=%i",index);
-  if (index < 0) return;
+  if (index < 0){
+    unlockNeighbours();
+    return;
+  }
+  if (neighbours[index].devId != devId){
+    neighbours[index].name = getKnownName(devId); //new entry --> name from before, if known
+  }
   neighbours[index].devId = devId;
   neighbours[index].tLastMsg = millis();
   neighbours[index].aircraftType = Data->aircraftType;
@@ -353,20 +443,25 @@ void FanetLora::insertDataToNeighbour(uint32_t devId, trackingData *Data){
   neighbours[index].climb = Data->climb;
   neighbours[index].heading = Data->heading;
   neighbours[index].rssi = Data->rssi;
+  neighbourChanges++;
+  unlockNeighbours();
 }
 
 void FanetLora::clearNeighboursWeather(uint32_t tAct){
   static uint32_t tCheck = millis();
   if ((tAct - tCheck) >= 5000){ //check only every 5 seconds
     tCheck = tAct;
+    lockNeighbours();
     for (int i = 0; i < MAXNEIGHBOURS; i++){
       if (neighbours[i].devId){
         if ((tCheck - neighbours[i].tLastMsg) >= NEIGHBOURSLIFETIME){ //if we get no msg in 4min --> del neighbour
           //log_i("clear slot %i devId %s",i,getDevId(neighbours[i].devId).c_str());
           neighbours[i].devId = 0; //clear slot
+          neighbourChanges++;
         }
       }
     }
+    unlockNeighbours();
     for (int i = 0; i < MAXWEATHERDATAS; i++){
       if (weatherDatas[i].devId){
         if ((tCheck - weatherDatas[i].tLastMsg) >= NEIGHBOURSLIFETIME){ //if we get no msg in 4min --> del neighbour
@@ -409,6 +504,10 @@ uint8_t FanetLora::getNeighboursCount(void){
   return countRet;
 }
 
+uint32_t FanetLora::getNeighbourChanges(void){
+  return neighbourChanges;
+}
+
 String FanetLora::getactMsg(){
     String ret = actMsg;
     actMsg = "";
@@ -421,13 +520,25 @@ bool FanetLora::isNewMsg(){
     return ret;
 }
 
-void FanetLora::run(void){    
+void FanetLora::run(bool bRxEvent){    
   uint32_t tAct = millis();
   clearNeighboursWeather(millis());
   if (autobroadcast){
     sendPilotName(tAct);
   }
-  fmac.handle();
+  if (bRxEvent) fmac.handleNow(); //packet received --> read it now
+  else fmac.handle();
+}
+
+void FanetLora::setRadioEvent(void (*callback)(void)){
+  LoRa.onDio0(callback);
+  bRadioEvent = (callback != NULL);
+}
+
+uint32_t FanetLora::getPollTime(void){
+  //without notification the radio is polled, frames in the fifos are handled slot by slot (csma, acks)
+  if ((!bRadioEvent) || (fmac.isBusy())) return MAC_SLOT_MS;
+  return FANET_IDLE_POLL;
 }
 
 void FanetLora::setLegacy(uint8_t enableTx){ 
@@ -559,7 +670,6 @@ void FanetLora::getWeatherinfo(uint8_t *buffer,uint16_t length){
     lastWeatherData.bStateOfCharge = false;
     lastWeatherData.Charge = NAN;
   }
-  newWData = true;
 }
 
 
@@ -590,24 +700,21 @@ void FanetLora::getGroundTrackingInfo(uint8_t *buffer,uint16_t length){
     //log_i("online-tracking=%d",actTrackingData.OnlineTracking);
     actTrackingData.type = 70 + (type >> 4);
     //log_i("type=%d,groundType=%d",type,actTrackingData.type);
-    newData = true;
 
 }
 
 bool FanetLora::getNameData(nameData *nameData){
-    bool bRet = newName;
-    *nameData = lastNameData; //copy tracking-data
-    memset(&lastNameData,0,sizeof(lastNameData));
-    newName = false; //clear new Data flag
-    return bRet;
+    return rxName.pop(nameData);
 }
 
 bool FanetLora::getWeatherData(weatherData *weather){
-    bool bRet = newWData;
-    *weather = lastWeatherData; //copy tracking-data
-    memset(&lastWeatherData,0,sizeof(lastWeatherData));
-    newWData = false; //clear new Data flag
-    return bRet;
+    return rxWeather.pop(weather);
+}
+
+void FanetLora::getRxStats(rxQueueStats *tracking,rxQueueStats *name,rxQueueStats *weather){
+    *tracking = rxTracking.getStats();
+    *name = rxName.getStats();
+    *weather = rxWeather.getStats();
 }
 
 void FanetLora::handle_frame(Frame *frm){
@@ -635,19 +742,22 @@ void FanetLora::handle_frame(Frame *frm){
   uint32_t devId = getDevIdFromMac(&frm->src);
   if (frm->type == 1){
     //online-tracking
+    memset(&actTrackingData,0,sizeof(actTrackingData));
     actTrackingData.devId = ((uint32_t)frm->src.manufacturer << 16) + (uint32_t)frm->src.id;
     actTrackingData.rssi = frm->rssi;
     actTrackingData.snr = frm->snr;
     actTrackingData.type = 11;
     getTrackingInfo(payload,frm->payload_length);
     insertDataToNeighbour(actTrackingData.devId,&actTrackingData);
+    rxTracking.push(actTrackingData);
   }else if (frm->type == 2){      
       //log_i("name=%s",msg2.c_str());
+      lastNameData = nameData();
       lastNameData.devId = ((uint32_t)frm->src.manufacturer << 16) + (uint32_t)frm->src.id;
       lastNameData.rssi = frm->rssi;
       lastNameData.snr = frm->snr;
       lastNameData.name = msg2;
-      newName = true;
+      rxName.push(lastNameData);
       insertNameToWeather(devId,msg2); //insert name in weather-list
       insertNameToNeighbour(devId,msg2); //insert name in neighbour-list
   }else if (frm->type == 3){
@@ -655,23 +765,37 @@ void FanetLora::handle_frame(Frame *frm){
     //if (frm->dest)
   }else if (frm->type == 4){   
     //weather-data   
+      lastWeatherData = weatherData();
       lastWeatherData.devId = ((uint32_t)frm->src.manufacturer << 16) + (uint32_t)frm->src.id;
       lastWeatherData.rssi = frm->rssi;
       lastWeatherData.snr = frm->snr;
       getWeatherinfo(frm->payload,frm->payload_length);    
       insertDataToWeatherStation(devId,&lastWeatherData);
+      rxWeather.push(lastWeatherData);
   }else if (frm->type == 7){      
     //ground-tracking
+    memset(&actTrackingData,0,sizeof(actTrackingData));
     actTrackingData.devId = ((uint32_t)frm->src.manufacturer << 16) + (uint32_t)frm->src.id;
     actTrackingData.rssi = frm->rssi;
     actTrackingData.snr = frm->snr;
     getGroundTrackingInfo(frm->payload,frm->payload_length);
+    rxTracking.push(actTrackingData);
   }
   //log_i("%s",msg.c_str());
   add2ActMsg(msg);
   rxCount++;
 }
 
+void FanetLora::simulateTracking(trackingData *tData){
+  Frame *frm = new Frame(getMacFromDevId(tData->devId));
+  frm->type = FRM_TYPE_TRACKING;
+  frm->payload_length = serialize_tracking(tData,frm->payload);
+  frm->rssi = tData->rssi;
+  frm->snr = tData->snr;
+  handle_frame(frm);
+  delete frm;
+}
+
 void FanetLora::add2ActMsg(String s){
   if (actMsg.length() != 0){
     actMsg += "\n";
@@ -839,11 +963,7 @@ int FanetLora::getByteFromHex(char in[]){
 }
 
 bool FanetLora::getTrackingData(trackingData *tData){
-    bool bRet = newData;
-    *tData = actTrackingData; //copy tracking-data
-    memset(&actTrackingData,0,sizeof(actTrackingData)); //clear tracking-data
-    newData = false; //clear new Data flag
-    return bRet;
+    return rxTracking.pop(tData);
 }
 
 void FanetLora::getTrackingInfo(String line,uint16_t length){
@@ -892,7 +1012,6 @@ void FanetLora::getTrackingInfo(String line,uint16_t length){
 
     actTrackingData.heading = float(getByteFromHex(&arPayload[20])) * 360 / 255;
     if (actTrackingData.heading  < 0) actTrackingData.heading += 360.0;
-    newData = true;
 }
 void FanetLora::coord2payload_absolut(float lat, float lon, uint8_t *buf)
 {
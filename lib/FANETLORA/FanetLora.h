@@ -16,6 +16,8 @@
 //#include "app.h"
 #include "./radio/LoRa.h"
 #include "CalcTools.h"
+#include "RxQueue.h"
+#include <FixedString.h>
 
 
 
@@ -28,6 +30,7 @@
 #define FANET_LORA_TYPE1OR7_AIRTIME_MS			40		//actually 20-30ms
 #define	FANET_LORA_TYPE1OR7_MINTAU_MS			250
 #define	FANET_LORA_TYPE1OR7_TAU_MS			5000
+#define FANET_IDLE_POLL 100 //radio notifies received packets --> broadcasts and neighbours only [ms]
 
 #define SEPARATOR			','
 
@@ -36,7 +39,13 @@
 
 
 #define MAXNEIGHBOURS 64
+#define MAXNAMELEN 32 //max. length of names of neighbours and weather-stations
 #define MAXWEATHERDATAS 10
+#define MAXKNOWNNAMES 24 //names of stations, which are not in the lists at the moment (e.g. before deep-sleep)
+
+#define RXQUEUE_TRACKING 100 //received tracking-frames waiting for application, holds a burst of a busy ground-station
+#define RXQUEUE_NAME 8
+#define RXQUEUE_WEATHER 8
 
 #define NEIGHBOURSLIFETIME 240000ul //4min
 #define SENDNAMEINTERVAL 240000ul //every 4min
@@ -121,7 +130,7 @@ public:
 
   typedef struct {
     uint32_t devId;
-    String name;
+    FixedString<MAXNAMELEN> name;
     int rssi; //rssi
     int snr; //signal to noise ratio
   } nameData;
@@ -145,7 +154,7 @@ public:
   typedef struct {
     uint32_t tLastMsg; //timestamp of neighbour (if 0 --> empty slot)
     uint32_t devId; //devId
-    String name; //name of neughbour
+    FixedString<MAXNAMELEN> name; //name of neughbour
     aircraft_t aircraftType; //
     float lat; //latitude
     float lon; //longitude
@@ -159,7 +168,7 @@ public:
   typedef struct {
     uint32_t tLastMsg; //timestamp of neighbour (if 0 --> empty slot)
     uint32_t devId; //devId
-    String name; //name of neughbour
+    FixedString<MAXNAMELEN> name; //name of neughbour
     int rssi; //rssi
     int snr; //signal to noise ratio
     float lat; //latitude
@@ -178,13 +187,22 @@ public:
     float Charge; //+1byte lower 4 bits: 0x00 = 0%, 0x01 = 6.666%, .. 0x0F = 100%
   } weatherData;
 
+  typedef struct {
+    uint32_t devId;
+    FixedString<MAXNAMELEN> name;
+  } knownName;
+
   FanetLora(); //constructor
   bool begin(int8_t sck, int8_t miso, int8_t mosi, int8_t ss,int reset, int dio0,long frequency,uint8_t outputPower);
   void end(void);
   String getMyDevId(void);
   String getDevId(uint32_t devId);
   String getNeighbourName(uint32_t devId);
+  bool getNeighbour(uint8_t index,neighbour *pNeighbour); //copy for other tasks, false if slot is empty
   uint8_t getNeighboursCount(void);
+  uint32_t getNeighbourChanges(void); //counter, changes with every update of the neighbour-list
+  uint8_t getKnownNames(knownName *pNames,uint8_t maxCount); //names of neighbours and weather-stations, only from the task which calls run()
+  void setKnownNames(const knownName *pNames,uint8_t count); //names are used, when the stations are received again
   int16_t getNextNeighbor(uint8_t index);
   int16_t getNearestNeighborIndex();
   void setPilotname(String name);
@@ -196,20 +214,24 @@ public:
   void writeMsgType4(weatherData *wData);
   String getAircraftType(aircraft_t type);
   aircraft_t getAircraftType(void);
-  void run(void); //has to be called cyclic
+  void run(bool bRxEvent = false); //has to be called after a radio-event and at least every getPollTime ms
+  void setRadioEvent(void (*callback)(void)); //isr on dio0 (packet received), only notifies
+  uint32_t getPollTime(void); //max. time until the next call of run [ms]
   bool isNewMsg();
   String getactMsg(); 
-  bool getTrackingData(trackingData *tData);
+  bool getTrackingData(trackingData *tData); //returns false if no more data in queue
   bool getMyTrackingData(trackingData *tData);
-  bool getNameData(nameData *nameData);
-  bool getWeatherData(weatherData *weather);
+  bool getNameData(nameData *nameData); //returns false if no more data in queue
+  bool getWeatherData(weatherData *weather); //returns false if no more data in queue
+  void getRxStats(rxQueueStats *tracking,rxQueueStats *name,rxQueueStats *weather);
   void printFanetData(trackingData tData);
   void sendTracking(trackingData *tData);
   void sendName(String name);
   void sendMSG(String msg);
+  void simulateTracking(trackingData *tData); //synthetic tracking-frame, takes the same way as a received one
   uint16_t txCount;
   uint16_t rxCount;
-  neighbour neighbours[MAXNEIGHBOURS];
+  neighbour neighbours[MAXNEIGHBOURS]; //direct access only from the task which calls run(), other tasks use getNeighbour
   weatherData weatherDatas[MAXWEATHERDATAS];
   uint8_t weathercount;
   trackingData _myData;
@@ -236,6 +258,7 @@ public:
 protected:
 private:  
   uint8_t _enableLegacyTx;
+  volatile uint32_t neighbourChanges;
   String _PilotName;  
   uint32_t valid_until;
   bool newMsg;
@@ -246,12 +269,18 @@ private:
   int getByteFromHex(char in[]);
   String getHexFromByte(uint8_t val,bool leadingZero = false);    
   String getHexFromWord(uint16_t val,bool leadingZero = false);
-  trackingData actTrackingData;
-  bool newData = false;
+  trackingData actTrackingData; //decoded frame
   nameData lastNameData;
-  bool newName = false;
   weatherData lastWeatherData;
-  bool newWData = false;
+  RxQueue<trackingData,RXQUEUE_TRACKING> rxTracking;
+  RxQueue<nameData,RXQUEUE_NAME> rxName;
+  RxQueue<weatherData,RXQUEUE_WEATHER> rxWeather;
+  portMUX_TYPE neighbourMux; //entries are copied by other tasks
+  knownName knownNames[MAXKNOWNNAMES];
+  uint8_t knownNameCount;
+  const char *getKnownName(uint32_t devId); //"" if unknown
+  void lockNeighbours(void);
+  void unlockNeighbours(void);
   void getTrackingInfo(String line,uint16_t length);
   void getGroundTrackingInfo(uint8_t *buffer,uint16_t length);  
   void getWeatherinfo(uint8_t *buffer,uint16_t length);  
@@ -278,6 +307,7 @@ private:
 	/* determines the tx rate */
 	unsigned long last_tx = 0;
 	unsigned long next_tx = 0;
+  bool bRadioEvent; //received packets are notified by dio0
 
   typedef struct fanet_header_t {
     unsigned int type           :6;
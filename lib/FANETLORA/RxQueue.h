@@ -0,0 +1,82 @@
+/*!
+ * @file RxQueue.h
+ *
+ *
+ */
+
+#ifndef __RXQUEUE_H__
+#define __RXQUEUE_H__
+
+#include <Arduino.h>
+
+typedef struct {
+  uint32_t pushed; //frames put into queue
+  uint32_t overflow; //frames lost because queue was full
+  uint8_t maxFill; //max. number of waiting frames
+} rxQueueStats;
+
+//bounded queue of decoded frames, if full the oldest entry is overwritten
+//items are plain structs (names in FixedString) --> copies are short, protected by a spinlock like the neighbours
+template <class T,uint8_t N> class RxQueue {
+public:
+  RxQueue(){
+    head = 0;
+    count = 0;
+    mux = portMUX_INITIALIZER_UNLOCKED;
+    memset(&_stats,0,sizeof(_stats));
+  }
+
+  void push(const T &item){
+    lock();
+    if (count >= N){
+      //drop oldest frame
+      head = (head + 1) % N;
+      count--;
+      _stats.overflow++;
+    }
+    items[(head + count) % N] = item;
+    count++;
+    _stats.pushed++;
+    if (count > _stats.maxFill) _stats.maxFill = count;
+    unlock();
+  }
+
+  bool pop(T *item){
+    bool bRet = false;
+    lock();
+    if (count > 0){
+      *item = items[head];
+      head = (head + 1) % N;
+      count--;
+      bRet = true;
+    }
+    unlock();
+    return bRet;
+  }
+
+  uint8_t available(void){
+    return count;
+  }
+
+  rxQueueStats getStats(void){
+    lock();
+    rxQueueStats ret = _stats;
+    unlock();
+    return ret;
+  }
+
+private:
+  void lock(void){
+    portENTER_CRITICAL(&mux);
+  }
+  void unlock(void){
+    portEXIT_CRITICAL(&mux);
+  }
+  T items[N];
+  uint8_t head; //index of oldest frame
+  volatile uint8_t count;
+  portMUX_TYPE mux;
+  rxQueueStats _stats;
+};
+
+#endif
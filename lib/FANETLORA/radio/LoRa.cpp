@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include "LoRa.h"
+#include <Trace.h>
 
 // registers
 #define REG_FIFO                 0x00
@@ -76,7 +77,9 @@ LoRaClass::LoRaClass() :
   _frequency(0),
   _packetIndex(0),
   _implicitHeaderMode(0),
-  _onReceive(NULL)
+  _onReceive(NULL),
+  _onDio0(NULL),
+  _rxMode(MODE_RX_SINGLE)
 {
   // overide Stream timeout value
   setTimeout(0);
@@ -303,16 +306,16 @@ int LoRaClass::parsePacket(int size)
     // set FIFO address to current RX address
     writeRegister(REG_FIFO_ADDR_PTR, readRegister(REG_FIFO_RX_CURRENT_ADDR));
 
-    // put in standby mode
-    idle();
-  } else if (readRegister(REG_OP_MODE) != (MODE_LONG_RANGE_MODE | MODE_RX_SINGLE)) {
+    // put in standby mode (continuous mode keeps receiving)
+    if (_rxMode == MODE_RX_SINGLE) idle();
+  } else if (readRegister(REG_OP_MODE) != (MODE_LONG_RANGE_MODE | _rxMode)) {
     // not currently in RX mode
 
     // reset FIFO address
     writeRegister(REG_FIFO_ADDR_PTR, 0);
 
-    // put in single RX mode
-    writeRegister(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_RX_SINGLE);
+    // put in RX mode
+    writeRegister(REG_OP_MODE, MODE_LONG_RANGE_MODE | _rxMode);
   }
 
   return packetLength;
@@ -590,6 +593,9 @@ int LoRaClass::sendFrame(uint8_t *data, int length, uint8_t cr){
 #if (SX1276_debug_mode > 0)
 	Serial.printf("done\n");
 #endif
+	/* back to rx, there is no poll which re-arms the receiver */
+	if (_rxMode == MODE_RX_CONTINUOUS)
+		writeRegister(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_RX_CONTINUOUS);
 	return TX_OK;
 
 }
@@ -756,11 +762,29 @@ void LoRaClass::onReceive(void(*callback)(int))
 #endif
     attachInterrupt(digitalPinToInterrupt(_dio0), LoRaClass::onDio0Rise, RISING);
   } else {
-    detachInterrupt(digitalPinToInterrupt(_dio0));
 #ifdef SPI_HAS_NOTUSINGINTERRUPT
     SPI.notUsingInterrupt(digitalPinToInterrupt(_dio0));
 #endif
+    if (_onDio0) attachInterrupt(digitalPinToInterrupt(_dio0), _onDio0, RISING); //keep notification
+    else detachInterrupt(digitalPinToInterrupt(_dio0));
+  }
+}
+
+void LoRaClass::onDio0(void(*callback)(void))
+{
+  if (_dio0 < 0) return;
+  _onDio0 = callback;
+  if (callback) {
+    // dio0 = RxDone, the packet is read by parsePacket outside of the isr
+    pinMode(_dio0, INPUT);
+    writeRegister(REG_DIO_MAPPING_1, 0x00);
+    attachInterrupt(digitalPinToInterrupt(_dio0), callback, RISING);
+    _rxMode = MODE_RX_CONTINUOUS;
+  } else {
+    detachInterrupt(digitalPinToInterrupt(_dio0));
+    _rxMode = MODE_RX_SINGLE;
   }
+  if (armed) parsePacket(); //clears pending irqs and switches the rx-mode
 }
 
 void LoRaClass::receive(int size)
@@ -1053,6 +1077,7 @@ void LoRaClass::implicitHeaderMode()
 
 void LoRaClass::handleDio0Rise()
 {
+  trace.start(TRACE_LORA_IRQ);
   int irqFlags = readRegister(REG_IRQ_FLAGS);
 
   // clear IRQ's
@@ -1077,6 +1102,7 @@ void LoRaClass::handleDio0Rise()
       _onReceive(packetLength);
     }
   }
+  trace.stop(TRACE_LORA_IRQ,irqFlags);
 }
 
 uint8_t LoRaClass::readRegister(uint8_t address)
@@ -1341,6 +1367,8 @@ void LoRaClass::irqEnable(bool enable)
   if (enable)
   {
    attachInterrupt(digitalPinToInterrupt(_dio0), LoRaClass::onDio0Rise, RISING);
+  } else if (_onDio0) {
+    attachInterrupt(digitalPinToInterrupt(_dio0), _onDio0, RISING); //keep notification
   } else {
     detachInterrupt(digitalPinToInterrupt(_dio0));
   }
@@ -199,6 +199,7 @@ public:
 
 #ifndef ARDUINO_SAMD_MKRWAN1300
   void onReceive(void(*callback)(int));
+  void onDio0(void(*callback)(void)); //only notifies (no spi in isr), receiver stays in continuous mode
 
   void receive(int size = 0);
 #endif
@@ -313,6 +314,8 @@ private:
   int _packetIndex;
   int _implicitHeaderMode;
   void (*_onReceive)(int);
+  void (*_onDio0)(void);
+  uint8_t _rxMode; //single (polled) or continuous (dio0-notification)
 };
 
 extern LoRaClass LoRa;
@@ -14,6 +14,7 @@
 #include <TimeLib.h>
 #include "Legacy/Legacy.h"
 #include "CRC/lib_crc.h"
+#include <Trace.h>
 
 
 /* get next frame which can be sent out */
@@ -206,13 +207,14 @@ bool FanetMac::begin(int8_t sck, int8_t miso, int8_t mosi, int8_t ss,int reset,
 	//if (setting.band == BAND915)frequency = FREQUENCY915; 
 	log_i("Start Lora Frequency=%d",frequency);
 	uint8_t counter = 0;
-	while (!LoRa.begin(frequency) && counter < 10) {
-		log_i(".");
+	while (!LoRa.begin(frequency) && counter < MAC_RADIO_STARTTRIES) {
 		counter++;
-		delay(500);
+		delay(MAC_RADIO_STARTDELAY_MS);
 	}
-	if (counter == 10) {
+	if (counter == MAC_RADIO_STARTTRIES) {
 		log_e("Starting LoRa failed!"); 
+	}else if (counter) {
+		log_i("LoRa answered after %dms",counter * MAC_RADIO_STARTDELAY_MS);
 	}
 	LoRa.setSignalBandwidth(250E3); //set Bandwidth to 250kHz
 	LoRa.setSpreadingFactor(7); //set spreading-factor to 7
@@ -297,7 +299,9 @@ void FanetMac::ack(Frame* frm)
 void FanetMac::handleIRQ(){
 	int packetSize = LoRa.parsePacket();
 	if (packetSize > 0){
+		trace.start(TRACE_LORA_PARSE,packetSize);
 		frameRxWrapper(packetSize);
+		trace.stop(TRACE_LORA_PARSE);
 	}
 }
 
@@ -322,6 +326,7 @@ void FanetMac::handleRx()
 	Frame *frm = rx_fifo.front();
 	if(frm == nullptr)
 		return;
+	trace.start(TRACE_MAC_RX,frm->type);
 
 	/* build up neighbors list */
 	bool neighbor_known = false;
@@ -410,12 +415,14 @@ void FanetMac::handleRx()
 
 			/* add to list */
 			tx_fifo.add(frm);
+			trace.stop(TRACE_MAC_RX);
 			return;
 		}
 	}
 
 	/* discard frame */
 	delete frm;
+	trace.stop(TRACE_MAC_RX);
 }
 
 
@@ -627,7 +634,9 @@ void FanetMac::handleTx()
 
 	/* channel free and transmit? */
 	//note: for only a few nodes around, increase the coding rate to ensure a more robust transmission
+	trace.start(TRACE_MAC_TX,blength);
 	int tx_ret = LoRa.sendFrame(buffer, blength, neighbors.size() < MAC_CODING48_THRESHOLD ? 8 : 5);
+	trace.stop(TRACE_MAC_TX,tx_ret);
 	//int tx_ret=TX_OK;
 	delete[] buffer;
 
@@ -77,6 +77,8 @@
 #define NEIGHBOR_MAX_TIMEOUT_MS			250000		//4min + 10sek
 
 #define MAC_SYNCWORD				0xF1
+#define MAC_RADIO_STARTTRIES			100		//radio needs some time after power-on --> poll it
+#define MAC_RADIO_STARTDELAY_MS			50
 
 /*
  * Number defines
@@ -189,6 +191,8 @@ public:
 	bool begin(int8_t sck, int8_t miso, int8_t mosi, int8_t ss,int reset, int dio0,Fapp &app,long frequency,uint8_t level);
 	void end();
 	void handle() { myTimer.Update(); }
+	void handleNow() { stateWrapper(); } //radio-event --> don't wait for the next slot
+	bool isBusy(void) { return ((rx_fifo.size() > 0) || (tx_fifo.size() > 0)); } //frames waiting --> handle every slot
 
 	bool txQueueDepleted(void) { return (tx_fifo.size() == 0); }
 	bool txQueueHasFreeSlots(void){ return (tx_fifo.size() < MAC_FIFO_SIZE); }
@@ -64,7 +64,6 @@ String Flarm::writeFlarmData(FlarmtrackingData *myData,FlarmtrackingData *movePi
     float relNorth=cos(rads) * pilotDistance * 1000;
     float relEast=sin(rads) * pilotDistance * 1000;
     float relVert = movePilotData->altitude - myData->altitude;
-    float currentSpeed = movePilotData->speed/KMPH_TO_MS;
     /*
     Serial.printf("myLat=%.6f\n",myData->lat);
     Serial.printf("myLon=%.6f\n",myData->lon);
@@ -85,6 +84,11 @@ String Flarm::writeFlarmData(FlarmtrackingData *myData,FlarmtrackingData *movePi
     Serial.print("relNorth=");Serial.println(relNorth);
     Serial.print("relEast=");Serial.println(relEast);
     */
+    return writeFlarmData(relNorth,relEast,relVert,movePilotData);
+}
+
+String Flarm::writeFlarmData(float relNorth,float relEast,float relVert,FlarmtrackingData *movePilotData){
+    float currentSpeed = movePilotData->speed/KMPH_TO_MS;
     String movingpilotData = "$PFLAA,0," + String((int32_t)round(relNorth)) + "," + String((int32_t)round(relEast)) + "," + String((int32_t)round(relVert)) + ",2," +
     		                    movePilotData->DevId + "," + (int32_t)round(movePilotData->heading) + ",0,"  +
 								 String(currentSpeed,1) + "," + String(movePilotData->climb,1) + ","+ getHexFromByte1(uint8_t(movePilotData->aircraftType));
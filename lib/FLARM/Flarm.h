@@ -57,6 +57,7 @@ public:
     uint8_t neighbors;
     uint8_t GPSState;
     String writeFlarmData(FlarmtrackingData *myData,FlarmtrackingData *movePilotData);
+    String writeFlarmData(float relNorth,float relEast,float relVert,FlarmtrackingData *movePilotData); //relative position already known
     String writeDataPort(void);
     String writeVersion(void);
     String writeSelfTestResult(void);
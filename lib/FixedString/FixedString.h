@@ -0,0 +1,78 @@
+/*!
+ * @file FixedString.h
+ *
+ *
+ */
+
+#ifndef __FIXEDSTRING_H__
+#define __FIXEDSTRING_H__
+
+#include <Arduino.h>
+#include <string.h>
+
+//string with inline buffer for max. N chars, longer strings are cut
+//trivially copyable --> structs with it can be copied and cleared without heap
+template <uint8_t N> class FixedString {
+public:
+  FixedString(){
+    buf[0] = 0;
+  }
+  FixedString(const char *s){
+    set(s);
+  }
+  FixedString(const String &s){
+    set(s.c_str());
+  }
+  FixedString &operator=(const char *s){
+    set(s);
+    return *this;
+  }
+  FixedString &operator=(const String &s){
+    set(s.c_str());
+    return *this;
+  }
+  bool assign(const char *s){ //false, if s was cut
+    return set(s);
+  }
+  operator String() const{
+    return String(buf);
+  }
+  const char *c_str() const{
+    return buf;
+  }
+  size_t length() const{
+    return strlen(buf);
+  }
+  bool startsWith(const char *prefix) const{
+    return (strncmp(buf,prefix,strlen(prefix)) == 0);
+  }
+  bool operator==(const char *s) const{
+    return (strcmp(buf,s) == 0);
+  }
+  bool operator!=(const char *s) const{
+    return (strcmp(buf,s) != 0);
+  }
+  template <uint8_t M> bool operator==(const FixedString<M> &s) const{
+    return (strcmp(buf,s.c_str()) == 0);
+  }
+  template <uint8_t M> bool operator!=(const FixedString<M> &s) const{
+    return (strcmp(buf,s.c_str()) != 0);
+  }
+  static constexpr uint8_t capacity(){
+    return N;
+  }
+
+private:
+  bool set(const char *s){
+    size_t full = (s) ? strlen(s) : 0;
+    size_t len = (full > N) ? N : full;
+    //don't cut an utf-8-sequence
+    while ((len > 0) && (len < full) && ((s[len] & 0xC0) == 0x80)) len--;
+    if (len) memcpy(buf,s,len);
+    memset(&buf[len],0,N + 1 - len); //unused part is cleared too --> equal strings are equal in memory (crc, memcmp)
+    return (len == full);
+  }
+  char buf[N + 1];
+};
+
+#endif
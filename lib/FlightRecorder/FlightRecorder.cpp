@@ -0,0 +1,616 @@
+/*!
+ * @file FlightRecorder.cpp
+ *
+ *
+ */
+
+#include "FlightRecorder.h"
+
+//sign-extension of a bit-field of a packed fix
+static inline int32_t fieldValue(uint16_t v,uint8_t bits){
+  return (int32_t)((uint32_t)v << (32 - bits)) >> (32 - bits);
+}
+
+static inline bool inRange(int32_t v,uint8_t bits){
+  return (v >= -(1 << (bits - 1))) && (v < (1 << (bits - 1)));
+}
+
+FlightRecorder::FlightRecorder(){
+  xTask = NULL;
+  xMutex = xSemaphoreCreateMutex(); //here, igc-export can be requested before the recorder-task is running
+  mux = portMUX_INITIALIZER_UNLOCKED;
+  buffer[0] = NULL;
+  buffer[1] = NULL;
+  igcBlock = NULL;
+  igcSrc = NULL;
+  bRecording = false;
+  bStartReq = false;
+  bStopReq = false;
+  blocks = 0;
+  session = 0;
+  seq = 0;
+  sessionSeq = 0;
+  dropCount = 0;
+  blockCount = 0;
+  wrapCount = 0;
+  pendingBuffer = -1;
+  bFixKey = false;
+  baroAlt = 0;
+  myLat = 0;
+  myLon = 0;
+  reservedCount = 0;
+}
+
+void FlightRecorder::reserveSpace(const char *fileName,uint32_t size){
+  for (int i = 0;i < reservedCount;i++){
+    if (strcmp(reserved[i].fileName,fileName) == 0){
+      reserved[i].size = size; //task was restarted
+      return;
+    }
+  }
+  if (reservedCount >= FLIGHTRECORDER_MAXRESERVED){
+    log_e("too many reserved files %s",fileName);
+    return;
+  }
+  reserved[reservedCount].fileName = fileName;
+  reserved[reservedCount].size = size;
+  reservedCount++;
+}
+
+int32_t FlightRecorder::reservedBytes(void){
+  //existing files are already in usedBytes
+  int32_t bytes = 0;
+  for (int i = 0;i < reservedCount;i++){
+    uint32_t existing = 0;
+    if (SPIFFS.exists(reserved[i].fileName)){
+      File f = SPIFFS.open(reserved[i].fileName,"r");
+      if (f) existing = f.size();
+      f.close();
+    }
+    if (reserved[i].size > existing) bytes += reserved[i].size - existing;
+  }
+  return bytes;
+}
+
+bool FlightRecorder::begin(String pilot,String glider){
+  _pilot = pilot;
+  _glider = glider;
+  xTask = xTaskGetCurrentTaskHandle();
+  for (int i = 0;i < 2;i++){
+    if (buffer[i] == NULL) buffer[i] = (uint8_t *)malloc(FLIGHTRECORDER_BLOCKSIZE);
+    if (buffer[i] == NULL){
+      log_e("no memory for flight-recorder");
+      return false;
+    }
+  }
+  xSemaphoreTake(xMutex,portMAX_DELAY);
+  bool bOk = openFile();
+  if (bOk) scanBlocks();
+  xSemaphoreGive(xMutex);
+  if (!bOk) return false;
+  log_i("flight-recorder ready blocks=%d session=%d seq=%d",blocks,session,seq);
+  return true;
+}
+
+void FlightRecorder::end(void){
+  stop();
+  run(); //flush last block
+  xSemaphoreTake(xMutex,portMAX_DELAY);
+  if (file) file.close();
+  xSemaphoreGive(xMutex);
+  xTask = NULL;
+  for (int i = 0;i < 2;i++){
+    free(buffer[i]);
+    buffer[i] = NULL;
+  }
+}
+
+bool FlightRecorder::openFile(void){
+  //ring-file takes the free space of the filesystem, an existing ring-file counts as free
+  //files of the other rings may be created later --> their space is not free
+  file = SPIFFS.open(FLIGHTRECORDER_FILE,"r+");
+  int32_t freeBytes = SPIFFS.totalBytes() - SPIFFS.usedBytes() - FLIGHTRECORDER_MINFREE - reservedBytes();
+  if (file) freeBytes += file.size();
+  int32_t maxBlocks = freeBytes / FLIGHTRECORDER_BLOCKSIZE;
+  if (maxBlocks > FLIGHTRECORDER_MAXBLOCKS) maxBlocks = FLIGHTRECORDER_MAXBLOCKS;
+  if ((file) && (file.size() > 0) && ((file.size() % FLIGHTRECORDER_BLOCKSIZE) == 0)){
+    blocks = file.size() / FLIGHTRECORDER_BLOCKSIZE;
+    if (abs(maxBlocks - (int32_t)blocks) < FLIGHTRECORDER_RESIZE) return true; //keep recorded flights
+    log_i("resize flight-recorder %d --> %d blocks",blocks,maxBlocks);
+  }
+  if (file) file.close();
+  SPIFFS.remove(FLIGHTRECORDER_FILE);
+  //preallocate ring-file, so we never run out of space during flight
+  if (maxBlocks < 2){
+    log_e("not enough space for flight-recorder free=%d",freeBytes);
+    return false;
+  }
+  blocks = maxBlocks;
+  file = SPIFFS.open(FLIGHTRECORDER_FILE,"w");
+  if (!file){
+    log_e("can't create %s",FLIGHTRECORDER_FILE);
+    return false;
+  }
+  memset(buffer[0],0xFF,FLIGHTRECORDER_BLOCKSIZE);
+  for (int i = 0;i < blocks;i++){
+    file.write(buffer[0],FLIGHTRECORDER_BLOCKSIZE);
+  }
+  file.close();
+  file = SPIFFS.open(FLIGHTRECORDER_FILE,"r+");
+  return (bool)file;
+}
+
+bool FlightRecorder::readBlockHeader(File &f,uint16_t index,blockHeader *header){
+  if (!f.seek((uint32_t)index * FLIGHTRECORDER_BLOCKSIZE,SeekSet)) return false;
+  if (f.read((uint8_t *)header,sizeof(blockHeader)) != sizeof(blockHeader)) return false;
+  if (header->magic != FLIGHTRECORDER_MAGIC) return false;
+  if ((header->used < sizeof(blockHeader)) || (header->used > FLIGHTRECORDER_BLOCKSIZE)) return false;
+  return true;
+}
+
+void FlightRecorder::scanBlocks(void){
+  blockHeader header;
+  bool bFirst = true;
+  session = 0;
+  seq = 0;
+  for (int i = 0;i < blocks;i++){
+    if (!readBlockHeader(file,i,&header)) continue;
+    if ((bFirst) || (header.seq >= seq)){
+      //newest block holds the last session
+      seq = header.seq + 1;
+      session = header.session;
+      bFirst = false;
+    }
+  }
+}
+
+void FlightRecorder::start(void){
+  bStartReq = true;
+  if (xTask) xTaskNotifyGive(xTask);
+}
+
+void FlightRecorder::stop(void){
+  bStopReq = true;
+  if (xTask) xTaskNotifyGive(xTask);
+}
+
+bool FlightRecorder::isRecording(void){
+  return bRecording;
+}
+
+uint32_t FlightRecorder::getDropCount(void){
+  return dropCount;
+}
+
+uint32_t FlightRecorder::getBlockCount(void){
+  return blockCount;
+}
+
+uint32_t FlightRecorder::getWrapCount(void){
+  return wrapCount;
+}
+
+uint16_t FlightRecorder::getRingBlocks(void){
+  return blocks;
+}
+
+void FlightRecorder::swapBuffers(void){
+  //has to be called inside critical section
+  blockHeader *header = (blockHeader *)buffer[actBuffer];
+  header->used = actFill;
+  pendingBuffer = actBuffer;
+  actBuffer ^= 1;
+  actFill = sizeof(blockHeader);
+  bFixKey = false; //every block starts with a full fix
+}
+
+uint8_t *FlightRecorder::reserve(uint16_t size,bool *pNotify){
+  //has to be called inside critical section
+  if ((actFill + size) > FLIGHTRECORDER_BLOCKSIZE){
+    if (pendingBuffer >= 0){
+      //flash is slower than we produce data --> drop record, never block caller
+      dropCount++;
+      return NULL;
+    }
+    swapBuffers();
+    *pNotify = true;
+  }
+  return &buffer[actBuffer][actFill];
+}
+
+void FlightRecorder::logRecord(uint8_t type,const void *data,uint8_t len){
+  if (!bRecording) return;
+  recHeader header;
+  header.type = type;
+  header.len = len;
+  header.tSec = (millis() - tStart) / 1000;
+  uint16_t size = sizeof(recHeader) + len;
+  bool bNotify = false;
+  portENTER_CRITICAL(&mux);
+  if (!bRecording){
+    portEXIT_CRITICAL(&mux);
+    return;
+  }
+  uint8_t *dest = reserve(size,&bNotify);
+  if (dest){
+    memcpy(dest,&header,sizeof(recHeader));
+    memcpy(dest + sizeof(recHeader),data,len);
+    actFill += size;
+  }
+  portEXIT_CRITICAL(&mux);
+  if ((bNotify) && (xTask)) xTaskNotifyGive(xTask);
+}
+
+uint8_t FlightRecorder::encodeFix(uint8_t *dest,const recFix *fix){
+  //has to be called inside critical section
+  //fixes of one block are coded against the last one, mostly only the change of the deltas (2 bytes)
+  int32_t d[4] = {fix->lat - lastFix.lat,fix->lon - lastFix.lon,fix->gpsAlt - lastFix.gpsAlt,fix->baroAlt - lastFix.baroAlt};
+  uint8_t len;
+  if ((bFixKey) && (fix->utc == (lastFix.utc + 1))){
+    int32_t a[4];
+    for (int i = 0;i < 4;i++) a[i] = d[i] - fixSpeed[i];
+    if ((inRange(a[0],4)) && (inRange(a[1],4)) && (inRange(a[2],4)) && (inRange(a[3],3))){
+      uint16_t v = 0x8000 | ((a[0] & 0x0F) << 11) | ((a[1] & 0x0F) << 7) | ((a[2] & 0x0F) << 3) | (a[3] & 0x07);
+      dest[0] = v >> 8;
+      dest[1] = v & 0xFF;
+      len = 2;
+    }else if ((inRange(d[0],8)) && (inRange(d[1],8)) && (inRange(d[2],8)) && (inRange(d[3],8))){
+      recFixDelta delta = {(int8_t)d[0],(int8_t)d[1],(int8_t)d[2],(int8_t)d[3]};
+      dest[0] = FR_REC_FIXDELTA;
+      memcpy(&dest[1],&delta,sizeof(delta));
+      len = 1 + sizeof(delta);
+    }else{
+      len = 0;
+    }
+  }else{
+    len = 0;
+  }
+  if (len == 0){
+    dest[0] = FR_REC_FIX;
+    memcpy(&dest[1],fix,sizeof(recFix));
+    len = 1 + sizeof(recFix);
+    memset(fixSpeed,0,sizeof(fixSpeed));
+  }else{
+    memcpy(fixSpeed,d,sizeof(fixSpeed));
+  }
+  lastFix = *fix;
+  bFixKey = true;
+  return len;
+}
+
+void FlightRecorder::writeBlock(uint8_t *buf){
+  blockHeader *header = (blockHeader *)buf;
+  header->magic = FLIGHTRECORDER_MAGIC;
+  header->session = session;
+  header->seq = seq;
+  header->sessionSeq = sessionSeq;
+  if ((seq - sessionSeq) >= blocks){
+    //ring is full --> oldest block of this flight gets overwritten
+    if (wrapCount == 0) log_w("flight-recorder ring full (%d blocks), overwriting start of flight",blocks);
+    wrapCount++;
+  }
+  //always write whole sectors at sector-boundaries
+  xSemaphoreTake(xMutex,portMAX_DELAY);
+  file.seek((seq % blocks) * FLIGHTRECORDER_BLOCKSIZE,SeekSet);
+  file.write(buf,FLIGHTRECORDER_BLOCKSIZE);
+  file.flush();
+  xSemaphoreGive(xMutex);
+  seq++;
+  blockCount++;
+}
+
+void FlightRecorder::run(void){
+  if (xTask == NULL) return;
+  if ((pendingBuffer < 0) && (!bStartReq) && (!bStopReq)){
+    ulTaskNotifyTake(pdTRUE,pdMS_TO_TICKS(1000));
+  }
+  if (!file) return;
+  if (bStartReq){
+    bStartReq = false;
+    if (!bRecording){
+      session++;
+      sessionSeq = seq;
+      wrapCount = 0;
+      tStart = millis();
+      tBaro = tStart - FLIGHTRECORDER_SLOWINTERVAL;
+      tImu = tStart - FLIGHTRECORDER_SLOWINTERVAL;
+      actBuffer = 0;
+      actFill = sizeof(blockHeader);
+      pendingBuffer = -1;
+      bFixKey = false;
+      bRecording = true;
+      log_i("flight-recorder start session %d",session);
+    }
+  }
+  if (pendingBuffer >= 0){
+    writeBlock(buffer[pendingBuffer]);
+    portENTER_CRITICAL(&mux);
+    pendingBuffer = -1;
+    portEXIT_CRITICAL(&mux);
+  }
+  if (bStopReq){
+    bStopReq = false;
+    if (bRecording){
+      portENTER_CRITICAL(&mux);
+      bRecording = false; //no producer can swap the buffers anymore
+      int8_t full = pendingBuffer; //a producer can have swapped since the write above
+      int8_t partial = -1;
+      if (actFill > sizeof(blockHeader)){
+        ((blockHeader *)buffer[actBuffer])->used = actFill;
+        partial = actBuffer;
+      }
+      portEXIT_CRITICAL(&mux);
+      //full block first, it is the older one
+      if (full >= 0) writeBlock(buffer[full]);
+      if (partial >= 0) writeBlock(buffer[partial]);
+      pendingBuffer = -1;
+      actFill = sizeof(blockHeader);
+      log_i("flight-recorder stop session %d blocks=%d dropped=%d overwritten=%d",session,blockCount,dropCount,wrapCount);
+    }
+  }
+}
+
+void FlightRecorder::logBaro(float pressure,float alt,float climb,float temp){
+  baroAlt = (int16_t)alt; //for the next fix
+  if ((millis() - tBaro) < FLIGHTRECORDER_SLOWINTERVAL) return;
+  tBaro = millis();
+  recBaro rec;
+  rec.pressure = pressure;
+  rec.alt = (int32_t)(alt * 100.0);
+  rec.climb = (int16_t)(climb * 100.0);
+  rec.temp = (int16_t)(temp * 10.0);
+  logRecord(FR_REC_BARO,&rec,sizeof(rec));
+}
+
+void FlightRecorder::logImu(int16_t *accel,int16_t *gyro){
+  if ((millis() - tImu) < FLIGHTRECORDER_SLOWINTERVAL) return;
+  tImu = millis();
+  recImu rec;
+  memcpy(rec.accel,accel,sizeof(rec.accel));
+  memcpy(rec.gyro,gyro,sizeof(rec.gyro));
+  logRecord(FR_REC_IMU,&rec,sizeof(rec));
+}
+
+void FlightRecorder::logGps(uint32_t utc,double lat,double lon,float alt){
+  if (!bRecording) return;
+  recFix fix;
+  fix.utc = utc;
+  fix.lat = (int32_t)lround(lat * 60000.0);
+  fix.lon = (int32_t)lround(lon * 60000.0);
+  fix.gpsAlt = (int16_t)alt;
+  fix.baroAlt = baroAlt;
+  bool bNotify = false;
+  portENTER_CRITICAL(&mux);
+  if (!bRecording){
+    portEXIT_CRITICAL(&mux);
+    return;
+  }
+  myLat = fix.lat;
+  myLon = fix.lon;
+  uint8_t *dest = reserve(FR_MAXFIXSIZE,&bNotify);
+  if (dest) actFill += encodeFix(dest,&fix);
+  portEXIT_CRITICAL(&mux);
+  if ((bNotify) && (xTask)) xTaskNotifyGive(xTask);
+}
+
+void FlightRecorder::logNeighbour(uint32_t devId,float lat,float lon,float alt,uint8_t aircraftType,int rssi){
+  recNeighbour rec;
+  rec.devId[0] = devId >> 16;
+  rec.devId[1] = devId >> 8;
+  rec.devId[2] = devId;
+  rec.lat = (int16_t)constrain(lround(lat * 60000.0) - myLat,-32768,32767);
+  rec.lon = (int16_t)constrain(lround(lon * 60000.0) - myLon,-32768,32767);
+  rec.alt = (int16_t)alt;
+  rec.aircraftType = aircraftType;
+  rec.rssi = (int8_t)constrain(rssi,-128,127);
+  logRecord(FR_REC_NEIGHBOUR,&rec,sizeof(rec));
+}
+
+/************************ igc-export ************************/
+
+bool FlightRecorder::igcOpen(void){
+  igcClose();
+  blockHeader header;
+  blockHeader oldest = {0,0,0,0,0};
+  bool bFound = false;
+  xSemaphoreTake(xMutex,portMAX_DELAY);
+  if (file){
+    igcSrc = &file; //recorder is running --> no second handle, reads are serialized with the writes
+  }else{
+    igcFile = SPIFFS.open(FLIGHTRECORDER_FILE,"r");
+    igcSrc = &igcFile;
+  }
+  igcBlocks = (*igcSrc) ? igcSrc->size() / FLIGHTRECORDER_BLOCKSIZE : 0;
+  //newest block --> session to export
+  for (int i = 0;i < igcBlocks;i++){
+    if (!readBlockHeader(*igcSrc,i,&header)) continue;
+    if ((!bFound) || (header.seq > igcLastSeq)){
+      igcLastSeq = header.seq;
+      igcSession = header.session;
+      bFound = true;
+    }
+  }
+  //oldest block of this session still in the ring
+  igcSeq = igcLastSeq;
+  for (int i = 0;(bFound) && (i < igcBlocks);i++){
+    if (!readBlockHeader(*igcSrc,i,&header)) continue;
+    if ((header.session == igcSession) && (header.seq <= igcSeq)){
+      igcSeq = header.seq;
+      oldest = header;
+    }
+  }
+  xSemaphoreGive(xMutex);
+  if (!bFound){
+    igcClose();
+    return false;
+  }
+  igcWrapped = (oldest.sessionSeq != oldest.seq);
+  igcBlock = (uint8_t *)malloc(FLIGHTRECORDER_BLOCKSIZE);
+  if (igcBlock == NULL){
+    igcClose();
+    return false;
+  }
+  //we need the first fix for the date in the header
+  uint32_t firstSeq = igcSeq;
+  igcPos = 0;
+  igcUsed = 0;
+  memset(&igcFirstFix,0,sizeof(igcFirstFix));
+  if (igcNextFix()) igcFirstFix = igcFix;
+  igcSeq = firstSeq;
+  igcPos = 0;
+  igcUsed = 0;
+  igcState = 0;
+  igcLineLen = 0;
+  igcLinePos = 0;
+  return true;
+}
+
+void FlightRecorder::igcClose(void){
+  if (igcFile) igcFile.close();
+  igcSrc = NULL;
+  free(igcBlock);
+  igcBlock = NULL;
+}
+
+bool FlightRecorder::igcNextBlock(void){
+  blockHeader header;
+  while (igcSeq <= igcLastSeq){
+    uint16_t index = igcSeq % igcBlocks;
+    igcSeq++;
+    xSemaphoreTake(xMutex,portMAX_DELAY);
+    bool bOk = ((*igcSrc) && (igcSrc->seek((uint32_t)index * FLIGHTRECORDER_BLOCKSIZE,SeekSet)) && (igcSrc->read(igcBlock,FLIGHTRECORDER_BLOCKSIZE) == FLIGHTRECORDER_BLOCKSIZE));
+    xSemaphoreGive(xMutex);
+    if (!bOk) continue;
+    memcpy(&header,igcBlock,sizeof(blockHeader));
+    //block can be overwritten by the recorder during export
+    if ((header.magic != FLIGHTRECORDER_MAGIC) || (header.session != igcSession) || (header.seq != (igcSeq - 1))) continue;
+    if (header.used > FLIGHTRECORDER_BLOCKSIZE) continue;
+    igcPos = sizeof(blockHeader);
+    igcUsed = header.used;
+    return true;
+  }
+  return false;
+}
+
+bool FlightRecorder::igcNextRecord(bool *pFix){
+  //decodes the record at igcPos, false at the end of the block
+  *pFix = false;
+  if (igcPos >= igcUsed) return false;
+  uint8_t *data = &igcBlock[igcPos];
+  uint16_t left = igcUsed - igcPos;
+  int32_t d[4];
+  if (data[0] & FR_REC_PACKED){
+    if (left < 2) return false;
+    uint16_t v = ((uint16_t)data[0] << 8) | data[1];
+    d[0] = igcSpeed[0] + fieldValue(v >> 11,4);
+    d[1] = igcSpeed[1] + fieldValue(v >> 7,4);
+    d[2] = igcSpeed[2] + fieldValue(v >> 3,4);
+    d[3] = igcSpeed[3] + fieldValue(v,3);
+    igcPos += 2;
+  }else if (data[0] == FR_REC_FIXDELTA){
+    if (left < (1 + sizeof(recFixDelta))) return false;
+    recFixDelta delta;
+    memcpy(&delta,&data[1],sizeof(delta));
+    d[0] = delta.lat;
+    d[1] = delta.lon;
+    d[2] = delta.gpsAlt;
+    d[3] = delta.baroAlt;
+    igcPos += 1 + sizeof(recFixDelta);
+  }else if (data[0] == FR_REC_FIX){
+    if (left < (1 + sizeof(recFix))) return false;
+    memcpy(&igcFix,&data[1],sizeof(recFix));
+    memset(igcSpeed,0,sizeof(igcSpeed));
+    igcPos += 1 + sizeof(recFix);
+    *pFix = true;
+    return true;
+  }else{
+    if (left < sizeof(recHeader)) return false;
+    recHeader *rec = (recHeader *)data;
+    igcPos += sizeof(recHeader) + rec->len;
+    return (igcPos <= igcUsed); //truncated record
+  }
+  igcFix.utc++;
+  igcFix.lat += d[0];
+  igcFix.lon += d[1];
+  igcFix.gpsAlt += d[2];
+  igcFix.baroAlt += d[3];
+  memcpy(igcSpeed,d,sizeof(igcSpeed));
+  *pFix = true;
+  return true;
+}
+
+bool FlightRecorder::igcNextFix(void){
+  bool bFix;
+  while (1){
+    if (!igcNextRecord(&bFix)){
+      if (!igcNextBlock()) return false;
+      continue;
+    }
+    if (bFix) return true;
+  }
+}
+
+bool FlightRecorder::igcNextLine(void){
+  tmElements_t tm;
+  igcLinePos = 0;
+  igcLineLen = 0;
+  while (igcLineLen == 0){
+    switch (igcState){
+    case 0:
+      igcLineLen = snprintf(igcLine,sizeof(igcLine),"AXGXGXAirCom\r\n");
+      break;
+    case 1:
+      breakTime(igcFirstFix.utc,tm);
+      igcLineLen = snprintf(igcLine,sizeof(igcLine),"HFDTE%02d%02d%02d\r\n",tm.Day,tm.Month,(tm.Year + 1970) % 100);
+      break;
+    case 2:
+      igcLineLen = snprintf(igcLine,sizeof(igcLine),"HFPLTPILOTINCHARGE:%s\r\n",_pilot.c_str());
+      break;
+    case 3:
+      igcLineLen = snprintf(igcLine,sizeof(igcLine),"HFGTYGLIDERTYPE:%s\r\n",_glider.c_str());
+      break;
+    case 4:
+      igcLineLen = snprintf(igcLine,sizeof(igcLine),"HFFTYFRTYPE:GXAirCom\r\n");
+      break;
+    case 5:
+      if (igcWrapped) igcLineLen = snprintf(igcLine,sizeof(igcLine),"LGXARING FULL, START OF FLIGHT OVERWRITTEN\r\n");
+      break;
+    default:
+      if (!igcNextFix()) return false;
+      breakTime(igcFix.utc,tm);
+      {
+        //1/60000 deg --> DDMMmmm
+        int32_t lat = abs(igcFix.lat);
+        int32_t lon = abs(igcFix.lon);
+        igcLineLen = snprintf(igcLine,sizeof(igcLine),"B%02d%02d%02d%02d%05d%c%03d%05d%cA%05d%05d\r\n",
+                              tm.Hour,tm.Minute,tm.Second,
+                              lat / 60000,lat % 60000,(igcFix.lat >= 0) ? 'N' : 'S',
+                              lon / 60000,lon % 60000,(igcFix.lon >= 0) ? 'E' : 'W',
+                              igcFix.baroAlt,igcFix.gpsAlt);
+      }
+      break;
+    }
+    if (igcState < 6) igcState++;
+  }
+  if (igcLineLen >= sizeof(igcLine)) igcLineLen = sizeof(igcLine) - 1; //truncated
+  return true;
+}
+
+size_t FlightRecorder::igcRead(uint8_t *buffer,size_t maxLen){
+  size_t len = 0;
+  if ((igcSrc == NULL) || (igcBlock == NULL)) return 0;
+  while (len < maxLen){
+    if (igcLinePos >= igcLineLen){
+      if (!igcNextLine()){
+        igcClose();
+        break;
+      }
+    }
+    size_t n = igcLineLen - igcLinePos;
+    if (n > (maxLen - len)) n = maxLen - len;
+    memcpy(&buffer[len],&igcLine[igcLinePos],n);
+    igcLinePos += n;
+    len += n;
+  }
+  return len;
+}
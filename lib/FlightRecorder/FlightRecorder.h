@@ -0,0 +1,177 @@
+/*!
+ * @file FlightRecorder.h
+ *
+ *
+ */
+
+#ifndef __FLIGHTRECORDER_H__
+#define __FLIGHTRECORDER_H__
+
+#include <Arduino.h>
+#include <string.h>
+#include <SPIFFS.h>
+#include <TimeLib.h>
+
+#define FLIGHTRECORDER_FILE "/flight.bin"
+#define FLIGHTRECORDER_MAGIC 0x32465847ul //"GXF2"
+#define FLIGHTRECORDER_BLOCKSIZE 4096 //one flash-sector
+#define FLIGHTRECORDER_MAXBLOCKS 256 //max. size of the ring-file, otherwise all free space is used
+#define FLIGHTRECORDER_MINFREE 16384 //keep space free for the web-files
+#define FLIGHTRECORDER_MAXRESERVED 4 //other ring-files, which keep their space
+#define FLIGHTRECORDER_RESIZE 4 //existing ring-file is recreated, if free space differs more than this [blocks]
+#define FLIGHTRECORDER_SLOWINTERVAL 300000 //interval of baro- and imu-records [ms], fixes (with baro-alt) are recorded every second
+
+#define FR_REC_BARO 1
+#define FR_REC_IMU 2
+#define FR_REC_FIX 3 //full fix
+#define FR_REC_NEIGHBOUR 4
+#define FR_REC_FIXDELTA 5 //fix 1s after the last one, 8bit-deltas
+#define FR_REC_PACKED 0x80 //fix 1s after the last one, 2 bytes with the change of the deltas
+#define FR_MAXFIXSIZE (1 + sizeof(FlightRecorder::recFix))
+
+class FlightRecorder {
+public:
+  typedef struct {
+    uint32_t magic;
+    uint16_t session; //number of flight
+    uint16_t used; //used bytes of block (including header)
+    uint32_t seq; //sequence-number of block
+    uint32_t sessionSeq; //sequence-number of the first block of the session
+  } __attribute__((packed)) blockHeader;
+
+  //header of baro-, imu- and neighbour-records, fixes have only the type-byte
+  typedef struct {
+    uint8_t type;
+    uint8_t len; //length of payload
+    uint16_t tSec; //s since start of recording
+  } __attribute__((packed)) recHeader;
+
+  typedef struct {
+    float pressure; //hPa
+    int32_t alt; //cm
+    int16_t climb; //cm/s
+    int16_t temp; //0.1°C
+  } __attribute__((packed)) recBaro;
+
+  typedef struct {
+    int16_t accel[3];
+    int16_t gyro[3];
+  } __attribute__((packed)) recImu;
+
+  //lat/lon in igc-resolution (1/1000 minute), the export is lossless
+  typedef struct {
+    uint32_t utc; //unix-time
+    int32_t lat; //1/60000 deg
+    int32_t lon; //1/60000 deg
+    int16_t gpsAlt; //m
+    int16_t baroAlt; //m
+  } __attribute__((packed)) recFix;
+
+  typedef struct {
+    int8_t lat;
+    int8_t lon;
+    int8_t gpsAlt;
+    int8_t baroAlt;
+  } __attribute__((packed)) recFixDelta;
+
+  typedef struct {
+    uint8_t devId[3]; //fanet-id
+    int16_t lat; //1/60000 deg, relative to own position
+    int16_t lon; //1/60000 deg, relative to own position
+    int16_t alt; //m
+    uint8_t aircraftType;
+    int8_t rssi;
+  } __attribute__((packed)) recNeighbour;
+
+  FlightRecorder(); //constructor
+  void reserveSpace(const char *fileName,uint32_t size); //space of a file, which is created later (uplink-stores), call before begin
+  bool begin(String pilot,String glider); //has to be called from the recorder-task
+  void end(void);
+  void run(void); //has to be called cyclic from the recorder-task, blocks until there is work
+  void start(void); //start new flight (non blocking)
+  void stop(void); //stop flight and flush data (non blocking)
+  bool isRecording(void);
+  void logBaro(float pressure,float alt,float climb,float temp);
+  void logImu(int16_t *accel,int16_t *gyro);
+  void logGps(uint32_t utc,double lat,double lon,float alt);
+  void logNeighbour(uint32_t devId,float lat,float lon,float alt,uint8_t aircraftType,int rssi);
+  uint32_t getDropCount(void);
+  uint32_t getBlockCount(void);
+  uint32_t getWrapCount(void); //blocks of the actual flight, which are already overwritten
+  uint16_t getRingBlocks(void);
+  //igc-export
+  bool igcOpen(void);
+  size_t igcRead(uint8_t *buffer,size_t maxLen);
+  void igcClose(void);
+
+private:
+  uint8_t *reserve(uint16_t size,bool *pNotify);
+  void logRecord(uint8_t type,const void *data,uint8_t len);
+  uint8_t encodeFix(uint8_t *dest,const recFix *fix);
+  bool openFile(void);
+  int32_t reservedBytes(void);
+  void scanBlocks(void);
+  bool readBlockHeader(File &f,uint16_t index,blockHeader *header);
+  void writeBlock(uint8_t *buffer);
+  void swapBuffers(void);
+  bool igcNextBlock(void);
+  bool igcNextLine(void);
+  bool igcNextRecord(bool *pFix);
+  bool igcNextFix(void);
+  typedef struct {
+    const char *fileName;
+    uint32_t size;
+  } reservedFile;
+  reservedFile reserved[FLIGHTRECORDER_MAXRESERVED];
+  uint8_t reservedCount;
+  File file;
+  SemaphoreHandle_t xMutex; //file is shared by recorder-task and igc-export
+  String _pilot;
+  String _glider;
+  TaskHandle_t xTask;
+  portMUX_TYPE mux;
+  uint8_t *buffer[2];
+  uint8_t actBuffer; //buffer we are writing records to
+  uint16_t actFill;
+  int8_t pendingBuffer; //buffer waiting for flash-write (-1 --> none)
+  volatile bool bRecording;
+  volatile bool bStartReq;
+  volatile bool bStopReq;
+  uint32_t tStart;
+  uint16_t blocks; //number of blocks in ring-file
+  uint16_t session; //actual session
+  uint32_t seq; //next block-sequence
+  uint32_t sessionSeq; //first block of actual session
+  uint32_t dropCount;
+  uint32_t blockCount;
+  uint32_t wrapCount;
+  //state of the fix-encoder, reset with every block
+  bool bFixKey;
+  recFix lastFix;
+  int32_t fixSpeed[4]; //last deltas of lat,lon,gpsAlt,baroAlt
+  volatile int16_t baroAlt; //last baro-altitude for the fixes [m]
+  int32_t myLat; //last own position, reference of neighbours
+  int32_t myLon;
+  uint32_t tBaro;
+  uint32_t tImu;
+  //igc-export
+  File igcFile;
+  File *igcSrc; //file of recorder, if it is running
+  uint16_t igcBlocks;
+  uint16_t igcSession;
+  uint32_t igcSeq;
+  uint32_t igcLastSeq;
+  uint8_t *igcBlock;
+  uint16_t igcPos;
+  uint16_t igcUsed;
+  uint8_t igcState;
+  char igcLine[80];
+  uint8_t igcLineLen;
+  uint8_t igcLinePos;
+  bool igcWrapped; //start of flight is overwritten
+  recFix igcFix; //last decoded fix
+  int32_t igcSpeed[4];
+  recFix igcFirstFix;
+};
+
+#endif
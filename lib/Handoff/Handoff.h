@@ -0,0 +1,60 @@
+/*!
+ * @file Handoff.h
+ *
+ *
+ */
+
+#ifndef __HANDOFF_H__
+#define __HANDOFF_H__
+
+#include <Arduino.h>
+
+#define HANDOFF_SPINS 8 //retries of a reader, before it gives the cpu to the writer
+
+//passes the latest value of one writer-task to readers on both cores (sequence-lock)
+//the writer never waits, a reader copies again, if the writer changed the value meanwhile
+//T has to be trivially copyable (no Strings)
+template <class T> class Handoff {
+public:
+  Handoff(){
+    seq = 0;
+    memset(&value,0,sizeof(value));
+  }
+
+  //only one task may write
+  void write(const T &newValue){
+    uint32_t seqAct = seq;
+    __atomic_store_n(&seq,seqAct + 1,__ATOMIC_RELAXED); //odd --> writing
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    value = newValue;
+    __atomic_store_n(&seq,seqAct + 2,__ATOMIC_RELEASE);
+  }
+
+  void read(T *pValue){
+    uint8_t spins = 0;
+    while (1){
+      uint32_t seqStart = __atomic_load_n(&seq,__ATOMIC_ACQUIRE);
+      if ((seqStart & 1) == 0){
+        *pValue = value;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&seq,__ATOMIC_RELAXED) == seqStart) return;
+      }
+      spins++;
+      if (spins >= HANDOFF_SPINS){
+        //writer was preempted by us on the same core --> let it finish
+        spins = 0;
+        vTaskDelay(1);
+      }
+    }
+  }
+
+  uint32_t getVersion(void){
+    return seq >> 1; //counts the writes
+  }
+
+private:
+  volatile uint32_t seq;
+  T value;
+};
+
+#endif
@@ -10,6 +10,8 @@ Ogn::Ogn(){
     _user = "";
     client = NULL;
     xMutex = NULL;
+    memset(lastSent,0,sizeof(lastSent));
+    memset(&_sendStats,0,sizeof(_sendStats));
 }
 
 void Ogn::setClient(Client *_client){
@@ -35,11 +37,145 @@ bool Ogn::begin(String user,String version){
         xMutex = new SemaphoreHandle_t();
         *xMutex = xSemaphoreCreateMutex();
     }
+    sendQueue.begin(OGN_QUEUE_LEN,sizeof(sendItem));
+    pendingCount = 0;
+    pendingBytes = 0;
     return true;
 }
 
 void Ogn::end(void){
+    sendQueue.end();
+}
+
+UplinkQueue::stats Ogn::getQueueStats(void){
+    return sendQueue.getStats();
+}
+
+Ogn::sendStats Ogn::getSendStats(void){
+    return _sendStats;
+}
+
+void Ogn::setMinInterval(uint8_t seconds){
+    minInterval = (uint32_t)seconds * 1000;
+}
+
+void Ogn::setOfflineStore(UplinkStore *store){
+    offlineStore = store;
+}
+
+void Ogn::queueLine(const char *line,const char *key){
+    sendItem item;
+    item.key[0] = 0;
+    if (key){
+        strncpy(item.key,key,OGN_KEYLEN - 1);
+        item.key[OGN_KEYLEN - 1] = 0;
+    }
+    strncpy(item.line,line,OGN_MAXLINE - 1);
+    item.line[OGN_MAXLINE - 1] = 0;
+    sendQueue.push(&item);
+}
+
+Ogn::aircraftSent *Ogn::getAircraftSent(const char *key,uint32_t tAct){
+    aircraftSent *pFree = NULL;
+    for (int i = 0;i < OGN_MAXAIRCRAFT;i++){
+        if (strcmp(lastSent[i].key,key) == 0) return &lastSent[i];
+        //empty entry or min. interval is over --> entry can be reused without losing the rate-limit
+        if ((pFree == NULL) && ((lastSent[i].key[0] == 0) || ((tAct - lastSent[i].tSent) >= minInterval))) pFree = &lastSent[i];
+    }
+    if (pFree == NULL) return NULL; //all aircrafts within min. interval
+    strcpy(pFree->key,key);
+    pFree->tSent = tAct - minInterval; //send first position immediately
+    return pFree;
+}
+
+void Ogn::addPending(sendItem *item,uint32_t tAct){
+    if (item->key[0]){
+        for (int i = 0;i < pendingCount;i++){
+            if (strcmp(pending[i].key,item->key) == 0){
+                //older position of this aircraft not sent yet --> replace it
+                pendingBytes -= strlen(pending[i].line);
+                strcpy(pending[i].line,item->line);
+                pendingBytes += strlen(pending[i].line);
+                _sendStats.stale++;
+                return;
+            }
+        }
+        aircraftSent *pSent = getAircraftSent(item->key,tAct);
+        if ((pSent == NULL) || ((minInterval) && ((tAct - pSent->tSent) < minInterval))){
+            //within min. interval or no free entry (all aircrafts within min. interval) --> drop it
+            _sendStats.rateLimited++;
+            return;
+        }
+        pSent->tSent = tAct;
+    }
+    if (pendingCount >= OGN_PENDING) writePending();
+    if (pendingCount == 0) tPending = tAct;
+    pending[pendingCount] = *item;
+    pendingBytes += strlen(item->line);
+    pendingCount++;
+}
+
+void Ogn::writePending(void){
+    uint16_t len = 0;
+    for (int i = 0;i <= pendingCount;i++){
+        uint16_t lineLen = (i < pendingCount) ? strlen(pending[i].line) : 0;
+        if ((len > 0) && ((i == pendingCount) || (len + lineLen > OGN_SENDBUF))){
+            //one write for all collected lines
+            xSemaphoreTake( *xMutex, portMAX_DELAY );
+            size_t written = client->write((const uint8_t *)sendBuffer,len);
+            xSemaphoreGive( *xMutex );
+            _sendStats.writes++;
+            _sendStats.bytes += written;
+            if (written != len) _sendStats.failed++;
+            len = 0;
+        }
+        if (i < pendingCount){
+            memcpy(&sendBuffer[len],pending[i].line,lineLen);
+            len += lineLen;
+        }
+    }
+    pendingCount = 0;
+    pendingBytes = 0;
+}
 
+void Ogn::storeLine(sendItem *item){
+    //key + line incl. terminating 0
+    if (offlineStore) offlineStore->append(time(NULL),item,OGN_KEYLEN + strlen(item->line) + 1);
+}
+
+void Ogn::replayStore(uint32_t tAct){
+    sendItem item;
+    int16_t len = offlineStore->peek(time(NULL),&item,sizeof(item));
+    if (len <= OGN_KEYLEN) return;
+    item.line[len - OGN_KEYLEN - 1] = 0;
+    item.key[0] = 0; //old positions are sent without stale-check and min. interval
+    addPending(&item,tAct);
+    offlineStore->pop();
+}
+
+void Ogn::flushQueue(uint32_t tAct){
+    sendItem item;
+    bool bOnline = ((connected) && (initOk >= 10));
+    while (sendQueue.pop(&item)){
+        if (!bOnline){
+            storeLine(&item); //no connection --> keep for later or discard
+            sendQueue.done(false);
+            continue;
+        }
+        addPending(&item,tAct);
+        sendQueue.done(true);
+    }
+    if (!bOnline){
+        for (int i = 0;i < pendingCount;i++) storeLine(&pending[i]);
+        pendingCount = 0;
+        pendingBytes = 0;
+        return;
+    }
+    if ((offlineStore) && (pendingCount < OGN_PENDING)) replayStore(tAct);
+    if (pendingCount == 0) return;
+    if ((pendingBytes >= OGN_FLUSHSIZE) || (timeOver(tAct,tPending,OGN_FLUSHTIME))){
+        writePending();
+    }
 }
 
 void Ogn::setAirMode(bool _AirMode){
@@ -78,7 +214,8 @@ void Ogn::connect2Server(uint32_t tAct){
     static uint32_t tConnRetry = tAct;
     initOk = 0;
     connected = false;
-    if ((tAct - tConnRetry) >= 5000){
+    if ((bConnectNow) || ((tAct - tConnRetry) >= 5000)){
+        bConnectNow = false;
         tConnRetry = tAct;
         xSemaphoreTake( *xMutex, portMAX_DELAY );
         client->stop();
@@ -92,6 +229,7 @@ void Ogn::connect2Server(uint32_t tAct){
         int ret = client->connect("aprs.glidernet.org", 14580);
         xSemaphoreGive( *xMutex );
         if (ret) {
+            rxLen = 0;
             sendLoginMsg();
             connected = true;
         }
@@ -99,19 +237,29 @@ void Ogn::connect2Server(uint32_t tAct){
     }
 }
 
-void Ogn::checkLine(String line){
-    String s = "";
-    int32_t pos = 0;
-    //log_i("%s",line.c_str());
-    if (!line.startsWith("# aprsc")){
-      log_i("%s",line.c_str());
+void Ogn::connectNow(void){
+    bConnectNow = true;
+}
+
+bool Ogn::isLoggedIn(void){
+    return ((connected) && (initOk));
+}
+
+void Ogn::checkLine(char *line){
+    //log_i("%s",line);
+    if (strncmp(line,"# aprsc",7) != 0){
+      log_i("%s",line);
     }
     if (initOk == 0){
-        pos = getStringValue(line,"server ","\r\n",0,&s);
-        if (pos > 0){
+        char *pos = strstr(line,"server ");
+        if (pos){
+            pos += 7;
+            char *end = strstr(pos,"\r\n");
+            if (end == NULL) return;
+            *end = 0;
             tStatus = 0;
             tRecBaecon = millis() - OGNSTATUSINTERVALL;
-            _servername = s;
+            _servername = pos;
             initOk = 1;
         }
     }
@@ -191,21 +339,19 @@ String Ogn::getOrigin(String devId){
 }
 
 void Ogn::sendNameData(String devId,String name,float snr){
-    if (initOk < 10) return; //nothing todo
+    if ((initOk < 10) && (offlineStore == NULL)) return; //nothing todo
     String sTime = getActTimeString();
     if (sTime.length() <= 0) return;
     char buff[200];
     sprintf (buff,"%s%s>OGNFNT,qAS,%s:>%sh Name=\"%s\" %0.1fdB\r\n"
     ,getOrigin(devId).c_str(),devId.c_str(),_user.c_str(),sTime.c_str(),name.c_str(),snr);
-    xSemaphoreTake( *xMutex, portMAX_DELAY );
-    client->print(buff);                
-    xSemaphoreGive( *xMutex );
+    queueLine(buff);
     //log_i("%s",buff);
 
 }
 
 void Ogn::sendWeatherData(float lat,float lon,String devId,float wDir,float wSpeed,float wGust,float temp,float rain1h, float rain24h,float hum,float press,float snr){
-    if (initOk < 10) return; //nothing todo
+    if ((initOk < 10) && (offlineStore == NULL)) return; //nothing todo
     float lLat = abs(lat);
     float lLon = abs(lon);
     int latDeg = int(lLat);
@@ -232,7 +378,7 @@ void Ogn::sendWeatherData(float lat,float lon,String devId,float wDir,float wSpe
     ,devId.c_str(),_user.c_str(),sTime.c_str(),latDeg,latMin/1000,latMin/10 %100,(lat < 0)?'S':'N',lonDeg,lonMin/1000,lonMin/10 %100,(lon < 0)?'W':'E',
     int(wDir),int(kmh2mph(wSpeed)),int(kmh2mph(wGust)),int(deg2f(temp)));
     send += buff;
-    if (rain1h != NAN){
+    if ((!isnan(rain1h)) && (!isnan(rain24h))){
         sprintf (buff,"r%03dp%03d"
         ,int(rain1h * 10),int(rain24h * 10));
         send += buff;
@@ -242,15 +388,13 @@ void Ogn::sendWeatherData(float lat,float lon,String devId,float wDir,float wSpe
     send += buff;
 
 
-    xSemaphoreTake( *xMutex, portMAX_DELAY );
-    client->print(send.c_str());                
-    xSemaphoreGive( *xMutex );
+    queueLine(send.c_str());
     //log_i("%s",send.c_str());
 
 }
 
 void Ogn::sendGroundTrackingData(float lat,float lon,String devId,uint8_t state,float snr){
-    if (initOk < 10) return; //nothing todo
+    if ((initOk < 10) && (offlineStore == NULL)) return; //nothing todo
     char buff[200];
     float lLat = abs(lat);
     float lLon = abs(lon);
@@ -265,16 +409,14 @@ void Ogn::sendGroundTrackingData(float lat,float lon,String devId,uint8_t state,
     //            ,getOrigin(devId).c_str(),devId.c_str(),sTime.c_str(),latDeg,latMin/1000,latMin/10 %100,(lat < 0)?'S':'N',lonDeg,lonMin/1000,lonMin/10 %100,(lon < 0)?'W':'E',int(latMin %10),int(latMin %10),getSenderDetails(aircraftType,devId),devId.c_str(),state,snr);
     sprintf (buff,"%s%s>OGNFNT,qAS,%s:/%sh%02d%02d.%02d%c\\%03d%02d.%02d%cn !W%01d%01d! id%02X%s FNT%d %0.1fdB\r\n" //3F OGN-Tracker and device 15
     ,getOrigin(devId).c_str(),devId.c_str(),_user.c_str(),sTime.c_str(),latDeg,latMin/1000,latMin/10 %100,(lat < 0)?'S':'N',lonDeg,lonMin/1000,lonMin/10 %100,(lon < 0)?'W':'E',int(latMin %10),int(latMin %10),getSenderDetails(true,aircraft_t::unknown,devId),devId.c_str(),state,snr);
-    xSemaphoreTake( *xMutex, portMAX_DELAY );
-    client->print(buff);                
-    xSemaphoreGive( *xMutex );
+    queueLine(buff,devId.c_str());
     //log_i("%s",buff);
 
 }
 
 void Ogn::sendTrackingData(float lat,float lon,float alt,float speed,float heading,float climb,String devId,aircraft_t aircraftType,bool Onlinetracking,float snr){
     //if ((WiFi.status() != WL_CONNECTED) || (initOk < 10)) return; //nothing todo
-    if (initOk < 10) return; //nothing todo
+    if ((initOk < 10) && (offlineStore == NULL)) return; //nothing todo
     char buff[200];
     float lLat = abs(lat);
     float lLon = abs(lon);
@@ -289,9 +431,7 @@ void Ogn::sendTrackingData(float lat,float lon,float alt,float speed,float headi
     //            ,getOrigin(devId).c_str(),devId.c_str(),sTime.c_str(),latDeg,latMin/1000,latMin/10 %100,(lat < 0)?'S':'N',lonDeg,lonMin/1000,lonMin/10 %100,(lon < 0)?'W':'E',int(heading),int(speed * 0.53996),int(alt * 3.28084),int(latMin %10),int(latMin %10),getSenderDetails(aircraftType,devId),devId.c_str(),climb*196.85f,snr);
     sprintf (buff,"%s%s>OGNFNT,qAS,%s:/%sh%02d%02d.%02d%c/%03d%02d.%02d%cg%03d/%03d/A=%06d !W%01d%01d! id%02X%s %+04.ffpm FNT11 %0.1fdB\r\n"
                 ,getOrigin(devId).c_str(),devId.c_str(),_user.c_str(),sTime.c_str(),latDeg,latMin/1000,latMin/10 %100,(lat < 0)?'S':'N',lonDeg,lonMin/1000,lonMin/10 %100,(lon < 0)?'W':'E',int(heading),int(speed * 0.53996),int(alt * 3.28084),int(latMin %10),int(latMin %10),getSenderDetails(Onlinetracking,aircraftType,devId),devId.c_str(),climb*196.85f,snr);
-    xSemaphoreTake( *xMutex, portMAX_DELAY );
-    client->print(buff);                
-    xSemaphoreGive( *xMutex );
+    queueLine(buff,devId.c_str());
     //log_i("%s",buff);
 }
 
@@ -405,19 +545,32 @@ void Ogn::sendStatus(uint32_t tAct){
 }
 
 void Ogn::readClient(){
-  String line = "";
+  //read all available data at once, parse lines after releasing the mutex
+  int len = 0;
   xSemaphoreTake( *xMutex, portMAX_DELAY );
-  while (client->available()){
-    char c = client->read(); //read 1 character 
-    
-    line += c; //read 1 character
-    if (c == '\n'){
-        checkLine(line);
-        line = "";
-    }
-
+  if (client->available()){
+    len = client->read((uint8_t *)&rxBuffer[rxLen],OGN_RXBUF - 1 - rxLen);
   }
   xSemaphoreGive( *xMutex );
+  if (len <= 0) return;
+  rxLen += len;
+  rxBuffer[rxLen] = 0;
+  char *line = rxBuffer;
+  char *end;
+  while ((end = strchr(line,'\n')) != NULL){
+    char c = end[1];
+    end[1] = 0; //line including \r\n
+    checkLine(line);
+    end[1] = c;
+    line = end + 1;
+  }
+  rxLen -= (line - rxBuffer);
+  if (rxLen >= OGN_RXBUF - 1){
+    log_e("line too long --> discard");
+    rxLen = 0;
+  }else if (line != rxBuffer){
+    memmove(rxBuffer,line,rxLen); //keep start of next line
+  }
 }
 
 void Ogn::checkClientConnected(uint32_t tAct){
@@ -447,4 +600,5 @@ void Ogn::run(bool bNetworkOk){
     }else{
         connected = false;
     }
+    flushQueue(tAct);
 }
\ No newline at end of file
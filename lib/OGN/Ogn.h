@@ -13,8 +13,21 @@
 #include "time.h"
 #include "tools.h"
 #include <TimeLib.h>
+#include <Uplink.h>
+#include <UplinkStore.h>
 
 #define OGNSTATUSINTERVALL 300000ul
+#define OGN_MAXLINE 200 //max. length of aprs-line
+#define OGN_QUEUE_LEN 16 //lines waiting for sending
+#define OGN_KEYLEN 12 //max. length of devId
+#define OGN_PENDING 8 //lines collected for one write
+#define OGN_FLUSHSIZE 512 //write, if collected lines are bigger
+#define OGN_FLUSHTIME 1000 //write, if oldest collected line is older [ms]
+#define OGN_SENDBUF 1024
+#define OGN_MAXAIRCRAFT 32 //aircrafts for min. send-interval
+#define OGN_RXBUF 512 //buffer for lines from server
+#define OGN_STORE_SLOTS 64 //lines in offline-store
+#define OGN_STORE_SLOTSIZE (sizeof(UplinkStore::slotHeader) + OGN_KEYLEN + OGN_MAXLINE)
 
 class Ogn {
 public:
@@ -44,14 +57,42 @@ public:
   void setMutex(SemaphoreHandle_t *_xMutex);
   void setBattVoltage(float battVoltage);
   void setStatusData(float pressure, float temp,float hum, float battVoltage);
+  void setMinInterval(uint8_t seconds); //min. time between 2 positions of one aircraft (0 --> send all)
+  void setOfflineStore(UplinkStore *store); //lines are kept in store while offline and sent later
+  void connectNow(void); //first connect without delay (e.g. was logged in before deep-sleep)
+  bool isLoggedIn(void);
+  typedef struct {
+    uint32_t stale; //positions replaced by newer one before sending
+    uint32_t rateLimited; //positions dropped because of min. interval
+    uint32_t writes; //writes to client
+    uint32_t bytes; //bytes written
+    uint32_t failed; //failed writes
+  } sendStats;
+  UplinkQueue::stats getQueueStats(void);
+  sendStats getSendStats(void);
 
 private:
+    typedef struct {
+      char key[OGN_KEYLEN]; //devId of position-lines, empty for other lines
+      char line[OGN_MAXLINE];
+    } sendItem;
+    typedef struct {
+      char key[OGN_KEYLEN];
+      uint32_t tSent;
+    } aircraftSent;
     void checkClientConnected(uint32_t tAct);
     void connect2Server(uint32_t tAct);
     void sendLoginMsg(void);
     String calcPass(String user);
     void readClient();
-    void checkLine(String line);
+    void queueLine(const char *line,const char *key = NULL);
+    void flushQueue(uint32_t tAct);
+    void addPending(sendItem *item,uint32_t tAct);
+    aircraftSent *getAircraftSent(const char *key,uint32_t tAct);
+    void writePending(void);
+    void storeLine(sendItem *item);
+    void replayStore(uint32_t tAct);
+    void checkLine(char *line);
     void sendStatus(uint32_t tAct);
     void sendReceiverStatus(String sTime);    
     void sendReceiverBeacon(String sTime);
@@ -60,8 +101,21 @@ private:
     uint8_t getAddressType(String devId);
     String getOrigin(String devId);
     bool connected = false;
+    bool bConnectNow = false;
     Client *client;
     SemaphoreHandle_t *xMutex;    
+    UplinkQueue sendQueue; //send* only queue the lines, run() sends them
+    UplinkStore *offlineStore = NULL;
+    sendItem pending[OGN_PENDING]; //lines for next write
+    uint8_t pendingCount = 0;
+    uint16_t pendingBytes = 0;
+    uint32_t tPending = 0; //time of first pending line
+    char sendBuffer[OGN_SENDBUF];
+    aircraftSent lastSent[OGN_MAXAIRCRAFT];
+    uint32_t minInterval = 0; //[ms]
+    sendStats _sendStats;
+    char rxBuffer[OGN_RXBUF]; //received data, begins always with start of line
+    uint16_t rxLen = 0;
     String _user;
     String _version;
     String _servername;
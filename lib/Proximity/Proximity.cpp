@@ -0,0 +1,71 @@
+/*!
+ * @file Proximity.cpp
+ *
+ *
+ */
+
+#include "Proximity.h"
+
+Proximity::Proximity(uint16_t maxTargets){
+  targets = (target *)malloc(maxTargets * sizeof(target));
+  sorted = (uint16_t *)malloc(maxTargets * sizeof(uint16_t));
+  maxCount = ((targets) && (sorted)) ? maxTargets : 0;
+  targetCount = 0;
+  sortedCount = 0;
+  myLat = 0.0;
+  myLon = 0.0;
+  myAlt = 0.0;
+  mPerDegLon = PROXIMITY_M_PER_DEG;
+}
+
+void Proximity::startUpdate(double lat,double lon,float alt){
+  myLat = lat;
+  myLon = lon;
+  myAlt = alt;
+  //local flat-earth projection --> only one cos per update
+  mPerDegLon = PROXIMITY_M_PER_DEG * cosf((float)lat * (float)(M_PI / 180.0));
+  targetCount = 0;
+}
+
+void Proximity::addTarget(uint8_t index,uint32_t devId,float lat,float lon,float alt){
+  if (targetCount >= maxCount) return;
+  target *pTarget = &targets[targetCount];
+  float dLon = (float)(lon - myLon);
+  if (dLon > 180.0) dLon -= 360.0;
+  if (dLon < -180.0) dLon += 360.0;
+  pTarget->devId = devId;
+  pTarget->index = index;
+  pTarget->relNorth = (float)(lat - myLat) * (float)PROXIMITY_M_PER_DEG;
+  pTarget->relEast = dLon * mPerDegLon;
+  pTarget->relVert = alt - myAlt;
+  pTarget->distance = sqrtf(pTarget->relNorth * pTarget->relNorth + pTarget->relEast * pTarget->relEast);
+  pTarget->bearing = atan2f(pTarget->relEast,pTarget->relNorth) * (float)(180.0 / M_PI);
+  if (pTarget->bearing < 0) pTarget->bearing += 360.0;
+  targetCount++;
+}
+
+void Proximity::finishUpdate(void){
+  //insertion-sort, starts with the order of the last update (same neighbours --> nearly sorted)
+  if (targetCount != sortedCount){
+    for (uint16_t i = 0;i < targetCount;i++) sorted[i] = i;
+    sortedCount = targetCount;
+  }
+  for (uint16_t i = 1;i < targetCount;i++){
+    uint16_t act = sorted[i];
+    int16_t j = i - 1;
+    while ((j >= 0) && (targets[sorted[j]].distance > targets[act].distance)){
+      sorted[j + 1] = sorted[j];
+      j--;
+    }
+    sorted[j + 1] = act;
+  }
+}
+
+uint16_t Proximity::count(void){
+  return targetCount;
+}
+
+Proximity::target *Proximity::get(uint16_t n){
+  if (n >= targetCount) return NULL;
+  return &targets[sorted[n]];
+}
@@ -0,0 +1,47 @@
+/*!
+ * @file Proximity.h
+ *
+ *
+ */
+
+#ifndef __PROXIMITY_H__
+#define __PROXIMITY_H__
+
+#include <Arduino.h>
+#include <math.h>
+
+#define PROXIMITY_MAXTARGETS 64 //default, one per neighbour-slot
+#define PROXIMITY_M_PER_DEG 111195.0 //meters per degree latitude (earth-radius 6371km)
+
+class Proximity {
+public:
+  typedef struct {
+    uint32_t devId;
+    uint8_t index; //index in neighbour-list
+    float relNorth; //[m]
+    float relEast; //[m]
+    float relVert; //[m]
+    float distance; //horizontal distance [m]
+    float bearing; //[deg]
+  } target;
+
+  Proximity(uint16_t maxTargets = PROXIMITY_MAXTARGETS); //constructor
+  void startUpdate(double lat,double lon,float alt); //start new calculation from own position
+  void addTarget(uint8_t index,uint32_t devId,float lat,float lon,float alt);
+  void finishUpdate(void); //sort targets by distance
+  uint16_t count(void);
+  target *get(uint16_t n); //n-th closest target
+
+private:
+  target *targets;
+  uint16_t *sorted; //target-numbers sorted by distance
+  uint16_t maxCount;
+  uint16_t targetCount;
+  uint16_t sortedCount; //targets of the last sort
+  double myLat;
+  double myLon;
+  float myAlt;
+  float mPerDegLon; //meters per degree longitude at own latitude
+};
+
+#endif
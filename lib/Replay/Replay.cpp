@@ -0,0 +1,162 @@
+/*!
+ * @file Replay.cpp
+ *
+ *
+ */
+
+#include "Replay.h"
+
+Replay::Replay(){
+  bRecording = false;
+  bPlaying = false;
+  bEof = false;
+  tStart = 0;
+  tLine = 0;
+  linePos = 0;
+  lineLen = 0;
+  bLineDue = false;
+  tInput = 0;
+  inputCount = 0;
+  memset(stats,0,sizeof(stats));
+}
+
+bool Replay::beginRecord(const char *fileName){
+  end();
+  file = SPIFFS.open(fileName,"w");
+  if (!file) return false;
+  tStart = millis();
+  bRecording = true;
+  log_i("recording to %s",fileName);
+  return true;
+}
+
+bool Replay::beginPlay(const char *fileName){
+  end();
+  if (!SPIFFS.exists(fileName)) return false;
+  file = SPIFFS.open(fileName,"r");
+  if (!file) return false;
+  memset(stats,0,sizeof(stats));
+  inputCount = 0;
+  tStart = millis();
+  tInput = tStart;
+  bEof = false;
+  bPlaying = readLine();
+  log_i("playing %s",fileName);
+  return bPlaying;
+}
+
+void Replay::end(void){
+  bRecording = false;
+  bPlaying = false;
+  if (file) file.close();
+}
+
+bool Replay::isPlaying(void){
+  return bPlaying;
+}
+
+void Replay::record(const char *line){
+  if (!bRecording) return;
+  if (file.size() >= REPLAY_MAXSIZE){
+    log_i("replay-file full --> stop recording");
+    end();
+    return;
+  }
+  int len = strcspn(line,"\r\n");
+  file.printf("%u;%.*s\n",millis() - tStart,len,line);
+}
+
+bool Replay::readLine(void){
+  char buffer[REPLAY_MAXLINE + 16];
+  while (file.available()){
+    int len = file.readBytesUntil('\n',buffer,sizeof(buffer) - 1);
+    buffer[len] = 0;
+    char *sep = strchr(buffer,';');
+    if (sep == NULL) continue; //broken line
+    *sep = 0;
+    tLine = strtoul(buffer,NULL,10);
+    //sentence is fed with \r\n like from gps
+    snprintf(line,sizeof(line) - 2,"%s",sep + 1);
+    strcat(line,"\r\n");
+    lineLen = strlen(line);
+    linePos = 0;
+    bLineDue = false;
+    return true;
+  }
+  return false;
+}
+
+int Replay::available(void){
+  if (!bPlaying) return 0;
+  if (bEof){
+    //outputs of the last sentence are counted, stop with the next poll
+    log_i("replay finished");
+    logStats();
+    end();
+    return 0;
+  }
+  if ((millis() - tStart) < tLine) return 0; //not due yet
+  if (!bLineDue){
+    bLineDue = true;
+    tInput = tStart + tLine;
+    inputCount++;
+  }
+  return lineLen - linePos;
+}
+
+int Replay::read(void){
+  if (available() <= 0) return -1;
+  int c = (uint8_t)line[linePos++];
+  if (linePos >= lineLen){
+    if (!readLine()) bEof = true;
+  }
+  return c;
+}
+
+int Replay::peek(void){
+  if (available() <= 0) return -1;
+  return (uint8_t)line[linePos];
+}
+
+void Replay::flush(void){
+}
+
+size_t Replay::write(uint8_t c){
+  return 0; //nothing to send to a recorded gps
+}
+
+void Replay::output(const char *data){
+  if (!bPlaying) return;
+  uint32_t latency = millis() - tInput;
+  char type[7];
+  strncpy(type,data,6);
+  type[6] = 0;
+  for (int i = 0;i < REPLAY_MAXTYPES;i++){
+    if ((stats[i].count == 0) || (strcmp(stats[i].type,type) == 0)){
+      strcpy(stats[i].type,type);
+      stats[i].count++;
+      stats[i].latencySum += latency;
+      if (latency > stats[i].latencyMax) stats[i].latencyMax = latency;
+      return;
+    }
+  }
+}
+
+void Replay::logStats(void){
+  uint32_t tRun = millis() - tStart;
+  log_i("replay inputs=%d time=%dms",inputCount,tRun);
+  for (int i = 0;i < REPLAY_MAXTYPES;i++){
+    if (stats[i].count == 0) break;
+    log_i("%s count=%d latency avg=%d max=%d",stats[i].type,stats[i].count,stats[i].latencySum / stats[i].count,stats[i].latencyMax);
+  }
+}
+
+bool Replay::getStats(uint8_t index,outputStats *pStats){
+  if ((index >= REPLAY_MAXTYPES) || (stats[index].count == 0)) return false;
+  *pStats = stats[index];
+  return true;
+}
+
+uint32_t Replay::getInputCount(void){
+  return inputCount;
+}
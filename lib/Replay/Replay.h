@@ -0,0 +1,65 @@
+/*!
+ * @file Replay.h
+ *
+ *
+ */
+
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+#include <Arduino.h>
+#include <string.h>
+#include <SPIFFS.h>
+
+#define REPLAY_FILE "/replay.nmea"
+#define REPLAY_MAXSIZE 65536 //stop recording, if file is bigger
+#define REPLAY_MAXLINE 128
+#define REPLAY_MAXTYPES 8 //output-sentences with own statistic
+
+//records gps-sentences with timestamp and plays them back in the same timing
+//file-format: one line per sentence "<ms since start>;<sentence>\n"
+//outputs are measured against the last input-sentence
+class Replay : public Stream {
+public:
+  typedef struct {
+    char type[7]; //first 6 chars of sentence ($PFLAU, $LK8EX, ...)
+    uint32_t count;
+    uint32_t latencySum; //[ms]
+    uint32_t latencyMax; //[ms]
+  } outputStats;
+
+  Replay(); //constructor
+  bool beginRecord(const char *fileName);
+  bool beginPlay(const char *fileName);
+  void end(void);
+  bool isPlaying(void);
+  void record(const char *line); //input-line incl. \r\n
+  void output(const char *data); //output-sentence was sent
+  void logStats(void);
+  bool getStats(uint8_t index,outputStats *pStats); //false, if no more types
+  uint32_t getInputCount(void); //input-sentences played
+  //stream-interface for playback (bytes of the sentences, which are due)
+  int available(void);
+  int read(void);
+  int peek(void);
+  void flush(void);
+  size_t write(uint8_t c);
+
+private:
+  bool readLine(void);
+  File file;
+  bool bRecording;
+  bool bPlaying;
+  bool bEof; //last line read
+  uint32_t tStart;
+  char line[REPLAY_MAXLINE];
+  uint32_t tLine; //time of line in file [ms]
+  uint8_t linePos; //next char to read
+  uint8_t lineLen;
+  bool bLineDue; //line is ready for reading
+  uint32_t tInput; //time, when last input-sentence was due
+  uint32_t inputCount;
+  outputStats stats[REPLAY_MAXTYPES];
+};
+
+#endif
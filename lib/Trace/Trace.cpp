@@ -0,0 +1,163 @@
+/*!
+ * @file Trace.cpp
+ *
+ *
+ */
+
+#include "Trace.h"
+#include <esp_heap_caps.h>
+
+Trace trace;
+
+static const char *traceNames[TRACE_COUNT] = {"pps","lora-irq","lora-parse","mac-rx","mac-tx","baro","eink-full","eink-part","ble-send","ogn","aw","traccar"};
+
+Trace::Trace(){
+  bEnabled = false;
+  bExporting = false;
+  size = 0;
+  mask = 0;
+  anchorMask = 0;
+  anchorShift = 0;
+  cyclesPerUs = 240;
+  tStart = 0;
+  memset(rings,0,sizeof(rings));
+}
+
+bool Trace::begin(bool bPsram){
+  if (size) return true;
+  uint32_t events = (bPsram) ? TRACE_EVENTS_LARGE : TRACE_EVENTS;
+  for (int i = 0;i < TRACE_CORES;i++){
+    //never psram, iram-isr (pps) writes into the ring while flash-cache may be disabled
+    rings[i].events = (traceEvent *)heap_caps_malloc(events * sizeof(traceEvent),MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (rings[i].events == NULL){
+      log_e("can't allocate trace-buffer");
+      for (int j = 0;j < i;j++){
+        free(rings[j].events);
+        rings[j].events = NULL;
+      }
+      return false;
+    }
+  }
+  size = events;
+  mask = size - 1;
+  anchorShift = 0;
+  while ((1ul << (anchorShift + 2)) < size) anchorShift++; //4 anchors per ring
+  anchorMask = (1ul << anchorShift) - 1;
+  cyclesPerUs = ESP.getCpuFreqMHz();
+  log_i("trace-buffer %d events per core",size);
+  return true;
+}
+
+void Trace::setEnabled(bool bEnable){
+  if (size == 0) return;
+  if (bEnable == bEnabled) return;
+  if (bEnable){
+    for (int i = 0;i < TRACE_CORES;i++){
+      rings[i].head = 0;
+      memset(rings[i].anchors,0,sizeof(rings[i].anchors));
+    }
+    tStart = esp_timer_get_time();
+  }
+  bEnabled = bEnable;
+  log_i("trace %s",(bEnable) ? "enabled" : "disabled");
+}
+
+bool Trace::isEnabled(void){
+  return bEnabled;
+}
+
+bool Trace::exportOpen(void){
+  exportClose(); //last download was aborted
+  if (size == 0) return false;
+  bWasEnabled = bEnabled;
+  bEnabled = false; //writers would overwrite the events we are reading
+  bExporting = true;
+  expState = 0;
+  expCore = 0;
+  expFirst = true;
+  expLineLen = 0;
+  expLinePos = 0;
+  return true;
+}
+
+void Trace::exportClose(void){
+  if (!bExporting) return;
+  bExporting = false;
+  bEnabled = bWasEnabled; //continue recording after the last event
+}
+
+bool Trace::exportNextLine(void){
+  const char *sep = (expFirst) ? "" : ",\n";
+  switch (expState){
+  case 0:
+    strcpy(expLine,"{\"traceEvents\":[\n");
+    expLineLen = strlen(expLine);
+    expState = 1;
+    expCore = 0;
+    expHead = rings[0].head;
+    expPos = (expHead > size) ? expHead - size : 0;
+    break;
+  case 1:
+    if (expPos >= expHead){
+      expCore++;
+      if (expCore >= TRACE_CORES){
+        expState = 2;
+        expCore = 0;
+      }else{
+        expHead = rings[expCore].head;
+        expPos = (expHead > size) ? expHead - size : 0;
+      }
+      expLineLen = 0;
+      break;
+    }
+    {
+      traceEvent *pEvent = &rings[expCore].events[expPos & mask];
+      traceAnchor *pAnchor = &rings[expCore].anchors[(expPos >> anchorShift) % TRACE_ANCHORS];
+      //events of an isr can be slightly before the anchor --> signed
+      int32_t cycles = (int32_t)(pEvent->cycles - pAnchor->cycles);
+      double ts = (double)(pAnchor->us - tStart) + (double)cycles / cyclesPerUs;
+      const char *name = (pEvent->id < TRACE_COUNT) ? traceNames[pEvent->id] : "?";
+      expLineLen = snprintf(expLine,sizeof(expLine),"%s{\"name\":\"%s\",\"cat\":\"gx\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,%s\"args\":{\"arg\":%u}}",
+                            sep,name,pEvent->phase,ts,expCore,(pEvent->phase == 'i') ? "\"s\":\"t\"," : "",pEvent->arg);
+      expPos++;
+      expFirst = false;
+    }
+    break;
+  case 2:
+    if (expCore < TRACE_CORES){
+      expLineLen = snprintf(expLine,sizeof(expLine),"%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"core %d\"}}",sep,expCore,expCore);
+      expCore++;
+      expFirst = false;
+    }else{
+      strcpy(expLine,"\n]}\n");
+      expLineLen = strlen(expLine);
+      expState = 3;
+    }
+    break;
+  default:
+    return false;
+  }
+  if (expLineLen >= sizeof(expLine)) expLineLen = sizeof(expLine) - 1;
+  expLinePos = 0;
+  return true;
+}
+
+size_t Trace::exportRead(uint8_t *buffer,size_t maxLen){
+  size_t len = 0;
+  if (!bExporting) return 0;
+  while (len < maxLen){
+    if (expLinePos >= expLineLen){
+      if (!exportNextLine()){
+        exportClose();
+        break;
+      }
+      continue;
+    }
+    size_t n = expLineLen - expLinePos;
+    if (n > (maxLen - len)) n = maxLen - len;
+    memcpy(&buffer[len],&expLine[expLinePos],n);
+    expLinePos += n;
+    len += n;
+  }
+  return len;
+}
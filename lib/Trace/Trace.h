@@ -0,0 +1,119 @@
+/*!
+ * @file Trace.h
+ *
+ *
+ */
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <Arduino.h>
+#include <string.h>
+#include <esp_timer.h>
+
+#define TRACE_EVENTS 256 //events per core (power of 2)
+#define TRACE_EVENTS_LARGE 1024 //events per core, if psram takes the big buffers off the internal heap
+#define TRACE_ANCHORS 8 //time-references per core, one every quarter of the ring
+#define TRACE_CORES 2
+
+//ids of traced events, names in Trace.cpp
+enum traceId {
+  TRACE_PPS = 0,
+  TRACE_LORA_IRQ,
+  TRACE_LORA_PARSE,
+  TRACE_MAC_RX,
+  TRACE_MAC_TX,
+  TRACE_BARO,
+  TRACE_EINK_FULL,
+  TRACE_EINK_PART,
+  TRACE_BLE_SEND,
+  TRACE_UPLINK_OGN,
+  TRACE_UPLINK_AW,
+  TRACE_UPLINK_TRACCAR,
+  TRACE_COUNT
+};
+
+//events are written lock-free into a ring per core, oldest events are overwritten
+//recording is switched on and off at runtime, export as chrome-trace (chrome://tracing, perfetto)
+class Trace {
+public:
+  typedef struct {
+    uint32_t cycles; //cpu-cycle-counter of the core
+    uint32_t arg;
+    uint16_t id;
+    uint8_t phase; //'B'egin, 'E'nd, 'i'nstant
+    uint8_t reserved;
+  } traceEvent;
+
+  Trace(); //constructor
+  bool begin(bool bPsram); //allocates the rings in internal ram
+  void setEnabled(bool bEnable); //starts with an empty ring
+  bool isEnabled(void);
+  inline void start(uint16_t id,uint32_t arg = 0) __attribute__((always_inline)){
+    if (bEnabled) record(id,'B',arg);
+  }
+  inline void stop(uint16_t id,uint32_t arg = 0) __attribute__((always_inline)){
+    if (bEnabled) record(id,'E',arg);
+  }
+  inline void mark(uint16_t id,uint32_t arg = 0) __attribute__((always_inline)){
+    if (bEnabled) record(id,'i',arg);
+  }
+  //chrome-trace-export, recording is paused while exporting
+  bool exportOpen(void);
+  size_t exportRead(uint8_t *buffer,size_t maxLen);
+  void exportClose(void);
+
+private:
+  typedef struct {
+    uint32_t cycles;
+    int64_t us; //esp-timer at cycles
+  } traceAnchor;
+
+  typedef struct {
+    traceEvent *events;
+    volatile uint32_t head; //counts up, position in ring is head & mask
+    traceAnchor anchors[TRACE_ANCHORS];
+  } traceRing;
+
+  //safe for isr, every core has its own ring, so only an isr on the same core can interrupt us
+  inline void record(uint16_t id,uint8_t phase,uint32_t arg) __attribute__((always_inline)){
+    uint32_t cycles = ESP.getCycleCount();
+    traceRing *pRing = &rings[xPortGetCoreID()];
+    uint32_t pos = __atomic_fetch_add(&pRing->head,1,__ATOMIC_RELAXED);
+    if ((pos & anchorMask) == 0){
+      //new quarter of ring --> new time-reference (cycle-counter wraps every 17s @240MHz)
+      traceAnchor *pAnchor = &pRing->anchors[(pos >> anchorShift) % TRACE_ANCHORS];
+      pAnchor->cycles = cycles;
+      pAnchor->us = esp_timer_get_time();
+    }
+    traceEvent *pEvent = &pRing->events[pos & mask];
+    pEvent->cycles = cycles;
+    pEvent->arg = arg;
+    pEvent->id = id;
+    pEvent->phase = phase;
+  }
+  bool exportNextLine(void);
+  volatile bool bEnabled;
+  traceRing rings[TRACE_CORES];
+  uint32_t size; //events per core
+  uint32_t mask;
+  uint32_t anchorMask;
+  uint8_t anchorShift;
+  uint32_t cyclesPerUs;
+  int64_t tStart; //esp-timer at enabling
+  //export
+  bool bExporting;
+  bool bWasEnabled;
+  uint8_t expState;
+  uint8_t expCore;
+  uint32_t expPos;
+  uint32_t expHead;
+  bool expFirst;
+  char expLine[160];
+  uint16_t expLineLen;
+  uint16_t expLinePos;
+};
+
+extern Trace trace;
+
+#endif
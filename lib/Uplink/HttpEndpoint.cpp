@@ -0,0 +1,246 @@
+/*!
+ * @file HttpEndpoint.cpp
+ *
+ *
+ */
+
+#include "HttpEndpoint.h"
+
+//endpoints can share one client (gsm-sockets), remember who opened the connection
+static Client *sharedClients[HTTP_MAXCLIENTS];
+static HttpEndpoint *sharedOwners[HTTP_MAXCLIENTS];
+
+static HttpEndpoint **getOwner(Client *pClient){
+  for (int i = 0;i < HTTP_MAXCLIENTS;i++){
+    if (sharedClients[i] == pClient) return &sharedOwners[i];
+  }
+  for (int i = 0;i < HTTP_MAXCLIENTS;i++){
+    if (sharedClients[i] == NULL){
+      sharedClients[i] = pClient;
+      sharedOwners[i] = NULL;
+      return &sharedOwners[i];
+    }
+  }
+  return NULL;
+}
+
+HttpEndpoint::HttpEndpoint(){
+  _port = 80;
+  client = NULL;
+  bOwnClient = false;
+  http = NULL;
+  bResolved = false;
+  tResolved = 0;
+  xMutex = NULL;
+  latencyCount = 0;
+  latencyPos = 0;
+  memset(&_stats,0,sizeof(_stats));
+}
+
+HttpEndpoint::~HttpEndpoint(){
+  close();
+  if (bOwnClient) delete client;
+}
+
+bool HttpEndpoint::setUrl(const String &url){
+  if (url == _url) return (_host.length() > 0);
+  _url = url;
+  if (!url.startsWith("http://")){
+    log_e("only http is supported %s",url.c_str());
+    close();
+    _host = "";
+    return false;
+  }
+  String server = url.substring(strlen("http://"));
+  String path = "";
+  int posPath = server.indexOf('/');
+  if (posPath >= 0){
+    path = server.substring(posPath);
+    server = server.substring(0,posPath);
+    if (path.endsWith("/")) path.remove(path.length() - 1);
+  }
+  uint16_t port = 80;
+  int posPort = server.indexOf(':');
+  if (posPort > 0){
+    port = server.substring(posPort + 1).toInt();
+    server = server.substring(0,posPort);
+  }
+  setHost(server.c_str(),port);
+  _path = path;
+  //log_i("host=%s port=%d path=%s",_host.c_str(),_port,_path.c_str());
+  return true;
+}
+
+void HttpEndpoint::setHost(const char *host,uint16_t port){
+  if ((_host == host) && (_port == port)) return;
+  close(); //http-client holds pointer to host-name
+  _host = host;
+  _port = port;
+  _path = "";
+  bResolved = false;
+}
+
+void HttpEndpoint::setClient(Client *_client){
+  if (_client == client) return;
+  close();
+  if (bOwnClient) delete client;
+  client = _client;
+  bOwnClient = false;
+}
+
+void HttpEndpoint::setMutex(SemaphoreHandle_t *_xMutex){
+  xMutex = _xMutex;
+}
+
+void HttpEndpoint::close(void){
+  if (client){
+    if (bOwnClient){
+      client->stop();
+    }else{
+      HttpEndpoint **owner = getOwner(client);
+      if ((owner) && (*owner == this)){
+        client->stop();
+        *owner = NULL;
+      }
+    }
+  }
+  if (http){
+    delete http;
+    http = NULL;
+  }
+}
+
+bool HttpEndpoint::resolve(uint32_t tAct){
+  if ((bResolved) && ((tAct - tResolved) < HTTP_DNS_TTL)) return true;
+  IPAddress newIp;
+  if (!WiFi.hostByName(_host.c_str(),newIp)){
+    log_e("can't resolve %s",_host.c_str());
+    return false;
+  }
+  if ((http) && (newIp != ip)){
+    //address changed --> new http-client
+    delete http;
+    http = NULL;
+  }
+  ip = newIp;
+  bResolved = true;
+  tResolved = tAct;
+  return true;
+}
+
+bool HttpEndpoint::prepare(void){
+  if (client == NULL){
+    client = new WiFiClient();
+    bOwnClient = true;
+  }
+  if (!bOwnClient){
+    //connection of shared client may belong to other server
+    HttpEndpoint **owner = getOwner(client);
+    if ((owner) && (*owner != this)){
+      client->stop();
+      *owner = this;
+    }
+  }
+  if (!client->connected()){
+    if ((bOwnClient) && (!resolve(millis()))) return false;
+    _stats.connects++;
+  }
+  if (http == NULL){
+    if (bOwnClient){
+      http = new HttpClient(*client,ip,_port);
+    }else{
+      http = new HttpClient(*client,_host,_port);
+    }
+    http->connectionKeepAlive();
+    http->setHttpResponseTimeout(HTTP_RESPONSE_TIMEOUT);
+  }
+  return true;
+}
+
+void HttpEndpoint::readBody(void){
+  if (http->skipResponseHeaders() != HTTP_SUCCESS){
+    http->stop();
+    return;
+  }
+  if ((http->contentLength() == HttpClient::kNoContentLengthHeader) && (!http->isResponseChunked())){
+    //body ends with closing the connection --> can't reuse it
+    http->stop();
+    return;
+  }
+  uint8_t buffer[64];
+  uint32_t tRead = millis();
+  while (!http->endOfBodyReached()){
+    int len = http->read(buffer,sizeof(buffer));
+    if (len > 0){
+      _stats.bytesRx += len;
+      tRead = millis();
+    }else if ((!http->connected()) || ((millis() - tRead) >= HTTP_RESPONSE_TIMEOUT)){
+      http->stop();
+      return;
+    }else{
+      delay(1);
+    }
+  }
+}
+
+int HttpEndpoint::get(const char *path){
+  if (_host.length() == 0) return HTTP_ERROR_API;
+  if (xMutex) xSemaphoreTake( *xMutex, portMAX_DELAY );
+  uint32_t tStart = millis();
+  String url = _path + path;
+  int ret = HTTP_ERROR_CONNECTION_FAILED;
+  _stats.requests++;
+  for (int i = 0;i < 2;i++){
+    if (!prepare()) break;
+    bool bReused = client->connected();
+    http->beginRequest();
+    ret = http->get(url);
+    if (ret == HTTP_SUCCESS){
+      if (bOwnClient){
+        //connected by ip --> send host-header by ourself
+        String host = _host;
+        if (_port != 80) host += ":" + String(_port);
+        http->sendHeader("Host",host.c_str());
+      }
+      http->endRequest();
+      _stats.bytesTx += url.length();
+      ret = http->responseStatusCode();
+      if (ret >= 0) readBody();
+    }
+    if (ret >= 0) break;
+    http->stop();
+    if (!bReused) break;
+    //server closed the kept connection --> try once with new connection
+  }
+  if (ret < 0){
+    _stats.errors++;
+    bResolved = false; //resolve again on next connect
+  }else{
+    addLatency(millis() - tStart);
+  }
+  if (xMutex) xSemaphoreGive( *xMutex );
+  return ret;
+}
+
+void HttpEndpoint::addLatency(uint32_t latency){
+  latencies[latencyPos] = latency;
+  latencyPos = (latencyPos + 1) % HTTP_LATENCY_SAMPLES;
+  if (latencyCount < HTTP_LATENCY_SAMPLES) latencyCount++;
+}
+
+HttpEndpoint::stats HttpEndpoint::getStats(void){
+  stats ret = _stats;
+  uint32_t sorted[HTTP_LATENCY_SAMPLES];
+  memcpy(sorted,latencies,latencyCount * sizeof(uint32_t));
+  for (int i = 1;i < latencyCount;i++){
+    uint32_t value = sorted[i];
+    int j = i - 1;
+    while ((j >= 0) && (sorted[j] > value)){
+      sorted[j + 1] = sorted[j];
+      j--;
+    }
+    sorted[j + 1] = value;
+  }
+  ret.latencyMedian = (latencyCount) ? sorted[latencyCount / 2] : 0;
+  return ret;
+}
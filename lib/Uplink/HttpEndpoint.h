@@ -0,0 +1,64 @@
+/*!
+ * @file HttpEndpoint.h
+ *
+ *
+ */
+
+#ifndef __HTTPENDPOINT_H__
+#define __HTTPENDPOINT_H__
+
+#include <Arduino.h>
+#include <string.h>
+#include <WiFi.h>
+#include <ArduinoHttpClient.h>
+
+#define HTTP_DNS_TTL 600000ul //resolved address valid for 10min
+#define HTTP_RESPONSE_TIMEOUT 5000
+#define HTTP_LATENCY_SAMPLES 16 //samples for median-latency
+#define HTTP_MAXCLIENTS 4 //max. number of clients shared between endpoints
+
+//http-server with parsed url, keep-alive connection and dns-cache
+class HttpEndpoint {
+public:
+  typedef struct {
+    uint32_t requests;
+    uint32_t errors;
+    uint32_t connects; //new tcp-connections
+    uint32_t bytesTx; //url-bytes sent
+    uint32_t bytesRx; //body-bytes received
+    uint32_t latencyMedian; //median of last requests [ms]
+  } stats;
+
+  HttpEndpoint(); //constructor
+  ~HttpEndpoint();
+  bool setUrl(const String &url); //http://host[:port][/path], only parsed if changed
+  void setHost(const char *host,uint16_t port = 80);
+  void setClient(Client *_client); //if not set, own WiFiClient with dns-cache is used
+  void setMutex(SemaphoreHandle_t *_xMutex);
+  int get(const char *path); //returns http-status or <0 if request failed
+  void close(void);
+  stats getStats(void);
+
+private:
+  bool prepare(void);
+  bool resolve(uint32_t tAct);
+  void readBody(void);
+  void addLatency(uint32_t latency);
+  String _url;
+  String _host;
+  String _path; //path-prefix from url
+  uint16_t _port;
+  Client *client;
+  bool bOwnClient;
+  HttpClient *http;
+  IPAddress ip;
+  bool bResolved;
+  uint32_t tResolved;
+  SemaphoreHandle_t *xMutex;
+  uint32_t latencies[HTTP_LATENCY_SAMPLES];
+  uint8_t latencyCount;
+  uint8_t latencyPos;
+  stats _stats;
+};
+
+#endif
@@ -0,0 +1,191 @@
+/*!
+ * @file ModemClient.cpp
+ *
+ *
+ */
+
+#include "ModemClient.h"
+
+ModemClient::ModemClient(ModemManager *manager,Client *client,ModemManager::prio_t prio){
+  _manager = manager;
+  _client = client;
+  _prio = prio;
+  xConnected = NULL;
+  mux = portMUX_INITIALIZER_UNLOCKED;
+  pending = 0;
+  bConnected = false;
+  bConnectResult = false;
+  host[0] = 0;
+  port = 0;
+  txHead = txTail = 0;
+  rxHead = rxTail = 0;
+}
+
+void ModemClient::request(ModemManager::op_t op){
+  portENTER_CRITICAL(&mux);
+  bool bQueued = (pending & (1 << op));
+  pending |= (1 << op);
+  portEXIT_CRITICAL(&mux);
+  if (bQueued) return; //already waiting
+  if (!_manager->submit(_prio,op,this)){
+    portENTER_CRITICAL(&mux);
+    pending &= ~(1 << op);
+    portEXIT_CRITICAL(&mux);
+  }
+}
+
+int ModemClient::doConnect(void){
+  if (xConnected == NULL) xConnected = xSemaphoreCreateBinary();
+  rxTail = rxHead; //discard data of last connection
+  bConnectResult = false;
+  if (!_manager->submit(_prio,ModemManager::OP_CONNECT,this)) return 0;
+  xSemaphoreTake(xConnected,portMAX_DELAY); //request is always completed (by run or end)
+  return bConnectResult;
+}
+
+int ModemClient::connect(IPAddress ip, uint16_t port){
+  host[0] = 0;
+  this->ip = ip;
+  this->port = port;
+  return doConnect();
+}
+
+int ModemClient::connect(const char *host, uint16_t port){
+  strncpy(this->host,host,sizeof(this->host) - 1);
+  this->host[sizeof(this->host) - 1] = 0;
+  this->port = port;
+  return doConnect();
+}
+
+size_t ModemClient::write(uint8_t c){
+  return write(&c,1);
+}
+
+size_t ModemClient::write(const uint8_t *buf, size_t size){
+  size_t written = 0;
+  uint32_t tStart = millis();
+  while ((written < size) && (bConnected)){
+    uint32_t space = MODEMCLIENT_TXBUF - (txHead - txTail);
+    if (space == 0){
+      //buffer full --> wait for the modem-task
+      request(ModemManager::OP_WRITE);
+      if ((millis() - tStart) >= MODEMCLIENT_WRITETIMEOUT) break;
+      delay(10);
+      continue;
+    }
+    uint32_t pos = txHead % MODEMCLIENT_TXBUF;
+    uint32_t len = min((uint32_t)(size - written),min(space,(uint32_t)(MODEMCLIENT_TXBUF - pos)));
+    memcpy(&txBuf[pos],&buf[written],len);
+    txHead += len;
+    written += len;
+  }
+  if (written) request(ModemManager::OP_WRITE);
+  return written;
+}
+
+int ModemClient::available(){
+  int len = rxHead - rxTail;
+  if (len == 0) request(ModemManager::OP_POLL);
+  return len;
+}
+
+int ModemClient::read(){
+  uint8_t c;
+  if (read(&c,1) == 1) return c;
+  return -1;
+}
+
+int ModemClient::read(uint8_t *buf, size_t size){
+  size_t len = 0;
+  while ((len < size) && (rxHead != rxTail)){
+    uint32_t pos = rxTail % MODEMCLIENT_RXBUF;
+    uint32_t count = min((uint32_t)(size - len),min((uint32_t)(rxHead - rxTail),(uint32_t)(MODEMCLIENT_RXBUF - pos)));
+    memcpy(&buf[len],&rxBuf[pos],count);
+    rxTail += count;
+    len += count;
+  }
+  if (rxHead == rxTail) request(ModemManager::OP_POLL); //fetch next data
+  if (len == 0) return -1;
+  return len;
+}
+
+int ModemClient::peek(){
+  if (rxHead == rxTail) return -1;
+  return rxBuf[rxTail % MODEMCLIENT_RXBUF];
+}
+
+void ModemClient::flush(){
+  uint32_t tStart = millis();
+  while ((txHead != txTail) && (bConnected) && ((millis() - tStart) < MODEMCLIENT_WRITETIMEOUT)){
+    request(ModemManager::OP_WRITE);
+    delay(10);
+  }
+}
+
+void ModemClient::stop(){
+  bConnected = false;
+  request(ModemManager::OP_STOP);
+}
+
+uint8_t ModemClient::connected(){
+  request(ModemManager::OP_POLL); //refresh state
+  return ((bConnected) || (rxHead != rxTail));
+}
+
+ModemClient::operator bool(){
+  return connected();
+}
+
+void ModemClient::serve(ModemManager::op_t op,bool bOnline){
+  portENTER_CRITICAL(&mux);
+  pending &= ~(1 << op);
+  portEXIT_CRITICAL(&mux);
+  switch (op){
+  case ModemManager::OP_CONNECT:
+    txTail = txHead; //discard data of last connection
+    bConnectResult = false;
+    if (bOnline){
+      if (host[0]) bConnectResult = _client->connect(host,port);
+      else bConnectResult = _client->connect(ip,port);
+    }
+    bConnected = bConnectResult;
+    xSemaphoreGive(xConnected);
+    break;
+  case ModemManager::OP_WRITE:
+    if ((bOnline) && (bConnected) && (txHead != txTail)){
+      //one contiguous block per request --> more important requests can go between
+      uint32_t pos = txTail % MODEMCLIENT_TXBUF;
+      uint32_t len = min((uint32_t)(txHead - txTail),(uint32_t)(MODEMCLIENT_TXBUF - pos));
+      size_t written = _client->write(&txBuf[pos],len);
+      txTail += written;
+      if (written < len) bConnected = _client->connected();
+      if ((bConnected) && (txHead != txTail)) request(ModemManager::OP_WRITE);
+    }
+    if ((!bOnline) || (!bConnected)) txTail = txHead; //can't be sent anymore
+    break;
+  case ModemManager::OP_POLL:
+    if (bOnline){
+      uint32_t space = MODEMCLIENT_RXBUF - (rxHead - rxTail);
+      int avail = _client->available();
+      while ((avail > 0) && (space > 0)){
+        uint32_t pos = rxHead % MODEMCLIENT_RXBUF;
+        int len = _client->read(&rxBuf[pos],min((uint32_t)avail,min(space,(uint32_t)(MODEMCLIENT_RXBUF - pos))));
+        if (len <= 0) break;
+        rxHead += len;
+        space -= len;
+        avail -= len;
+      }
+      bConnected = _client->connected();
+    }else{
+      bConnected = false;
+    }
+    break;
+  case ModemManager::OP_STOP:
+    if (bOnline) _client->stop();
+    bConnected = false;
+    txTail = txHead;
+    break;
+  default:
+    break;
+  }
+}
@@ -0,0 +1,63 @@
+/*!
+ * @file ModemClient.h
+ *
+ *
+ */
+
+#ifndef __MODEMCLIENT_H__
+#define __MODEMCLIENT_H__
+
+#include <Arduino.h>
+#include <Client.h>
+#include "ModemManager.h"
+
+#define MODEMCLIENT_TXBUF 1536 //bytes waiting for the modem
+#define MODEMCLIENT_RXBUF 1024 //bytes fetched from the modem
+#define MODEMCLIENT_HOSTLEN 64
+#define MODEMCLIENT_WRITETIMEOUT 10000 //max. wait for space in tx-buffer [ms]
+
+//socket of the shared modem: every call only queues a request for the modem-task
+//write copies into the tx-buffer, available/read serve data, which the modem-task has fetched before
+//only connect (result needed) and flush (tx-buffer sent) wait for the modem-task
+class ModemClient : public Client {
+public:
+  ModemClient(ModemManager *manager,Client *client,ModemManager::prio_t prio);
+  int connect(IPAddress ip, uint16_t port);
+  int connect(const char *host, uint16_t port);
+  size_t write(uint8_t c);
+  size_t write(const uint8_t *buf, size_t size);
+  int available();
+  int read();
+  int read(uint8_t *buf, size_t size);
+  int peek();
+  void flush();
+  void stop();
+  uint8_t connected();
+  operator bool();
+
+private:
+  friend class ModemManager;
+  void serve(ModemManager::op_t op,bool bOnline); //executed by the modem-task
+  void request(ModemManager::op_t op);
+  int doConnect(void);
+  ModemManager *_manager;
+  Client *_client;
+  ModemManager::prio_t _prio;
+  SemaphoreHandle_t xConnected;
+  portMUX_TYPE mux;
+  volatile uint8_t pending; //bit per op waiting in queue
+  volatile bool bConnected;
+  volatile bool bConnectResult;
+  char host[MODEMCLIENT_HOSTLEN];
+  IPAddress ip;
+  uint16_t port;
+  //single producer, single consumer --> free running counters, no lock needed
+  uint8_t txBuf[MODEMCLIENT_TXBUF];
+  volatile uint32_t txHead; //written by client
+  volatile uint32_t txTail; //written by modem-task
+  uint8_t rxBuf[MODEMCLIENT_RXBUF];
+  volatile uint32_t rxHead; //written by modem-task
+  volatile uint32_t rxTail; //written by client
+};
+
+#endif
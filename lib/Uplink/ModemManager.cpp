@@ -0,0 +1,127 @@
+/*!
+ * @file ModemManager.cpp
+ *
+ *
+ */
+
+#include "ModemManager.h"
+#include "ModemClient.h"
+
+ModemManager::ModemManager(){
+  for (int i = 0;i < PRIO_COUNT;i++) xQueue[i] = NULL;
+  xWake = NULL;
+  xLock = NULL;
+  xCallLock = NULL;
+  xCallDone = NULL;
+  callResult = false;
+  mux = portMUX_INITIALIZER_UNLOCKED;
+  bRunning = false;
+  _bOnline = false;
+  memset(_stats,0,sizeof(_stats));
+}
+
+bool ModemManager::begin(void){
+  if (xLock == NULL){
+    for (int i = 0;i < PRIO_COUNT;i++) xQueue[i] = xQueueCreate(MODEM_QUEUE_LEN,sizeof(request));
+    xWake = xSemaphoreCreateCounting(PRIO_COUNT * MODEM_QUEUE_LEN,0);
+    xLock = xSemaphoreCreateMutex();
+    xCallLock = xSemaphoreCreateMutex();
+    xCallDone = xSemaphoreCreateBinary();
+  }
+  bRunning = true;
+  return true;
+}
+
+void ModemManager::end(void){
+  xSemaphoreTake(xLock,portMAX_DELAY);
+  bRunning = false;
+  xSemaphoreGive(xLock);
+  //fail waiting requests, so no caller waits forever
+  request req;
+  for (int i = 0;i < PRIO_COUNT;i++){
+    while (xQueueReceive(xQueue[i],&req,0) == pdTRUE){
+      xSemaphoreTake(xWake,0);
+      execute((prio_t)i,&req,false);
+    }
+  }
+}
+
+void ModemManager::setOnline(bool bOnline){
+  _bOnline = bOnline;
+}
+
+bool ModemManager::isOnline(void){
+  return _bOnline;
+}
+
+bool ModemManager::queue(prio_t prio,request *req){
+  bool bRet = false;
+  if (xLock == NULL) return false;
+  xSemaphoreTake(xLock,portMAX_DELAY);
+  if (bRunning){
+    bRet = (xQueueSend(xQueue[prio],req,0) == pdTRUE);
+    if (bRet) xSemaphoreGive(xWake);
+  }
+  xSemaphoreGive(xLock);
+  if ((!bRet) && (bRunning)){
+    portENTER_CRITICAL(&mux);
+    _stats[prio].dropped++;
+    portEXIT_CRITICAL(&mux);
+  }
+  return bRet;
+}
+
+bool ModemManager::submit(prio_t prio,op_t op,ModemClient *client){
+  request req = {op,client,millis(),NULL,NULL};
+  return queue(prio,&req);
+}
+
+bool ModemManager::call(prio_t prio,callFunc fn,void *arg){
+  if (xCallLock == NULL) return false;
+  request req = {OP_CALL,NULL,millis(),fn,arg};
+  xSemaphoreTake(xCallLock,portMAX_DELAY);
+  bool bRet = queue(prio,&req);
+  if (bRet){
+    //request is always completed (by run or end), arg stays valid until then
+    xSemaphoreTake(xCallDone,portMAX_DELAY);
+    bRet = callResult;
+  }
+  xSemaphoreGive(xCallLock);
+  return bRet;
+}
+
+bool ModemManager::run(uint32_t timeout){
+  request req;
+  if (xSemaphoreTake(xWake,timeout) != pdTRUE) return false;
+  for (int i = 0;i < PRIO_COUNT;i++){
+    if (xQueueReceive(xQueue[i],&req,0) == pdTRUE){
+      execute((prio_t)i,&req,_bOnline);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ModemManager::execute(prio_t prio,request *req,bool bOnline){
+  uint32_t tStart = millis();
+  if (req->op == OP_CALL){
+    callResult = (bRunning) ? req->fn(req->arg) : false;
+    xSemaphoreGive(xCallDone);
+  }else{
+    req->client->serve(req->op,bOnline);
+  }
+  uint32_t tEnd = millis();
+  portENTER_CRITICAL(&mux);
+  _stats[prio].count++;
+  _stats[prio].waitSum += tStart - req->tQueued;
+  if ((tStart - req->tQueued) > _stats[prio].waitMax) _stats[prio].waitMax = tStart - req->tQueued;
+  _stats[prio].busySum += tEnd - tStart;
+  portEXIT_CRITICAL(&mux);
+}
+
+ModemManager::stats ModemManager::getStats(prio_t prio){
+  portENTER_CRITICAL(&mux);
+  stats ret = _stats[prio];
+  portEXIT_CRITICAL(&mux);
+  return ret;
+}
@@ -0,0 +1,77 @@
+/*!
+ * @file ModemManager.h
+ *
+ *
+ */
+
+#ifndef __MODEMMANAGER_H__
+#define __MODEMMANAGER_H__
+
+#include <Arduino.h>
+#include <string.h>
+
+#define MODEM_QUEUE_LEN 16 //requests waiting per priority
+
+class ModemClient;
+
+//owner of the modem: only the task, which calls run(), talks to the modem
+//other tasks put requests into one queue per priority, the most important request is served first
+class ModemManager {
+public:
+  enum prio_t : uint8_t
+  {
+    PRIO_HIGH = 0, //live-data
+    PRIO_NORMAL = 1, //modem-management
+    PRIO_LOW = 2, //uploads
+    PRIO_COUNT = 3,
+  };
+  enum op_t : uint8_t
+  {
+    OP_CONNECT = 0,
+    OP_WRITE = 1,
+    OP_POLL = 2, //read received data and connection-state
+    OP_STOP = 3,
+    OP_CALL = 4, //function, which is executed by the modem-task
+  };
+  typedef bool (*callFunc)(void *arg);
+  typedef struct {
+    uint32_t count; //served requests
+    uint32_t dropped; //requests lost because queue was full
+    uint32_t waitSum; //sum of queueing-delay [ms]
+    uint32_t waitMax; //max. queueing-delay [ms]
+    uint32_t busySum; //sum of execution-time [ms]
+  } stats;
+
+  ModemManager(); //constructor
+  bool begin(void);
+  void end(void); //fails all waiting requests, new requests fail immediately
+  bool run(uint32_t timeout); //serves one request, waits max. timeout [ms] for it (only from modem-task)
+  void setOnline(bool bOnline); //offline --> socket-requests fail without talking to the modem
+  bool isOnline(void);
+  bool call(prio_t prio,callFunc fn,void *arg); //executes fn in the modem-task and waits for the result
+  bool submit(prio_t prio,op_t op,ModemClient *client); //queues a socket-request, doesn't wait
+  stats getStats(prio_t prio);
+
+private:
+  typedef struct {
+    op_t op;
+    ModemClient *client;
+    uint32_t tQueued;
+    callFunc fn;
+    void *arg;
+  } request;
+  bool queue(prio_t prio,request *req);
+  void execute(prio_t prio,request *req,bool bOnline);
+  QueueHandle_t xQueue[PRIO_COUNT];
+  SemaphoreHandle_t xWake; //counts queued requests
+  SemaphoreHandle_t xLock; //no request is queued after end()
+  SemaphoreHandle_t xCallLock; //one call at a time
+  SemaphoreHandle_t xCallDone;
+  volatile bool callResult;
+  portMUX_TYPE mux;
+  volatile bool bRunning;
+  volatile bool _bOnline;
+  stats _stats[PRIO_COUNT];
+};
+
+#endif
@@ -0,0 +1,71 @@
+/*!
+ * @file Uplink.cpp
+ *
+ *
+ */
+
+#include "Uplink.h"
+
+UplinkQueue::UplinkQueue(){
+  xQueue = NULL;
+  _itemSize = 0;
+  tPopped = 0;
+  memset(&_stats,0,sizeof(_stats));
+}
+
+bool UplinkQueue::begin(uint8_t length,uint16_t itemSize){
+  if (xQueue) return true;
+  _itemSize = itemSize;
+  //every item is prefixed with the timestamp it was queued
+  xQueue = xQueueCreate(length,sizeof(uint32_t) + itemSize);
+  if (xQueue == NULL){
+    log_e("can't create uplink-queue");
+    return false;
+  }
+  return true;
+}
+
+void UplinkQueue::end(void){
+  if (xQueue == NULL) return;
+  vQueueDelete(xQueue);
+  xQueue = NULL;
+}
+
+bool UplinkQueue::push(const void *item){
+  if (xQueue == NULL) return false;
+  uint8_t buffer[sizeof(uint32_t) + _itemSize];
+  uint32_t tAct = millis();
+  memcpy(&buffer[0],&tAct,sizeof(uint32_t));
+  memcpy(&buffer[sizeof(uint32_t)],item,_itemSize);
+  if (xQueueSend(xQueue,buffer,0) != pdTRUE){
+    _stats.dropped++;
+    return false;
+  }
+  _stats.queued++;
+  return true;
+}
+
+bool UplinkQueue::pop(void *item){
+  if (xQueue == NULL) return false;
+  uint8_t buffer[sizeof(uint32_t) + _itemSize];
+  if (xQueueReceive(xQueue,buffer,0) != pdTRUE) return false;
+  memcpy(&tPopped,&buffer[0],sizeof(uint32_t));
+  memcpy(item,&buffer[sizeof(uint32_t)],_itemSize);
+  return true;
+}
+
+void UplinkQueue::done(bool bOk){
+  if (!bOk){
+    _stats.failed++;
+    return;
+  }
+  _stats.sent++;
+  _stats.latency = millis() - tPopped;
+  if (_stats.latency > _stats.latencyMax) _stats.latencyMax = _stats.latency;
+}
+
+UplinkQueue::stats UplinkQueue::getStats(void){
+  stats ret = _stats;
+  ret.waiting = (xQueue) ? uxQueueMessagesWaiting(xQueue) : 0;
+  return ret;
+}
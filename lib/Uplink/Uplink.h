@@ -0,0 +1,41 @@
+/*!
+ * @file Uplink.h
+ *
+ *
+ */
+
+#ifndef __UPLINK_H__
+#define __UPLINK_H__
+
+#include <Arduino.h>
+#include <string.h>
+
+//bounded queue for one uplink-destination, producer never blocks
+class UplinkQueue {
+public:
+  typedef struct {
+    uint32_t queued; //messages put into queue
+    uint32_t sent; //messages sent successfully
+    uint32_t dropped; //queue full --> message dropped
+    uint32_t failed; //sending failed
+    uint32_t latency; //last latency (queued --> sent) [ms]
+    uint32_t latencyMax; //max latency [ms]
+    uint8_t waiting; //messages waiting in queue
+  } stats;
+
+  UplinkQueue(); //constructor
+  bool begin(uint8_t length,uint16_t itemSize);
+  void end(void);
+  bool push(const void *item); //returns false if queue is full
+  bool pop(void *item); //returns false if queue is empty
+  void done(bool bOk); //has to be called after sending the popped item
+  stats getStats(void);
+
+private:
+  QueueHandle_t xQueue;
+  uint16_t _itemSize;
+  uint32_t tPopped; //queue-timestamp of last popped item
+  stats _stats;
+};
+
+#endif
@@ -0,0 +1,171 @@
+/*!
+ * @file UplinkStore.cpp
+ *
+ *
+ */
+
+#include "UplinkStore.h"
+
+UplinkStore::UplinkStore(const char *fileName,uint16_t slots,uint16_t slotSize){
+  _fileName = fileName;
+  _slots = slots;
+  _slotSize = slotSize;
+  _maxAge = 0;
+  _replayInterval = 0;
+  writeSeq = 0;
+  readSeq = 0;
+  bPeeked = false;
+  tReplay = 0;
+  tRateWindow = 0;
+  rateCount = 0;
+  memset(&_stats,0,sizeof(_stats));
+}
+
+bool UplinkStore::begin(uint32_t maxAge,uint32_t replayInterval){
+  _maxAge = maxAge;
+  _replayInterval = replayInterval;
+  file = SPIFFS.open(_fileName,"r+");
+  if ((!file) || (file.size() != (uint32_t)_slots * _slotSize)){
+    if (file) file.close();
+    //preallocate ring-file
+    file = SPIFFS.open(_fileName,"w");
+    if (!file){
+      log_e("can't create %s",_fileName);
+      return false;
+    }
+    uint8_t empty[_slotSize];
+    memset(empty,0xFF,_slotSize);
+    for (int i = 0;i < _slots;i++){
+      if (file.write(empty,_slotSize) != _slotSize){
+        log_e("not enough space for %s",_fileName);
+        file.close();
+        SPIFFS.remove(_fileName);
+        return false;
+      }
+    }
+    file.close();
+    file = SPIFFS.open(_fileName,"r+");
+    if (!file) return false;
+  }
+  //find records, which were not sent before reset
+  bool bFirst = true;
+  writeSeq = 0;
+  readSeq = 0;
+  slotHeader header;
+  for (int i = 0;i < _slots;i++){
+    if (!file.seek((uint32_t)i * _slotSize,SeekSet)) continue;
+    if (file.read((uint8_t *)&header,sizeof(header)) != sizeof(header)) continue;
+    if ((header.magic != UPLINKSTORE_MAGIC) || ((header.seq % _slots) != i)) continue;
+    if ((bFirst) || (header.seq < readSeq)) readSeq = header.seq;
+    if ((bFirst) || (header.seq >= writeSeq)) writeSeq = header.seq + 1;
+    bFirst = false;
+  }
+  log_i("%s backlog=%d",_fileName,writeSeq - readSeq);
+  return true;
+}
+
+void UplinkStore::end(void){
+  if (file) file.close();
+}
+
+uint8_t UplinkStore::calcCrc(slotHeader *header,const uint8_t *data){
+  uint8_t crc = 0;
+  const uint8_t *p = (const uint8_t *)&header->seq;
+  for (int i = 0;i < 8;i++) crc = (crc << 1 | crc >> 7) ^ p[i];
+  for (int i = 0;i < header->len;i++) crc = (crc << 1 | crc >> 7) ^ data[i];
+  return crc;
+}
+
+bool UplinkStore::readHeader(uint32_t seq,slotHeader *header){
+  if (!file.seek((seq % _slots) * _slotSize,SeekSet)) return false;
+  if (file.read((uint8_t *)header,sizeof(slotHeader)) != sizeof(slotHeader)) return false;
+  return ((header->magic == UPLINKSTORE_MAGIC) && (header->seq == seq));
+}
+
+void UplinkStore::markSent(uint32_t seq){
+  uint16_t magic = 0;
+  file.seek((seq % _slots) * _slotSize,SeekSet);
+  file.write((uint8_t *)&magic,sizeof(magic));
+  file.flush();
+}
+
+bool UplinkStore::append(uint32_t tRecord,const void *data,uint8_t len){
+  if (!file) return false;
+  if (len > _slotSize - sizeof(slotHeader)) return false;
+  if (writeSeq - readSeq >= _slots){
+    //store full --> overwrite oldest record
+    readSeq = writeSeq - _slots + 1;
+    bPeeked = false;
+    _stats.overwritten++;
+  }
+  slotHeader header;
+  header.magic = UPLINKSTORE_MAGIC;
+  header.len = len;
+  header.seq = writeSeq;
+  header.time = tRecord;
+  header.crc = calcCrc(&header,(const uint8_t *)data);
+  file.seek((writeSeq % _slots) * _slotSize,SeekSet);
+  file.write((uint8_t *)&header,sizeof(header));
+  file.write((const uint8_t *)data,len);
+  file.flush();
+  writeSeq++;
+  _stats.stored++;
+  return true;
+}
+
+int16_t UplinkStore::peek(uint32_t tNow,void *data,uint8_t maxLen){
+  if (!file) return -1;
+  uint32_t tAct = millis();
+  if ((tAct - tRateWindow) >= UPLINKSTORE_RATEWINDOW){
+    _stats.replayRate = (float)rateCount * 1000.0 / (float)(tAct - tRateWindow);
+    tRateWindow = tAct;
+    rateCount = 0;
+  }
+  if (readSeq == writeSeq) return -1;
+  if ((tAct - tReplay) < _replayInterval) return -1;
+  slotHeader header;
+  while (readSeq != writeSeq){
+    if ((!readHeader(readSeq,&header)) || (header.len > maxLen) || (file.read((uint8_t *)data,header.len) != header.len)
+        || (calcCrc(&header,(uint8_t *)data) != header.crc)){
+      readSeq++; //record already sent or broken
+      continue;
+    }
+    if ((_maxAge) && (tNow > header.time) && ((tNow - header.time) > _maxAge)){
+      markSent(readSeq);
+      readSeq++;
+      _stats.expired++;
+      continue;
+    }
+    bPeeked = true;
+    tReplay = tAct; //also limits retries, if sending fails
+    return header.len;
+  }
+  return -1;
+}
+
+void UplinkStore::pop(void){
+  if (!bPeeked) return;
+  bPeeked = false;
+  markSent(readSeq);
+  readSeq++;
+  rateCount++;
+  _stats.replayed++;
+}
+
+uint16_t UplinkStore::backlog(void){
+  return writeSeq - readSeq;
+}
+
+const char *UplinkStore::getFileName(void){
+  return _fileName;
+}
+
+uint32_t UplinkStore::getFileSize(void){
+  return (uint32_t)_slots * _slotSize;
+}
+
+UplinkStore::stats UplinkStore::getStats(void){
+  stats ret = _stats;
+  ret.backlog = backlog();
+  return ret;
+}
@@ -0,0 +1,68 @@
+/*!
+ * @file UplinkStore.h
+ *
+ *
+ */
+
+#ifndef __UPLINKSTORE_H__
+#define __UPLINKSTORE_H__
+
+#include <Arduino.h>
+#include <string.h>
+#include <SPIFFS.h>
+
+#define UPLINKSTORE_MAGIC 0x5355 //"US"
+#define UPLINKSTORE_RATEWINDOW 10000 //window for replay-rate [ms]
+
+//flash-backed ring of records, which couldn't be sent (network down)
+//every record is written to its own slot, so a reset looses max. the actual record
+class UplinkStore {
+public:
+  typedef struct {
+    uint16_t magic; //0 --> record already sent
+    uint8_t len; //length of payload
+    uint8_t crc; //crc over seq, time and payload
+    uint32_t seq; //sequence-number of record
+    uint32_t time; //unix-time of record
+  } __attribute__((packed)) slotHeader;
+
+  typedef struct {
+    uint16_t backlog; //records waiting
+    uint32_t stored; //records written to flash
+    uint32_t replayed; //records sent after network was back
+    uint32_t expired; //records dropped because too old
+    uint32_t overwritten; //records dropped because store was full
+    float replayRate; //records/s
+  } stats;
+
+  UplinkStore(const char *fileName,uint16_t slots,uint16_t slotSize); //constructor
+  bool begin(uint32_t maxAge,uint32_t replayInterval); //maxAge [s], replayInterval [ms]
+  void end(void);
+  bool append(uint32_t tRecord,const void *data,uint8_t len);
+  int16_t peek(uint32_t tNow,void *data,uint8_t maxLen); //oldest record, -1 if none or rate-limited
+  void pop(void); //peeked record was sent
+  uint16_t backlog(void);
+  stats getStats(void);
+  const char *getFileName(void);
+  uint32_t getFileSize(void); //size of the preallocated file
+
+private:
+  uint8_t calcCrc(slotHeader *header,const uint8_t *data);
+  bool readHeader(uint32_t seq,slotHeader *header);
+  void markSent(uint32_t seq);
+  const char *_fileName;
+  uint16_t _slots;
+  uint16_t _slotSize;
+  uint32_t _maxAge;
+  uint32_t _replayInterval;
+  File file;
+  uint32_t writeSeq; //seq of next record
+  uint32_t readSeq; //seq of oldest record
+  bool bPeeked;
+  uint32_t tReplay;
+  uint32_t tRateWindow;
+  uint32_t rateCount;
+  stats _stats;
+};
+
+#endif
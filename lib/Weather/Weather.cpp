@@ -2,18 +2,25 @@
 
 volatile uint32_t rainCount = 0;
 volatile unsigned long rainDebounceTime; // Timer to avoid contact bounce in isr
-volatile uint32_t aneometerpulsecount = 0;
-volatile uint32_t actPulseCount = 0;
-volatile uint8_t timerIrq = 0;
-volatile unsigned long ContactBounceTime; // Timer to avoid contact bounce in isr
+//anemometer-isr only writes the cpu-cycles of every pulse into the ring (single writer, no lock)
+//all isrs are attached on the core of the weather-task --> cycle-counters are comparable
+volatile uint32_t pulseCycles[PULSE_RING];
+volatile uint32_t pulseHead = 0; //number of pulses written
+volatile uint32_t lastPulseCycles = 0;
+volatile uint32_t debounceCycles = 0;
+volatile uint8_t timerIrq = 0; //seconds since last sample
+volatile uint32_t tickCycles = 0; //cpu-cycles of last timer-tick
+volatile uint32_t tickHead = 0; //pulseHead at last timer-tick
+portMUX_TYPE timerMux = portMUX_INITIALIZER_UNLOCKED;
 
 hw_timer_t * timer = NULL;
 
 void IRAM_ATTR windspeedhandler(void){
-  if((millis() - ContactBounceTime) > 15 ) { // debounce the switch contact.
-    aneometerpulsecount++;
-    ContactBounceTime = millis();
-  }
+  uint32_t t = ESP.getCycleCount();
+  if ((t - lastPulseCycles) < debounceCycles) return; // debounce the switch contact.
+  lastPulseCycles = t;
+  pulseCycles[pulseHead % PULSE_RING] = t;
+  pulseHead++;
 }
 
 void IRAM_ATTR rainhandler(void){
@@ -24,9 +31,11 @@ void IRAM_ATTR rainhandler(void){
 }
 
 void IRAM_ATTR onTimer() {
-  actPulseCount = aneometerpulsecount;
-  aneometerpulsecount = 0;
-  timerIrq = 1;
+  portENTER_CRITICAL_ISR(&timerMux);
+  tickCycles = ESP.getCycleCount();
+  tickHead = pulseHead; //pulses until this tick
+  timerIrq++;
+  portEXIT_CRITICAL_ISR(&timerMux);
 }
 
 
@@ -71,7 +80,11 @@ bool Weather::begin(TwoWire *pi2c, float height,int8_t oneWirePin, int8_t windDi
   pI2c = pi2c;
   _height = height;
   hasTempSensor = false;
-  aneometerpulsecount = 0;
+  cyclesPerSec = ESP.getCpuFreqMHz() * 1000000ul;
+  debounceCycles = cyclesPerSec / 1000 * WIND_DEBOUNCE;
+  pulseTail = pulseHead;
+  bLastPulse = false;
+  windspeed = 0;
   log_i("onewire pin=%d",oneWirePin);
   if (oneWirePin >= 0){
     oneWire.begin(oneWirePin);
@@ -122,7 +135,8 @@ bool Weather::begin(TwoWire *pi2c, float height,int8_t oneWirePin, int8_t windDi
   }
   timer = timerBegin(0, 80, true);
   timerAttachInterrupt(timer, &onTimer, true);
-  timerAlarmWrite(timer, 2250000, true); //every 2.25 seconds
+  ring.begin();
+  timerAlarmWrite(timer, 1000000, true); //every second one sample
   timerAlarmEnable(timer);
   return true;
 }
@@ -146,12 +160,29 @@ float Weather::calcPressure(float p, float t, float h){
 
 }
 
-void Weather::resetWindGust(void){
-  windgust = 0; //reset windgust
+void Weather::getValues(weatherData *weather,uint16_t window){
+  *weather = _weather;
+  WeatherRing::aggregate agg;
+  if (ring.getAggregate(window,&agg)){
+    weather->temp = agg.temp;
+    if (_weather.bWindSpeed){
+      weather->WindSpeed = agg.windSpeed;
+      weather->WindGust = agg.windGust;
+    }
+    if (_weather.bWindDir) weather->WindDir = agg.windDir;
+  }
+  if (_weather.bRain){
+    weather->rain1h = float(ring.getRainTips(60)) * Bucket_Size;
+    weather->rain24h = float(ring.getRainTips(1440)) * Bucket_Size;
+  }
+}
+
+void Weather::getRainHours(uint16_t *tips,uint8_t hours){
+  ring.getRainHours(tips,hours);
 }
 
-void Weather::getValues(weatherData *weather){
-  *weather = _weather;
+void Weather::setRainHistory(const uint16_t *tips,uint8_t hours){
+  ring.setRainHistory(tips,hours);
 }
 
 float Weather::calcExpAvgf(float oldValue, float newValue, float Factor){
@@ -223,50 +254,62 @@ void Weather::setWindDirOffset(int16_t winddirOffset){
   _winddirOffset = winddirOffset;
 }
 
-float Weather::calcWindspeed(void){
-  return (float)_actPulseCount * 1.609;
+float Weather::calcWindspeed(uint32_t head,uint32_t tTick,uint8_t seconds){
+  if ((head - pulseTail) > PULSE_RING){
+    //task was too late --> oldest pulses are overwritten
+    pulseTail = head - PULSE_RING;
+    bLastPulse = false;
+  }
+  uint32_t periods = 0;
+  uint32_t span = 0; //cpu-cycles of all periods
+  while (pulseTail != head){
+    uint32_t t = pulseCycles[pulseTail % PULSE_RING];
+    pulseTail++;
+    if (bLastPulse){
+      span += t - lastPulse;
+      periods++;
+    }
+    lastPulse = t;
+    bLastPulse = true;
+    silentSeconds = 0;
+  }
+  if (!bLastPulse) return 0;
+  silentSeconds += seconds;
+  if (silentSeconds > WIND_TIMEOUT){
+    //cycle-counter overflows after some seconds --> last pulse is not valid anymore
+    bLastPulse = false;
+    return 0;
+  }
+  float speed = windspeed;
+  if (periods > 0) speed = WIND_PULSE_FACTOR * periods * cyclesPerSec / span;
+  //no pulse since some time --> speed can't be higher
+  uint32_t gap = tTick - lastPulse;
+  if (gap > 0){
+    float maxSpeed = WIND_PULSE_FACTOR * cyclesPerSec / gap;
+    if (maxSpeed < speed) speed = maxSpeed;
+  }
+  return speed;
 }
 
 void Weather::checkAneometer(void){
-  static bool bFirstWSpeed = false;
-  static bool bFirstWDir = false;
-  
+  portENTER_CRITICAL(&timerMux);
+  uint8_t seconds = timerIrq;
+  uint32_t tTick = tickCycles;
+  uint32_t head = tickHead;
+  timerIrq = 0;
+  portEXIT_CRITICAL(&timerMux);
+  if (seconds == 0) return;
+  if (_weather.bWindSpeed) windspeed = calcWindspeed(head,tTick,seconds);
   if (_weather.bWindDir){
+    //direction is sampled with every timer-tick and weighted with the speed of this period
     VaneValue = analogRead(_windDirPin);
     winddir = (map(VaneValue, 0, 1023, 0, 359) + _winddirOffset) % 360;
-    if (!bFirstWDir){
-      sinWinddir = sin(winddir * DEG2RAD);
-      cosWinddir = cos(winddir * DEG2RAD);
-      bFirstWDir = true;
-    }
-    sinWinddir = calcExpAvgf(sinWinddir,sin(winddir * DEG2RAD),avgFactor); //calc avg from sin
-    cosWinddir = calcExpAvgf(cosWinddir,cos(winddir * DEG2RAD),avgFactor); //calc avg from cos
-    winddirAvg = int16_t(atan2(sinWinddir,cosWinddir) * RAD2DEG * 10); //get deg back vom sin and cos-value
-    while (winddirAvg < 0){
-      winddirAvg += 3600;
-    }
-    while (winddirAvg > 3600){
-      winddirAvg -= 3600;
-    }
-    _weather.WindDir = winddirAvg / 10.0;
   }
-  if (_weather.bWindSpeed){
-    if (timerIrq){
-      _actPulseCount = actPulseCount;
-      timerIrq = 0;
-      float wSpeed = calcWindspeed();
-      if (!bFirstWSpeed){
-        windspeed = wSpeed;
-        bFirstWSpeed = true;
-      }
-      if (wSpeed > windgust) windgust =  wSpeed;
-      windspeed = calcExpAvgf(windspeed,wSpeed,avgFactor);
-      //log_i("timer-interrupt pulse_count=%d %d",_actPulseCount,millis());
-      //log_i("gust=%.1f speed=%.1f",_weather.WindGust,_weather.WindSpeed);
-      _weather.WindSpeed = windspeed;
-      _weather.WindGust = windgust;      
-    }
+  if (!bFirst) return; //no temp yet
+  for (uint8_t i = 0;i < seconds;i++){
+    ring.addSample(windspeed,winddir,dTemp,rainCount);
   }
+  //log_i("speed=%.1f dir=%.0f %d",windspeed,winddir,millis());
 }
 
 void Weather::checkRainSensor(void){
@@ -17,6 +17,7 @@
 #include <OneWire.h>
 #include <DallasTemperature.h>
 #include <TimeLib.h>
+#include "WeatherRing.h"
 
 #define DEG2RAD M_PI / 180.0
 #define RAD2DEG 180.0 / M_PI
@@ -27,6 +28,11 @@
 #define WEATHER_UPLOAD 300000uL //weather upload intervall 5min
 
 #define Bucket_Size 0.5           // rain bucket size 0.5mm
+#define WIND_PULSE_FACTOR 3.62 // 1 pulse/s = 2.25mph = 3.62km/h
+#define WIND_DEBOUNCE 15 //min. time between 2 pulses [ms]
+#define WIND_TIMEOUT 10 //no pulse for this time --> calm [s]
+#define PULSE_RING 64 //timestamps of pulses, enough for 1s at 64Hz
+#define WEATHER_WINDOW 60 //default window for averages [s]
 
 class Weather {
 public:
@@ -45,6 +51,7 @@ public:
         bool bRain; //rain-sensor exists
         float rain1h; // rain this hour [l/h]
         float rain1d; // rain this day [l/h]
+        float rain24h = NAN; // rain last 24h [l/h]
     } weatherData;
 
     Weather(); //constructor
@@ -52,8 +59,9 @@ public:
     void setWindDirOffset(int16_t winddirOffset);
     bool begin(TwoWire *pi2c, float height,int8_t oneWirePin, int8_t windDirPin, int8_t windSpeedPin,int8_t rainPin);
     void run(void);
-    void getValues(weatherData *weather);
-    void resetWindGust(void);
+    void getValues(weatherData *weather,uint16_t window = WEATHER_WINDOW); //wind and temp averaged over window [s]
+    void getRainHours(uint16_t *tips,uint8_t hours); //rain-tips per hour, [0] = last hour
+    void setRainHistory(const uint16_t *tips,uint8_t hours); //rain-tips per hour before start (e.g. before deep-sleep)
 
 protected:
 private:
@@ -65,7 +73,7 @@ private:
     void copyValues(void);
     void checkAneometer(void);
     void checkRainSensor(void);
-    float calcWindspeed(void);
+    float calcWindspeed(uint32_t head,uint32_t tTick,uint8_t seconds);
     uint8_t sensorAdr;
     Adafruit_BME280 bme;
     uint16_t avgFactor; //factor for avg-factor
@@ -89,13 +97,14 @@ private:
 
     int VaneValue;// raw analog value from wind vane
     int Direction;// translated 0 - 360 direction    
-    uint32_t _actPulseCount = 0;
-    float winddir;
-    float sinWinddir;
-    float cosWinddir;
-    int16_t winddirAvg;
-    float windspeed = 0;
-    float windgust = 0;
+    float winddir = NAN;
+    float windspeed = 0; //speed of last second, calculated from pulse-periods [km/h]
+    uint32_t cyclesPerSec;
+    uint32_t pulseTail; //next pulse to read
+    uint32_t lastPulse; //cpu-cycles of last pulse
+    bool bLastPulse; //lastPulse is valid
+    uint8_t silentSeconds; //seconds since last pulse
+    WeatherRing ring; //1s-samples of wind, temp and rain
     uint32_t rainTipCount1h = 0;
     uint32_t rainTipCount1d = 0;
     uint8_t actHour;
@@ -0,0 +1,147 @@
+/*!
+ * @file WeatherRing.cpp
+ *
+ *
+ */
+
+#include "WeatherRing.h"
+
+#define DEG2RAD M_PI / 180.0
+#define RAD2DEG 180.0 / M_PI
+
+WeatherRing::WeatherRing(){
+  samples = NULL;
+  rain = NULL;
+  pos = 0;
+  count = 0;
+  rainPos = 0;
+  rainCount = 0;
+  secCount = 0;
+  actRainTips = 0;
+  lastDir = NAN;
+  memset(rainHist,0,sizeof(rainHist));
+}
+
+WeatherRing::~WeatherRing(){
+  free(samples);
+  free(rain);
+}
+
+bool WeatherRing::begin(void){
+  //one more entry than window, the sum before the window is needed too
+  if (samples == NULL) samples = (sample *)malloc((WEATHERRING_SECONDS + 1) * sizeof(sample));
+  if (rain == NULL) rain = (uint16_t *)malloc((WEATHERRING_MINUTES + 1) * sizeof(uint16_t));
+  if ((samples == NULL) || (rain == NULL)){
+    log_e("not enough memory");
+    return false;
+  }
+  memset(samples,0,(WEATHERRING_SECONDS + 1) * sizeof(sample));
+  memset(rain,0,(WEATHERRING_MINUTES + 1) * sizeof(uint16_t));
+  pos = 0;
+  count = 0;
+  rainPos = 0;
+  rainCount = 0;
+  secCount = 0;
+  return true;
+}
+
+void WeatherRing::addSample(float windSpeed,float windDir,float temp,uint32_t rainTips){
+  if (samples == NULL) return;
+  sample *last = &samples[pos];
+  uint16_t newPos = (pos + 1) % (WEATHERRING_SECONDS + 1);
+  sample *act = &samples[newPos];
+  int32_t speed = int32_t(windSpeed * 10.0 + 0.5);
+  float dir = (isnan(windDir)) ? 0 : windDir * DEG2RAD;
+  act->speed = last->speed + speed;
+  act->windX = last->windX + (uint32_t)int32_t(speed * cos(dir));
+  act->windY = last->windY + (uint32_t)int32_t(speed * sin(dir));
+  act->temp = last->temp + (uint32_t)int32_t(temp * 100.0);
+  //3s-mean from running sum
+  uint8_t n = (count + 1 < WEATHERRING_GUST) ? count + 1 : WEATHERRING_GUST;
+  sample *before = &samples[(newPos + WEATHERRING_SECONDS + 1 - n) % (WEATHERRING_SECONDS + 1)];
+  act->gust = uint16_t((act->speed - before->speed) / n);
+  pos = newPos;
+  if (count < WEATHERRING_SECONDS) count++;
+  if ((speed > 0) && (!isnan(windDir))) lastDir = windDir;
+
+  actRainTips = rainTips;
+  if (rainCount == 0){
+    rain[0] = (uint16_t)rainTips; //start of first minute
+    rainCount = 1;
+  }
+  secCount++;
+  if (secCount >= 60){
+    secCount = 0;
+    rainPos = (rainPos + 1) % (WEATHERRING_MINUTES + 1);
+    rain[rainPos] = (uint16_t)rainTips;
+    if (rainCount <= WEATHERRING_MINUTES) rainCount++;
+  }
+}
+
+bool WeatherRing::getAggregate(uint16_t seconds,aggregate *agg){
+  if ((samples == NULL) || (count == 0)) return false;
+  if (seconds > count) seconds = count;
+  if (seconds == 0) seconds = 1;
+  sample *act = &samples[pos];
+  uint16_t startPos = (pos + WEATHERRING_SECONDS + 1 - seconds) % (WEATHERRING_SECONDS + 1);
+  sample *start = &samples[startPos];
+  agg->samples = seconds;
+  agg->windSpeed = (act->speed - start->speed) / 10.0 / seconds;
+  int32_t x = (int32_t)(act->windX - start->windX);
+  int32_t y = (int32_t)(act->windY - start->windY);
+  if ((x == 0) && (y == 0)){
+    agg->windDir = lastDir; //calm --> keep last direction
+  }else{
+    agg->windDir = atan2(y,x) * RAD2DEG;
+    if (agg->windDir < 0) agg->windDir += 360.0;
+  }
+  agg->temp = (float)(int32_t)(act->temp - start->temp) / 100.0 / seconds;
+  //gust is no sum --> search max. of the 3s-means in window
+  uint16_t gust = 0;
+  for (uint16_t i = 0;i < seconds;i++){
+    uint16_t index = (pos + WEATHERRING_SECONDS + 1 - i) % (WEATHERRING_SECONDS + 1);
+    if (samples[index].gust > gust) gust = samples[index].gust;
+  }
+  agg->windGust = gust / 10.0;
+  return true;
+}
+
+uint32_t WeatherRing::getRainTips(uint16_t minutes){
+  if (minutes > WEATHERRING_MINUTES) minutes = WEATHERRING_MINUTES;
+  uint32_t tips = 0;
+  uint16_t ringMinutes = 0;
+  if ((rain != NULL) && (rainCount > 0)){
+    ringMinutes = rainCount - 1;
+    uint16_t window = (minutes > ringMinutes) ? ringMinutes : minutes; //not enough history --> since start
+    //the actual minute is running, the window begins at the minute-mark before
+    uint16_t index = (rainPos + WEATHERRING_MINUTES + 1 - window) % (WEATHERRING_MINUTES + 1);
+    tips = (uint16_t)((uint16_t)actRainTips - rain[index]);
+  }
+  //rest of window is before start --> whole hours from history
+  if (minutes > ringMinutes){
+    uint8_t hours = (minutes - ringMinutes + 59) / 60;
+    for (uint8_t i = 0;i < hours;i++) tips += rainHist[i];
+  }
+  return tips;
+}
+
+void WeatherRing::getRainHours(uint16_t *tips,uint8_t hours){
+  uint32_t last = 0;
+  for (uint8_t i = 0;i < hours;i++){
+    uint32_t sum = getRainTips((i + 1) * 60);
+    tips[i] = (uint16_t)(sum - last);
+    last = sum;
+  }
+}
+
+void WeatherRing::setRainHistory(const uint16_t *tips,uint8_t hours){
+  if (hours > WEATHERRING_HISTHOURS) hours = WEATHERRING_HISTHOURS;
+  memset(rainHist,0,sizeof(rainHist));
+  memcpy(rainHist,tips,hours * sizeof(uint16_t));
+}
+
+void WeatherRing::shiftRainHours(uint16_t *tips,uint8_t hours,uint32_t shift){
+  for (int i = hours - 1;i >= 0;i--){
+    tips[i] = ((uint32_t)i >= shift) ? tips[i - shift] : 0;
+  }
+}
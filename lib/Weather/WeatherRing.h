@@ -0,0 +1,59 @@
+/*!
+ * @file WeatherRing.h
+ *
+ *
+ */
+
+#ifndef __WEATHERRING_H__
+#define __WEATHERRING_H__
+
+#include <Arduino.h>
+#include <string.h>
+
+#define WEATHERRING_SECONDS 300 //max. window for wind and temp [s]
+#define WEATHERRING_MINUTES 1440 //max. window for rain [min]
+#define WEATHERRING_GUST 3 //gust is max. of 3s-mean
+#define WEATHERRING_HISTHOURS 24 //hours of rain before start (e.g. before deep-sleep)
+
+//ring of 1s-samples with running sums --> mean over any window is the difference of 2 sums
+class WeatherRing {
+public:
+  typedef struct {
+    float windSpeed; //mean speed [km/h]
+    float windDir; //direction of mean wind-vector [deg]
+    float windGust; //max. 3s-mean [km/h]
+    float temp; //mean temp [°C]
+    uint16_t samples; //samples in window
+  } aggregate;
+
+  WeatherRing(); //constructor
+  ~WeatherRing();
+  bool begin(void);
+  void addSample(float windSpeed,float windDir,float temp,uint32_t rainTips); //windSpeed of last second [km/h], rainTips since start
+  bool getAggregate(uint16_t seconds,aggregate *agg);
+  uint32_t getRainTips(uint16_t minutes); //tips of last minutes
+  void getRainHours(uint16_t *tips,uint8_t hours); //tips per hour, [0] = last hour
+  void setRainHistory(const uint16_t *tips,uint8_t hours); //tips per hour before start, [0] = last hour
+  static void shiftRainHours(uint16_t *tips,uint8_t hours,uint32_t shift); //makes the hours older by shift hours (e.g. slept)
+
+private:
+  typedef struct {
+    uint32_t speed; //running sums, differences are valid also after overflow [0.1km/h]
+    uint32_t windX; //[0.1km/h]
+    uint32_t windY; //[0.1km/h]
+    uint32_t temp; //[0.01°C]
+    uint16_t gust; //3s-mean ending with this sample [0.1km/h]
+  } __attribute__((packed)) sample;
+  sample *samples;
+  uint16_t *rain; //running sum of rain-tips at every full minute
+  uint16_t pos; //index of last sample
+  uint16_t count; //samples in ring
+  uint16_t rainPos;
+  uint16_t rainCount;
+  uint8_t secCount; //seconds of actual minute
+  uint32_t actRainTips;
+  uint16_t rainHist[WEATHERRING_HISTHOURS]; //tips per hour before start
+  float lastDir;
+};
+
+#endif
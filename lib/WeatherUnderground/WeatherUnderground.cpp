@@ -4,14 +4,21 @@
 WeatherUnderground::WeatherUnderground(){
     client = NULL;
     xMutex = NULL;
+    upload.setHost("weatherstation.wunderground.com");
 }
 
 void WeatherUnderground::setClient(Client *_client){
     client = _client;
+    upload.setClient(_client);
 }
 
 void WeatherUnderground::setMutex(SemaphoreHandle_t *_xMutex){
     xMutex = _xMutex;
+    upload.setMutex(_xMutex);
+}
+
+HttpEndpoint::stats WeatherUnderground::getUploadStats(void){
+    return upload.getStats();
 }
 
 
@@ -29,21 +36,43 @@ bool WeatherUnderground::getData(String ID,String KEY,wData *data){ //get Data f
           KEY.c_str()
           );
   //log_i("%s len=%d",msg,strlen(msg));
-  String payload = ""; //http.getString();
   if (client == NULL){    
     client = new WiFiClient();
   }
+  //only the needed fields are stored, the rest of the response is skipped while parsing
+  DynamicJsonDocument filter(WU_FILTER_SIZE);
+  JsonObject fObs = filter["observations"].createNestedObject();
+  fObs["stationID"] = true;
+  fObs["lat"] = true;
+  fObs["lon"] = true;
+  fObs["humidity"] = true;
+  fObs["winddir"] = true;
+  JsonObject fMetric = fObs.createNestedObject("metric");
+  fMetric["elev"] = true;
+  fMetric["temp"] = true;
+  fMetric["windSpeed"] = true;
+  fMetric["windGust"] = true;
+  fMetric["pressure"] = true;
+  fMetric["precipRate"] = true;
+  fMetric["precipTotal"] = true;
+  DynamicJsonDocument doc(WU_JSON_SIZE);
   xSemaphoreTake( *xMutex, portMAX_DELAY );
   HttpClient http(*client, "api.weather.com");  
   int httpResponseCode = http.get(msg);
   if (httpResponseCode == 0){
     httpResponseCode = http.responseStatusCode();
     if (httpResponseCode == 200){
-      int length = http.contentLength();
-      if (length >= 0) {
-        payload = http.responseBody();
+      if (http.skipResponseHeaders() == HTTP_SUCCESS){
+        //parse directly from the client, no copy of the body
+        uint32_t tStart = millis();
+        DeserializationError error = deserializeJson(doc, http, DeserializationOption::Filter(filter));
+        if (error){
+          log_e("deserializeJson() failed: %s",error.c_str());
+          bRet = false;
+        }
+        log_d("parsed in %dms, doc-size=%d",millis() - tStart,doc.memoryUsage());
       }else{
-        log_e("content length <= 0");
+        log_e("can't read header");
         bRet = false;
       }
     }else{
@@ -59,26 +88,23 @@ bool WeatherUnderground::getData(String ID,String KEY,wData *data){ //get Data f
   if (!bRet){
     return bRet;
   }
-  //log_i("%s",payload.c_str());
-  DynamicJsonDocument doc(2048);
-  deserializeJson(doc, payload);
-  String stationID = doc["observations"][0]["stationID"].as<String>();
-  if (stationID != ID){
-    log_e("stationid not equal %s != %s",ID.c_str(),stationID.c_str());
+  JsonObject obs = doc["observations"][0];
+  JsonObject metric = obs["metric"];
+  const char *stationID = obs["stationID"] | "";
+  if (ID != stationID){
+    log_e("stationid not equal %s != %s",ID.c_str(),stationID);
     return false;
   }
-  //if (doc["observations"][0]["stationID"]) log_i("%s",doc["observations"][0]["stationID"].as<String>().c_str());
-  if (doc["observations"][0]["lat"]) data->lat = doc["observations"][0]["lat"].as<float>();
-  if (doc["observations"][0]["lon"]) data->lon = doc["observations"][0]["lon"].as<float>();
-  if (doc["observations"][0]["metric"]["elev"]) data->height = doc["observations"][0]["metric"]["elev"].as<float>();
-  if (doc["observations"][0]["metric"]["temp"]) data->temp = doc["observations"][0]["metric"]["temp"].as<float>();
-  if (doc["observations"][0]["humidity"]) data->humidity = doc["observations"][0]["humidity"].as<float>();
-  String s = doc["observations"][0]["winddir"].as<String>();
-  if (s != "null"){
+  if (obs["lat"]) data->lat = obs["lat"].as<float>();
+  if (obs["lon"]) data->lon = obs["lon"].as<float>();
+  if (metric["elev"]) data->height = metric["elev"].as<float>();
+  if (metric["temp"]) data->temp = metric["temp"].as<float>();
+  if (obs["humidity"]) data->humidity = obs["humidity"].as<float>();
+  if (!obs["winddir"].isNull()){
     data->bWind = true;
-    data->winddir = doc["observations"][0]["winddir"].as<float>();
-    data->windspeed = doc["observations"][0]["metric"]["windSpeed"].as<float>();    
-    data->windgust = doc["observations"][0]["metric"]["windGust"].as<float>();
+    data->winddir = obs["winddir"].as<float>();
+    data->windspeed = metric["windSpeed"].as<float>();    
+    data->windgust = metric["windGust"].as<float>();
   }else{
     log_i("no wind-data");
     data->bWind = false;
@@ -88,13 +114,12 @@ bool WeatherUnderground::getData(String ID,String KEY,wData *data){ //get Data f
   }
   
   
-  if (doc["observations"][0]["metric"]["pressure"]) data->pressure = doc["observations"][0]["metric"]["pressure"].as<float>();
+  if (metric["pressure"]) data->pressure = metric["pressure"].as<float>();
   
-  s = doc["observations"][0]["metric"]["precipRate"].as<String>();
-  if (s != "null"){
+  if (!metric["precipRate"].isNull()){
     data->bRain = true;
-    data->rain1h = doc["observations"][0]["metric"]["precipRate"].as<float>();
-    data->raindaily = doc["observations"][0]["metric"]["precipTotal"].as<float>();
+    data->rain1h = metric["precipRate"].as<float>();
+    data->raindaily = metric["precipTotal"].as<float>();
   }else{
     log_i("no rain-data");
     data->bRain = false;
@@ -154,24 +179,14 @@ bool  WeatherUnderground::sendData(String ID,String KEY,wData *data){ //send Dat
   strcat(msg,msg2);
   //log_i("T1=%f h=%f p1=%f dp=%f",temp,humidity,baro,dewpoint);
   //log_i("%s len=%d",msg,strlen(msg));
-  if (client == NULL){    
-    client = new WiFiClient();
-  }
-  xSemaphoreTake( *xMutex, portMAX_DELAY );
-  HttpClient http(*client, "weatherstation.wunderground.com");  
-  int httpResponseCode = http.get(msg);
-  if (httpResponseCode == 0){
-    httpResponseCode = http.responseStatusCode();
-    if (httpResponseCode != 200){
-      log_e("resp=%d",httpResponseCode);
-      bRet = false;
-    } 
-  }else{
+  int httpResponseCode = upload.get(msg);
+  if (httpResponseCode < 0){
     log_e("failed to connect=%d",httpResponseCode);
     bRet = false;
+  }else if (httpResponseCode != 200){
+    log_e("resp=%d",httpResponseCode);
+    bRet = false;
   }
-  http.stop();
-  xSemaphoreGive( *xMutex );
   return bRet;
 
   /*
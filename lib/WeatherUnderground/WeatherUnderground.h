@@ -16,6 +16,11 @@
 #include <ArduinoJson.h>
 #include <ArduinoHttpClient.h>
 #include <WiFi.h>
+#include <HttpEndpoint.h>
+
+//filter: {"observations":[{6 fields,"metric":{7 fields}}]}, sized with the slot-size of the target
+#define WU_FILTER_SIZE (JSON_OBJECT_SIZE(1) + JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(6) + JSON_OBJECT_SIZE(7))
+#define WU_JSON_SIZE (WU_FILTER_SIZE + 160) //filtered observation + copied keys and station-id, the full response needs ~2kB
 
 //windspeed [km/h]
 //windgust [km/h]
@@ -45,6 +50,7 @@ public:
     bool getData(String ID,String KEY,wData *data); //get Data from WU with Station-ID and API-Key
     void setClient(Client *_client);
     void setMutex(SemaphoreHandle_t *_xMutex);
+    HttpEndpoint::stats getUploadStats(void);
 
 protected:
 private:
@@ -55,5 +61,6 @@ private:
     bool _rainsensor;
     Client *client;
     SemaphoreHandle_t *xMutex;    
+    HttpEndpoint upload; //kept between uploads
 };
 #endif
\ No newline at end of file
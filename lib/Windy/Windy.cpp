@@ -4,14 +4,21 @@
 Windy::Windy(){
     client = NULL;
     xMutex = NULL;
+    upload.setHost("stations.windy.com");
 }
 
 void Windy::setClient(Client *_client){
     client = _client;
+    upload.setClient(_client);
 }
 
 void Windy::setMutex(SemaphoreHandle_t *_xMutex){
     xMutex = _xMutex;
+    upload.setMutex(_xMutex);
+}
+
+HttpEndpoint::stats Windy::getUploadStats(void){
+    return upload.getStats();
 }
 
 bool  Windy::sendData(String ID,String APIKEY,wData *data){ //send Data to WU with Station-ID and Station-Key
@@ -59,23 +66,13 @@ bool  Windy::sendData(String ID,String APIKEY,wData *data){ //send Data to WU wi
   }  
   //log_i("T1=%f h=%f p1=%f dp=%f",temp,humidity,baro,dewpoint);
   log_i("%s len=%d",msg,strlen(msg));
-  if (client == NULL){    
-    client = new WiFiClient();
-  }
-  xSemaphoreTake( *xMutex, portMAX_DELAY );
-  HttpClient http(*client, "stations.windy.com");  
-  int httpResponseCode = http.get(msg);
-  if (httpResponseCode == 0){
-    httpResponseCode = http.responseStatusCode();
-    if (httpResponseCode != 200){
-      log_e("resp=%d",httpResponseCode);
-      bRet = false;
-    } 
-  }else{
+  int httpResponseCode = upload.get(msg);
+  if (httpResponseCode < 0){
     log_e("failed to connect=%d",httpResponseCode);
     bRet = false;
+  }else if (httpResponseCode != 200){
+    log_e("resp=%d",httpResponseCode);
+    bRet = false;
   }
-  http.stop();
-  xSemaphoreGive( *xMutex );
   return bRet;
 }
\ No newline at end of file
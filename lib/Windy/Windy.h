@@ -16,6 +16,7 @@
 #include <ArduinoJson.h>
 #include <ArduinoHttpClient.h>
 #include <WiFi.h>
+#include <HttpEndpoint.h>
 
 //windspeed [km/h]
 //windgust [km/h]
@@ -44,6 +45,7 @@ public:
     bool sendData(String ID,String APIKEY,wData *data); //send Data to Windy with Station-ID and Station-Key
     void setClient(Client *_client);
     void setMutex(SemaphoreHandle_t *_xMutex);
+    HttpEndpoint::stats getUploadStats(void);
 
 protected:
 private:
@@ -54,5 +56,6 @@ private:
     bool _rainsensor;
     Client *client;
     SemaphoreHandle_t *xMutex;    
+    HttpEndpoint upload; //kept between uploads
 };
 #endif
\ No newline at end of file
@@ -34,13 +34,44 @@ beeper::beeper(double sinkingThreshold, double climbingThreshold, double nearCli
   beepStartTime = 0;
   beepState = 0;
   beepType = BEEP_TYPE_SILENT;
+  beepVelocity = 0;
+  beepFreq = 0;
+  beepCadence = 0;
+  beepPaternBasePosition = 0;
+  beepPaternPosition = 0;
+  outFreq = 0;
+  outVolume = 0;
+  tUpdate = 0;
+  tUpdateMax = 0;
+  buildTables();
+}
+
+void beeper::buildTables() {
+
+  /* precompute freq and climbing cadence for every velocity step */
+  for( int16_t i = 0; i < BEEP_TABLE_SIZE; i++ ) {
+    double velocity = (double)(i + BEEP_TABLE_MIN_INDEX) * BEEP_VELOCITY_SENSITIVITY;
+    double freq = CLIMBING_BEEP_FREQ_COEFF * velocity + CLIMBING_BEEP_BASE_FREQ;
+    climbFreqTable[i] = (freq < 1.0) ? 1 : (uint16_t)freq;
+    freq = SINKING_BEEP_FREQ_COEFF * velocity + SINKING_BEEP_BASE_FREQ;
+    sinkFreqTable[i] = (freq < 1.0) ? 1 : (uint16_t)freq;
+    double cadence = velocity * CLIMBING_BEEP_VELOCITY_FILTER_COEFF + CLIMBING_BEEP_VELOCITY_FILTER_BASE;
+    cadenceTable[i] = (cadence < 0.0) ? 0 : (uint16_t)(cadence * (1 << BEEP_CADENCE_SHIFT));
+  }
+}
+
+int16_t beeper::tableIndex(int16_t velocity) {
+  int16_t index = velocity / BEEP_VELOCITY_SENSITIVITY_CMS;
+  if( index < BEEP_TABLE_MIN_INDEX ) index = BEEP_TABLE_MIN_INDEX;
+  if( index > BEEP_TABLE_MAX_INDEX ) index = BEEP_TABLE_MAX_INDEX;
+  return index - BEEP_TABLE_MIN_INDEX;
 }
 
 void beeper::setThresholds(double sinkingThreshold, double climbingThreshold, double nearClimbingSensitivity) {
 
-  beepSinkingThreshold = sinkingThreshold;
-  beepGlidingThreshold = climbingThreshold - nearClimbingSensitivity;
-  beepClimbingThreshold = climbingThreshold;
+  beepSinkingThreshold = (int16_t)round(sinkingThreshold * 100.0);
+  beepGlidingThreshold = (int16_t)round((climbingThreshold - nearClimbingSensitivity) * 100.0);
+  beepClimbingThreshold = (int16_t)round(climbingThreshold * 100.0);
 }
 
 void beeper::setVolume(uint8_t newVolume) {
@@ -53,8 +84,8 @@ void beeper::setGlidingBeepState(boolean status) {
     bst_set(GLIDING_BEEP_ENABLED);
     if( beepType == BEEP_TYPE_GLIDING ) {
       beepStartTime = millis();
-      beepPaternBasePosition = 0.0;
-      beepPaternPosition = 0.0;
+      beepPaternBasePosition = 0;
+      beepPaternPosition = 0;
     }
   } else {
     bst_unset(GLIDING_BEEP_ENABLED);
@@ -70,40 +101,40 @@ void beeper::setGlidingAlarmState(boolean status) {
 }
 
 
-void beeper::setBeepParameters(double velocity) {
+void beeper::setBeepParameters(int16_t velocity) {
 
   /* save velocity */
   beepVelocity = velocity;
 
-  /* compute the beep freq that depend to beep type */
+  /* get the beep freq that depend to beep type */
+  int16_t index = tableIndex(velocity);
   switch( beepType ) {
   case BEEP_TYPE_SINKING :
-    beepFreq = SINKING_BEEP_FREQ_COEFF * velocity + SINKING_BEEP_BASE_FREQ;
+    beepFreq = sinkFreqTable[index];
     break;
 
   case BEEP_TYPE_SILENT :
-    beepFreq = 0.0;
+    beepFreq = 0;
     break;
 
   case BEEP_TYPE_GLIDING :
-    beepFreq = CLIMBING_BEEP_FREQ_COEFF * velocity + CLIMBING_BEEP_BASE_FREQ;
-    break;
-
   case BEEP_TYPE_CLIMBING :
-    beepFreq = CLIMBING_BEEP_FREQ_COEFF * velocity + CLIMBING_BEEP_BASE_FREQ;
+    beepFreq = climbFreqTable[index];
     break;
   }
-
+  beepCadence = cadenceTable[index];
 }
 
 
-void beeper::setVelocity(double velocity) {
+void beeper::setVelocity(double fVelocity) {
+
+  int16_t velocity = (int16_t)round(constrain(fVelocity, -300.0, 300.0) * 100.0); //cm/s
   
   /* check if we need to change the beep type */
   boolean beepTypeChange = false;
   switch( beepType ) {
   case BEEP_TYPE_SINKING :
-    if( velocity >  beepSinkingThreshold + BEEP_VELOCITY_SENSITIVITY )
+    if( velocity >  beepSinkingThreshold + BEEP_VELOCITY_SENSITIVITY_CMS )
       beepTypeChange = true;
     break;
 
@@ -113,12 +144,12 @@ void beeper::setVelocity(double velocity) {
     break;
 
   case BEEP_TYPE_GLIDING :
-    if( velocity < beepGlidingThreshold - BEEP_VELOCITY_SENSITIVITY || velocity > beepClimbingThreshold )
+    if( velocity < beepGlidingThreshold - BEEP_VELOCITY_SENSITIVITY_CMS || velocity > beepClimbingThreshold )
       beepTypeChange = true;
     break;
 
   case BEEP_TYPE_CLIMBING :
-    if( velocity < beepClimbingThreshold - BEEP_VELOCITY_SENSITIVITY )
+    if( velocity < beepClimbingThreshold - BEEP_VELOCITY_SENSITIVITY_CMS )
        beepTypeChange = true;
     break;
   }
@@ -157,8 +188,8 @@ void beeper::setVelocity(double velocity) {
   if( (beepTypeChange && !bst_isset(CLIMBING_ALARM) && !bst_isset(SINKING_ALARM) ) ||
       (startAlarm) ) {
     beepStartTime = millis();
-    beepPaternBasePosition = 0.0;
-    beepPaternPosition = 0.0;
+    beepPaternBasePosition = 0;
+    beepPaternPosition = 0;
     bst_set(BEEP_NEW_FREQ); //force changing freq
   }
 
@@ -176,19 +207,18 @@ void beeper::setVelocity(double velocity) {
     //log_i("new beepType=%d",beepType);
   }
  
-  /* check if we need to change the beep parameters  */
-  /* !!! not forcing freq change on patern beeps !!! */
-  /*     just wait for the next silent               */
+  /* check if we need to change the beep parameters     */
+  /* patern beeps take the new freq with the next update */
   if( startAlarm || beepTypeChange ||
-      velocity > beepVelocity + BEEP_VELOCITY_SENSITIVITY ||
-      velocity < beepVelocity - BEEP_VELOCITY_SENSITIVITY ) {
+      velocity > beepVelocity + BEEP_VELOCITY_SENSITIVITY_CMS ||
+      velocity < beepVelocity - BEEP_VELOCITY_SENSITIVITY_CMS ) {
     setBeepParameters(velocity);
     if( beepType == BEEP_TYPE_SINKING )
       bst_set(BEEP_NEW_FREQ);  //sinking beep don't have patern
   }
 }
 
-void beeper::setBeepPaternPosition(double velocity) {
+void beeper::setBeepPaternPosition(uint32_t currentTime) {
 
   /* check alarm */
   boolean haveAlarm = false;
@@ -204,15 +234,14 @@ void beeper::setBeepPaternPosition(double velocity) {
     return;
   }
   
-  unsigned long currentTime = millis();
-  double currentLength = (double)(currentTime - beepStartTime) / 1000.0;
+  uint32_t currentLength = currentTime - beepStartTime;
 
   /*******************************************/
   /* does the position depends on velocity ? */
   /*******************************************/
   if( !haveAlarm &&
       beepType == BEEP_TYPE_CLIMBING ) {
-    currentLength *= (beepVelocity * CLIMBING_BEEP_VELOCITY_FILTER_COEFF + CLIMBING_BEEP_VELOCITY_FILTER_BASE);
+    currentLength = (currentLength * beepCadence) >> BEEP_CADENCE_SHIFT;
 
     /* avoid going backward */
     if( currentLength + beepPaternBasePosition > beepPaternPosition ) {
@@ -231,12 +260,12 @@ void beeper::setBeepPaternPosition(double velocity) {
     /* climbing alarm */
     if( bst_isset(CLIMBING_ALARM) ) {
       /* if alarm done, reset */
-      if( beepPaternPosition > CLIMBING_ALARM_LENGTH ) {
+      if( beepPaternPosition > CLIMBING_ALARM_LENGTH_MS ) {
 	bst_unset(CLIMBING_ALARM);
 	beepStartTime = currentTime;
-	beepPaternBasePosition = 0.0;
-	beepPaternPosition = 0.0;
-	setBeepPaternPosition(velocity);
+	beepPaternBasePosition = 0;
+	beepPaternPosition = 0;
+	setBeepPaternPosition(currentTime);
 	bst_set(BEEP_NEW_FREQ);
 	return;
       }
@@ -244,12 +273,12 @@ void beeper::setBeepPaternPosition(double velocity) {
     /* sinking alarm */
     else {
       /* if alarm done reset */
-      if( beepPaternPosition > SINKING_ALARM_LENGTH ) {
+      if( beepPaternPosition > SINKING_ALARM_LENGTH_MS ) {
 	bst_unset(SINKING_ALARM);
 	beepStartTime = currentTime;
-	beepPaternBasePosition = 0.0;
-	beepPaternPosition = 0.0;
-	setBeepPaternPosition(velocity);
+	beepPaternBasePosition = 0;
+	beepPaternPosition = 0;
+	setBeepPaternPosition(currentTime);
 	bst_set(BEEP_NEW_FREQ);
 	return;
       }
@@ -257,21 +286,39 @@ void beeper::setBeepPaternPosition(double velocity) {
   }
   /* looping patern case */
   else {
-    double loopingPaternLength;
+    uint32_t loopingPaternLength;
     if(  beepType == BEEP_TYPE_GLIDING ) {
-      loopingPaternLength = GLIDING_BEEP_LENGTH;
+      loopingPaternLength = GLIDING_BEEP_LENGTH_MS;
     }else {
-      loopingPaternLength = CLIMBING_BEEP_LENGTH;
+      loopingPaternLength = CLIMBING_BEEP_LENGTH_MS;
     }
 
-    while( beepPaternPosition > loopingPaternLength ) {
-        beepPaternPosition -= loopingPaternLength;
-        beepStartTime = millis();
+    if( beepPaternPosition > loopingPaternLength ) {
+        beepPaternPosition %= loopingPaternLength;
+        beepStartTime = currentTime;
         beepPaternBasePosition = beepPaternPosition;
     }
   }
 }
 
+void beeper::writeTone(uint16_t freq) {
+
+  /* only touch the ledc-timer when the output really changes */
+  uint8_t newVolume = (freq == 0) ? 0 : volume;
+  if( freq == 0 || newVolume == 0 ) {
+    freq = 0;
+    newVolume = 0;
+  }
+  if( (freq == outFreq) && (newVolume == outVolume) ) return;
+  if( freq == 0 ) {
+    toneAC(0);
+  } else {
+    toneAC(freq, newVolume);
+  }
+  outFreq = freq;
+  outVolume = newVolume;
+}
+
 
 void beeper::setTone() {
   
@@ -284,21 +331,17 @@ void beeper::setTone() {
     if( bst_isset(CLIMBING_ALARM) ) {
 
       /* get half position */
-      double halfPaternPosition = beepPaternPosition;
-      if( halfPaternPosition > (CLIMBING_ALARM_LENGTH/2.0) ) {
-	halfPaternPosition -= (CLIMBING_ALARM_LENGTH/2.0);
+      uint32_t halfPaternPosition = beepPaternPosition;
+      if( halfPaternPosition > (CLIMBING_ALARM_LENGTH_MS/2) ) {
+	halfPaternPosition -= (CLIMBING_ALARM_LENGTH_MS/2);
       }
 
       /* set tone */
-      if( halfPaternPosition < CLIMBING_ALARM_HIGH_LENGTH ) {
-	if( !bst_isset(BEEP_HIGH) ) {
-	  toneAC(CLIMBING_ALARM_FREQ, volume);
-	  bst_set(BEEP_HIGH);
-	} else if( bst_isset(BEEP_NEW_FREQ) ) {
-	  toneAC(CLIMBING_ALARM_FREQ, volume);
-	}
+      if( halfPaternPosition < CLIMBING_ALARM_HIGH_LENGTH_MS ) {
+	writeTone(CLIMBING_ALARM_FREQ);
+	bst_set(BEEP_HIGH);
       } else {
-	toneAC(0.0);
+	writeTone(0);
 	bst_unset(BEEP_HIGH);
       }
     }
@@ -307,10 +350,8 @@ void beeper::setTone() {
     /* sinking alarm */
     /*****************/
     else {
-      if( !bst_isset(BEEP_HIGH) || bst_isset(BEEP_NEW_FREQ) ) {
-	toneAC(SINKING_ALARM_FREQ, volume);
-	bst_set(BEEP_HIGH);
-      }
+      writeTone(SINKING_ALARM_FREQ);
+      bst_set(BEEP_HIGH);
     }
   } else {
     
@@ -318,17 +359,15 @@ void beeper::setTone() {
     /* sinking beep */
     /****************/
     if( beepType == BEEP_TYPE_SINKING ) {
-      if( !bst_isset(BEEP_HIGH) || bst_isset(BEEP_NEW_FREQ) ) {
-	toneAC(beepFreq, volume);
-	bst_set(BEEP_HIGH);
-      }
+      writeTone(beepFreq);
+      bst_set(BEEP_HIGH);
     }
 
     /**********/
     /* silent */
     /**********/
     else if( beepType == BEEP_TYPE_SILENT ) {
-      toneAC(0.0);
+      writeTone(0);
       bst_unset(BEEP_HIGH);
     }
 
@@ -336,20 +375,12 @@ void beeper::setTone() {
     /* gliding */
     /***********/
     else if(  beepType == BEEP_TYPE_GLIDING ) {
-      if( bst_isset(GLIDING_BEEP_ENABLED) ) {
-	if( beepPaternPosition < GLIDING_BEEP_HIGH_LENGTH ) {
-	  if( !bst_isset(BEEP_HIGH) ) {
-	    toneAC(beepFreq, volume);
-	    bst_set(BEEP_HIGH);
-	  } else if( bst_isset(BEEP_NEW_FREQ) ) {
-	    toneAC(beepFreq, volume);
-	  }
-	} else {
-	  toneAC(0.0);
-	  bst_unset(BEEP_HIGH);
-	}
+      if( bst_isset(GLIDING_BEEP_ENABLED) && beepPaternPosition < GLIDING_BEEP_HIGH_LENGTH_MS ) {
+	/* freq follows the velocity-step also in a running beep (writeTone skips unchanged values) */
+	writeTone(beepFreq);
+	bst_set(BEEP_HIGH);
       } else {
-	toneAC(0.0);
+	writeTone(0);
 	bst_unset(BEEP_HIGH);
       }
     }
@@ -358,15 +389,11 @@ void beeper::setTone() {
     /* climbing */
     /************/
     else {
-      if( beepPaternPosition < CLIMBING_BEEP_HIGH_LENGTH ) {
-	if( !bst_isset(BEEP_HIGH) ) {
-	  toneAC(beepFreq, volume);
-	  bst_set(BEEP_HIGH);
-	} else if( bst_isset(BEEP_NEW_FREQ) ) {
-	  toneAC(beepFreq, volume);
-	}
+      if( beepPaternPosition < CLIMBING_BEEP_HIGH_LENGTH_MS ) {
+	writeTone(beepFreq);
+	bst_set(BEEP_HIGH);
       } else {
-	toneAC(0.0);
+	writeTone(0);
 	bst_unset(BEEP_HIGH);
       }
     }
@@ -380,7 +407,17 @@ void beeper::setTone() {
 
 
 void beeper::update() {
-  setBeepPaternPosition(beepVelocity);
+  uint32_t tStart = micros();
+  setBeepPaternPosition(millis());
   setTone();
-  
+  tUpdate = micros() - tStart;
+  if( tUpdate > tUpdateMax ) tUpdateMax = tUpdate;
+}
+
+uint32_t beeper::getUpdateTime(uint32_t *maxTime) {
+  if( maxTime ) {
+    *maxTime = tUpdateMax;
+    tUpdateMax = 0;
+  }
+  return tUpdate;
 }
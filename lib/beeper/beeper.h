@@ -34,6 +34,19 @@
 /* avoid changing beep freq too often */
 #define BEEP_VELOCITY_SENSITIVITY 0.1
 
+/* all per-tick math runs in integer units : velocity in cm/s, patern in ms */
+#define BEEP_VELOCITY_SENSITIVITY_CMS ((int16_t)(BEEP_VELOCITY_SENSITIVITY * 100))
+
+/* tone and cadence tables, one entry per BEEP_VELOCITY_SENSITIVITY step */
+#define BEEP_TABLE_MIN_VELOCITY (-10.0)
+#define BEEP_TABLE_MAX_VELOCITY 10.0
+#define BEEP_TABLE_MIN_INDEX ((int16_t)(BEEP_TABLE_MIN_VELOCITY / BEEP_VELOCITY_SENSITIVITY))
+#define BEEP_TABLE_MAX_INDEX ((int16_t)(BEEP_TABLE_MAX_VELOCITY / BEEP_VELOCITY_SENSITIVITY))
+#define BEEP_TABLE_SIZE (BEEP_TABLE_MAX_INDEX - BEEP_TABLE_MIN_INDEX + 1)
+
+/* cadence is stored as fixed point with 10 fractional bits */
+#define BEEP_CADENCE_SHIFT 10
+
 
 /*********************/
 /* THE CLIMBING BEEP */
@@ -42,6 +55,8 @@
 #define CLIMBING_BEEP_HIGH_LENGTH 0.5
 #define CLIMBING_BEEP_LOW_LENGTH 0.5
 #define CLIMBING_BEEP_LENGTH (CLIMBING_BEEP_HIGH_LENGTH + CLIMBING_BEEP_LOW_LENGTH)
+#define CLIMBING_BEEP_HIGH_LENGTH_MS ((uint32_t)(CLIMBING_BEEP_HIGH_LENGTH * 1000))
+#define CLIMBING_BEEP_LENGTH_MS ((uint32_t)(CLIMBING_BEEP_LENGTH * 1000))
 
 /* climbing beep sound freq computation : BEEP_FREQ_COEFF * velocity + BEEP_BASE_FREQ */
 #define CLIMBING_BEEP_BASE_FREQ 386.0
@@ -64,6 +79,8 @@
 #define GLIDING_BEEP_HIGH_LENGTH 0.10
 #define GLIDING_BEEP_LOW_LENGTH 1.40
 #define GLIDING_BEEP_LENGTH (GLIDING_BEEP_HIGH_LENGTH + GLIDING_BEEP_LOW_LENGTH)
+#define GLIDING_BEEP_HIGH_LENGTH_MS ((uint32_t)(GLIDING_BEEP_HIGH_LENGTH * 1000))
+#define GLIDING_BEEP_LENGTH_MS ((uint32_t)(GLIDING_BEEP_LENGTH * 1000))
 
 /**********************/
 /* THE CLIMBING ALARM */
@@ -71,6 +88,8 @@
 #define CLIMBING_ALARM_HIGH_LENGTH 0.10
 #define CLIMBING_ALARM_LOW_LENGTH 0.30
 #define CLIMBING_ALARM_LENGTH (CLIMBING_ALARM_HIGH_LENGTH + CLIMBING_ALARM_LOW_LENGTH)
+#define CLIMBING_ALARM_HIGH_LENGTH_MS ((uint32_t)(CLIMBING_ALARM_HIGH_LENGTH * 1000))
+#define CLIMBING_ALARM_LENGTH_MS ((uint32_t)(CLIMBING_ALARM_LENGTH * 1000))
 
 #define  CLIMBING_ALARM_FREQ 1000.0
 
@@ -78,6 +97,7 @@
 /* THE SINKING ALARM */
 /*********************/
 #define SINKING_ALARM_LENGTH 0.7
+#define SINKING_ALARM_LENGTH_MS ((uint32_t)(SINKING_ALARM_LENGTH * 1000))
 
 #define SINKING_ALARM_FREQ 100.0 
 
@@ -132,21 +152,35 @@ class beeper {
   /* run as often as possible */
   void update();
 
+  /* cpu-time of update() in us (last and max since last call) */
+  uint32_t getUpdateTime(uint32_t *maxTime = NULL);
+
  private:
-  void setBeepParameters(double velocity);
-  void setBeepPaternPosition(double velocity);
+  void buildTables();
+  int16_t tableIndex(int16_t velocity);
+  void setBeepParameters(int16_t velocity);
+  void setBeepPaternPosition(uint32_t currentTime);
   void setTone();
-  double beepSinkingThreshold;
-  double beepGlidingThreshold;
-  double beepClimbingThreshold;
+  void writeTone(uint16_t freq);
+  int16_t beepSinkingThreshold; //cm/s
+  int16_t beepGlidingThreshold; //cm/s
+  int16_t beepClimbingThreshold; //cm/s
   uint8_t volume;
-  unsigned long beepStartTime;
-  double beepVelocity;
-  double beepFreq;
-  double beepPaternBasePosition;
-  double beepPaternPosition;
+  uint32_t beepStartTime;
+  int16_t beepVelocity; //cm/s
+  uint16_t beepFreq;
+  uint16_t beepCadence; //climbing patern speed, fixed point
+  uint32_t beepPaternBasePosition; //ms
+  uint32_t beepPaternPosition; //ms
   uint8_t beepState;
   uint8_t beepType;
+  uint16_t outFreq; //freq actually written to the buzzer
+  uint8_t outVolume; //volume actually written to the buzzer
+  uint16_t climbFreqTable[BEEP_TABLE_SIZE];
+  uint16_t sinkFreqTable[BEEP_TABLE_SIZE];
+  uint16_t cadenceTable[BEEP_TABLE_SIZE];
+  uint32_t tUpdate;
+  uint32_t tUpdateMax;
 };
 
 
@@ -5,6 +5,7 @@
  */
 
 #include "Screen.h"
+#include <Trace.h>
 
 GxEPD2_BW<GxEPD2_290, GxEPD2_290::HEIGHT> e_ink(GxEPD2_290(EINK_CS, EINK_DC, EINK_RST, EINK_BUSY));
 
@@ -246,26 +247,160 @@ void Screen::getTextPositions(int16_t *posx, int16_t *posy,int16_t x, int16_t y,
     //log_i("%s x=%d,y=%d,w=%d,h=%d,tbx=%d,tby=%d,tbw=%d,tbh=%d,posx=%d,posy=%d",sText.c_str(),x,y,width,height,tbx, tby, tbw, tbh,*posx,*posy);
 }
 
-void Screen::drawMainScreen(void){
-    uint32_t tAct = millis();
-    //static uint32_t tOldUpate = millis();
+//bounding boxes of the widgets, values are cleared and redrawn inside this box only
+const Screen::screenRect Screen::widgetRects[W_COUNT] = {
+    {0,0,128,16},   //status-bar
+    {0,65,96,34},   //altitude
+    {0,114,96,34},  //vario
+    {0,163,96,34},  //speed
+    {0,213,128,34}, //flight-time
+    {0,261,128,31}, //compass
+};
+
+void Screen::drawStatusBar(screenMainData *pData){
+    drawspeaker(49,0,16,16,pData->volume);
+    drawflying(67,0,16,16,pData->flying);
+    if (pData->wifi) e_ink.drawXBitmap(85, 4,WIFI_bits,  14, 8, GxEPD_BLACK);
+    if (pData->bluetooth == 1){
+        e_ink.drawXBitmap(101, 3,BT_bits,  8, 10, GxEPD_BLACK);
+    }else if (pData->bluetooth == 2){
+        e_ink.fillRect(101, 3, 8, 10, GxEPD_BLACK);
+        e_ink.drawXBitmap(101, 3,BT_bits,  8, 10, GxEPD_WHITE);
+    }  
+    drawBatt(111,4,17,8,pData->battPercent);
+    switch (setting.AircraftType)
+    {
+    case FanetLora::paraglider :
+        e_ink.drawXBitmap(0, 0, Paraglider16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
+        break;
+    case FanetLora::hangglider :
+        e_ink.drawXBitmap(0, 0, Hangglider16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
+        break;
+    case FanetLora::balloon :
+        e_ink.drawXBitmap(0, 0, Ballon16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
+        break;
+    case FanetLora::glider :
+        e_ink.drawXBitmap(0, 0, Sailplane16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
+        break;
+    case FanetLora::poweredAircraft :
+        e_ink.drawXBitmap(0, 0, Airplane16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
+        break;
+    case FanetLora::helicopter :
+        e_ink.drawXBitmap(0, 0, Helicopter16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
+        break;
+    case FanetLora::uav :
+        e_ink.drawXBitmap(0, 0, UAV16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
+        break;
+    
+    default:
+        e_ink.drawXBitmap(0, 0, UFO16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
+        break;
+    }
+    drawSatCount(18,0,26,16,pData->SatCount);
+}
+
+void Screen::drawWidget(uint8_t widget,screenMainData *pData){
+    const screenRect *r = &widgetRects[widget];
+    switch (widget)
+    {
+    case W_STATUSBAR:
+        drawStatusBar(pData);
+        break;
+    case W_ALT:
+        e_ink.setFont(&gnuvarioe23pt7b);
+        drawValue(r->x,r->y,r->w,r->h,pData->alt,0);
+        break;
+    case W_VARIO:
+        e_ink.setFont(&gnuvarioe23pt7b);
+        drawValue(r->x,r->y,r->w,r->h,pData->vario,1);
+        break;
+    case W_SPEED:
+        e_ink.setFont(&gnuvarioe23pt7b);
+        drawValue(r->x,r->y,r->w,r->h,pData->speed,0);
+        break;
+    case W_FLIGHTTIME:
+        drawFlightTime(r->x,r->y,r->w,r->h,pData->flightTime);
+        break;
+    case W_COMPASS:
+        e_ink.setFont(&gnuvarioe18pt7b);
+        drawCompass(r->x,r->y,r->w,r->h,pData->compass);
+        break;
+    default:
+        break;
+    }
+}
+
+void Screen::drawStaticContent(void){
     int16_t posx = 0;
     int16_t posy = 0;
+    e_ink.drawFastHLine(0,52,e_ink.width(),GxEPD_BLACK);
+    e_ink.drawFastHLine(0,101,e_ink.width(),GxEPD_BLACK);
+    e_ink.drawFastHLine(0,150,e_ink.width(),GxEPD_BLACK);
+    e_ink.drawFastHLine(0,198,e_ink.width(),GxEPD_BLACK);
+    e_ink.drawFastHLine(0,248,e_ink.width(),GxEPD_BLACK);
+    //e_ink.setFont(&FreeSansBold9pt7b);            
+    e_ink.setFont(&NotoSansBold6pt7b);
+    getTextPositions(&posx,&posy,0,35,128,10,setting.PilotName);        
+    e_ink.setCursor(posx,posy);
+    e_ink.print(setting.PilotName);
+    e_ink.setFont(&NotoSans6pt7b);
+    e_ink.setCursor(40,30);
+    e_ink.print(setting.myDevId);
+    e_ink.setCursor(5,62);
+    e_ink.print("Altitude");
+    e_ink.setCursor(98, 97);
+    e_ink.print('m');
+    e_ink.setCursor(5,111);
+    e_ink.print("Vario");
+    e_ink.drawBitmap(98, 120, msicons, 24, 24, GxEPD_BLACK);   //GxEPD_BLACK);
+    e_ink.setCursor(5,160);
+    e_ink.print("Speed");
+    e_ink.drawBitmap(98, 170, kmhicons, 24, 24, GxEPD_BLACK);   //GxEPD_BLACK);
+    e_ink.setCursor(5,208);
+    e_ink.print("Flight time");
+    e_ink.setCursor(5,258);
+    e_ink.print("Compass");
+}
+
+uint32_t Screen::refreshRegion(screenRect *pRect,uint8_t widgets,bool bStatic,screenMainData *pData){
+    //drawing outside the partial window is clipped by GxEPD2
+    trace.start(TRACE_EINK_PART,widgets);
+    e_ink.setPartialWindow(pRect->x,pRect->y,pRect->w,pRect->h);
+    e_ink.firstPage();
+    do
+    {
+        e_ink.fillScreen(GxEPD_WHITE);
+        if (bStatic) drawStaticContent();
+        for (uint8_t i = 0;i < W_COUNT;i++){
+            if (widgets & (1 << i)) drawWidget(i,pData);
+        }
+    }
+    while (e_ink.nextPage());
+    trace.stop(TRACE_EINK_PART);
+    return (uint32_t)((pRect->w + 7) / 8) * pRect->h; //bytes sent to controller
+}
+
+void Screen::drawMainScreen(void){
+    uint32_t tAct = millis();
     static screenMainData data;
     screenMainData actData;
     static bool bForceUpdate = false;
-    bool UpdateScreen = false;
+    uint8_t dirty = 0; //bit-mask of widgets to redraw
     static bool bFullUpdate = false;
     static uint32_t tCharging = millis();
 
-    //copy values
-    actData.alt = (status.GPS_Fix) ? status.GPS_alt : status.varioAlt;
-    actData.vario = status.ClimbRate;
-    actData.speed = status.GPS_speed;
-    //actData.compass = (status.GPS_speed <= 5.0) ? status.varioHeading : status.GPS_course ;
-    actData.compass = status.GPS_course ;
+    //copy values, gps and vario are written on the other core
+    gpsValues gps;
+    gpsHandoff.read(&gps);
+    varioValues vario;
+    varioHandoff.read(&vario);
+    actData.alt = (gps.fix) ? gps.alt : vario.alt;
+    actData.vario = (status.vario.bHasVario) ? vario.climb : status.ClimbRate;
+    actData.speed = gps.speed;
+    //actData.compass = (gps.speed <= 5.0) ? vario.heading : gps.course ;
+    actData.compass = gps.course ;
     actData.battPercent = (status.BattCharging) ? 255 : status.BattPerc / 25;
-    actData.SatCount = (status.GPS_Fix) ? status.GPS_NumSat : 0;
+    actData.SatCount = (gps.fix) ? gps.numSat : 0;
     if (actData.SatCount > 9) actData.SatCount = 9;
     //actData.SatCount = 9;
     actData.flightTime = status.flightTime;
@@ -294,164 +429,126 @@ void Screen::drawMainScreen(void){
         if ((abs(data.SatCount - actData.SatCount) >= 1) || (bForceUpdate)){
             data.SatCount = actData.SatCount;
             //log_i("update SatCount");
-            UpdateScreen = true;
+            dirty |= (1 << W_STATUSBAR);
         }
         if ((abs(data.battPercent - actData.battPercent) >= 1) || (bForceUpdate)){
             data.battPercent = actData.battPercent;
             //log_i("update Batt");
-            UpdateScreen = true;
+            dirty |= (1 << W_STATUSBAR);
         }else if (data.battPercent == 255){
             if (timeOver(tAct,tCharging,1000)){
                 tCharging = tAct;
                 //log_i("update Charging");
-                UpdateScreen = true;
+                dirty |= (1 << W_STATUSBAR);
             }
         }
         if ((abs(data.alt - actData.alt) >= 1.0) || (bForceUpdate)){
             data.alt = actData.alt;
-            UpdateScreen = true;
+            dirty |= (1 << W_ALT);
         }
         if ((abs(data.vario - actData.vario) >= 0.1) || (bForceUpdate)){
             data.vario = actData.vario;
             //log_i("update Vario");
-            UpdateScreen = true;
+            dirty |= (1 << W_VARIO);
         }
         if ((abs(data.speed - actData.speed) >= 1.0) || (bForceUpdate)){
             data.speed = actData.speed;
             //log_i("update Speed");
-            UpdateScreen = true;
+            dirty |= (1 << W_SPEED);
         }
         if ((abs((int32_t)data.flightTime - (int32_t)actData.flightTime) >= 60) || (bForceUpdate)){
             data.flightTime = (actData.flightTime / 60) * 60; //only fixed minutes
             //log_i("update flightTime");
-            UpdateScreen = true;
+            dirty |= (1 << W_FLIGHTTIME);
         }
         if ((abs(data.compass - actData.compass) >= 1.0) || (bForceUpdate)){
             data.compass = actData.compass;
             //log_i("update Compass");
-            UpdateScreen = true;
+            dirty |= (1 << W_COMPASS);
         }
         if ((data.volume != actData.volume) || (bForceUpdate)){
             data.volume = actData.volume;
             //log_i("update Volume");
-            UpdateScreen = true;
+            dirty |= (1 << W_STATUSBAR);
         }
         if ((data.flying != actData.flying) || (bForceUpdate)){
             data.flying = actData.flying;  
             //log_i("update status flying");          
-            UpdateScreen = true;
+            dirty |= (1 << W_STATUSBAR);
         }
         if ((data.wifi != actData.wifi) || (bForceUpdate)){
             data.wifi = actData.wifi;  
             //log_i("update wifi status");          
-            UpdateScreen = true;
+            dirty |= (1 << W_STATUSBAR);
         }
         if ((data.bluetooth != actData.bluetooth) || (bForceUpdate)){
             data.bluetooth = actData.bluetooth;  
             //log_i("update bluetooth status");          
-            UpdateScreen = true;
+            dirty |= (1 << W_STATUSBAR);
         }
-        if ((!bFullUpdate) && (!UpdateScreen)){
+        if ((!bFullUpdate) && (!dirty)){
             break;
         }
-        //log_i("fullUpdate=%d UpdateScreen=%d time=%d",bFullUpdate,UpdateScreen,millis()-tOldUpate);
-        //tOldUpate = millis();
         tAct = millis();
         e_ink.setTextColor(GxEPD_BLACK);
         e_ink.setRotation(0); 
         e_ink.setTextSize(1);       
         
         if (bFullUpdate){
+            trace.start(TRACE_EINK_FULL);
             e_ink.setFullWindow();
             e_ink.firstPage();
+            do
+            {
+                e_ink.fillScreen(GxEPD_WHITE);
+                drawStaticContent();
+                for (uint8_t i = 0;i < W_COUNT;i++) drawWidget(i,&data);
+            }
+            while (e_ink.nextPage());
+            trace.stop(TRACE_EINK_FULL);
+            log_d("e-ink full update bytes=%d %dms",(e_ink.width() / 8) * e_ink.height(),millis() - tAct);
         }else{
-            e_ink.setPartialWindow(0,0,e_ink.width(),e_ink.height());
-        }
-        e_ink.setFont(&NotoSansBold6pt7b);
-        getTextPositions(&posx,&posy,0,35,128,10,setting.PilotName);        
-        do
-        {
-            e_ink.fillScreen(GxEPD_WHITE);
-            drawspeaker(49,0,16,16,data.volume);
-            drawflying(67,0,16,16,data.flying);
-            if (data.wifi) e_ink.drawXBitmap(85, 4,WIFI_bits,  14, 8, GxEPD_BLACK);
-            if (data.bluetooth == 1){
-                e_ink.drawXBitmap(101, 3,BT_bits,  8, 10, GxEPD_BLACK);
-            }else if (data.bluetooth == 2){
-                e_ink.fillRect(101, 3, 8, 10, GxEPD_BLACK);
-                e_ink.drawXBitmap(101, 3,BT_bits,  8, 10, GxEPD_WHITE);
-            }  
-            drawBatt(111,4,17,8,data.battPercent);
-            switch (setting.AircraftType)
-           {
-           case FanetLora::paraglider :
-               e_ink.drawXBitmap(0, 0, Paraglider16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
-               break;
-           case FanetLora::hangglider :
-               e_ink.drawXBitmap(0, 0, Hangglider16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
-               break;
-           case FanetLora::balloon :
-               e_ink.drawXBitmap(0, 0, Ballon16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
-               break;
-           case FanetLora::glider :
-               e_ink.drawXBitmap(0, 0, Sailplane16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
-               break;
-           case FanetLora::poweredAircraft :
-               e_ink.drawXBitmap(0, 0, Airplane16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
-               break;
-           case FanetLora::helicopter :
-               e_ink.drawXBitmap(0, 0, Helicopter16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
-               break;
-           case FanetLora::uav :
-               e_ink.drawXBitmap(0, 0, UAV16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
-               break;
-           
-           default:
-               e_ink.drawXBitmap(0, 0, UFO16_bits, 16, 16, GxEPD_BLACK);   //GxEPD_BLACK);
-               break;
-           }
-            drawSatCount(18,0,26,16,data.SatCount);
-            e_ink.drawFastHLine(0,52,e_ink.width(),GxEPD_BLACK);
-            e_ink.setFont(&gnuvarioe23pt7b);
-            drawValue(0,65,96,34,data.alt,0);
-            e_ink.drawFastHLine(0,101,e_ink.width(),GxEPD_BLACK);
-            e_ink.setFont(&gnuvarioe23pt7b);
-            drawValue(0,114,96,34,data.vario,1);
-            e_ink.drawFastHLine(0,150,e_ink.width(),GxEPD_BLACK);
-            e_ink.setFont(&gnuvarioe23pt7b);
-            drawValue(0,163,96,34,data.speed,0);
-            e_ink.drawFastHLine(0,198,e_ink.width(),GxEPD_BLACK);
-            drawFlightTime(0,213,128,34,data.flightTime);
-            e_ink.drawFastHLine(0,248,e_ink.width(),GxEPD_BLACK);
-            e_ink.setFont(&gnuvarioe18pt7b);
-            drawCompass(0,261,128,31,data.compass);
-            //e_ink.setFont(&FreeSansBold9pt7b);            
-            e_ink.setFont(&NotoSansBold6pt7b);
-            e_ink.setCursor(posx,posy);
-            e_ink.print(setting.PilotName);
-            e_ink.setFont(&NotoSans6pt7b);
-            e_ink.setCursor(40,30);
-            e_ink.print(setting.myDevId);
-            e_ink.setCursor(5,62);
-            e_ink.print("Altitude");
-            e_ink.setCursor(98, 97);
-            e_ink.print('m');
-            e_ink.setCursor(5,111);
-            e_ink.print("Vario");
-            e_ink.drawBitmap(98, 120, msicons, 24, 24, GxEPD_BLACK);   //GxEPD_BLACK);
-            e_ink.setCursor(5,160);
-            e_ink.print("Speed");
-            e_ink.drawBitmap(98, 170, kmhicons, 24, 24, GxEPD_BLACK);   //GxEPD_BLACK);
-            e_ink.setCursor(5,208);
-            e_ink.print("Flight time");
-            e_ink.setCursor(5,258);
-            e_ink.print("Compass");
-
+            //build refresh-regions from dirty widgets, merge neighbours
+            screenRect regions[W_COUNT];
+            uint8_t regionWidgets[W_COUNT];
+            uint8_t regionCount = 0;
+            for (uint8_t i = 0;i < W_COUNT;i++){
+                if (!(dirty & (1 << i))) continue;
+                const screenRect *r = &widgetRects[i];
+                screenRect *last = (regionCount > 0) ? &regions[regionCount - 1] : NULL;
+                if ((last) && (r->y <= (last->y + last->h + SCREEN_MERGEGAP))){
+                    int16_t x2 = max(last->x + last->w,r->x + r->w);
+                    last->x = min(last->x,r->x);
+                    last->w = x2 - last->x;
+                    last->h = r->y + r->h - last->y;
+                    regionWidgets[regionCount - 1] |= (1 << i);
+                }else{
+                    regions[regionCount] = *r;
+                    regionWidgets[regionCount] = (1 << i);
+                    regionCount++;
+                }
+            }
+            if (regionCount > SCREEN_MAXREGIONS){
+                //every partial refresh costs a full panel-cycle --> one refresh for the bounding box
+                int16_t x2 = 0;
+                for (uint8_t i = 0;i < regionCount;i++){
+                    x2 = max(x2,(int16_t)(regions[i].x + regions[i].w));
+                    regions[0].x = min(regions[0].x,regions[i].x);
+                    regionWidgets[0] |= regionWidgets[i];
+                }
+                regions[0].w = x2 - regions[0].x;
+                regions[0].h = regions[regionCount - 1].y + regions[regionCount - 1].h - regions[0].y;
+                regionCount = 1;
+            }
+            uint32_t bytes = 0;
+            for (uint8_t i = 0;i < regionCount;i++){
+                //merged regions cover lines and labels between the widgets --> redraw them too
+                bool bStatic = ((regionWidgets[i] & (regionWidgets[i] - 1)) != 0);
+                bytes += refreshRegion(&regions[i],regionWidgets[i],bStatic,&data);
+            }
+            log_d("e-ink partial update regions=%d bytes=%d %dms",regionCount,bytes,millis() - tAct);
         }
-        while (e_ink.nextPage());
-        //log_i("update e-ink %dms",millis() - tAct);
         bFullUpdate = false;
-        UpdateScreen = false;
         break;
     default:
         break;
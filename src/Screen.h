@@ -28,6 +28,10 @@ extern struct statusData status;
 #include "main.h"
 #include <icons.h>
 #include <string.h>
+#include <Handoff.h>
+
+extern Handoff<varioValues> varioHandoff;
+extern Handoff<gpsValues> gpsHandoff;
 
 #define EINK_BUSY     33
 #define EINK_RST      4
@@ -37,6 +41,18 @@ extern struct statusData status;
 #define EINK_CLK      0
 #define EINK_DIN      2
 
+#define SCREEN_MAXREGIONS 3 //more dirty regions --> one refresh of the bounding box
+#define SCREEN_MERGEGAP 8 //merge regions with a gap less than this (pixel)
+
+//widgets of main-screen (sorted from top to bottom)
+#define W_STATUSBAR   0
+#define W_ALT         1
+#define W_VARIO       2
+#define W_SPEED       3
+#define W_FLIGHTTIME  4
+#define W_COMPASS     5
+#define W_COUNT       6
+
 class Screen {
 public:
   Screen(); //constructor
@@ -59,6 +75,13 @@ private:
   void drawflying(int16_t x, int16_t y, int16_t width, int16_t height,bool flying);
   String getWDir(float dir);
   uint8_t stepCount;
+  struct screenRect{
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+  };
+  static const screenRect widgetRects[W_COUNT];
   struct screenMainData{
     uint8_t battPercent;
     float alt;
@@ -72,6 +95,10 @@ private:
     bool wifi;
     uint8_t bluetooth;
   };
+  void drawStaticContent(void);
+  void drawStatusBar(screenMainData *pData);
+  void drawWidget(uint8_t widget,screenMainData *pData);
+  uint32_t refreshRegion(screenRect *pRect,uint8_t widgets,bool bStatic,screenMainData *pData);
 
 };
 
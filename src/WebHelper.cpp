@@ -59,7 +59,7 @@ void onWebSocketEvent(uint8_t client_num,
         log_i("page=%d",value);
         doc.clear();
         if (clientPages[client_num] == 1){ //info
-          doc["myDevId"] = setting.myDevId;
+          doc["myDevId"] = setting.myDevId.c_str();
           doc["compiledate"] = String(compile_date);
           doc["bHasVario"] = (uint8_t)status.vario.bHasVario;       
           doc["bHasMPU"] = (uint8_t)status.vario.bHasMPU;   
@@ -95,13 +95,17 @@ void onWebSocketEvent(uint8_t client_num,
             doc["gpsSpeed"] = String(status.GPS_speed,2);
           }
           #endif
-          doc["gpslat"] = String(status.GPS_Lat,6);
-          doc["gpslon"] = String(status.GPS_Lon,6);
-          doc["gpsAlt"] = String(status.GPS_alt,1);
+          gpsValues gps;
+          gpsHandoff.read(&gps); //lat/lon are doubles, written on the other core
+          doc["gpslat"] = String(gps.lat,6);
+          doc["gpslon"] = String(gps.lon,6);
+          doc["gpsAlt"] = String(gps.alt,1);
           doc["fanetTx"] = status.fanetTx;
           doc["fanetRx"] = status.fanetRx;
           doc["tLoop"] = status.tLoop;
           doc["tMaxLoop"] = status.tMaxLoop;
+          doc["uplBacklog"] = status.uplinkBacklog;
+          doc["uplRate"] = String(status.uplinkReplayRate,1);
           doc["freeHeap"] = xPortGetFreeHeapSize();
           doc["fHeapMin"] = xPortGetMinimumEverFreeHeapSize();
           serializeJson(doc, msg_buf);
@@ -135,10 +139,11 @@ void onWebSocketEvent(uint8_t client_num,
           doc["power"] = setting.LoraPower;
           doc["mode"] = setting.Mode;
           doc["type"] = (uint8_t)setting.AircraftType;
-          doc["PilotName"] = setting.PilotName;
+          doc["PilotName"] = setting.PilotName.c_str();
           doc["ognlive"] = setting.OGNLiveTracking;
+          doc["ognMinInt"] = setting.ognMinInterval;
           doc["traccar_live"] = setting.traccarLiveTracking;
-          doc["traccarsrv"]= setting.TraccarSrv;
+          doc["traccarsrv"]= setting.TraccarSrv.c_str();
           doc["fntMode"] = setting.fanetMode;
           doc["fntPin"] = setting.fanetpin;
           doc["legacytx"] = setting.LegacyTxEnable;
@@ -153,16 +158,16 @@ void onWebSocketEvent(uint8_t client_num,
           doc["oFanet"] = setting.outputFANET;
           doc["oLK8EX1"] = setting.outputLK8EX1;
           doc["awlive"] = setting.awLiveTracking;
-          doc["UDPServerIP"] = setting.UDPServerIP;
+          doc["UDPServerIP"] = setting.UDPServerIP.c_str();
           doc["UDPSendPort"] = setting.UDPSendPort;
           serializeJson(doc, msg_buf);
           webSocket.sendTXT(client_num, msg_buf);
 
           doc.clear();
-          doc["appw"] = setting.wifi.appw;
+          doc["appw"] = setting.wifi.appw.c_str();
           doc["wificonnect"] = (uint8_t)setting.wifi.connect;
-          doc["ssid"] = setting.wifi.ssid;
-          doc["password"] = setting.wifi.password;
+          doc["ssid"] = setting.wifi.ssid.c_str();
+          doc["password"] = setting.wifi.password.c_str();
           doc["wifioff"] = setting.wifi.tWifiStop;
           serializeJson(doc, msg_buf);
           webSocket.sendTXT(client_num, msg_buf);
@@ -206,25 +211,27 @@ void onWebSocketEvent(uint8_t client_num,
           doc["vBeepFly"] = setting.vario.BeepOnlyWhenFlying;
           doc["useMPU"] = (uint8_t)setting.vario.useMPU;
           doc["vTOffs"] = serialized(String(setting.vario.tempOffset,2));
+          doc["fltRec"] = setting.flightRecorder;
+          doc["cores"] = setting.corePlacement;
           serializeJson(doc, msg_buf);
           webSocket.sendTXT(client_num, msg_buf);
 
           doc.clear();
           doc["bHasBME"] = (uint8_t)status.vario.bHasBME;
           doc["WUUlEnable"] = setting.WUUpload.enable;
-          doc["WUUlID"] = setting.WUUpload.ID;
-          doc["WUUlKEY"] = setting.WUUpload.KEY;
+          doc["WUUlID"] = setting.WUUpload.ID.c_str();
+          doc["WUUlKEY"] = setting.WUUpload.KEY.c_str();
           doc["WIUlEnable"] = setting.WindyUpload.enable;
-          doc["WIUlID"] = setting.WindyUpload.ID;
-          doc["WIUlKEY"] = setting.WindyUpload.KEY;
+          doc["WIUlID"] = setting.WindyUpload.ID.c_str();
+          doc["WIUlKEY"] = setting.WindyUpload.KEY.c_str();
           serializeJson(doc, msg_buf);
           webSocket.sendTXT(client_num, msg_buf);
 
           doc.clear();
           doc["bHasGSM"] = (uint8_t)status.bHasGSM;
-          doc["GSMAPN"] = setting.gsm.apn;
-          doc["GSMUSER"] = setting.gsm.user;
-          doc["GSMPWD"] = setting.gsm.pwd;
+          doc["GSMAPN"] = setting.gsm.apn.c_str();
+          doc["GSMUSER"] = setting.gsm.user.c_str();
+          doc["GSMPWD"] = setting.gsm.pwd.c_str();
           serializeJson(doc, msg_buf);
           webSocket.sendTXT(client_num, msg_buf);
           
@@ -234,7 +241,7 @@ void onWebSocketEvent(uint8_t client_num,
           doc["band"] = setting.band;
           doc["power"] = setting.LoraPower;
           doc["type"] = (uint8_t)setting.AircraftType;
-          doc["PilotName"] = setting.PilotName;
+          doc["PilotName"] = setting.PilotName.c_str();
           serializeJson(doc, msg_buf);
           webSocket.sendTXT(client_num, msg_buf);
         }else if (clientPages[client_num] == 12){ //settings output
@@ -244,14 +251,14 @@ void onWebSocketEvent(uint8_t client_num,
           doc["oFanet"] = setting.outputFANET;
           doc["oLK8EX1"] = setting.outputLK8EX1;
           doc["awlive"] = setting.awLiveTracking;
-          doc["UDPServerIP"] = setting.UDPServerIP;
+          doc["UDPServerIP"] = setting.UDPServerIP.c_str();
           doc["UDPSendPort"] = setting.UDPSendPort;
           serializeJson(doc, msg_buf);
           webSocket.sendTXT(client_num, msg_buf);
         }else if (clientPages[client_num] == 13){ //settings wifi
-          doc["appw"] = setting.wifi.appw;
-          doc["ssid"] = setting.wifi.ssid;
-          doc["password"] = setting.wifi.password;
+          doc["appw"] = setting.wifi.appw.c_str();
+          doc["ssid"] = setting.wifi.ssid.c_str();
+          doc["password"] = setting.wifi.password.c_str();
           doc["wifioff"] = setting.wifi.tWifiStop;
           serializeJson(doc, msg_buf);
           webSocket.sendTXT(client_num, msg_buf);
@@ -335,6 +342,7 @@ void onWebSocketEvent(uint8_t client_num,
         if (root.containsKey("mode")) newSetting.Mode = doc["mode"].as<uint8_t>();
         
         if (root.containsKey("ognlive")) newSetting.OGNLiveTracking = doc["ognlive"].as<uint8_t>();
+        if (root.containsKey("ognMinInt")) newSetting.ognMinInterval = doc["ognMinInt"].as<uint8_t>();
         if (root.containsKey("traccar_live")) newSetting.traccarLiveTracking = doc["traccar_live"].as<uint8_t>();
         if (root.containsKey("traccarsrv")) newSetting.TraccarSrv = doc["traccarsrv"].as<String>();
         if (root.containsKey("legacytx")) newSetting.LegacyTxEnable = doc["legacytx"].as<uint8_t>();
@@ -352,6 +360,8 @@ void onWebSocketEvent(uint8_t client_num,
         if (root.containsKey("vBeepFly")) newSetting.vario.BeepOnlyWhenFlying = doc["vBeepFly"].as<uint8_t>();
         if (root.containsKey("useMPU")) newSetting.vario.useMPU = doc["useMPU"].as<uint8_t>();        
         if (root.containsKey("vTOffs")) newSetting.vario.tempOffset = doc["vTOffs"].as<float>();        
+        if (root.containsKey("fltRec")) newSetting.flightRecorder = doc["fltRec"].as<uint8_t>();
+        if (root.containsKey("cores")) newSetting.corePlacement = doc["cores"].as<uint8_t>();
         if (root.containsKey("axOffset")) newSetting.vario.accel[0] = doc["axOffset"].as<int16_t>();
         if (root.containsKey("ayOffset")) newSetting.vario.accel[1] = doc["ayOffset"].as<int16_t>();
         if (root.containsKey("azOffset")) newSetting.vario.accel[2] = doc["azOffset"].as<int16_t>();
@@ -378,7 +388,7 @@ void onWebSocketEvent(uint8_t client_num,
 
         setting = newSetting;
         log_i("write config-to file");
-        write_configFile(&newSetting);
+        update_configFile(&newSetting); //only if something changed
         if (value == 2){
           log_i("reboot");
           ESP.restart();
@@ -420,7 +430,7 @@ void onWebSocketEvent(uint8_t client_num,
           testWeatherData.Charge = doc["charge"].as<uint8_t>();
           sendTestData = value; //          
         }
-
+        dispatcher.post(EV_MSG);
       }      
       break;
 
@@ -457,25 +467,27 @@ String processor(const String& var){
     }
   }else if (var == "NEIGHBOURS"){
     sRet = "";
+    FanetLora::neighbour neighbour; //copy, table is written on the other core
     for (int i = 0; i < MAXNEIGHBOURS; i++){
-      if (fanet.neighbours[i].devId){
-        sRet += "<option value=\"" + fanet.getDevId(fanet.neighbours[i].devId) + "\">" + fanet.neighbours[i].name + " " + fanet.getDevId(fanet.neighbours[i].devId) + "</option>\r\n";
+      if (fanet.getNeighbour(i,&neighbour)){
+        sRet += "<option value=\"" + fanet.getDevId(neighbour.devId) + "\">" + neighbour.name + " " + fanet.getDevId(neighbour.devId) + "</option>\r\n";
       }
     }
     return sRet;
   }else if (var == "NEIGHBOURSLIST"){
     sRet = "";
+    FanetLora::neighbour neighbour; //copy, table is written on the other core
     for (int i = 0; i < MAXNEIGHBOURS; i++){
-      if (fanet.neighbours[i].devId){
-        sRet += "<tr><th><a href=\"https://www.google.com/maps/search/?api=1&query=" + String(fanet.neighbours[i].lat,6) + "," + String(fanet.neighbours[i].lon,6)+ "\"  target=\"_blank\">" + fanet.neighbours[i].name + " [" + fanet.getDevId(fanet.neighbours[i].devId) + "]</a></th>" + 
-        "<td>lat: " + String(fanet.neighbours[i].lat,6) + "</td>" + 
-        "<td>lon: " + String(fanet.neighbours[i].lon,6) + "</td>" + 
-        "<td>alt: " + String(fanet.neighbours[i].altitude,0) + "m</td>" +
-        "<td>speed: " + String(fanet.neighbours[i].speed,0) + "km/h</td>" +
-        "<td>climb: " + String(fanet.neighbours[i].climb,0) + "m/s</td>" +
-        "<td>heading: " + String(fanet.neighbours[i].heading,0) + "°</td>" +
-        "<td>rssi: " + String(fanet.neighbours[i].rssi) + "dB</td>" +
-        "<td>last seen: " + String((millis() - fanet.neighbours[i].tLastMsg) / 1000) + "seconds</td>" +
+      if (fanet.getNeighbour(i,&neighbour)){
+        sRet += "<tr><th><a href=\"https://www.google.com/maps/search/?api=1&query=" + String(neighbour.lat,6) + "," + String(neighbour.lon,6)+ "\"  target=\"_blank\">" + neighbour.name + " [" + fanet.getDevId(neighbour.devId) + "]</a></th>" + 
+        "<td>lat: " + String(neighbour.lat,6) + "</td>" + 
+        "<td>lon: " + String(neighbour.lon,6) + "</td>" + 
+        "<td>alt: " + String(neighbour.altitude,0) + "m</td>" +
+        "<td>speed: " + String(neighbour.speed,0) + "km/h</td>" +
+        "<td>climb: " + String(neighbour.climb,0) + "m/s</td>" +
+        "<td>heading: " + String(neighbour.heading,0) + "°</td>" +
+        "<td>rssi: " + String(neighbour.rssi) + "dB</td>" +
+        "<td>last seen: " + String((millis() - neighbour.tLastMsg) / 1000) + "seconds</td>" +
         "</th>" +
         "\r\n";
       }
@@ -652,6 +664,71 @@ void Web_setup(void){
     request->send(SPIFFS, request->url(), "text/html",false,processor);
   });
 
+  server.on("/diag.html", HTTP_GET, [](AsyncWebServerRequest *request){
+    request->send(SPIFFS, request->url(), "text/html",false,processor);
+  });
+  server.on("/diag.json", HTTP_GET, [](AsyncWebServerRequest *request){
+    DynamicJsonDocument doc(4096);
+    taskDiag.getJson(doc);
+    dispatcher.getJson(doc);
+    coreBench.getJson(doc);
+    doc["cores"] = setting.corePlacement;
+    boot.getJson(doc);
+    doc["boot"]["cfg"] = status.tConfigLoad;
+    doc["boot"]["warm"] = status.bWarmStart;
+    doc["boot"]["sleeps"] = status.warmSleeps;
+    String msg;
+    serializeJson(doc, msg);
+    request->send(200, "application/json", msg);
+  });
+  server.on("/bench", HTTP_GET, [](AsyncWebServerRequest *request){
+    if (request->hasParam("start")){
+      if (status.flying){
+        request->send(409, "text/plain", "not while flying");
+        return;
+      }
+      gpsValues gps;
+      gpsHandoff.read(&gps);
+      uint32_t duration = request->getParam("start")->value().toInt();
+      if (duration == 0) duration = 60;
+      coreBench.start(duration * 1000,60,gps.lat,gps.lon,gps.alt,&taskDiag);
+    }
+    request->send(200, "text/plain", (coreBench.isRunning()) ? "1" : "0");
+  });
+  server.on("/trace", HTTP_GET, [](AsyncWebServerRequest *request){
+    if (request->hasParam("enable")){
+      trace.setEnabled(request->getParam("enable")->value().toInt() != 0);
+    }
+    request->send(200, "text/plain", (trace.isEnabled()) ? "1" : "0");
+  });
+  server.on("/trace.json", HTTP_GET, [](AsyncWebServerRequest *request){
+    if (!trace.exportOpen()){
+      request->send(503, "text/plain", "trace not available");
+      return;
+    }
+    //json is generated event by event, while sending
+    AsyncWebServerResponse *response = request->beginChunkedResponse("application/json", [](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+      return trace.exportRead(buffer,maxLen);
+    });
+    response->addHeader("Content-Disposition","attachment; filename=trace.json");
+    request->send(response);
+  });
+
+  #ifdef AIRMODULE
+  server.on("/flight.igc", HTTP_GET, [](AsyncWebServerRequest *request){
+    if (!flightRecorder.igcOpen()){
+      request->send(404, "text/plain", "no flight recorded");
+      return;
+    }
+    //igc-file is generated line by line, while sending
+    AsyncWebServerResponse *response = request->beginChunkedResponse("application/octet-stream", [](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+      return flightRecorder.igcRead(buffer,maxLen);
+    });
+    response->addHeader("Content-Disposition","attachment; filename=flight.igc");
+    request->send(response);
+  });
+  #endif
+
   // On HTTP request for style sheet, provide style.css
   //server.on("/style.css", HTTP_GET, onCSSRequest);
 
@@ -767,15 +844,17 @@ void Web_loop(void){
       }    
     }
     #endif
-    if (mStatus.GPS_Lat != status.GPS_Lat){
+    gpsValues gps;
+    gpsHandoff.read(&gps); //lat/lon are doubles, written on the other core
+    if (mStatus.GPS_Lat != gps.lat){
       bSend = true;
-      mStatus.GPS_Lat = status.GPS_Lat;
-      doc["gpslat"] = String(status.GPS_Lat,6);
+      mStatus.GPS_Lat = gps.lat;
+      doc["gpslat"] = String(gps.lat,6);
     }    
-    if (mStatus.GPS_Lon != status.GPS_Lon){
+    if (mStatus.GPS_Lon != gps.lon){
       bSend = true;
-      mStatus.GPS_Lon = status.GPS_Lon;
-      doc["gpslon"] = String(status.GPS_Lon,6);
+      mStatus.GPS_Lon = gps.lon;
+      doc["gpslon"] = String(gps.lon,6);
     }    
     if (mStatus.GPS_alt != status.GPS_alt){
       bSend = true;
@@ -802,6 +881,16 @@ void Web_loop(void){
       mStatus.tMaxLoop = status.tMaxLoop;
       doc["tMaxLoop"] = status.tMaxLoop;
     }    
+    if (mStatus.uplinkBacklog != status.uplinkBacklog){
+      bSend = true;
+      mStatus.uplinkBacklog = status.uplinkBacklog;
+      doc["uplBacklog"] = status.uplinkBacklog;
+    }    
+    if (mStatus.uplinkReplayRate != status.uplinkReplayRate){
+      bSend = true;
+      mStatus.uplinkReplayRate = status.uplinkReplayRate;
+      doc["uplRate"] = String(status.uplinkReplayRate,1);
+    }    
     //doc["freeHeap"] = xPortGetFreeHeapSize();
     //doc["fHeapMin"] = xPortGetMinimumEverFreeHeapSize();
     if (bSend){
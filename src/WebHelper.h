@@ -9,6 +9,15 @@
 #include <string>
 #include <math.h>
 #include <Update.h>
+#include <TaskDiag.h>
+#include <Trace.h>
+#include <Dispatcher.h>
+#include <CoreBench.h>
+#include <Handoff.h>
+#include <BootSequence.h>
+#ifdef AIRMODULE
+#include <FlightRecorder.h>
+#endif
 
 //extern WebServer server;
 extern struct SettingsData setting;
@@ -24,6 +33,14 @@ extern const char compile_date[];
 
 extern TaskHandle_t xHandleStandard;
 extern bool WebUpdateRunning;
+extern TaskDiag taskDiag;
+extern Dispatcher dispatcher;
+extern CoreBench coreBench;
+extern Handoff<gpsValues> gpsHandoff;
+extern BootSequence boot;
+#ifdef AIRMODULE
+extern FlightRecorder flightRecorder;
+#endif
 
 void Web_setup(void);
 void Web_stop(void);
@@ -1,81 +1,126 @@
 #include "fileOps.h"
+#include <rom/crc.h>
 
 Preferences preferences;  
+static SemaphoreHandle_t xConfigMutex = NULL; //settings are saved from the web-server and from the standard-task
+static configRecord stored; //last record read or written --> base for update_configFile
+static configRecord scratch; //too big for the stacks of the callers, protected by xConfigMutex
+static const char *slotKeys[2] = {"CFG0","CFG1"};
 
-void load_configFile(SettingsData* pSetting){
-  log_i("LOAD CONFIG FILE");
+static uint32_t calcCrc(configRecord *pRecord){
+  return crc32_le(0,(const uint8_t *)&pRecord->data,pRecord->header.size);
+}
+
+static void setDefaults(SettingsData* pSetting){
+  memset(pSetting,0,sizeof(SettingsData));
+  pSetting->wifi.appw = "12345678";
+  pSetting->boardType = BOARD_T_BEAM;
+  pSetting->BattType = BATT_TYPE_1S_LIPO;
+  pSetting->band = BAND868;
+  pSetting->LoraPower = 10;
+  pSetting->outputLK8EX1 = 1;
+  pSetting->outputFLARM = 1;
+  pSetting->outputGPS = 1;
+  pSetting->outputFANET = 1;
+  pSetting->AircraftType = (FanetLora::aircraft_t)1;
+  pSetting->UDPServerIP = "192.168.4.2"; //UDP-IP-Adress to match connected device
+  pSetting->UDPSendPort = 10110;
+  pSetting->outputMode = OUTPUT_SERIAL;
+  pSetting->fanetpin = 1234;
+  pSetting->vario.sinkingThreshold = -2.5;
+  pSetting->vario.climbingThreshold = 0.2;
+  pSetting->vario.nearClimbingSensitivity = 0.2;
+  pSetting->vario.volume = 127; //full duty-cycle
+  pSetting->vario.BeepOnlyWhenFlying = 1;
+  pSetting->vario.tValues[0] = 20.0;
+  pSetting->corePlacement = CORES_SPLIT;
+}
+
+//old keys were Strings without limit --> a cut value has to be entered again
+template <uint8_t N> static void load_configString(const char *key,FixedString<N> &value){
+  String s = preferences.getString(key,value.c_str());
+  if (!value.assign(s.c_str())) log_w("setting %s cut to %d of %d chars",key,(int)value.length(),(int)s.length());
+}
+
+//single keys of older firmware, only needed for migration (pSetting holds the defaults)
+static void load_configKeys(SettingsData* pSetting){
   preferences.begin("settings", false);                         //Ordner settings anlegen/verwenden
-  pSetting->wifi.appw = preferences.getString("APPW","12345678");
-  pSetting->boardType = preferences.getUChar("BOARDTYPE",BOARD_T_BEAM); //
-  pSetting->BattType = preferences.getUChar("BATT_TYPE",BATT_TYPE_1S_LIPO); //
-  pSetting->band = preferences.getUChar("BAND",BAND868); //
-  pSetting->LoraPower = preferences.getUChar("LORA_POWER",10);//
-  pSetting->awLiveTracking = preferences.getUChar("AWLIVE",0); //
-  pSetting->bOutputSerial = preferences.getUChar("OSerial",0); //
-  pSetting->outputLK8EX1 = preferences.getUChar("OLK8EX1",1); //
-  pSetting->outputFLARM = preferences.getUChar("OFLARM",1); //
-  pSetting->outputGPS = preferences.getUChar("OGPS",1); //
-  pSetting->outputFANET = preferences.getUChar("OFANET",1); //
-  pSetting->PilotName = preferences.getString("PILOTNAME","");
-  pSetting->wifi.connect = preferences.getUChar("WIFI_CONNECT",0); //
-  pSetting->wifi.ssid = preferences.getString("WIFI_SSID","");
-  pSetting->wifi.password = preferences.getString("WIFI_PW","");
-  pSetting->wifi.tWifiStop = preferences.getUInt("Time_WIFI_Stop",0);
-  pSetting->AircraftType = (FanetLora::aircraft_t)preferences.getUChar("AIRCRAFTTYPE",1);
-  pSetting->UDPServerIP = preferences.getString("UDP_SERVER","192.168.4.2"); //UDP-IP-Adress to match connected device
-  pSetting->UDPSendPort = preferences.getUInt("UDP_PORT",10110); //Port of udp-server
-  pSetting->outputMode = preferences.getUChar("OutputMode",OUTPUT_SERIAL); //output-mode
-  pSetting->Mode = preferences.getUChar("Mode",0);
-  pSetting->fanetMode = preferences.getUChar("fntMode",0);  
-  pSetting->fanetpin = preferences.getUInt("fntPin",1234);
+  load_configString("APPW",pSetting->wifi.appw);
+  pSetting->boardType = preferences.getUChar("BOARDTYPE",pSetting->boardType); //
+  pSetting->BattType = preferences.getUChar("BATT_TYPE",pSetting->BattType); //
+  pSetting->band = preferences.getUChar("BAND",pSetting->band); //
+  pSetting->LoraPower = preferences.getUChar("LORA_POWER",pSetting->LoraPower);//
+  pSetting->awLiveTracking = preferences.getUChar("AWLIVE",pSetting->awLiveTracking); //
+  pSetting->bOutputSerial = preferences.getUChar("OSerial",pSetting->bOutputSerial); //
+  pSetting->outputLK8EX1 = preferences.getUChar("OLK8EX1",pSetting->outputLK8EX1); //
+  pSetting->outputFLARM = preferences.getUChar("OFLARM",pSetting->outputFLARM); //
+  pSetting->outputGPS = preferences.getUChar("OGPS",pSetting->outputGPS); //
+  pSetting->outputFANET = preferences.getUChar("OFANET",pSetting->outputFANET); //
+  load_configString("PILOTNAME",pSetting->PilotName);
+  pSetting->wifi.connect = preferences.getUChar("WIFI_CONNECT",pSetting->wifi.connect); //
+  load_configString("WIFI_SSID",pSetting->wifi.ssid);
+  load_configString("WIFI_PW",pSetting->wifi.password);
+  pSetting->wifi.tWifiStop = preferences.getUInt("Time_WIFI_Stop",pSetting->wifi.tWifiStop);
+  pSetting->AircraftType = (FanetLora::aircraft_t)preferences.getUChar("AIRCRAFTTYPE",uint8_t(pSetting->AircraftType));
+  load_configString("UDP_SERVER",pSetting->UDPServerIP); //UDP-IP-Adress to match connected device
+  pSetting->UDPSendPort = preferences.getUInt("UDP_PORT",pSetting->UDPSendPort); //Port of udp-server
+  pSetting->outputMode = preferences.getUChar("OutputMode",pSetting->outputMode); //output-mode
+  pSetting->Mode = preferences.getUChar("Mode",pSetting->Mode);
+  pSetting->fanetMode = preferences.getUChar("fntMode",pSetting->fanetMode);  
+  pSetting->fanetpin = preferences.getUInt("fntPin",pSetting->fanetpin);
   
   //gs settings
-  pSetting->gs.lat = preferences.getFloat("GSLAT",0.0);
-  pSetting->gs.lon = preferences.getFloat("GSLON",0.0);
-  pSetting->gs.alt = preferences.getFloat("GSALT",0.0);
-  pSetting->gs.SreenOption = preferences.getUChar("GSSCR",0);
-  pSetting->gs.PowerSave = preferences.getUChar("GSPS",0);
+  pSetting->gs.lat = preferences.getFloat("GSLAT",pSetting->gs.lat);
+  pSetting->gs.lon = preferences.getFloat("GSLON",pSetting->gs.lon);
+  pSetting->gs.alt = preferences.getFloat("GSALT",pSetting->gs.alt);
+  pSetting->gs.SreenOption = preferences.getUChar("GSSCR",pSetting->gs.SreenOption);
+  pSetting->gs.PowerSave = preferences.getUChar("GSPS",pSetting->gs.PowerSave);
 
   //live-tracking
-  pSetting->OGNLiveTracking = preferences.getUChar("OGN_LIVE",0);
-  pSetting->screenNumber = preferences.getUChar("SCREEN",0);
-  pSetting->displayType = preferences.getUChar("Display",0);
-  pSetting->LegacyTxEnable = preferences.getUChar("LEGACY_TX",0);
-  pSetting->traccarLiveTracking = preferences.getUChar("TRACCAR_LIVE",0);
-  pSetting->TraccarSrv = preferences.getString("TRACCAR_SRV","");
+  pSetting->OGNLiveTracking = preferences.getUChar("OGN_LIVE",pSetting->OGNLiveTracking);
+  pSetting->ognMinInterval = preferences.getUChar("OGN_MININT",pSetting->ognMinInterval);
+  pSetting->screenNumber = preferences.getUChar("SCREEN",pSetting->screenNumber);
+  pSetting->displayType = preferences.getUChar("Display",pSetting->displayType);
+  pSetting->LegacyTxEnable = preferences.getUChar("LEGACY_TX",pSetting->LegacyTxEnable);
+  pSetting->traccarLiveTracking = preferences.getUChar("TRACCAR_LIVE",pSetting->traccarLiveTracking);
+  load_configString("TRACCAR_SRV",pSetting->TraccarSrv);
   
   //weathersettings
-  pSetting->wd.sendFanet = preferences.getUChar("FanetWeather",0);
-  pSetting->wd.tempOffset = preferences.getFloat("wdTempOffset",0.0);
-  pSetting->wd.windDirOffset = preferences.getInt("wdWDirOffset",0);
+  pSetting->wd.sendFanet = preferences.getUChar("FanetWeather",pSetting->wd.sendFanet);
+  pSetting->wd.tempOffset = preferences.getFloat("wdTempOffset",pSetting->wd.tempOffset);
+  pSetting->wd.windDirOffset = preferences.getInt("wdWDirOffset",pSetting->wd.windDirOffset);
 
 
   //vario
-  pSetting->vario.sinkingThreshold = preferences.getFloat("vSinkTh",-2.5);
-  pSetting->vario.climbingThreshold = preferences.getFloat("vClimbTh",0.2);
-  pSetting->vario.nearClimbingSensitivity = preferences.getFloat("vNClimbSens",0.2);
-  pSetting->vario.volume = preferences.getUChar("VarioVolume",127); //full duty-cycle
-  pSetting->vario.BeepOnlyWhenFlying = preferences.getUChar("VBeepFlying",1);
-  pSetting->vario.useMPU = preferences.getUChar("useMPU",0);
-  pSetting->vario.tempOffset = preferences.getFloat("vTOffs",0.0);
+  pSetting->vario.sinkingThreshold = preferences.getFloat("vSinkTh",pSetting->vario.sinkingThreshold);
+  pSetting->vario.climbingThreshold = preferences.getFloat("vClimbTh",pSetting->vario.climbingThreshold);
+  pSetting->vario.nearClimbingSensitivity = preferences.getFloat("vNClimbSens",pSetting->vario.nearClimbingSensitivity);
+  pSetting->vario.volume = preferences.getUChar("VarioVolume",pSetting->vario.volume);
+  pSetting->vario.BeepOnlyWhenFlying = preferences.getUChar("VBeepFlying",pSetting->vario.BeepOnlyWhenFlying);
+  pSetting->vario.useMPU = preferences.getUChar("useMPU",pSetting->vario.useMPU);
+  pSetting->vario.tempOffset = preferences.getFloat("vTOffs",pSetting->vario.tempOffset);
+  pSetting->flightRecorder = preferences.getUChar("FLTREC",pSetting->flightRecorder);
+  pSetting->corePlacement = preferences.getUChar("CORES",pSetting->corePlacement);
 
   //wu-upload
-  pSetting->WUUpload.enable = preferences.getUChar("WUUlEnable",0);
-  pSetting->WUUpload.ID = preferences.getString("WUUlID","");
-  pSetting->WUUpload.KEY = preferences.getString("WUUlKEY","");
+  pSetting->WUUpload.enable = preferences.getUChar("WUUlEnable",pSetting->WUUpload.enable);
+  load_configString("WUUlID",pSetting->WUUpload.ID);
+  load_configString("WUUlKEY",pSetting->WUUpload.KEY);
 
   //windy-upload
-  pSetting->WindyUpload.enable = preferences.getUChar("WIUlEnable",0);
-  pSetting->WindyUpload.ID = preferences.getString("WIUlID","");
-  pSetting->WindyUpload.KEY = preferences.getString("WIUlKEY","");
+  pSetting->WindyUpload.enable = preferences.getUChar("WIUlEnable",pSetting->WindyUpload.enable);
+  load_configString("WIUlID",pSetting->WindyUpload.ID);
+  load_configString("WIUlKEY",pSetting->WindyUpload.KEY);
 
   //gsm
-  pSetting->gsm.apn = preferences.getString("GSMAPN","");
-  pSetting->gsm.user = preferences.getString("GSMUSER","");
-  pSetting->gsm.pwd = preferences.getString("GSMKEY","");
-
-  preferences.end(); 
+  load_configString("GSMAPN",pSetting->gsm.apn);
+  load_configString("GSMUSER",pSetting->gsm.user);
+  load_configString("GSMKEY",pSetting->gsm.pwd);
+  preferences.end();
+}
 
+//offsets are written by the calibration of the vario too
+static void load_calibration(SettingsData* pSetting){
   preferences.begin("fastvario", false);
   pSetting->vario.accel[0] = preferences.getInt("axOffset", 0);
   pSetting->vario.accel[1] = preferences.getInt("ayOffset", 0);
@@ -88,81 +133,10 @@ void load_configFile(SettingsData* pSetting){
   pSetting->vario.zValues[0] = preferences.getFloat("z[0]",0.0);
   pSetting->vario.zValues[1] = preferences.getFloat("z[1]",0.0);
   preferences.end();
-
 }
 
-void write_configFile(SettingsData* pSetting){
-  log_i("WRITE CONFIG FILE");
-  preferences.begin("settings", false);                         //Ordner settings anlegen/verwenden
-  preferences.putString("APPW",pSetting->wifi.appw);
-  preferences.putUChar("BOARDTYPE",pSetting->boardType); //
-  preferences.putUChar("BATT_TYPE",pSetting->BattType); //battery-type
-  preferences.putUChar("BAND",pSetting->band); //
-  preferences.putUChar("LORA_POWER",pSetting->LoraPower);//
-  preferences.putUChar("AWLIVE",pSetting->awLiveTracking); //
-  preferences.putUChar("OSerial",pSetting->bOutputSerial); //
-  preferences.putUChar("OLK8EX1",pSetting->outputLK8EX1); //
-  preferences.putUChar("OFLARM",pSetting->outputFLARM); //
-  preferences.putUChar("OGPS",pSetting->outputGPS); //
-  preferences.putUChar("OFANET",pSetting->outputFANET); //
-  preferences.putString("PILOTNAME",pSetting->PilotName);
-  preferences.putUChar("WIFI_CONNECT",pSetting->wifi.connect); //
-  preferences.putString("WIFI_SSID",pSetting->wifi.ssid);
-  preferences.putString("WIFI_PW",pSetting->wifi.password);
-  preferences.putUChar("AIRCRAFTTYPE",uint8_t(pSetting->AircraftType));
-  preferences.putUInt("Time_WIFI_Stop",pSetting->wifi.tWifiStop);    
-  preferences.putString("UDP_SERVER",pSetting->UDPServerIP); //UDP-IP-Adress for sending Pakets
-  preferences.putUInt("UDP_PORT",pSetting->UDPSendPort); //Port of udp-server
-  preferences.putUChar("OutputMode",pSetting->outputMode);
-  preferences.putUChar("Mode",pSetting->Mode);
-  preferences.putUChar("fntMode",pSetting->fanetMode);
-  preferences.putUInt("fntPin",pSetting->fanetpin);
-
-  //GS Settings
-  preferences.putFloat("GSLAT",pSetting->gs.lat);
-  preferences.putFloat("GSLON",pSetting->gs.lon);
-  preferences.putFloat("GSALT",pSetting->gs.alt);
-  preferences.putUChar("GSSCR",pSetting->gs.SreenOption);
-  preferences.putUChar("GSPS",pSetting->gs.PowerSave);
-
-  //live-tracking
-  preferences.putUChar("OGN_LIVE",pSetting->OGNLiveTracking);
-  preferences.putUChar("Display",pSetting->displayType);
-  preferences.putUChar("LEGACY_TX",pSetting->LegacyTxEnable);
-  preferences.putUChar("TRACCAR_LIVE",pSetting->traccarLiveTracking);
-  preferences.putString("TRACCAR_SRV",pSetting->TraccarSrv);
-  
-
-  //vario
-  preferences.putFloat("vSinkTh",pSetting->vario.sinkingThreshold);
-  preferences.putFloat("vClimbTh",pSetting->vario.climbingThreshold);
-  preferences.putFloat("vNClimbSens",pSetting->vario.nearClimbingSensitivity);
-  preferences.putUChar("VarioVolume",pSetting->vario.volume);
-  preferences.putUChar("VBeepFlying",pSetting->vario.BeepOnlyWhenFlying);
-  preferences.putUChar("useMPU",pSetting->vario.useMPU);
-  preferences.putFloat("vTOffs",pSetting->vario.tempOffset);
-
-  //weathersettings
-  preferences.putUChar("FanetWeather",pSetting->wd.sendFanet);
-  preferences.putFloat("wdTempOffset",pSetting->wd.tempOffset);
-  preferences.putInt("wdWDirOffset",pSetting->wd.windDirOffset);
-  
-  //wu-upload
-  preferences.putUChar("WUUlEnable",pSetting->WUUpload.enable);
-  preferences.putString("WUUlID",pSetting->WUUpload.ID);
-  preferences.putString("WUUlKEY",pSetting->WUUpload.KEY);
-
-  //windy-upload
-  preferences.putUChar("WIUlEnable",pSetting->WindyUpload.enable);
-  preferences.putString("WIUlID",pSetting->WindyUpload.ID);
-  preferences.putString("WIUlKEY",pSetting->WindyUpload.KEY);
-
-  //gsm
-  preferences.putString("GSMAPN",pSetting->gsm.apn);
-  preferences.putString("GSMUSER",pSetting->gsm.user);
-  preferences.putString("GSMKEY",pSetting->gsm.pwd);
-  preferences.end();
-
+//the vario reads its offsets from "fastvario" --> keep them there
+static void write_calibration(SettingsData* pSetting){
   preferences.begin("fastvario", false);
   if ((pSetting->vario.accel[0] != 0) || (pSetting->vario.accel[1] != 0) || (pSetting->vario.accel[2] != 0)){
     preferences.putInt("axOffset", pSetting->vario.accel[0]);
@@ -179,19 +153,110 @@ void write_configFile(SettingsData* pSetting){
   preferences.putFloat("z[0]",pSetting->vario.zValues[0]);
   preferences.putFloat("z[1]",pSetting->vario.zValues[1]);
   preferences.end();
+}
 
+static bool calibrationChanged(SettingsData* pNew,SettingsData* pOld){
+  return ((memcmp(pNew->vario.accel,pOld->vario.accel,sizeof(pNew->vario.accel)) != 0) ||
+          (memcmp(pNew->vario.gyro,pOld->vario.gyro,sizeof(pNew->vario.gyro)) != 0) ||
+          (memcmp(pNew->vario.tValues,pOld->vario.tValues,sizeof(pNew->vario.tValues)) != 0) ||
+          (memcmp(pNew->vario.zValues,pOld->vario.zValues,sizeof(pNew->vario.zValues)) != 0));
 }
 
-void write_screenNumber(void){
-  //log_i("WRITE CONFIG FILE");
+static bool readSlot(uint8_t slot,configRecord *pRecord){
+  memset(pRecord,0,sizeof(configRecord));
+  size_t len = preferences.getBytes(slotKeys[slot],pRecord,sizeof(configRecord));
+  if (len < sizeof(configHeader)) return false; //empty or written by a newer firmware with bigger settings
+  if ((pRecord->header.magic != CONFIG_MAGIC) || (pRecord->header.version != CONFIG_VERSION)) return false;
+  if (len != sizeof(configHeader) + pRecord->header.size) return false;
+  if (pRecord->header.crc != calcCrc(pRecord)) return false;
+  return true;
+}
+
+//xConfigMutex has to be taken
+static bool saveRecord(SettingsData* pSetting,uint32_t flags,bool bDiff){
+  memset(&scratch,0,sizeof(scratch));
+  memcpy(&scratch.data,pSetting,sizeof(SettingsData));
+  //runtime-values are not stored
+  scratch.data.myDevId = "";
+  scratch.data.bConfigGPS = false;
+  scratch.data.vario.bCalibGyro = false;
+  scratch.data.vario.bCalibAcc = false;
+  bool bCalibChanged = calibrationChanged(&scratch.data,&stored.data);
+  if ((bDiff) && (flags == stored.header.flags) && (memcmp(&scratch.data,&stored.data,sizeof(SettingsData)) == 0)) return false; //nothing changed
+  scratch.header.magic = CONFIG_MAGIC;
+  scratch.header.version = CONFIG_VERSION;
+  scratch.header.size = sizeof(SettingsData);
+  scratch.header.seq = stored.header.seq + 1;
+  scratch.header.flags = flags;
+  scratch.header.crc = calcCrc(&scratch);
+  uint32_t tStart = micros();
   preferences.begin("settings", false);
-  preferences.putUChar("SCREEN",setting.screenNumber);
+  size_t len = preferences.putBytes(slotKeys[scratch.header.seq & 1],&scratch,sizeof(scratch)); //the older slot is overwritten
   preferences.end();
+  if (len != sizeof(scratch)){
+    log_e("error writing settings slot %d",scratch.header.seq & 1);
+    return false;
+  }
+  if ((!bDiff) || (bCalibChanged)) write_calibration(&scratch.data);
+  memcpy(&stored,&scratch,sizeof(stored));
+  log_i("settings saved slot=%d seq=%d size=%d time=%dus",stored.header.seq & 1,stored.header.seq,(int)sizeof(stored),micros() - tStart);
+  return true;
 }
 
-void write_Volume(void){
-  //log_i("WRITE vario volume");
+void load_configFile(SettingsData* pSetting){
+  log_i("LOAD CONFIG FILE");
+  if (xConfigMutex == NULL) xConfigMutex = xSemaphoreCreateMutex(); //called from setup, before any task is running
+  xSemaphoreTake(xConfigMutex,portMAX_DELAY);
+  uint32_t tStart = micros();
+  setDefaults(pSetting);
   preferences.begin("settings", false);
-  preferences.putUChar("VarioVolume",setting.vario.volume);
+  bool bValid0 = readSlot(0,&stored);
+  bool bValid1 = readSlot(1,&scratch);
   preferences.end();
-}
\ No newline at end of file
+  if ((bValid1) && ((!bValid0) || ((int32_t)(scratch.header.seq - stored.header.seq) > 0))){
+    memcpy(&stored,&scratch,sizeof(stored));
+  }
+  if ((bValid0) || (bValid1)){
+    memcpy(pSetting,&stored.data,stored.header.size); //settings appended by a newer version keep their defaults
+    log_i("settings loaded slot=%d seq=%d time=%dus",stored.header.seq & 1,stored.header.seq,micros() - tStart);
+    if (stored.header.flags & CONFIG_FLAG_CALIB){
+      load_calibration(pSetting); //offsets were written by the calibration
+      saveRecord(pSetting,0,false);
+    }
+  }else{
+    log_i("no valid settings-record --> migrate keys");
+    memset(&stored,0,sizeof(stored));
+    load_configKeys(pSetting);
+    load_calibration(pSetting);
+    saveRecord(pSetting,0,false);
+  }
+  xSemaphoreGive(xConfigMutex);
+}
+
+void write_configFile(SettingsData* pSetting){
+  log_i("WRITE CONFIG FILE");
+  xSemaphoreTake(xConfigMutex,portMAX_DELAY);
+  saveRecord(pSetting,stored.header.flags,false);
+  xSemaphoreGive(xConfigMutex);
+}
+
+bool update_configFile(SettingsData* pSetting){
+  xSemaphoreTake(xConfigMutex,portMAX_DELAY);
+  bool bRet = saveRecord(pSetting,stored.header.flags,true);
+  xSemaphoreGive(xConfigMutex);
+  return bRet;
+}
+
+void write_screenNumber(void){
+  update_configFile(&setting);
+}
+
+void write_Volume(void){
+  update_configFile(&setting);
+}
+
+void mark_calibration(void){
+  xSemaphoreTake(xConfigMutex,portMAX_DELAY);
+  saveRecord(&setting,stored.header.flags | CONFIG_FLAG_CALIB,true);
+  xSemaphoreGive(xConfigMutex);
+}
@@ -5,10 +5,32 @@
 #include <Preferences.h>
 #include "main.h"
 
+#define CONFIG_MAGIC 0x46435847 //"GXCF"
+#define CONFIG_VERSION 1 //increase, if members of SettingsData are changed or moved (new settings are appended at the end)
+#define CONFIG_FLAG_CALIB 0x01 //vario-calibration was started --> offsets have to be reloaded from "fastvario"
+
+//settings are stored as one binary record, alternating in 2 slots
+//an interrupted save destroys only the older slot
+struct configHeader{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size; //size of data, when the record was written
+  uint32_t seq; //save-counter, the valid slot with the higher one is used
+  uint32_t flags;
+  uint32_t crc; //crc32 of data
+};
+
+struct configRecord{
+  configHeader header;
+  SettingsData data;
+};
+
 extern SettingsData setting;
 
 void load_configFile(SettingsData* pSetting);
-void write_configFile(SettingsData* pSetting);
+void write_configFile(SettingsData* pSetting); //writes always
+bool update_configFile(SettingsData* pSetting); //writes only, if settings are changed
 void write_screenNumber(void);
 void write_Volume(void);
-#endif
\ No newline at end of file
+void mark_calibration(void); //has to be called before the calibration of the vario
+#endif
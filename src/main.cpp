@@ -7,15 +7,31 @@
 //#include <LoRa.h>
 #include <FanetLora.h>
 #include <Flarm.h>
+#include <Proximity.h>
 #include <axp20x.h>
 #include <main.h>
 #include <config.h>
 #include "WebHelper.h"
 #include "fileOps.h"
+#include "warmStart.h"
 #include <SPIFFS.h>
 #include <ble.h>
 #include <icons.h>
 #include <Ogn.h>
+#include <Uplink.h>
+#include <HttpEndpoint.h>
+#include <UplinkStore.h>
+#include <ModemManager.h>
+#include <ModemClient.h>
+#include <TaskDiag.h>
+#include <CoreBench.h>
+#include <Trace.h>
+#include <Dispatcher.h>
+#include <Handoff.h>
+#include <BootSequence.h>
+#ifdef REPLAY
+#include <Replay.h>
+#endif
 #include "SparkFun_Ublox_Arduino_Library.h"
 #include <TimeLib.h>
 #include <sys/time.h>
@@ -49,6 +65,9 @@
   //TinyGsm modem(GsmSerial);
   TinyGsmClient GsmOGNClient(modem,0); //client number 0 for OGN
   TinyGsmClient GsmWUClient(modem,1); //client number 1 for weather-underground
+  ModemManager gsmModem; //taskGsm owns the modem, other tasks queue requests (live-data before uploads)
+  ModemClient GsmOGNSocket(&gsmModem,&GsmOGNClient,ModemManager::PRIO_HIGH);
+  ModemClient GsmWUSocket(&gsmModem,&GsmWUClient,ModemManager::PRIO_LOW);
 #endif
 
 #ifdef EINK
@@ -104,8 +123,10 @@ BluetoothSerial SerialBT;
 #include <Baro.h>
 #include <beeper.h>
 #include <toneAC.h>
+#include <FlightRecorder.h>
 
 #define USE_BEEPER
+//#define BEEPER_DEBUG //log cpu-time of Beeper.update()
 
 char nmeaBuffer[100];
 MicroNMEA nmea(nmeaBuffer, sizeof(nmeaBuffer));
@@ -115,6 +136,7 @@ beeper Beeper(BEEP_VELOCITY_DEFAULT_SINKING_THRESHOLD,BEEP_VELOCITY_DEFAULT_CLIM
 int freq = 2000;
 int channel = 0;
 int resolution = 8;
+FlightRecorder flightRecorder;
 
 
 #endif
@@ -135,8 +157,26 @@ const char compile_date[] = __DATE__ " " __TIME__;
 FanetLora fanet;
 //NmeaOut nmeaout;
 Flarm flarm;
+Proximity proximity; //relative position of neighbours, updated with every gps-fix and change of the neighbour-list
+TaskDiag taskDiag; //loop-times, cpu-load and stack of the tasks
+Dispatcher dispatcher; //calls the handlers of taskStandard on events and timers
+CoreBench coreBench; //synthetic fanet-load, measures load of the cores
+Handoff<varioValues> varioHandoff; //written by taskBaro
+Handoff<gpsValues> gpsHandoff; //written by taskStandard
+BootSequence boot; //subsystems start in parallel, timeline on /diag
+
+//core of the task-groups for every placement (setting.corePlacement)
+static const uint8_t taskCores[CORES_COUNT][3] = {
+  {ARDUINO_RUNNING_CORE1,ARDUINO_RUNNING_CORE1,ARDUINO_RUNNING_CORE1}, //CORES_SINGLE
+  {ARDUINO_RUNNING_CORE1,ARDUINO_RUNNING_CORE1,ARDUINO_RUNNING_CORE0}, //CORES_SPLIT
+  {ARDUINO_RUNNING_CORE1,ARDUINO_RUNNING_CORE0,ARDUINO_RUNNING_CORE0}, //CORES_RADIO
+};
 #ifdef AIRMODULE
 HardwareSerial NMeaSerial(2);
+bool bGpsEvents = false; //uart posts EV_GPSDATA, no polling
+#ifdef REPLAY
+Replay replay; //records gps-sentences or plays them back instead of the gps
+#endif
 #endif
 //MicroNMEA library structures
 
@@ -159,7 +199,6 @@ IPAddress local_IP(192,168,4,1);
 IPAddress gateway(192,168,4,1);
 IPAddress subnet(255,255,255,0);
 
-volatile bool ppsTriggered = false;
 
 AXP20X_Class axp;
 #define AXP_IRQ 35
@@ -171,6 +210,32 @@ volatile float BattCurrent = 0.0;
 #define AIRWHERE_UDP_PORT 5555
 String airwhere_web_ip = "37.128.187.9";
 
+#define AW_MAXLINE 120 //max. length of AW-udp-message
+#define AW_QUEUE_LEN 16
+#define TRACCAR_QUEUE_LEN 8
+#define UPLINK_STATINTERVALL 60000ul
+#define UPLINK_OGN 0
+#define UPLINK_AW 1
+#define UPLINK_TRACCAR 2
+#define UPLINK_DESTINATIONS 3
+UplinkQueue awQueue; //lines for AirWhere
+UplinkQueue traccarQueue; //tracking-data for traccar
+HttpEndpoint traccarHttp; //keep-alive connection to traccar-server
+#define TRACCAR_BATCH 4 //max. positions per uplink-loop
+typedef struct {
+  time_t tTime; //time, when data was received
+  FanetLora::trackingData data;
+} traccarItem;
+#define OGN_STORE_MAXAGE 1800 //offline-store: max. age of OGN-lines [s]
+#define AW_STORE_SLOTS 32
+#define AW_STORE_MAXAGE 1800
+#define TRACCAR_STORE_SLOTS 64
+#define TRACCAR_STORE_MAXAGE 86400
+#define UPLINK_REPLAYINTERVALL 500 //min. time between 2 replayed records [ms]
+UplinkStore ognStore("/ogn.bin",OGN_STORE_SLOTS,OGN_STORE_SLOTSIZE);
+UplinkStore awStore("/aw.bin",AW_STORE_SLOTS,sizeof(UplinkStore::slotHeader) + AW_MAXLINE);
+UplinkStore traccarStore("/traccar.bin",TRACCAR_STORE_SLOTS,sizeof(UplinkStore::slotHeader) + sizeof(traccarItem));
+
 
 
  unsigned long ble_low_heap_timer=0;
@@ -179,6 +244,10 @@ String airwhere_web_ip = "37.128.187.9";
 
 
 static RTC_NOINIT_ATTR uint8_t startOption;
+#ifdef GSMODULE
+static warmData warm; //state restored after deep-sleep or collected for the next one
+static bool bWarmSleep = false; //tasks collect their state for warm, powerOff saves it
+#endif
 uint32_t psRamSize = 0;
 
 
@@ -238,9 +307,11 @@ TaskHandle_t xHandleBluetooth = NULL;
 TaskHandle_t xHandleMemory = NULL;
 TaskHandle_t xHandleEInk = NULL;
 TaskHandle_t xHandleWeather = NULL;
+TaskHandle_t xHandleFlightRecorder = NULL;
+TaskHandle_t xHandleUplink[UPLINK_DESTINATIONS] = {NULL,NULL,NULL}; //one task per destination, a slow server delays only its own uplink
+TaskHandle_t xHandleSplash = NULL;
 #ifdef GSM_MODULE
 TaskHandle_t xHandleGsm = NULL;
-SemaphoreHandle_t xGsmMutex;
 #endif
 
 /********** function prototypes ******************/
@@ -248,29 +319,45 @@ SemaphoreHandle_t xGsmMutex;
 void taskWeather(void *pvParameters);
 void sendAWGroundStationdata(uint32_t tAct);
 void enterDeepsleep();
+void restoreWarmState();
+void saveWarmNames();
 int isDayTime();
 uint32_t calcSleepTime();
 #endif
 #ifdef AIRMODULE
 void readGPS();
 void taskBaro(void *pvParameters);
+void taskFlightRecorder(void *pvParameters);
+void recordFlight(uint32_t tAct);
 #endif
 #ifdef EINK
 void taskEInk(void *pvParameters);
 #endif
 #ifdef GSM_MODULE
 void taskGsm(void *pvParameters);
+typedef struct {
+  int year;
+  int month;
+  int day;
+  int hour;
+  int min;
+  int sec;
+  float timezone;
+} gsmTime;
+bool gsmGetTime(void *arg);
 #endif
 #ifdef OLED
 void startOLED();
+void taskSplash(void *pvParameters);
 void DrawRadarScreen(uint32_t tAct,uint8_t mode);
-void DrawRadarPilot(uint8_t neighborIndex);
+void DrawRadarPilot(Proximity::target *pTarget);
 void printGSData(uint32_t tAct);
 void printBattVoltage(uint32_t tAct);
 void printScanning(uint32_t tAct);
 void printWeather(uint32_t tAct);
 void printGPSData(uint32_t tAct);
 void DrawAngleLine(int16_t x,int16_t y,int16_t length,float deg);
+void oledFlush(uint32_t tFrame);
 void drawBatt(int16_t x, int16_t y,uint8_t value);
 void drawSignal(int16_t x, int16_t y,uint8_t strength);
 void drawflying(int16_t x, int16_t y, bool flying);
@@ -340,11 +427,13 @@ void drawWifiStat(int wifiStat)
 
 void setupAXP192();
 void taskStandard(void *pvParameters);
+void taskUplink(void *pvParameters); //pvParameters = destination (UPLINK_OGN, ...)
 void taskBackGround(void *pvParameters);
 void taskBluetooth(void *pvParameters);
 void taskMemory(void *pvParameters);
 void setupWifi();
 void IRAM_ATTR ppsHandler(void);
+void IRAM_ATTR loraHandler(void);
 void printSettings();
 void listSpiffsFiles();
 String setStringSize(String s,uint8_t sLen);
@@ -353,16 +442,24 @@ void sendData2Client(String data);
 eFlarmAircraftType Fanet2FlarmAircraft(FanetLora::aircraft_t aircraft);
 void Fanet2FlarmData(FanetLora::trackingData *FanetData,FlarmtrackingData *FlarmDataData);
 void sendLK8EX(uint32_t tAct);
+void updateProximity(void);
+void publishGps(void);
+BaseType_t getTaskCore(uint8_t group);
 void powerOff();
 esp_sleep_wakeup_cause_t print_wakeup_reason();
 void WiFiEvent(WiFiEvent_t event);
 //void listConnectedStations();
 float readBattvoltage();
 void sendAWTrackingdata(FanetLora::trackingData *FanetData);
+void logFanetRxStats(uint32_t tAct);
 void sendTraccarTrackingdata(FanetLora::trackingData *FanetData);
+bool sendTraccar(traccarItem *pItem);
 void sendAWUdp(String msg);
+bool sendAWLine(const char *line);
+void flushAWQueue(void);
+void logHttpStats(const char *name,HttpEndpoint::stats stat);
 void checkFlyingState(uint32_t tAct);
-void sendFlarmData(uint32_t tAct);
+void sendFlarmData(uint32_t tAct,bool bGpsCycle);
 void handleButton(uint32_t tAct);
 char* readSerial();
 void checkReceivedLine(char *ch_str);
@@ -488,10 +585,9 @@ void handleButton(uint32_t tAct){
 }
 
 
-void sendFlarmData(uint32_t tAct){
+void sendFlarmData(uint32_t tAct,bool bGpsCycle){
   static uint32_t tSend = millis();
   static uint32_t tSendStatus = millis();
-  FlarmtrackingData myFlarmData;
   FlarmtrackingData PilotFlarmData;
   FanetLora::trackingData tFanetData;  
   uint8_t countNeighbours = 0;
@@ -504,24 +600,26 @@ void sendFlarmData(uint32_t tAct){
     sendData2Client(flarm.writeSelfTestResult());
   }
 
-  if (timeOver(tAct,tSend,FLARM_UPDATE_RATE)){
+  //air-module sends with every gps-cycle
+  if ((bGpsCycle) || (timeOver(tAct,tSend,FLARM_UPDATE_RATE))){
     tSend = tAct;
     if (status.GPS_Fix){
-      Fanet2FlarmData(&fanet._myData,&myFlarmData);
-      for (int i = 0; i < MAXNEIGHBOURS; i++){
-        if (fanet.neighbours[i].devId){
-          tFanetData.aircraftType = fanet.neighbours[i].aircraftType;
-          tFanetData.altitude = fanet.neighbours[i].altitude;
-          tFanetData.climb = fanet.neighbours[i].climb;
-          tFanetData.devId = fanet.neighbours[i].devId;
-          tFanetData.heading = fanet.neighbours[i].heading;
-          tFanetData.lat = fanet.neighbours[i].lat;
-          tFanetData.lon = fanet.neighbours[i].lon;
-          tFanetData.speed = fanet.neighbours[i].speed;
-          Fanet2FlarmData(&tFanetData,&PilotFlarmData);
-          sendData2Client(flarm.writeFlarmData(&myFlarmData,&PilotFlarmData));    
-          countNeighbours++;    
-        }
+      //closest aircraft first
+      for (uint16_t n = 0; n < proximity.count(); n++){
+        Proximity::target *pTarget = proximity.get(n);
+        FanetLora::neighbour *pNeighbour = &fanet.neighbours[pTarget->index];
+        if (pNeighbour->devId != pTarget->devId) continue; //neighbour changed since last fix
+        tFanetData.aircraftType = pNeighbour->aircraftType;
+        tFanetData.altitude = pNeighbour->altitude;
+        tFanetData.climb = pNeighbour->climb;
+        tFanetData.devId = pNeighbour->devId;
+        tFanetData.heading = pNeighbour->heading;
+        tFanetData.lat = pNeighbour->lat;
+        tFanetData.lon = pNeighbour->lon;
+        tFanetData.speed = pNeighbour->speed;
+        Fanet2FlarmData(&tFanetData,&PilotFlarmData);
+        sendData2Client(flarm.writeFlarmData(pTarget->relNorth,pTarget->relEast,pTarget->relVert,&PilotFlarmData));    
+        countNeighbours++;    
       }
       flarm.GPSState = FLARM_GPS_FIX3d_AIR;
     }else{
@@ -532,6 +630,22 @@ void sendFlarmData(uint32_t tAct){
   }
 }
 
+void publishGps(void){
+  gpsValues gps = {status.GPS_Fix,status.GPS_NumSat,status.GPS_Lat,status.GPS_Lon,status.GPS_alt,status.GPS_speed,status.GPS_course};
+  gpsHandoff.write(gps); //lat/lon are doubles --> not atomic for tasks on the other core
+  if (status.GPS_Fix) boot.ready(BOOT_GPSFIX);
+}
+
+void updateProximity(void){
+  proximity.startUpdate(fanet._myData.lat,fanet._myData.lon,fanet._myData.altitude);
+  for (int i = 0; i < MAXNEIGHBOURS; i++){
+    if (fanet.neighbours[i].devId){
+      proximity.addTarget(i,fanet.neighbours[i].devId,fanet.neighbours[i].lat,fanet.neighbours[i].lon,fanet.neighbours[i].altitude);
+    }
+  }
+  proximity.finishUpdate();
+}
+
 void checkFlyingState(uint32_t tAct){
   static uint32_t tOk = millis();
   static uint32_t tFlightTime = millis();
@@ -808,10 +922,47 @@ void enterDeepsleep(){
   log_i("time to sleep = %d",tSleep);
   log_i("time to sleep = %02d:%02d:%02d",tSleep/60/60,(tSleep/60)%60,tSleep%60);
   esp_sleep_enable_timer_wakeup((uint64_t)tSleep * uS_TO_S_FACTOR); //set Timer for wakeup
+  time_t now;
+  time(&now);
+  warm.sleeps = (status.bWarmStart) ? status.warmSleeps + 1 : 1;
+  warm.tSleep = now;
+  warm.bTimeOk = status.bTimeOk;
+  warm.nameCount = 0;
+  warm.bOgnLoggedIn = false;
+  memset(warm.rainHours,0,sizeof(warm.rainHours));
+  bWarmSleep = true; //stopping tasks add their state
   log_i("not day --> Power off --> enter deep-sleep");
   powerOff();
 }
 
+void restoreWarmState(){
+  if (!read_warmState(&warm)) return;
+  status.bWarmStart = true;
+  status.warmSleeps = warm.sleeps;
+  status.bTimeOk = warm.bTimeOk; //system-time runs on in deep-sleep
+  time_t now;
+  time(&now);
+  if (warm.bTimeOk) setTime(now); //timelib starts at 0
+  FanetLora::knownName names[WARM_MAXNAMES];
+  for (int i = 0;i < warm.nameCount;i++){
+    names[i].devId = warm.names[i].devId;
+    names[i].name = warm.names[i].name;
+  }
+  fanet.setKnownNames(names,warm.nameCount);
+  //rain-history is shifted by the hours of sleeping
+  WeatherRing::shiftRainHours(warm.rainHours,WARM_RAINHOURS,(now - warm.tSleep) / 3600);
+  log_i("warm start %d: slept %ds, %d names, time ok=%d, ogn=%d",warm.sleeps,(uint32_t)(now - warm.tSleep),warm.nameCount,warm.bTimeOk,warm.bOgnLoggedIn);
+}
+
+void saveWarmNames(){
+  FanetLora::knownName names[WARM_MAXNAMES];
+  warm.nameCount = fanet.getKnownNames(names,WARM_MAXNAMES);
+  for (int i = 0;i < warm.nameCount;i++){
+    warm.names[i].devId = names[i].devId;
+    strcpy(warm.names[i].name,names[i].name.c_str());
+  }
+}
+
 void sendAWGroundStationdata(uint32_t tAct){
   static uint32_t tSend = millis() - 290000; //10sec. delay, to get wifi working
   if ((tAct - tSend) < 300000) return; //every 5min.
@@ -831,31 +982,33 @@ void sendAWGroundStationdata(uint32_t tAct){
 }
 #endif
 
+void logFanetRxStats(uint32_t tAct){
+  static uint32_t tLog = millis();
+  static uint32_t lostOld = 0;
+  if (!timeOver(tAct,tLog,60000)) return;
+  tLog = tAct;
+  rxQueueStats tracking,name,weather;
+  fanet.getRxStats(&tracking,&name,&weather);
+  uint32_t lost = tracking.overflow + name.overflow + weather.overflow;
+  if (lost == lostOld) return; //only log, if we lost frames
+  lostOld = lost;
+  log_e("rx-queue overflow tracking=%d/%d(max %d) name=%d/%d(max %d) weather=%d/%d(max %d)",tracking.overflow,tracking.pushed,tracking.maxFill,name.overflow,name.pushed,name.maxFill,weather.overflow,weather.pushed,weather.maxFill);
+}
+
 void sendTraccarTrackingdata(FanetLora::trackingData *FanetData){
 
-  if ((!setting.traccarLiveTracking) || (!setting.TraccarSrv.startsWith("http://")) || (WiFi.status() != WL_CONNECTED) || (!status.bTimeOk)) return;
-
-  //HTTPClient http;
-  //WiFiClient c;
-  //HttpClient http(c);
-  String server = setting.TraccarSrv.substring(strlen("http://"),setting.TraccarSrv.length());
-  int iPort = 80;
-  int posPortStart = server.indexOf(':');  
-  if (posPortStart > 0){
-    posPortStart++;
-    int posPortEnd = server.indexOf('/',posPortStart);
-    if (posPortEnd > 0){
-    }else{
-      posPortEnd = server.length();
-    }
-    String port = server.substring(posPortStart,posPortEnd);
-    iPort = server.substring(posPortStart,posPortEnd).toInt();
-    server = server.substring(0,posPortStart-1);
-    //log_i("port=%s, %d",port.c_str(),iPort);
-  }
-  //log_i("server=%s port=%d",server.c_str(),iPort);
-  time_t now;
-  time(&now);
+  if ((!setting.traccarLiveTracking) || (!setting.TraccarSrv.startsWith("http://")) || (!status.bTimeOk)) return;
+  traccarItem item;
+  time(&item.tTime);
+  item.data = *FanetData;
+  traccarQueue.push(&item); //sent from uplink-task
+}
+
+bool sendTraccar(traccarItem *pItem){
+  if (WiFi.status() != WL_CONNECTED) return false;
+  if (!traccarHttp.setUrl(setting.TraccarSrv)) return false; //url is only parsed, if changed
+  FanetLora::trackingData *FanetData = &pItem->data;
+  time_t now = pItem->tTime;
   char chs[120];
   String msg="/?id=FANET_";
   msg +=fanet.getDevId(FanetData->devId) + "&lat=";
@@ -873,22 +1026,16 @@ void sendTraccarTrackingdata(FanetLora::trackingData *FanetData){
   sprintf(chs,"%0.2f",FanetData->heading); //heading in degrees
   msg += String(chs);
   
-  //log_i("server=%s port=%d",server.c_str(),iPort);
   //log_i("%s",msg.c_str());
-
-  WiFiClient c;
-  HttpClient http(c, server,iPort);
-  int httpResponseCode = http.get(msg);
-  if (httpResponseCode == 0){
-    httpResponseCode = http.responseStatusCode();
-    if (httpResponseCode != 200){
-      log_e("resp=%d",httpResponseCode);
-    } 
-  }else{
+  int httpResponseCode = traccarHttp.get(msg.c_str());
+  if (httpResponseCode < 0){
     log_e("failed to connect=%d",httpResponseCode);
+    return false;
+  }else if (httpResponseCode != 200){
+    log_e("resp=%d",httpResponseCode);
+    return false;
   }
-  http.stop();
-  //log_i("ready");
+  return true;
 }
 
 void sendAWTrackingdata(FanetLora::trackingData *FanetData){
@@ -909,7 +1056,7 @@ void sendAWTrackingdata(FanetLora::trackingData *FanetData){
     }
   }
   #endif
-  msg += setting.myDevId + ","
+  msg += String(setting.myDevId) + ","
          + fanet.getDevId(FanetData->devId) + ","
          + String((uint8_t)FanetData->aircraftType) + ",";
   sprintf(chs,"%02.6f",FanetData->lat);
@@ -927,18 +1074,44 @@ void sendAWTrackingdata(FanetLora::trackingData *FanetData){
 }
 
 void sendAWUdp(String msg){
-  if (WiFi.status() == WL_CONNECTED){
-    //log_i("%s",msg.c_str());
-    WiFiUDP udp;
-    udp.beginPacket(airwhere_web_ip.c_str(),AIRWHERE_UDP_PORT);
-    udp.write((uint8_t *)msg.c_str(),msg.length());
-    udp.endPacket();
-  }else{
-    //log_e("can't send AW-Data WIFI not connected state=%d",WiFi.status());
-  }      
+  //log_i("%s",msg.c_str());
+  char line[AW_MAXLINE];
+  strncpy(line,msg.c_str(),AW_MAXLINE - 1);
+  line[AW_MAXLINE - 1] = 0;
+  awQueue.push(line); //sent from uplink-task, kept in offline-store if wifi is down
+}
+
+bool sendAWLine(const char *line){
+  static WiFiUDP udp;
+  bool bOk = udp.beginPacket(airwhere_web_ip.c_str(),AIRWHERE_UDP_PORT);
+  if (bOk){
+    udp.write((const uint8_t *)line,strlen(line));
+    bOk = udp.endPacket();
+  }
+  return bOk;
+}
+
+void flushAWQueue(void){
+  char line[AW_MAXLINE];
+  bool bOnline = (WiFi.status() == WL_CONNECTED);
+  while (awQueue.pop(line)){
+    bool bOk = false;
+    if (bOnline) bOk = sendAWLine(line);
+    if (!bOk) awStore.append(time(NULL),line,strlen(line) + 1);
+    awQueue.done(bOk);
+  }
+  if (!bOnline) return;
+  int16_t len = awStore.peek(time(NULL),line,sizeof(line));
+  if (len > 0){
+    line[len - 1] = 0;
+    if (sendAWLine(line)) awStore.pop();
+  }
 }
 
 void sendData2Client(String data){
+  #ifdef REPLAY
+  replay.output(data.c_str()); //latency to gps-sentence
+  #endif
   if (setting.outputMode == OUTPUT_UDP){
     //output via udp
     if ((WiFi.status() == WL_CONNECTED) || (WiFi.softAPgetStationNum() > 0)){ //connected to wifi or a client is connected to me
@@ -1000,6 +1173,7 @@ void writeTrackingData(uint32_t tAct){
 
 static void IRAM_ATTR AXP192_Interrupt_handler() {
   AXP192_Irq = true;
+  dispatcher.postFromISR(EV_AXP);
   log_v("AXP192 IRQ");
 }
 
@@ -1043,9 +1217,20 @@ void setupAXP192(){
 }
 
 void IRAM_ATTR ppsHandler(void){
-  ppsTriggered = true;
+  trace.mark(TRACE_PPS);
+  dispatcher.postFromISR(EV_PPS);
+}
+
+void IRAM_ATTR loraHandler(void){
+  dispatcher.postFromISR(EV_LORA); //packet is read by handleFanet
 }
 
+#ifdef AIRMODULE
+void gpsReceived(void){
+  dispatcher.post(EV_GPSDATA); //called from the uart-event-task
+}
+#endif
+
 void WiFiEvent(WiFiEvent_t event){
   switch(event){
     case SYSTEM_EVENT_STA_START:
@@ -1087,9 +1272,7 @@ void WiFiEvent(WiFiEvent_t event){
 
 
 void setupWifi(){
-  while(host_name.length() == 0){
-    delay(100); //wait until we have the devid
-  }
+  boot.start(BOOT_WIFI);
   status.wifiStat = 0;
   WiFi.mode(WIFI_OFF);
   //delay(500);
@@ -1134,6 +1317,7 @@ void setupWifi(){
   log_i("my APIP=%s",local_IP.toString().c_str());
   status.wifiStat = 1;
   Web_setup();
+  boot.ready(BOOT_WIFI);
 }
 
 #ifdef OLED
@@ -1183,6 +1367,25 @@ void startOLED(){
 
   }
 }
+
+//logo and devId, the radio starts meanwhile
+void taskSplash(void *pvParameters){
+  boot.start(BOOT_DISPLAY);
+  startOLED();
+  boot.waitReady(BOOT_RADIO,BOOT_WAITMAX); //devId is read from the radio
+  display.setTextColor(WHITE);
+  display.setTextSize(1);
+  display.setCursor(0,55);
+  display.print(setting.myDevId);
+  display.display();
+  delay(3000);
+  if (setting.gs.SreenOption == SCREEN_ALWAYS_OFF){
+    oledPowerOff();
+  }
+  boot.ready(BOOT_DISPLAY); //now handleDisplay may draw
+  log_i("stop task");
+  vTaskDelete(xHandleSplash);
+}
 #endif
 
 void printSettings(){
@@ -1232,6 +1435,7 @@ void printSettings(){
   
   log_i("Airwhere-Livetracking=%d",setting.awLiveTracking);
   log_i("OGN-Livetracking=%d",setting.OGNLiveTracking);
+  log_i("OGN-min-interval=%d",setting.ognMinInterval);
   log_i("Traccar-Livetracking=%d",setting.traccarLiveTracking);
   log_i("Traccar-Address=%s",setting.TraccarSrv.c_str());
   log_i("Legacy-TX=%d",setting.LegacyTxEnable);
@@ -1315,18 +1519,36 @@ void startBluetooth(void){
 }
 */
 
+BaseType_t getTaskCore(uint8_t group){
+  uint8_t placement = (setting.corePlacement < CORES_COUNT) ? setting.corePlacement : CORES_SPLIT;
+  return taskCores[placement][group];
+}
+
 void setup() {
   
   
   // put your setup code here, to run once:  
   //Serial.begin(57600);
   Serial.begin(115200);
+  boot.begin();
+  boot.add(BOOT_CONFIG,"config",0);
+  boot.add(BOOT_BOARD,"board",BOOT_BIT(BOOT_CONFIG));
+  boot.add(BOOT_DISPLAY,"display",BOOT_BIT(BOOT_BOARD));
+  boot.add(BOOT_RADIO,"radio",BOOT_BIT(BOOT_BOARD)); //lora is powered by the axp192
+  boot.add(BOOT_GPS,"gps",0);
+  boot.add(BOOT_GPSFIX,"gps-fix",0);
+  boot.add(BOOT_WIFI,"wifi",BOOT_BIT(BOOT_RADIO)); //host-name is built from the devId
+  boot.add(BOOT_BLUETOOTH,"bluetooth",BOOT_BIT(BOOT_RADIO) | BOOT_BIT(BOOT_WIFI)); //web-interface first, so that the settings can be changed
+  boot.add(BOOT_FANETTX,"fanet-tx",BOOT_BIT(BOOT_RADIO));
+  boot.add(BOOT_ONLINE,"online",0);
 
   status.bPowerOff = false;
   status.vario.bHasBME = false;
   status.bWUBroadCast = false;
   status.bInternetConnected = false;
   status.bTimeOk = false;
+  status.bWarmStart = false;
+  status.warmSleeps = 0;
   status.modemstatus = MODEM_DISCONNECTED;
   setting.bConfigGPS = false;
 
@@ -1354,6 +1576,7 @@ void setup() {
   }
   #endif
   printChipInfo();
+  trace.begin(psRamSize > 0); //recording is switched on over the web-interface
   log_i("compiled at %s",compile_date);
   log_i("current free heap: %d, minimum ever free heap: %d", xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize());
 
@@ -1365,6 +1588,7 @@ void setup() {
   }
   log_i("startOption=%d",startOption);
 
+  boot.start(BOOT_CONFIG);
     // Make sure we can read the file system
   if( !SPIFFS.begin(true)){
     log_e("Error mounting SPIFFS");
@@ -1373,7 +1597,10 @@ void setup() {
   log_i("SPIFFS total=%d used=%d free=%d",SPIFFS.totalBytes(),SPIFFS.usedBytes(),SPIFFS.totalBytes()-SPIFFS.usedBytes());
 
   //listSpiffsFiles();
+  uint32_t tConfig = micros();
   load_configFile(&setting); //load configuration
+  status.tConfigLoad = micros() - tConfig;
+  boot.ready(BOOT_CONFIG);
   #ifdef OLED && !EINK
   setting.displayType = OLED0_96;
   #elif EINK && !OLED
@@ -1438,11 +1665,16 @@ void setup() {
       }
     }
   }
+  if ((setting.Mode == MODE_GROUND_STATION) && (setting.gs.PowerSave == GS_POWER_SAFE) && (reason2 == ESP_SLEEP_WAKEUP_TIMER)){
+    restoreWarmState();
+  }
+  clear_warmState(); //snapshot is used only once
   #endif
   if ((setting.wifi.ssid.length() <= 0) || (setting.wifi.password.length() <= 0)){
     setting.wifi.connect = WIFI_CONNECT_NONE; //if no pw or ssid given --> don't connecto to wifi
   }
 
+  boot.start(BOOT_BOARD);
   pinMode(BUTTON2, INPUT_PULLUP);
 
   printSettings();
@@ -1628,45 +1860,54 @@ void setup() {
     pinMode(PinExtPowerOnOff, INPUT);
     log_i("ext power-state=%d",digitalRead(PinExtPowerOnOff));
   }
+  boot.ready(BOOT_BOARD);
 
   #ifdef OLED
   if (setting.displayType == OLED0_96){
-    startOLED();  
+    xTaskCreatePinnedToCore(taskSplash, "taskSplash", 3072, NULL, 4, &xHandleSplash, getTaskCore(TASKGROUP_IO)); //runs beside the start of the radio
+  }else{
+    boot.skip(BOOT_DISPLAY);
   }
+  #else
+  boot.skip(BOOT_DISPLAY);
   #endif
   setting.myDevId = "";
 #ifdef GSM_MODULE
-xGsmMutex = xSemaphoreCreateMutex();
+gsmModem.begin();
 #endif
 
   //log_i("currHeap:%d,minHeap:%d", xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize());
+  log_i("core-placement=%d radio=core%d sensor=core%d io=core%d",setting.corePlacement,getTaskCore(TASKGROUP_RADIO),getTaskCore(TASKGROUP_SENSOR),getTaskCore(TASKGROUP_IO));
 #ifdef AIRMODULE
   if (setting.Mode == MODE_AIR_MODULE){
-    xTaskCreatePinnedToCore(taskBaro, "taskBaro", 6500, NULL, 100, &xHandleBaro, ARDUINO_RUNNING_CORE1); //high priority task
+    xTaskCreatePinnedToCore(taskBaro, "taskBaro", 6500, NULL, 100, &xHandleBaro, getTaskCore(TASKGROUP_SENSOR)); //high priority task
+    if (setting.flightRecorder){
+      xTaskCreatePinnedToCore(taskFlightRecorder, "taskFlightRecorder", 4096, NULL, 6, &xHandleFlightRecorder, getTaskCore(TASKGROUP_IO)); //writes flight-data to flash
+    }
   }
 #endif  
   //log_i("currHeap:%d,minHeap:%d", xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize());
-  xTaskCreatePinnedToCore(taskStandard, "taskStandard", 6500, NULL, 10, &xHandleStandard, ARDUINO_RUNNING_CORE1); //standard task
+  xTaskCreatePinnedToCore(taskStandard, "taskStandard", 6500, NULL, 10, &xHandleStandard, getTaskCore(TASKGROUP_RADIO)); //standard task
   //log_i("currHeap:%d,minHeap:%d", xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize());
 #ifdef EINK
-  xTaskCreatePinnedToCore(taskEInk, "taskEInk", 6500, NULL, 8, &xHandleEInk, ARDUINO_RUNNING_CORE1); //background EInk
+  xTaskCreatePinnedToCore(taskEInk, "taskEInk", 6500, NULL, 8, &xHandleEInk, getTaskCore(TASKGROUP_IO)); //background EInk
 #endif  
   //log_i("currHeap:%d,minHeap:%d", xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize());
-  xTaskCreatePinnedToCore(taskBackGround, "taskBackGround", 6500, NULL, 5, &xHandleBackground, ARDUINO_RUNNING_CORE1); //background task
+  xTaskCreatePinnedToCore(taskBackGround, "taskBackGround", 6500, NULL, 5, &xHandleBackground, getTaskCore(TASKGROUP_IO)); //background task
   //log_i("currHeap:%d,minHeap:%d", xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize());
   //xTaskCreatePinnedToCore(taskMemory, "taskMemory", 4096, NULL, 1, &xHandleMemory, ARDUINO_RUNNING_CORE1);
   //log_i("currHeap:%d,minHeap:%d", xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize());
-  xTaskCreatePinnedToCore(taskBluetooth, "taskBluetooth", 4096, NULL, 7, &xHandleBluetooth, ARDUINO_RUNNING_CORE1);
+  xTaskCreatePinnedToCore(taskBluetooth, "taskBluetooth", 4096, NULL, 7, &xHandleBluetooth, getTaskCore(TASKGROUP_IO));
 
 #ifdef GSMODULE  
   if (setting.Mode == MODE_GROUND_STATION){
     //start weather-task
-    xTaskCreatePinnedToCore(taskWeather, "taskWeather", 4096, NULL, 8, &xHandleWeather, ARDUINO_RUNNING_CORE1);
+    xTaskCreatePinnedToCore(taskWeather, "taskWeather", 4096, NULL, 8, &xHandleWeather, getTaskCore(TASKGROUP_IO));
   }
 #endif  
 #ifdef GSM_MODULE
   //start Gsm-task
-  xTaskCreatePinnedToCore(taskGsm, "taskGsm", 4096, NULL, 6, &xHandleGsm, ARDUINO_RUNNING_CORE1);
+  xTaskCreatePinnedToCore(taskGsm, "taskGsm", 4096, NULL, 6, &xHandleGsm, getTaskCore(TASKGROUP_IO));
 #endif
 
 }
@@ -1674,6 +1915,13 @@ xGsmMutex = xSemaphoreCreateMutex();
 
 #ifdef GSM_MODULE
 
+//executed by taskGsm (ModemManager::call)
+bool gsmGetTime(void *arg){
+  gsmTime *t = (gsmTime *)arg;
+  modem.NTPServerSync("pool.ntp.org",0);
+  return modem.getNetworkTime(&t->year, &t->month, &t->day, &t->hour, &t->min, &t->sec,&t->timezone);
+}
+
 bool connectGPRS(){
   log_i("Connecting to internet");
   return modem.gprsConnect(setting.gsm.apn.c_str(), setting.gsm.user.c_str(), setting.gsm.pwd.c_str());
@@ -1738,40 +1986,54 @@ void taskGsm(void *pvParameters){
   #endif
   */
   GsmSerial.begin(115200,SERIAL_8N1,PinGsmRx,PinGsmTx,false); //baud, config, rx, tx, invert
-  const TickType_t xDelay = 5000 / portTICK_PERIOD_MS;   //only every 1sek.
-  TickType_t xLastWakeTime = xTaskGetTickCount (); //get actual tick-count
+  uint32_t tStats = millis();
+  uint32_t tCheck = millis() - 5000; //check modem at once
+  uint8_t diagId = taskDiag.add("gsm",&xHandleGsm,6000);
   //bool status;
   while(1){
-    xSemaphoreTake( xGsmMutex, portMAX_DELAY );
-    if (modem.isGprsConnected()){
-      status.modemstatus = MODEM_CONNECTED;
-      xLastWakeTime = xTaskGetTickCount (); //get actual tick-count
-      status.GSMSignalQuality = modem.getSignalQuality();
-      /*
-      modem.sendAT(GF("+CNSMOD?"));      
-      String res;
-      if (modem.waitResponse(GF("+CNSMOD:")) == 1){
-        modem.streamSkipUntil(',');  // Skip context id
-        String res = modem.stream.readStringUntil('\r');
-        log_i("network system mode %s",res.c_str());
+    taskDiag.loopStart(diagId);
+    if (timeOver(millis(),tStats,60000)){
+      tStats = millis();
+      const char *prioNames[ModemManager::PRIO_COUNT] = {"ogn","modem","upload"};
+      for (int i = 0;i < ModemManager::PRIO_COUNT;i++){
+        ModemManager::stats stat = gsmModem.getStats((ModemManager::prio_t)i);
+        if (stat.count == 0) continue;
+        log_i("modem-queue %s count=%d dropped=%d wait avg=%dms max=%dms busy=%dms",prioNames[i],stat.count,stat.dropped,stat.waitSum / stat.count,stat.waitMax,stat.busySum);
       }
-      */
-    }else{
-      status.modemstatus = MODEM_CONNECTING;
-      if (modem.isNetworkConnected()){  
-        connectGPRS();
+    }
+    if (timeOver(millis(),tCheck,5000)){
+      tCheck = millis();
+      if (modem.isGprsConnected()){
+        status.modemstatus = MODEM_CONNECTED;
+        gsmModem.setOnline(true);
+        status.GSMSignalQuality = modem.getSignalQuality();
+        /*
+        modem.sendAT(GF("+CNSMOD?"));      
+        String res;
+        if (modem.waitResponse(GF("+CNSMOD:")) == 1){
+          modem.streamSkipUntil(',');  // Skip context id
+          String res = modem.stream.readStringUntil('\r');
+          log_i("network system mode %s",res.c_str());
+        }
+        */
       }else{
-        initModem(); //init modem
+        status.modemstatus = MODEM_CONNECTING;
+        gsmModem.setOnline(false); //socket-requests fail instead of waiting for the reconnect
+        if (modem.isNetworkConnected()){  
+          connectGPRS();
+        }else{
+          initModem(); //init modem
+        }
+        tCheck = millis() - 5000; //check again at once
       }
     }
-    xSemaphoreGive( xGsmMutex );
+    gsmModem.run(100); //serve socket-requests of other tasks
+    taskDiag.loopEnd(diagId);
     if ((WebUpdateRunning) || (bGsmOff)) break;
-    //delay(1);
-    vTaskDelayUntil( &xLastWakeTime, xDelay); //wait until next cycle
   }
   //modem.stop(15000L);
   status.modemstatus = MODEM_DISCONNECTED;
-  xSemaphoreTake( xGsmMutex, portMAX_DELAY );
+  gsmModem.end(); //fail waiting requests
   
   log_i("stop gprs connection");
   modem.gprsDisconnect();
@@ -1797,7 +2059,6 @@ void taskGsm(void *pvParameters){
     modem.sendAT(GF("+CSCLK=2"));
     delay(1000);
   #endif
-  xSemaphoreGive( xGsmMutex );
   //GsmSerial.end();
   //if (PinGsmRst >= 0){
   //  digitalWrite(PinGsmRst,LOW);
@@ -1823,6 +2084,7 @@ void taskWeather(void *pvParameters){
   if (weather.begin(&i2cWeather,setting.gs.alt,PinOneWire,PinWindDir,PinWindSpeed,PinRainGauge)){
     status.vario.bHasBME = true; //we have a bme-sensor
   }
+  if (status.bWarmStart) weather.setRainHistory(warm.rainHours,WARM_RAINHOURS);
   if ((setting.WUUpload.enable) && (!status.vario.bHasBME)){
     status.bWUBroadCast = true;
     log_i("wu broadcast enabled");
@@ -1834,7 +2096,9 @@ void taskWeather(void *pvParameters){
   }
   const TickType_t xDelay = 1000 / portTICK_PERIOD_MS;   //only every 1sek.
   TickType_t xLastWakeTime = xTaskGetTickCount (); //get actual tick-count
+  uint8_t diagId = taskDiag.add("weather",&xHandleWeather,1500);
   while (1){
+    taskDiag.loopStart(diagId);
     uint32_t tAct = millis();
     if (tUploadData == 0){
       //first time sending if we have internet and time is ok
@@ -1845,7 +2109,7 @@ void taskWeather(void *pvParameters){
     if (status.vario.bHasBME){
       //station has BME --> we are a weather-station
       weather.run();
-      weather.getValues(&wData);
+      weather.getValues(&wData,WEATHER_UPDATE_RATE / 1000); //status is sent to fanet and ogn
       status.weather.temp = wData.temp;
       status.weather.Humidity = wData.Humidity;
       status.weather.Pressure = wData.Pressure;
@@ -1854,16 +2118,17 @@ void taskWeather(void *pvParameters){
       status.weather.WindGust = wData.WindGust;
       status.weather.rain1h = wData.rain1h;
       status.weather.rain1d = wData.rain1d;
+      status.weather.rain24h = wData.rain24h;
       if (timeOver(tAct,tUploadData,WEATHER_UNDERGROUND_UPDATE_RATE)){
         tUploadData = tAct;
         if ((status.bInternetConnected) && (status.bTimeOk)){
+          weather.getValues(&wData,WEATHER_UNDERGROUND_UPDATE_RATE / 1000); //averages over upload-interval
           if (setting.WUUpload.enable){
             WeatherUnderground::wData wuData;
-            WeatherUnderground wu;
+            static WeatherUnderground wu; //keeps connection between uploads
             #ifdef GSM_MODULE
               if (setting.wifi.connect == MODE_WIFI_DISABLED){
-                wu.setClient(&GsmWUClient);
-                wu.setMutex(&xGsmMutex);
+                wu.setClient(&GsmWUSocket);
               }
             #endif
             //log_i("temp=%f,humidity=%f",testWeatherData.temp,testWeatherData.Humidity);
@@ -1878,14 +2143,14 @@ void taskWeather(void *pvParameters){
             wuData.rain1h = wData.rain1h ;
             wuData.raindaily = wData.rain1d;
             wu.sendData(setting.WUUpload.ID,setting.WUUpload.KEY,&wuData);
+            logHttpStats("WU",wu.getUploadStats());
           }
           if (setting.WindyUpload.enable){
             Windy::wData wiData;
-            Windy wi;
+            static Windy wi; //keeps connection between uploads
             #ifdef GSM_MODULE
               if (setting.wifi.connect == MODE_WIFI_DISABLED){
-                wi.setClient(&GsmWUClient);
-                wi.setMutex(&xGsmMutex);
+                wi.setClient(&GsmWUSocket);
               }
             #endif
             //log_i("temp=%f,humidity=%f",testWeatherData.temp,testWeatherData.Humidity);
@@ -1900,10 +2165,10 @@ void taskWeather(void *pvParameters){
             wiData.rain1h = wData.rain1h ;
             wiData.raindaily = wData.rain1d;
             wi.sendData(setting.WindyUpload.ID,setting.WindyUpload.KEY,&wiData);
+            logHttpStats("Windy",wi.getUploadStats());
           }
 
         }
-        weather.resetWindGust();
       }
       
       if (setting.wd.sendFanet){
@@ -1925,6 +2190,7 @@ void taskWeather(void *pvParameters){
           testWeatherData.Charge = status.BattPerc;
           //testWeatherData.Charge = 44;
           sendWeatherData = true;
+          dispatcher.post(EV_MSG);
           tSendData = tAct;
         }
       }
@@ -1937,8 +2203,7 @@ void taskWeather(void *pvParameters){
         WeatherUnderground wu;
         #ifdef GSM_MODULE
           if (setting.wifi.connect == MODE_WIFI_DISABLED){
-            wu.setClient(&GsmWUClient);
-            wu.setMutex(&xGsmMutex);
+            wu.setClient(&GsmWUSocket);
           }
         #endif
         bDataOk = wu.getData(setting.WUUpload.ID,setting.WUUpload.KEY,&wuData);
@@ -1951,6 +2216,7 @@ void taskWeather(void *pvParameters){
           status.weather.WindGust = wuData.windgust;
           status.weather.rain1h = wuData.rain1h;
           status.weather.rain1d = wuData.raindaily;
+          status.weather.rain24h = NAN;
           testWeatherData.lat = wuData.lat;
           testWeatherData.lon = wuData.lon;
           testWeatherData.bWind = true;
@@ -1974,14 +2240,17 @@ void taskWeather(void *pvParameters){
         if (bDataOk){
           testWeatherData.Charge = status.BattPerc;
           sendWeatherData = true;
+          dispatcher.post(EV_MSG);
         }
       }
 
     }
     if ((WebUpdateRunning) || (bPowerOff)) break;
+    taskDiag.loopEnd(diagId);
     vTaskDelayUntil( &xLastWakeTime, xDelay); //wait until next cycle
     //delay(1);
   }
+  if ((bWarmSleep) && (status.vario.bHasBME)) weather.getRainHours(warm.rainHours,WARM_RAINHOURS);
   log_i("stop task");
   vTaskDelete(xHandleWeather); //delete weather-task
 }
@@ -1991,6 +2260,10 @@ void taskWeather(void *pvParameters){
 #ifdef AIRMODULE
 void taskBaro(void *pvParameters){
   uint8_t u8Volume = setting.vario.volume;
+  uint32_t tRecord = millis();
+  #ifdef BEEPER_DEBUG
+  uint32_t tBeeperLog = millis();
+  #endif
   log_i("starting baro-task ");  
   TickType_t xLastWakeTime;
   // Block for 500ms.
@@ -2025,12 +2298,16 @@ void taskBaro(void *pvParameters){
   }
   if (status.vario.bHasVario){
     xLastWakeTime = xTaskGetTickCount ();
+    uint8_t diagId = taskDiag.add("baro",&xHandleBaro,20);
     while (1){      
+      taskDiag.loopStart(diagId);
       if (setting.vario.bCalibGyro){
+        mark_calibration(); //calibration writes the offsets and restarts
         baro.calibGyro();
         setting.vario.bCalibGyro = false;
       }
       if (setting.vario.bCalibAcc){
+        mark_calibration();
         baro.calibAcc();
         setting.vario.bCalibAcc = false;
       }
@@ -2047,16 +2324,34 @@ void taskBaro(void *pvParameters){
         baro.getValues(&status.pressure,&status.varioAlt,&status.ClimbRate,&status.varioTemp);
         status.varioTemp = status.varioTemp + setting.vario.tempOffset;
         status.varioHeading = baro.getHeading();
+        varioValues vario = {status.pressure,status.varioAlt,status.ClimbRate,status.varioTemp,status.varioHeading};
+        varioHandoff.write(vario); //consistent set for tasks on the other core
         #ifdef USE_BEEPER
         Beeper.setVelocity(status.ClimbRate);
         #endif
+        if (timeOver(millis(),tRecord,1000)){
+          tRecord = millis();
+          flightRecorder.logBaro(status.pressure,status.varioAlt,status.ClimbRate,status.varioTemp);
+          if (setting.vario.useMPU){
+            flightRecorder.logImu(&status.vario.accel[0],&status.vario.gyro[0]);
+          }
+        }
       }
       #ifdef USE_BEEPER
         Beeper.update();
+        #ifdef BEEPER_DEBUG
+        if (timeOver(millis(),tBeeperLog,10000)){
+          tBeeperLog = millis();
+          uint32_t tMax = 0;
+          uint32_t tLast = Beeper.getUpdateTime(&tMax);
+          log_i("beeper update=%dus max=%dus",tLast,tMax);
+        }
+        #endif
       #endif      
       //delay(10);
       // Wait for the next cycle.
       //vTaskDelayUntil( &xLastWakeTime, xDelay );
+      taskDiag.loopEnd(diagId);
       delay(1);
       if ((WebUpdateRunning) || (bPowerOff)) break;
     }
@@ -2065,6 +2360,51 @@ void taskBaro(void *pvParameters){
   log_i("stop task");
   vTaskDelete(xHandleBaro); //delete baro-task
 }
+
+void recordFlight(uint32_t tAct){
+  static bool bOldFlying = false;
+  static uint32_t tNeighbours = millis();
+  if (status.flying != bOldFlying){
+    bOldFlying = status.flying;
+    if (status.flying){
+      flightRecorder.start();
+    }else{
+      flightRecorder.stop();
+    }
+  }
+  if (!flightRecorder.isRecording()) return;
+  if (timeOver(tAct,tNeighbours,300000)){ //snapshot every 5min, so the ring holds a 6h flight
+    tNeighbours = tAct;
+    for (int i = 0; i < MAXNEIGHBOURS; i++){
+      if (fanet.neighbours[i].devId){
+        flightRecorder.logNeighbour(fanet.neighbours[i].devId,fanet.neighbours[i].lat,fanet.neighbours[i].lon,fanet.neighbours[i].altitude,fanet.neighbours[i].aircraftType,fanet.neighbours[i].rssi);
+      }
+    }
+  }
+}
+
+void taskFlightRecorder(void *pvParameters){
+  static const char *aircraftTypes[] = {"other","paraglider","hangglider","balloon","glider","powered aircraft","helicopter","uav"};
+  log_i("starting flight-recorder-task ");
+  String glider = "";
+  if (setting.AircraftType <= FanetLora::uav) glider = aircraftTypes[setting.AircraftType];
+  //the other ring-files are created later by their tasks --> keep their space free
+  if ((setting.OGNLiveTracking) && (setting.Mode == MODE_GROUND_STATION)) flightRecorder.reserveSpace(ognStore.getFileName(),ognStore.getFileSize());
+  if (setting.awLiveTracking) flightRecorder.reserveSpace(awStore.getFileName(),awStore.getFileSize());
+  if (setting.traccarLiveTracking) flightRecorder.reserveSpace(traccarStore.getFileName(),traccarStore.getFileSize());
+  #ifdef REPLAY
+  flightRecorder.reserveSpace(REPLAY_FILE,REPLAY_MAXSIZE + REPLAY_MAXLINE);
+  #endif
+  if (flightRecorder.begin(setting.PilotName,glider)){
+    while (1){
+      flightRecorder.run(); //waits until there is something to write
+      if ((WebUpdateRunning) || (bPowerOff)) break;
+    }
+  }
+  flightRecorder.end(); //write last block
+  log_i("stop task");
+  vTaskDelete(xHandleFlightRecorder);
+}
 #endif
 
 void loop() {
@@ -2084,19 +2424,13 @@ void taskMemory(void *pvParameters) {
 void taskBluetooth(void *pvParameters) {
 
 	// BLEServer *pServer;
-  //Put a 10 second delay before Seral BT start to allow settings to work.
-  if ((setting.outputMode == OUTPUT_BLUETOOTH))
-    delay(10000);
-
   //esp_coex_preference_set(ESP_COEX_PREFER_BT);
-  while(host_name.length() == 0){
-    delay(100); //wait until we have the devid
-  }
   if ((setting.outputMode == OUTPUT_BLE) || (setting.outputMode == OUTPUT_BLUETOOTH)){
     if ((psRamSize > 0) || (startOption == 1)){
       //startBluetooth(); //start bluetooth
     }else{
       log_i("stop task");
+      boot.skip(BOOT_BLUETOOTH);
       vTaskDelete(xHandleBluetooth);
       return;    
     }
@@ -2106,9 +2440,12 @@ void taskBluetooth(void *pvParameters) {
     esp_bt_controller_mem_release(ESP_BT_MODE_BTDM);
     //log_i("currHeap:%d,minHeap:%d", xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize());
     log_i("stop task");
+    boot.skip(BOOT_BLUETOOTH);
     vTaskDelete(xHandleBluetooth);
     return;    
   }
+  //waits for the devId and the web-interface (was a fixed delay of 10s)
+  boot.start(BOOT_BLUETOOTH);
 
   if (setting.outputMode == OUTPUT_BLE){
     esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT);
@@ -2116,8 +2453,11 @@ void taskBluetooth(void *pvParameters) {
     //log_i("currHeap:%d,minHeap:%d", xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize());    
     start_ble(host_name+"-LE");
     status.bluetoothStat = 1;
+    boot.ready(BOOT_BLUETOOTH);
+    uint8_t diagId = taskDiag.add("ble",&xHandleBluetooth,200);
 	 while (1)
 	 {
+     taskDiag.loopStart(diagId);
 	   // only send if we have more than 31k free heap space.
 	   if (xPortGetFreeHeapSize()>BLE_LOW_HEAP)
 	   {
@@ -2125,7 +2465,9 @@ void taskBluetooth(void *pvParameters) {
 		   if (ble_data.length()>0)
            {
 			   ble_mutex=true;
+			   trace.start(TRACE_BLE_SEND,ble_data.length());
 			   BLESendChunks(ble_data);
+			   trace.stop(TRACE_BLE_SEND);
 			   ble_data="";
 			   ble_mutex=false;
            }
@@ -2138,6 +2480,7 @@ void taskBluetooth(void *pvParameters) {
 		   ble_data="";
 		   ble_mutex=false;
 	   }
+     taskDiag.loopEnd(diagId);
 	   vTaskDelay(100);
 	 }
   }else if (setting.outputMode == OUTPUT_BLUETOOTH){
@@ -2152,6 +2495,7 @@ void taskBluetooth(void *pvParameters) {
     log_i("currHeap:%d,minHeap:%d", xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize());
   #endif
     status.bluetoothStat = 1; //client disconnected
+    boot.ready(BOOT_BLUETOOTH);
     while (1)
     {
       delay(1);
@@ -2400,31 +2744,39 @@ void printScanning(uint32_t tAct){
 
   display.display();
 }
-void DrawRadarPilot(uint8_t neighborIndex){
-  float pilotDistance = 0.0;
-  int bearing = 0;
-  float rads;
-  int relNorth;
-  int relEast;
+void DrawRadarPilot(Proximity::target *pTarget){
+  //screen-position is only recalculated if pilot, his bearing or own heading changed
+  static struct {
+    uint32_t devId;
+    int16_t bearing;
+    int16_t myHeading;
+    int16_t relEast;
+    int16_t relNorth;
+  } cache = {0,0,0,0,0};
+  FanetLora::neighbour *pNeighbour = &fanet.neighbours[pTarget->index];
+  if (pNeighbour->devId != pTarget->devId) return; //neighbour changed since last update
+  //distance and bearing are calculated by proximity, when own position or neighbours change
+  int16_t bearing = (int16_t)roundf(pTarget->bearing);
+  int16_t myHeading = (int16_t)roundf(fanet._myData.heading);
+  if ((cache.devId != pTarget->devId) || (cache.bearing != bearing) || (cache.myHeading != myHeading)){
+    cache.devId = pTarget->devId;
+    cache.bearing = bearing;
+    cache.myHeading = myHeading;
+    cache.relEast = ((sinDeg(bearing - myHeading) * 16) / SINTAB_SCALE) + RADAR_SCREEN_CENTER_X - 8;
+    cache.relNorth = ((cosDeg(bearing - myHeading) * -16) / SINTAB_SCALE) + RADAR_SCREEN_CENTER_Y - 8;
+  }
+  int16_t relEast = cache.relEast;
+  int16_t relNorth = cache.relNorth;
 
-  
   //display.setCursor(95,0);
-  //display.printf("%4d", fanet.neighbours[neighborIndex].rssi);
+  //display.printf("%4d", pNeighbour->rssi);
   display.setCursor(68,16);
-  if (fanet.neighbours[neighborIndex].name.length() > 0){
-    display.print(fanet.neighbours[neighborIndex].name.substring(0,10)); //max. 10 signs
+  if (pNeighbour->name.length() > 0){
+    display.printf("%.10s",pNeighbour->name.c_str()); //max. 10 signs
   }else{
-    display.print(fanet.getDevId(fanet.neighbours[neighborIndex].devId));
-  }
-  pilotDistance = distance(fanet._myData.lat, fanet._myData.lon,fanet.neighbours[neighborIndex].lat,fanet.neighbours[neighborIndex].lon, 'K') * 1000 ;
-  bearing = CalcBearingA( fanet._myData.lat, fanet._myData.lon,fanet.neighbours[neighborIndex].lat,fanet.neighbours[neighborIndex].lon);
-  rads = deg2rad(bearing + (fanet._myData.heading * -1));
-  relEast=(int)((sin(rads) * 16) + RADAR_SCREEN_CENTER_X-8);
-  relNorth=(int)(((cos(rads) * 16) * -1) + RADAR_SCREEN_CENTER_Y-8);
-  //log_i("bearing=%i",bearing);
-  //log_i("relNorth=%i",relNorth);
-  //log_i("relEast=%i",relEast);
-  switch (fanet.neighbours[neighborIndex].aircraftType)
+    display.print(fanet.getDevId(pNeighbour->devId));
+  }
+  switch (pNeighbour->aircraftType)
   {
   case FanetLora::aircraft_t ::paraglider :
     display.drawXBitmap(relEast, relNorth, Paraglider16_bits,16, 16,WHITE);      
@@ -2452,44 +2804,53 @@ void DrawRadarPilot(uint8_t neighborIndex){
     display.drawXBitmap(relEast, relNorth, UFO16_bits,16, 16,WHITE);      
     break;
   }
-  if (pilotDistance > 1000){
-    pilotDistance /= 1000;
+  if (pTarget->distance > 1000){
     display.setCursor(68,28);
-    display.printf("%skm",setStringSize(String(pilotDistance,1),5).c_str());
+    display.printf("%5.1fkm",pTarget->distance / 1000);
   }else{
     display.setCursor(75,28);
-    display.printf("%sm",setStringSize(String(pilotDistance,0),5).c_str());
+    display.printf("%5.0fm",pTarget->distance);
   }
   display.setCursor(75,40); //display relative alt
-  display.printf("%sm",setStringSize(String(fanet.neighbours[neighborIndex].altitude - fanet._myData.altitude,0),5).c_str());
+  display.printf("%5.0fm",pTarget->relVert);
   display.setCursor(75,52); //display climbing
-  display.printf("%sms",setStringSize(String(fanet.neighbours[neighborIndex].climb,1),5).c_str());
+  display.printf("%5.1fms",pNeighbour->climb);
 
 }
 
 void DrawAngleLine(int16_t x,int16_t y,int16_t length,float deg){
-  int16_t xStart;
-  int16_t yStart;
-  int16_t xEnd;
-  int16_t yEnd;
-  float rads;
-  rads = deg2rad(deg);
-  xStart=(int)roundf(((sin(rads) * length/2) * 1) + x);
-  yStart=(int)roundf(((cos(rads) * length/2) * -1) + y);
-  xEnd=(int)roundf(((sin(rads) * length/2) * -1) + x);
-  yEnd=(int)roundf(((cos(rads) * length/2) * 1) + y);  
-  display.drawLine(xStart,yStart,xEnd,yEnd,WHITE);
-  //log_i("x=%i,y=%i,deg=%0.1f,X-Start=%i,Y-Start=%i,X-End=%i,Y-End=%i",x,y,deg,xStart,yStart,xEnd,yEnd);
+  int16_t iDeg = (int16_t)roundf(deg);
+  int16_t dx = (sinDeg(iDeg) * length / 2) / SINTAB_SCALE;
+  int16_t dy = (cosDeg(iDeg) * length / 2) / SINTAB_SCALE;
+  display.drawLine(x + dx,y - dy,x - dx,y + dy,WHITE);
+  //log_i("x=%i,y=%i,deg=%0.1f,dx=%i,dy=%i",x,y,deg,dx,dy);
+}
+
+void oledFlush(uint32_t tFrame){
+  static uint32_t tLog = millis();
+  static uint32_t frames = 0;
+  static uint32_t frameTime = 0;
+  static uint32_t frameBytes = 0;
+  frameBytes += display.displayChanged(); //only changed pages are sent
+  frameTime += micros() - tFrame;
+  frames++;
+  if (timeOver(millis(),tLog,10000)){
+    tLog = millis();
+    log_d("oled frames=%d avg %dus %dbytes",frames,frameTime / frames,frameBytes / frames);
+    frames = 0;
+    frameTime = 0;
+    frameBytes = 0;
+  }
 }
 
 void DrawRadarScreen(uint32_t tAct,uint8_t mode){
-  static uint8_t neighborIndex = 0;
-  int index;
+  static uint16_t listPos = 0;
+  uint32_t tFrame = micros();
+  Proximity::target *pTarget;
   int16_t xStart;
   int16_t yStart;
-  float rads;
+  int16_t heading = (int16_t)roundf(fanet._myData.heading * -1);
   
-  String s = "";
   display.clearDisplay();
   drawAircraftType(0,0,setting.AircraftType);
   drawSatCount(18,0,(status.GPS_NumSat > 9) ? 9 : status.GPS_NumSat);
@@ -2502,11 +2863,10 @@ void DrawRadarScreen(uint32_t tAct,uint8_t mode){
   display.setTextSize(1);
   display.drawCircle(RADAR_SCREEN_CENTER_X,RADAR_SCREEN_CENTER_Y,24,WHITE);
 
-  DrawAngleLine(RADAR_SCREEN_CENTER_X,RADAR_SCREEN_CENTER_Y,30,fanet._myData.heading * -1);
-  DrawAngleLine(RADAR_SCREEN_CENTER_X,RADAR_SCREEN_CENTER_Y,6,(fanet._myData.heading + 90) * -1);
-  rads = deg2rad(fanet._myData.heading * -1);
-  xStart=(int)(((sin(rads) * 19) * 1) + RADAR_SCREEN_CENTER_X);
-  yStart=(int)(((cos(rads) * 19) * -1) + RADAR_SCREEN_CENTER_Y);
+  DrawAngleLine(RADAR_SCREEN_CENTER_X,RADAR_SCREEN_CENTER_Y,30,heading);
+  DrawAngleLine(RADAR_SCREEN_CENTER_X,RADAR_SCREEN_CENTER_Y,6,heading - 90);
+  xStart = ((sinDeg(heading) * 19) / SINTAB_SCALE) + RADAR_SCREEN_CENTER_X;
+  yStart = ((cosDeg(heading) * -19) / SINTAB_SCALE) + RADAR_SCREEN_CENTER_Y;
   display.setCursor(xStart-2,yStart-3);
   display.print("N");
 
@@ -2523,11 +2883,9 @@ void DrawRadarScreen(uint32_t tAct,uint8_t mode){
       display.print("NO GPS-FIX");
       break;
     } 
-    index = fanet.getNearestNeighborIndex();
-    //log_i("index %i",index);
-    if (index < 0) break;
-    neighborIndex = index;
-    DrawRadarPilot(neighborIndex);
+    pTarget = proximity.get(0);
+    if (pTarget == NULL) break;
+    DrawRadarPilot(pTarget);
     break;
   case RADAR_LIST:
     display.print("LIST");
@@ -2536,10 +2894,12 @@ void DrawRadarScreen(uint32_t tAct,uint8_t mode){
       display.print("NO GPS-FIX");
       break;
     } 
-    index = fanet.getNextNeighbor(neighborIndex);
-    if (index < 0) break;
-    neighborIndex = index;
-    DrawRadarPilot(neighborIndex);
+    //list sorted by distance
+    if (proximity.count() == 0) break;
+    listPos++;
+    if (listPos >= proximity.count()) listPos = 0;
+    pTarget = proximity.get(listPos);
+    DrawRadarPilot(pTarget);
     break;
   case RADAR_FRIENDS:
     display.print("FRIENDS");
@@ -2552,7 +2912,7 @@ void DrawRadarScreen(uint32_t tAct,uint8_t mode){
   default:
     break;
   }
-  display.display();
+  oledFlush(tFrame);
 }
 
 void drawSatCount(int16_t x, int16_t y,uint8_t value){
@@ -2600,7 +2960,7 @@ void drawspeaker(int16_t x, int16_t y){
 
 
 void printGPSData(uint32_t tAct){
-  String s = "";
+  uint32_t tFrame = micros();
   display.clearDisplay();
   display.setTextSize(2);
   display.setCursor(0,0);
@@ -2627,7 +2987,7 @@ void printGPSData(uint32_t tAct){
   display.setCursor(65,46);
   display.print(setStringSize(String(status.GPS_speed,0) + "kh",5));
 
-  display.display();
+  oledFlush(tFrame);
 
 }
 #endif
@@ -2752,19 +3112,33 @@ char* readSerial(){
 void readGPS(){
   static char lineBuffer[255];
   static uint16_t recBufferIndex = 0;
+  static bool bFirstSentence = true;
+  Stream *pGps = &NMeaSerial;
+  #ifdef REPLAY
+  if (replay.isPlaying()) pGps = &replay;
+  #endif
   
-  while(NMeaSerial.available()){
+  while(pGps->available()){
     
     if (recBufferIndex >= 255) recBufferIndex = 0; //Buffer overrun
-    lineBuffer[recBufferIndex] = NMeaSerial.read();
+    lineBuffer[recBufferIndex] = pGps->read();
     //log_i("GPS %c",lineBuffer[recBufferIndex]);
-    nmea.process(lineBuffer[recBufferIndex]);
+    if (nmea.process(lineBuffer[recBufferIndex])){
+      if (bFirstSentence){
+        boot.ready(BOOT_GPS); //first valid sentence
+        bFirstSentence = false;
+      }
+      if (strcmp(nmea.getMessageID(),"GGA") == 0) dispatcher.post(EV_GPSFIX); //last sentence of gps-cycle
+    }
     if (lineBuffer[recBufferIndex] == '\n'){
       lineBuffer[recBufferIndex] = '\r';
       recBufferIndex++;
       lineBuffer[recBufferIndex] = '\n';
       recBufferIndex++;
       lineBuffer[recBufferIndex] = 0; //zero-termination
+      #ifdef REPLAY
+      replay.record(lineBuffer);
+      #endif
       String s = lineBuffer;
       if (setting.outputGPS) sendData2Client(s);
       recBufferIndex = 0;
@@ -2818,14 +3192,16 @@ void sendLK8EX(uint32_t tAct){
     String s = "$LK8EX1,";
 
     if (status.vario.bHasVario){
-      s += String(status.pressure,2) + ","; //raw pressure in hPascal: hPA*100 (example for 1013.25 becomes  101325) 
+      varioValues vario;
+      varioHandoff.read(&vario); //pressure, altitude and climb of the same sample
+      s += String(vario.pressure,2) + ","; //raw pressure in hPascal: hPA*100 (example for 1013.25 becomes  101325) 
       if (status.GPS_Fix){
         s += String(status.GPS_alt,2) + ","; // altitude in meters, relative to QNH 1013.25
       }else{
-        s += String(status.varioAlt,2) + ","; // altitude in meters, relative to QNH 1013.25
+        s += String(vario.alt,2) + ","; // altitude in meters, relative to QNH 1013.25
       }
-      s += String((int32_t)(status.ClimbRate * 100.0)) + ","; //climbrate in cm/s
-      s += String(status.varioTemp,1) + ","; //temperature
+      s += String((int32_t)(vario.climb * 100.0)) + ","; //climbrate in cm/s
+      s += String(vario.temp,1) + ","; //temperature
     }else{
       s += "999999,"; //raw pressure in hPascal: hPA*100 (example for 1013.25 becomes  101325) 
       s += String(status.GPS_alt,2) + ","; // altitude in meters, relative to QNH 1013.25
@@ -2899,22 +3275,360 @@ bool setupUbloxConfig(){
 #endif
 
 
-void taskStandard(void *pvParameters){
-  static uint32_t tLoop = millis();
-  static float oldAlt = 0.0;
-  static uint32_t tOldPPS = millis();
-  static uint32_t tLastPPS = millis();
-  static uint32_t tDisplay = millis();
+//state shared between the handlers of taskStandard
+static uint32_t tDisplay = 0;
+static uint8_t oldScreenNumber = 0;
+static uint32_t tLastPPS = 0;
+static FanetLora::trackingData tFanetData;
+
+void handleHousekeeping(uint32_t tAct,uint32_t events){
   #ifdef TEST
   static uint32_t tSend = millis();
+  if (timeOver(tAct,tSend,1000)){
+    tSend = tSend;
+    sendData2Client("$GPGGA,161640.00,4804.36384,N,01444.09266,E,1,04,11.84,320.6,M,43.5,M,,*69\n");
+    sendData2Client("$GPRMC,161640.00,A,4804.36384,N,01444.09266,E,0.867,,090121,,,A*7A\n");
+    sendData2Client("#FNF 8,C3CC,1,0,1,B,F33344467E0A0A12397CB8\n");
+    sendData2Client("#FNF 8,C3CC,1,0,2,13,416E64726561732048696E74657265636B6572\n");
+  }
   #endif
-  char * pSerialLine = NULL;
-  String sSerial = "";
-  String s = "";
-  FanetLora::trackingData myFanetData;  
-  FanetLora::trackingData tFanetData;  
-  
-  uint8_t oldScreenNumber = 0;
+
+  handleButton(tAct);
+  checkFlyingState(tAct);
+  #ifdef AIRMODULE
+  if (setting.Mode == MODE_AIR_MODULE){
+    recordFlight(tAct);
+  }
+  #endif
+  printBattVoltage(tAct);
+  logFanetRxStats(tAct);
+  #ifdef GSMODULE
+  if (setting.Mode == MODE_GROUND_STATION){
+    sendAWGroundStationdata(tAct); //send ground-station-data    
+  }
+  #endif
+}
+
+#ifdef AIRMODULE
+void handleGps(uint32_t tAct,uint32_t events){
+  if (setting.bConfigGPS){
+    setupUbloxConfig();
+    setting.bConfigGPS = false;
+  }
+  if (setting.Mode == MODE_AIR_MODULE){
+    readGPS(); //posts EV_GPSFIX with every GGA-sentence
+  }
+  bool bPoll = !bGpsEvents;
+  #ifdef REPLAY
+  if (replay.isPlaying()) bPoll = true; //replay has no uart-event
+  #endif
+  dispatcher.setPeriod(handleGps,(bPoll) ? GPS_POLL : GPS_IDLE);
+}
+
+void handlePps(uint32_t tAct,uint32_t events){
+  tLastPPS = tAct;
+}
+
+void handleFix(uint32_t tAct,uint32_t events){
+  static uint32_t tFix = millis();
+  static float oldAlt = 0.0;
+  //GGA is the last sentence of a gps-cycle --> position is used immediately, not with the next pps
+  //without GGA, we are called after GPS_FIXTIMEOUT
+  if ((events & EV_GPSFIX) && (!timeOver(tAct,tFix,GPS_MINCYCLE))) return;
+  status.tGPSCycle = tAct - tFix;
+  tFix = tAct;
+  if (!status.bHasAXP192) tLastPPS = tAct; //only new boards have a pps-pin
+  log_v("GPS-Cycle t=%d",status.tGPSCycle);
+  if (nmea.isValid()){
+    long alt = 0;
+    nmea.getAltitude(alt);
+    status.GPS_NumSat = nmea.getNumSatellites();
+    status.GPS_Fix = 1;
+    if (status.GPS_NumSat < 4){ //we need at least 4 satellites to get accurate position !!
+      status.GPS_speed = 0;
+      status.GPS_course = 0;
+    }else{
+      status.GPS_speed = nmea.getSpeed()*1.852/1000.; //speed in cm/s --> we need km/h
+      status.GPS_course = nmea.getCourse()/1000.;
+    }
+    status.GPS_Lat = nmea.getLatitude() / 1000000.;
+    status.GPS_Lon = nmea.getLongitude() / 1000000.;  
+    status.GPS_alt = alt/1000.;
+    setTime(nmea.getHour(), nmea.getMinute(), nmea.getSecond(), nmea.getDay(), nmea.getMonth(), nmea.getYear());
+    if (oldAlt == 0) oldAlt = status.GPS_alt;        
+    if (!status.vario.bHasVario) status.ClimbRate = (status.GPS_alt - oldAlt) / (float(status.tGPSCycle) / 1000.0);        
+    oldAlt = status.GPS_alt;
+    MyFanetData.climb = status.ClimbRate;
+    MyFanetData.lat = status.GPS_Lat;
+    MyFanetData.lon = status.GPS_Lon;
+    MyFanetData.altitude = status.GPS_alt;
+    MyFanetData.speed = status.GPS_speed; //speed in cm/s --> we need km/h
+    if ((status.GPS_speed <= 5.0) && (status.vario.bHasVario)){
+      MyFanetData.heading = status.varioHeading;
+    }else{
+      MyFanetData.heading = status.GPS_course;
+    }        
+    if (setting.OGNLiveTracking){
+      ogn.setGPS(status.GPS_Lat,status.GPS_Lon,status.GPS_alt,status.GPS_speed,MyFanetData.heading);
+      if (fanet.onGround){
+        ogn.sendGroundTrackingData(status.GPS_Lat,status.GPS_Lon,fanet.getDevId(tFanetData.devId),fanet.state,0.0);
+      }else{
+        ogn.sendTrackingData(status.GPS_Lat,status.GPS_Lon,status.GPS_alt,status.GPS_speed,MyFanetData.heading,status.ClimbRate,fanet.getMyDevId() ,(Ogn::aircraft_t)fanet.getAircraftType(),fanet.doOnlineTracking,0.0);
+      }
+      
+    } 
+
+    flightRecorder.logGps(now(),status.GPS_Lat,status.GPS_Lon,status.GPS_alt);
+    fanet.setMyTrackingData(&MyFanetData); //set Data on fanet
+    updateProximity();
+    sendAWTrackingdata(&MyFanetData);
+    sendTraccarTrackingdata(&MyFanetData);
+  }else{
+    status.GPS_Fix = 0;
+    status.GPS_speed = 0.0;
+    status.GPS_Lat = 0.0;
+    status.GPS_Lon = 0.0;
+    status.GPS_alt = 0.0;
+    status.GPS_course = 0.0;
+    status.GPS_NumSat = 0;
+    if (!status.vario.bHasVario) status.ClimbRate = 0.0;
+    oldAlt = 0.0;
+  }
+  if((tAct - tLastPPS) >= 10000){
+    //no pps for more then 10sec. --> clear GPS-state
+    status.GPS_Fix = 0;
+    status.GPS_speed = 0.0;
+    status.GPS_Lat = 0.0;
+    status.GPS_Lon = 0.0;
+    status.GPS_alt = 0.0;
+    status.GPS_course = 0.0;
+    status.GPS_NumSat = 0;
+  }
+  publishGps();
+  dispatcher.post(EV_GPSCYCLE); //outputs with new position
+}
+#endif
+
+void handleFanet(uint32_t tAct,uint32_t events){
+  if ((setting.fanetMode == FN_AIR_TRACKING) || (status.flying)){
+    fanet.onGround = false; //online-tracking
+  }else{
+    fanet.onGround = true; //ground-tracking
+  }
+  fanet.run((events & EV_LORA) != 0);
+  dispatcher.setPeriod(handleFanet,fanet.getPollTime()); //every slot only with frames in the fifos
+  //neighbour moved, new or lost --> new geometry also between own fixes (ground-station has no fixes)
+  static uint32_t neighbourChanges = 0;
+  if (fanet.getNeighbourChanges() != neighbourChanges){
+    neighbourChanges = fanet.getNeighbourChanges();
+    updateProximity();
+  }
+  status.fanetRx = fanet.rxCount;
+  status.fanetTx = fanet.txCount;
+  if (status.fanetTx) boot.ready(BOOT_FANETTX); //we are visible
+  if (fanet.isNewMsg()){
+    //write msg to udp !!
+    String msg = fanet.getactMsg() + "\n";
+    if (setting.outputFANET) sendData2Client(msg);
+  }
+  //drain rx-queues, max. one queue-length per loop
+  FanetLora::nameData nameData;
+  for (uint8_t i = 0;(i < RXQUEUE_NAME) && (fanet.getNameData(&nameData));i++){
+    if (setting.OGNLiveTracking){
+      ogn.sendNameData(fanet.getDevId(nameData.devId),nameData.name,(float)nameData.snr / 10.0);
+    }
+  }
+  FanetLora::weatherData weatherData;
+  for (uint8_t i = 0;(i < RXQUEUE_WEATHER) && (fanet.getWeatherData(&weatherData));i++){
+    if (setting.OGNLiveTracking){
+      ogn.sendWeatherData(weatherData.lat,weatherData.lon,fanet.getDevId(weatherData.devId),weatherData.wHeading,weatherData.wSpeed,weatherData.wGust,weatherData.temp,NAN,NAN,weatherData.Humidity,weatherData.Baro,(float)weatherData.snr / 10.0); //set to 70 db
+    }
+  }    
+  for (uint8_t i = 0;(i < RXQUEUE_TRACKING) && (fanet.getTrackingData(&tFanetData));i++){
+      //log_i("new Tracking-Data");
+      if (coreBench.isSynthetic(tFanetData.devId)) continue; //don't upload targets of the benchmark
+      if (tFanetData.type == 11){ //online-tracking
+        if (setting.OGNLiveTracking){
+          ogn.sendTrackingData(tFanetData.lat ,tFanetData.lon,tFanetData.altitude,tFanetData.speed,tFanetData.heading,tFanetData.climb,fanet.getDevId(tFanetData.devId) ,(Ogn::aircraft_t)tFanetData.aircraftType,tFanetData.OnlineTracking,(float)tFanetData.snr / 10.0);
+        } 
+        sendAWTrackingdata(&tFanetData);
+        sendTraccarTrackingdata(&tFanetData);
+      }else if (tFanetData.type >= 70){ //ground-tracking
+        if (setting.OGNLiveTracking){
+          ogn.sendGroundTrackingData(tFanetData.lat,tFanetData.lon,fanet.getDevId(tFanetData.devId),tFanetData.type,(float)tFanetData.snr / 10.0);
+        } 
+      }
+      
+     
+      //if (nmea.isValid()){
+      //  fanet.getMyTrackingData(&myFanetData);
+      //}
+  }    
+}
+
+void handleBench(uint32_t tAct,uint32_t events){
+  dispatcher.setPeriod(handleBench,(coreBench.isRunning()) ? BENCH_POLL : BENCH_IDLE);
+  if (!coreBench.isRunning()) return;
+  CoreBench::target target;
+  FanetLora::trackingData tData;
+  for (uint8_t i = 0;(i < BENCH_MAXTARGETS) && (coreBench.getTarget(tAct,&target));i++){
+    memset(&tData,0,sizeof(tData));
+    tData.devId = target.devId;
+    tData.lat = target.lat;
+    tData.lon = target.lon;
+    tData.altitude = target.alt;
+    tData.aircraftType = FanetLora::paraglider;
+    tData.speed = target.speed;
+    tData.climb = target.climb;
+    tData.heading = target.heading;
+    tData.rssi = -80;
+    tData.snr = 50;
+    fanet.simulateTracking(&tData);
+  }
+  coreBench.run(tAct);
+}
+
+void handleFlarm(uint32_t tAct,uint32_t events){
+  sendFlarmData(tAct,(events & EV_GPSCYCLE) != 0);
+  flarm.run();
+}
+
+void handleLK8EX(uint32_t tAct,uint32_t events){
+  sendLK8EX(tAct);
+}
+
+void handleSerial(uint32_t tAct,uint32_t events){
+  char *pSerialLine;
+  while ((pSerialLine = readSerial()) != NULL){
+    checkReceivedLine(pSerialLine);
+  }
+  #ifdef BLUETOOTHSERIAL 
+  if (setting.outputMode == OUTPUT_BLUETOOTH){
+    while ((pSerialLine = readBtSerial()) != NULL){
+      checkReceivedLine(pSerialLine);
+    }
+  }
+  #endif    
+}
+
+void handleMessages(uint32_t tAct,uint32_t events){
+  if (sendTestData == 1){
+    log_i("sending msgtype 1");
+    testTrackingData.devId = fanet._myData.devId;
+    fanet.writeMsgType1(&testTrackingData);
+    sendAWTrackingdata(&testTrackingData);
+    sendTraccarTrackingdata(&testTrackingData);
+    sendTestData = 0;
+  }else if (sendTestData == 2){
+    log_i("sending msgtype 2 %s",testString.c_str());
+    fanet.writeMsgType2(testString);
+    sendTestData = 0;
+  }else if (sendTestData == 3){
+    log_i("sending msgtype 3 %s",testString.c_str());
+    fanet.writeMsgType3(fanetReceiver,testString);
+    sendTestData = 0;
+  }else if (sendTestData == 4){
+    log_i("sending msgtype 4");
+    testWeatherData.bStateOfCharge = true;
+    testWeatherData.bBaro = true;
+    testWeatherData.bHumidity = true;
+    testWeatherData.bWind = true;
+    testWeatherData.bTemp = true;
+    fanet.writeMsgType4(&testWeatherData);
+    sendTestData = 0;
+  }
+  if (sendWeatherData){ //we have to send weatherdata
+    //log_i("sending weatherdata");
+    fanet.writeMsgType4(&testWeatherData);
+    if (setting.OGNLiveTracking){
+      ogn.sendWeatherData(status.GPS_Lat,status.GPS_Lon,fanet.getMyDevId(),status.weather.WindDir,status.weather.WindSpeed,status.weather.WindGust,status.weather.temp,status.weather.rain1h,status.weather.rain24h,status.weather.Humidity,status.weather.Pressure,0);
+    }      
+    sendWeatherData = false;
+  }
+}
+
+void handleAxp(uint32_t tAct,uint32_t events){
+  if (!AXP192_Irq) return;
+  if (axp.readIRQ() == AXP_PASS) {
+    if (axp.isPEKLongtPressIRQ()) {
+      log_v("Long Press IRQ");
+      status.bPowerOff = true;
+    }
+    if (axp.isPEKShortPressIRQ()) {
+      log_v("Short Press IRQ");
+      setting.screenNumber ++;
+      if (setting.screenNumber > MAXSCREENS) setting.screenNumber = 0;
+      write_screenNumber(); //save screennumber in File
+      tDisplay = tAct - DISPLAY_UPDATE_RATE;
+    }
+    axp.clearIRQ();
+  }
+  AXP192_Irq = false;
+}
+
+#ifdef OLED
+void handleDisplay(uint32_t tAct,uint32_t events){
+  if (!boot.isReady(BOOT_DISPLAY)) return; //splash-screen is still shown
+  if (setting.displayType == OLED0_96){
+  #ifdef GSMODULE
+    if (setting.Mode == MODE_GROUND_STATION){
+      if (setting.gs.SreenOption == SCREEN_WEATHER_DATA){
+        printWeather(tAct);
+      }else if (setting.gs.SreenOption != SCREEN_ALWAYS_OFF){
+        if (fanet.getNeighboursCount() == 0){
+          if (timeOver(tAct,tDisplay,500)){
+            tDisplay = tAct;
+            printScanning(tAct);
+          }
+        }else{
+          if (timeOver(tAct,tDisplay,DISPLAY_UPDATE_RATE_GS)){
+            tDisplay = tAct;
+            printGSData(tAct);
+          }
+        }
+      }
+    }
+  #endif
+  #ifdef AIRMODULE
+    if (setting.Mode == MODE_AIR_MODULE){
+      switch (setting.screenNumber)
+      {
+      case 0: //main-Display
+        if ((timeOver(tAct,tDisplay,DISPLAY_UPDATE_RATE)) || (oldScreenNumber != setting.screenNumber)){
+          tDisplay = tAct;
+          printGPSData(tAct);          
+        }
+        break;
+      case 1: //radar-screen with list
+        if ((timeOver(tAct,tDisplay,DISPLAY_UPDATE_RATE2)) || (oldScreenNumber != setting.screenNumber)){
+          tDisplay = tAct;              
+          DrawRadarScreen(tAct,RADAR_LIST);
+        }
+        break;
+      case 2: //radar-screen with closest
+        if ((timeOver(tAct,tDisplay,DISPLAY_UPDATE_RATE)) || (oldScreenNumber != setting.screenNumber)){
+          tDisplay = tAct;
+          DrawRadarScreen(tAct,RADAR_CLOSEST);
+        }
+        break;
+      case 3: //list aircrafts
+        if ((timeOver(tAct,tDisplay,DISPLAY_UPDATE_RATE)) || (oldScreenNumber != setting.screenNumber)){
+          tDisplay = tAct;
+          //DrawAircraftList();
+        }
+        break;
+      default:
+        break;
+      }
+      oldScreenNumber = setting.screenNumber;
+    }
+  #endif
+  }
+}
+#endif
+
+void taskStandard(void *pvParameters){
+  static uint32_t tLoop = millis();
   tFanetData.rssi = 0;
   MyFanetData.rssi = 0;
 
@@ -2926,6 +3640,13 @@ void taskStandard(void *pvParameters){
     NMeaSerial.begin(GPSBAUDRATE,SERIAL_8N1,12,15,false);
     log_i("GPS Baud=9600,8N1,RX=12,TX=15");
   }
+  #ifdef ESP_ARDUINO_VERSION_MAJOR
+  #if ESP_ARDUINO_VERSION >= ESP_ARDUINO_VERSION_VAL(2,0,3)
+  //uart-event (fifo-threshold or rx-timeout) wakes handleGps
+  NMeaSerial.onReceive(gpsReceived);
+  bGpsEvents = true;
+  #endif
+  #endif
   
   //setupUbloxConfig();
 
@@ -2937,11 +3658,12 @@ void taskStandard(void *pvParameters){
   //Reset the device so that the changes could take plaace
   //MicroNMEA::sendSentence(NMeaSerial, "$PSTMSRR");
 
-
-  delay(1000);
-  //clear serial buffer
-  while (NMeaSerial.available())
-    NMeaSerial.read();
+  //no waiting for the gps, garbage of the power-up is dropped by the nmea-checksum
+  //BOOT_GPS is signaled with the first valid sentence
+  #ifdef REPLAY
+  //play recorded file, if there is one, otherwise record a new one
+  if (!replay.beginPlay(REPLAY_FILE)) replay.beginRecord(REPLAY_FILE);
+  #endif
   if (status.bHasAXP192){  
     //only on new boards we have an pps-pin
     pinMode(PPSPIN, INPUT);
@@ -2954,16 +3676,23 @@ void taskStandard(void *pvParameters){
     status.GPS_Lat = setting.gs.lat;
     status.GPS_Lon = setting.gs.lon;  
     status.GPS_alt = setting.gs.alt;
+    publishGps();
   }
   #endif
+  if (setting.Mode != MODE_AIR_MODULE){
+    boot.skip(BOOT_GPS);
+    boot.skip(BOOT_GPSFIX);
+  }
 
 
+  boot.start(BOOT_RADIO);
   // create a binary semaphore for task synchronization
   long frequency = FREQUENCY868;
   //bool begin(int8_t sck, int8_t miso, int8_t mosi, int8_t ss,int reset, int dio0,long frequency,uint8_t outputPower);
   if (setting.band == BAND915)frequency = FREQUENCY915; 
   fanet.setLegacy(setting.LegacyTxEnable);
   fanet.begin(PinLora_SCK, PinLora_MISO, PinLora_MOSI, PinLora_SS,PinLoraRst, PinLoraDI0,frequency,setting.LoraPower);
+  if (PinLoraDI0 >= 0) fanet.setRadioEvent(loraHandler); //dio0 wakes handleFanet, otherwise the radio is polled
   fanet.setPilotname(setting.PilotName);
   fanet.setAircraftType(setting.AircraftType);
   //if (setting.Mode != MODE_DEVELOPER){ //
@@ -2973,6 +3702,7 @@ void taskStandard(void *pvParameters){
   //}
   setting.myDevId = fanet.getMyDevId();
   host_name = APPNAME "-" + setting.myDevId; //String((ESP32_getChipId() & 0xFFFFFF), HEX);
+  boot.ready(BOOT_RADIO);
   #ifdef AIRMODULE
   if (setting.Mode == MODE_AIR_MODULE){
     flarm.begin();
@@ -2984,8 +3714,7 @@ void taskStandard(void *pvParameters){
         ogn.setAirMode(false); //set airmode
         #ifdef GSM_MODULE
           if (setting.wifi.connect == MODE_WIFI_DISABLED){
-            ogn.setClient(&GsmOGNClient);
-            ogn.setMutex(&xGsmMutex);
+            ogn.setClient(&GsmOGNSocket);
           }
         #endif
         if (setting.PilotName.length() > 0){
@@ -2994,6 +3723,8 @@ void taskStandard(void *pvParameters){
           ogn.begin("FNB" + setting.myDevId,VERSION "." APPNAME);
         }      
         ogn.setGPS(setting.gs.lat,setting.gs.lon,setting.gs.alt,0.0,0.0);
+        ogn.setMinInterval(setting.ognMinInterval);
+        if ((status.bWarmStart) && (warm.bOgnLoggedIn)) ogn.connectNow();
       }
     #endif
     #ifdef AIRMODULE
@@ -3003,325 +3734,54 @@ void taskStandard(void *pvParameters){
       }
     #endif
   } 
+  if ((setting.OGNLiveTracking) || (setting.awLiveTracking) || (setting.traccarLiveTracking)){
+    awQueue.begin(AW_QUEUE_LEN,AW_MAXLINE);
+    traccarQueue.begin(TRACCAR_QUEUE_LEN,sizeof(traccarItem));
+    //ogn-lines are only kept for ground-stations, in the air the ring would wear the flash
+    if ((setting.OGNLiveTracking) && (setting.Mode == MODE_GROUND_STATION)) ogn.setOfflineStore(&ognStore);
+    //sends data to internet-services, every destination in its own task
+    if (setting.OGNLiveTracking) xTaskCreatePinnedToCore(taskUplink, "taskUplinkOGN", 4096, (void *)UPLINK_OGN, 4, &xHandleUplink[UPLINK_OGN], getTaskCore(TASKGROUP_IO));
+    if (setting.awLiveTracking) xTaskCreatePinnedToCore(taskUplink, "taskUplinkAW", 4096, (void *)UPLINK_AW, 4, &xHandleUplink[UPLINK_AW], getTaskCore(TASKGROUP_IO));
+    if (setting.traccarLiveTracking) xTaskCreatePinnedToCore(taskUplink, "taskUplinkTraccar", 4096, (void *)UPLINK_TRACCAR, 4, &xHandleUplink[UPLINK_TRACCAR], getTaskCore(TASKGROUP_IO));
+  }
 
 
-#ifdef OLED
+  //udp.begin(UDPPORT);
+  tDisplay = millis();
+  tLastPPS = millis();
+  //handlers are only called, when their event was posted or their period is over
+  #ifdef AIRMODULE
+  dispatcher.add("gps",handleGps,EV_GPSDATA,(bGpsEvents) ? GPS_IDLE : GPS_POLL);
+  if (setting.Mode == MODE_AIR_MODULE){
+    dispatcher.add("pps",handlePps,EV_PPS,0);
+    dispatcher.add("fix",handleFix,EV_GPSFIX,GPS_FIXTIMEOUT);
+  }
+  #endif
+  dispatcher.add("fanet",handleFanet,EV_LORA,fanet.getPollTime());
+  dispatcher.add("bench",handleBench,0,BENCH_IDLE);
+  dispatcher.add("flarm",handleFlarm,EV_GPSCYCLE,(setting.Mode == MODE_AIR_MODULE) ? 0 : FLARM_UPDATE_RATE);
+  dispatcher.add("lk8ex",handleLK8EX,0,LK8EX_RATE);
+  dispatcher.add("serial",handleSerial,0,SERIAL_POLL);
+  dispatcher.add("msg",handleMessages,EV_MSG,0);
+  dispatcher.add("axp",handleAxp,EV_AXP,0);
+  #ifdef OLED
   if (setting.displayType == OLED0_96){
-    display.setTextColor(WHITE);
-    display.setTextSize(1);
-    display.setCursor(0,55);
-    display.print(setting.myDevId);
-    display.display();
-    delay(3000);
-    if (setting.gs.SreenOption == SCREEN_ALWAYS_OFF){
-      oledPowerOff();
-    }
+    dispatcher.add("display",handleDisplay,0,DISPLAY_POLL);
   }
-#endif
-
-  //udp.begin(UDPPORT);
+  #endif
+  dispatcher.add("housekeeping",handleHousekeeping,0,HOUSEKEEPING_POLL);
+  dispatcher.begin(xTaskGetCurrentTaskHandle());
   tLoop = millis();
+  uint8_t diagId = taskDiag.add("standard",&xHandleStandard,100);
   while(1){    
-    // put your main code here, to run repeatedly:
+    uint32_t events = dispatcher.wait(); //sleep until there is something to do
+    taskDiag.loopStart(diagId);
     uint32_t tAct = millis();
-    #ifdef TEST
-    if (timeOver(tAct,tSend,1000)){
-      tSend = tSend;
-      sendData2Client("$GPGGA,161640.00,4804.36384,N,01444.09266,E,1,04,11.84,320.6,M,43.5,M,,*69\n");
-      sendData2Client("$GPRMC,161640.00,A,4804.36384,N,01444.09266,E,0.867,,090121,,,A*7A\n");
-      sendData2Client("#FNF 8,C3CC,1,0,1,B,F33344467E0A0A12397CB8\n");
-      sendData2Client("#FNF 8,C3CC,1,0,2,13,416E64726561732048696E74657265636B6572\n");
-    }
-    #endif
-
     status.tLoop = tAct - tLoop;
     tLoop = tAct;
     if (status.tMaxLoop < status.tLoop) status.tMaxLoop = status.tLoop;
-
-    #ifdef AIRMODULE    
-    if (setting.bConfigGPS){
-      setupUbloxConfig();
-      setting.bConfigGPS = false;
-    }
-    #endif
-    handleButton(tAct);
-
-    if (setting.OGNLiveTracking){
-      if (status.vario.bHasVario){
-        ogn.setStatusData(status.pressure ,status.varioTemp,NAN,(float)status.vBatt / 1000.);
-      }else if ((status.vario.bHasBME) || (status.bWUBroadCast)){
-        ogn.setStatusData(status.weather.Pressure ,status.weather.temp,status.weather.Humidity,(float)status.vBatt / 1000.);
-      }else{
-        ogn.setStatusData(NAN ,NAN, NAN, (float)status.vBatt / 1000.);
-      }
-      ogn.run(status.bInternetConnected);
-    } 
-    checkFlyingState(tAct);
-    printBattVoltage(tAct);
-    #ifdef AIRMODULE
-    if (setting.Mode == MODE_AIR_MODULE){
-      readGPS();
-    }
-    #endif
-    sendFlarmData(tAct);
-    #ifdef OLED
-    if (setting.displayType == OLED0_96){
-    #ifdef GSMODULE
-      if (setting.Mode == MODE_GROUND_STATION){
-        if (setting.gs.SreenOption == SCREEN_WEATHER_DATA){
-          printWeather(tAct);
-        }else if (setting.gs.SreenOption != SCREEN_ALWAYS_OFF){
-          if (fanet.getNeighboursCount() == 0){
-            if (timeOver(tAct,tDisplay,500)){
-              tDisplay = tAct;
-              printScanning(tAct);
-            }
-          }else{
-            if (timeOver(tAct,tDisplay,DISPLAY_UPDATE_RATE_GS)){
-              tDisplay = tAct;
-              printGSData(tAct);
-            }
-          }
-        }
-      }
-    #endif
-    #ifdef AIRMODULE
-      if (setting.Mode == MODE_AIR_MODULE){
-        switch (setting.screenNumber)
-        {
-        case 0: //main-Display
-          if ((timeOver(tAct,tDisplay,DISPLAY_UPDATE_RATE)) || (oldScreenNumber != setting.screenNumber)){
-            tDisplay = tAct;
-            printGPSData(tAct);          
-          }
-          break;
-        case 1: //radar-screen with list
-          if ((timeOver(tAct,tDisplay,DISPLAY_UPDATE_RATE2)) || (oldScreenNumber != setting.screenNumber)){
-            tDisplay = tAct;              
-            DrawRadarScreen(tAct,RADAR_LIST);
-          }
-          break;
-        case 2: //radar-screen with closest
-          if ((timeOver(tAct,tDisplay,DISPLAY_UPDATE_RATE)) || (oldScreenNumber != setting.screenNumber)){
-            tDisplay = tAct;
-            DrawRadarScreen(tAct,RADAR_CLOSEST);
-          }
-          break;
-        case 3: //list aircrafts
-          if ((timeOver(tAct,tDisplay,DISPLAY_UPDATE_RATE)) || (oldScreenNumber != setting.screenNumber)){
-            tDisplay = tAct;
-            //DrawAircraftList();
-          }
-          break;
-        default:
-          break;
-        }
-        oldScreenNumber = setting.screenNumber;
-      }
-    #endif
-    }
-    #endif
-    if (sendTestData == 1){
-      log_i("sending msgtype 1");
-      testTrackingData.devId = fanet._myData.devId;
-      fanet.writeMsgType1(&testTrackingData);
-      sendAWTrackingdata(&testTrackingData);
-      sendTraccarTrackingdata(&testTrackingData);
-      sendTestData = 0;
-    }else if (sendTestData == 2){
-      log_i("sending msgtype 2 %s",testString.c_str());
-      fanet.writeMsgType2(testString);
-      sendTestData = 0;
-    }else if (sendTestData == 3){
-      log_i("sending msgtype 3 %s",testString.c_str());
-      fanet.writeMsgType3(fanetReceiver,testString);
-      sendTestData = 0;
-    }else if (sendTestData == 4){
-      log_i("sending msgtype 4");
-      testWeatherData.bStateOfCharge = true;
-      testWeatherData.bBaro = true;
-      testWeatherData.bHumidity = true;
-      testWeatherData.bWind = true;
-      testWeatherData.bTemp = true;
-      fanet.writeMsgType4(&testWeatherData);
-      sendTestData = 0;
-    }
-    if (sendWeatherData){ //we have to send weatherdata
-      //log_i("sending weatherdata");
-      fanet.writeMsgType4(&testWeatherData);
-      if (setting.OGNLiveTracking){
-        ogn.sendWeatherData(status.GPS_Lat,status.GPS_Lon,fanet.getMyDevId(),status.weather.WindDir,status.weather.WindSpeed,status.weather.WindGust,status.weather.temp,status.weather.rain1h,status.weather.rain1d,status.weather.Humidity,status.weather.Pressure,0);
-      }      
-      sendWeatherData = false;
-    }
-    pSerialLine = readSerial();
-    if (pSerialLine != NULL){
-      checkReceivedLine(pSerialLine);
-    }
-    #ifdef BLUETOOTHSERIAL 
-    if (setting.outputMode == OUTPUT_BLUETOOTH){
-      pSerialLine = readBtSerial();
-      if (pSerialLine != NULL){
-        checkReceivedLine(pSerialLine);
-      }
-    }
-    #endif    
-    if ((setting.fanetMode == FN_AIR_TRACKING) || (status.flying)){
-      fanet.onGround = false; //online-tracking
-    }else{
-      fanet.onGround = true; //ground-tracking
-    }
-    fanet.run();
-    status.fanetRx = fanet.rxCount;
-    status.fanetTx = fanet.txCount;
-    if (fanet.isNewMsg()){
-      //write msg to udp !!
-      String msg = fanet.getactMsg() + "\n";
-      if (setting.outputFANET) sendData2Client(msg);
-    }
-    FanetLora::nameData nameData;
-    if (fanet.getNameData(&nameData)){
-      if (setting.OGNLiveTracking){
-        ogn.sendNameData(fanet.getDevId(nameData.devId),nameData.name,(float)nameData.snr / 10.0);
-      }
-    }
-    FanetLora::weatherData weatherData;
-    if (fanet.getWeatherData(&weatherData)){
-      if (setting.OGNLiveTracking){
-        ogn.sendWeatherData(weatherData.lat,weatherData.lon,fanet.getDevId(weatherData.devId),weatherData.wHeading,weatherData.wSpeed,weatherData.wGust,weatherData.temp,NAN,NAN,weatherData.Humidity,weatherData.Baro,(float)weatherData.snr / 10.0); //set to 70 db
-      }
-    }    
-    if (fanet.getTrackingData(&tFanetData)){
-        //log_i("new Tracking-Data");
-        if (tFanetData.type == 11){ //online-tracking
-          if (setting.OGNLiveTracking){
-            ogn.sendTrackingData(tFanetData.lat ,tFanetData.lon,tFanetData.altitude,tFanetData.speed,tFanetData.heading,tFanetData.climb,fanet.getDevId(tFanetData.devId) ,(Ogn::aircraft_t)tFanetData.aircraftType,tFanetData.OnlineTracking,(float)tFanetData.snr / 10.0);
-          } 
-          sendAWTrackingdata(&tFanetData);
-          sendTraccarTrackingdata(&tFanetData);
-        }else if (tFanetData.type >= 70){ //ground-tracking
-          if (setting.OGNLiveTracking){
-            ogn.sendGroundTrackingData(tFanetData.lat,tFanetData.lon,fanet.getDevId(tFanetData.devId),tFanetData.type,(float)tFanetData.snr / 10.0);
-          } 
-        }
-        
-       
-        //if (nmea.isValid()){
-        //  fanet.getMyTrackingData(&myFanetData);
-        //}
-    }    
-    flarm.run();
-    sendLK8EX(tAct);
-    #ifdef AIRMODULE
-    if (setting.Mode == MODE_AIR_MODULE){
-      if (!status.bHasAXP192){
-        if ((tAct - tOldPPS) >= 1000){
-          ppsTriggered = true;
-        }
-      }
-      if (ppsTriggered){
-        ppsTriggered = false;
-        tLastPPS = tAct;
-        log_v("PPS-Triggered t=%d",status.tGPSCycle);
-        //log_e("GPS-FixTime=%s",nmea.getFixTime().c_str());
-        status.tGPSCycle = tAct - tOldPPS;
-        if (nmea.isValid()){
-          long alt = 0;
-          nmea.getAltitude(alt);
-          #ifdef AIRMODULE
-          if (setting.Mode == MODE_AIR_MODULE){
-            status.GPS_NumSat = nmea.getNumSatellites();
-          }
-          #endif
-          status.GPS_Fix = 1;
-          if (status.GPS_NumSat < 4){ //we need at least 4 satellites to get accurate position !!
-            status.GPS_speed = 0;
-            status.GPS_course = 0;
-          }else{
-            status.GPS_speed = nmea.getSpeed()*1.852/1000.; //speed in cm/s --> we need km/h
-            status.GPS_course = nmea.getCourse()/1000.;
-          }
-          status.GPS_Lat = nmea.getLatitude() / 1000000.;
-          status.GPS_Lon = nmea.getLongitude() / 1000000.;  
-          status.GPS_alt = alt/1000.;
-          setTime(nmea.getHour(), nmea.getMinute(), nmea.getSecond(), nmea.getDay(), nmea.getMonth(), nmea.getYear());
-          if (oldAlt == 0) oldAlt = status.GPS_alt;        
-          if (!status.vario.bHasVario) status.ClimbRate = (status.GPS_alt - oldAlt) / (float(status.tGPSCycle) / 1000.0);        
-          oldAlt = status.GPS_alt;
-          MyFanetData.climb = status.ClimbRate;
-          MyFanetData.lat = status.GPS_Lat;
-          MyFanetData.lon = status.GPS_Lon;
-          MyFanetData.altitude = status.GPS_alt;
-          MyFanetData.speed = status.GPS_speed; //speed in cm/s --> we need km/h
-          if ((status.GPS_speed <= 5.0) && (status.vario.bHasVario)){
-            MyFanetData.heading = status.varioHeading;
-          }else{
-            MyFanetData.heading = status.GPS_course;
-          }        
-          if (setting.OGNLiveTracking){
-            ogn.setGPS(status.GPS_Lat,status.GPS_Lon,status.GPS_alt,status.GPS_speed,MyFanetData.heading);
-            if (fanet.onGround){
-              ogn.sendGroundTrackingData(status.GPS_Lat,status.GPS_Lon,fanet.getDevId(tFanetData.devId),fanet.state,0.0);
-            }else{
-              ogn.sendTrackingData(status.GPS_Lat,status.GPS_Lon,status.GPS_alt,status.GPS_speed,MyFanetData.heading,status.ClimbRate,fanet.getMyDevId() ,(Ogn::aircraft_t)fanet.getAircraftType(),fanet.doOnlineTracking,0.0);
-            }
-            
-          } 
-
-          fanet.setMyTrackingData(&MyFanetData); //set Data on fanet
-          sendAWTrackingdata(&MyFanetData);
-          sendTraccarTrackingdata(&MyFanetData);
-        }else{
-          status.GPS_Fix = 0;
-          status.GPS_speed = 0.0;
-          status.GPS_Lat = 0.0;
-          status.GPS_Lon = 0.0;
-          status.GPS_alt = 0.0;
-          status.GPS_course = 0.0;
-          status.GPS_NumSat = 0;
-          if (!status.vario.bHasVario) status.ClimbRate = 0.0;
-          oldAlt = 0.0;
-        }
-        tOldPPS = tAct;
-      }
-      if((tAct - tLastPPS) >= 10000){
-        //no pps for more then 10sec. --> clear GPS-state
-        status.GPS_Fix = 0;
-        status.GPS_speed = 0.0;
-        status.GPS_Lat = 0.0;
-        status.GPS_Lon = 0.0;
-        status.GPS_alt = 0.0;
-        status.GPS_course = 0.0;
-        status.GPS_NumSat = 0;
-      }
-    }
-    #endif
-
-    #ifdef GSMODULE
-    if (setting.Mode == MODE_GROUND_STATION){
-      sendAWGroundStationdata(tAct); //send ground-station-data    
-    }
-    #endif
-
-    if (AXP192_Irq){
-      if (axp.readIRQ() == AXP_PASS) {
-        if (axp.isPEKLongtPressIRQ()) {
-          log_v("Long Press IRQ");
-          status.bPowerOff = true;
-        }
-        if (axp.isPEKShortPressIRQ()) {
-          log_v("Short Press IRQ");
-          setting.screenNumber ++;
-          if (setting.screenNumber > MAXSCREENS) setting.screenNumber = 0;
-          write_screenNumber(); //save screennumber in File
-          tDisplay = tAct - DISPLAY_UPDATE_RATE;
-        }
-        axp.clearIRQ();
-      }
-      AXP192_Irq = false;
-    }
-
-    delay(1);
+    dispatcher.dispatch(events);
+    taskDiag.loopEnd(diagId);
     if ((WebUpdateRunning) || (bPowerOff)) break;
   }
   log_i("stop task");
@@ -3338,11 +3798,151 @@ void taskStandard(void *pvParameters){
     }
   }
   #endif
+  #ifdef GSMODULE
+  if (bWarmSleep){
+    saveWarmNames();
+    warm.bOgnLoggedIn = ((setting.OGNLiveTracking) && (ogn.isLoggedIn()));
+  }
+  #endif
   fanet.end();
+  if (xHandleUplink[UPLINK_OGN]){
+    while (eTaskGetState(xHandleUplink[UPLINK_OGN]) != eDeleted) delay(10); //ogn is still used by uplink-task
+  }
   if (setting.OGNLiveTracking) ogn.end();
   vTaskDelete(xHandleStandard); //delete standard-task
 }
 
+void logUplinkStats(const char *name,UplinkQueue *pQueue){
+  UplinkQueue::stats stat = pQueue->getStats();
+  if (stat.queued == 0) return;
+  log_i("%s queued=%d sent=%d dropped=%d failed=%d waiting=%d latency=%d max=%d",name,stat.queued,stat.sent,stat.dropped,stat.failed,stat.waiting,stat.latency,stat.latencyMax);
+}
+
+void logHttpStats(const char *name,HttpEndpoint::stats stat){
+  if (stat.requests == 0) return;
+  log_i("%s http requests=%d errors=%d connects=%d tx=%d rx=%d latency=%d",name,stat.requests,stat.errors,stat.connects,stat.bytesTx,stat.bytesRx,stat.latencyMedian);
+}
+
+void logStoreStats(const char *name,UplinkStore *pStore){
+  UplinkStore::stats stat = pStore->getStats();
+  if (stat.stored == 0) return;
+  log_i("%s store backlog=%d stored=%d replayed=%d expired=%d overwritten=%d rate=%.1f/s",name,stat.backlog,stat.stored,stat.replayed,stat.expired,stat.overwritten,stat.replayRate);
+}
+
+void replayTraccar(void){
+  traccarItem item;
+  if (WiFi.status() != WL_CONNECTED) return;
+  if (traccarStore.peek(time(NULL),&item,sizeof(item)) != sizeof(item)) return;
+  if (sendTraccar(&item)) traccarStore.pop(); //otherwise try again later
+}
+
+void runOgnUplink(void){
+  if (status.vario.bHasVario){
+    ogn.setStatusData(status.pressure ,status.varioTemp,NAN,(float)status.vBatt / 1000.);
+  }else if ((status.vario.bHasBME) || (status.bWUBroadCast)){
+    ogn.setStatusData(status.weather.Pressure ,status.weather.temp,status.weather.Humidity,(float)status.vBatt / 1000.);
+  }else{
+    ogn.setStatusData(NAN ,NAN, NAN, (float)status.vBatt / 1000.);
+  }
+  trace.start(TRACE_UPLINK_OGN);
+  ogn.run(status.bInternetConnected);
+  trace.stop(TRACE_UPLINK_OGN);
+}
+
+void runTraccarUplink(void){
+  traccarItem item;
+  //send some positions over the kept connection, then look at the store again
+  for (uint8_t i = 0;(i < TRACCAR_BATCH) && (traccarQueue.pop(&item));i++){
+    trace.start(TRACE_UPLINK_TRACCAR);
+    bool bOk = sendTraccar(&item);
+    trace.stop(TRACE_UPLINK_TRACCAR,bOk);
+    if (!bOk) traccarStore.append(item.tTime,&item,sizeof(item));
+    traccarQueue.done(bOk);
+  }
+  if (traccarQueue.getStats().waiting == 0) replayTraccar(); //actual positions first
+}
+
+void taskUplink(void *pvParameters){
+  static const char *names[UPLINK_DESTINATIONS] = {"OGN","AW","Traccar"};
+  static volatile uint32_t backlog[UPLINK_DESTINATIONS] = {0,0,0};
+  static volatile float replayRate[UPLINK_DESTINATIONS] = {0,0,0};
+  uint8_t dest = (uint32_t)pvParameters;
+  uint32_t tStats = millis();
+  uint32_t tStore = millis();
+  //every store is only accessed from the task of its destination
+  UplinkStore *pStore;
+  uint8_t diagId;
+  switch (dest){
+  case UPLINK_OGN:
+    pStore = &ognStore;
+    if (setting.Mode == MODE_GROUND_STATION) pStore->begin(OGN_STORE_MAXAGE,UPLINK_REPLAYINTERVALL); //no ring-file in air-mode
+    diagId = taskDiag.add("uplinkOGN",&xHandleUplink[dest],200);
+    break;
+  case UPLINK_AW:
+    pStore = &awStore;
+    pStore->begin(AW_STORE_MAXAGE,UPLINK_REPLAYINTERVALL);
+    diagId = taskDiag.add("uplinkAW",&xHandleUplink[dest],200);
+    break;
+  default:
+    pStore = &traccarStore;
+    pStore->begin(TRACCAR_STORE_MAXAGE,UPLINK_REPLAYINTERVALL);
+    diagId = taskDiag.add("uplinkTraccar",&xHandleUplink[dest],TRACCAR_BATCH * HTTP_RESPONSE_TIMEOUT); //blocking http-requests
+    break;
+  }
+  while (1){
+    taskDiag.loopStart(diagId);
+    uint32_t tAct = millis();
+    switch (dest){
+    case UPLINK_OGN:
+      runOgnUplink();
+      break;
+    case UPLINK_AW:
+      trace.start(TRACE_UPLINK_AW);
+      flushAWQueue();
+      trace.stop(TRACE_UPLINK_AW);
+      break;
+    default:
+      runTraccarUplink();
+      break;
+    }
+    if (timeOver(tAct,tStore,1000)){
+      tStore = tAct;
+      UplinkStore::stats stat = pStore->getStats();
+      backlog[dest] = stat.backlog;
+      replayRate[dest] = stat.replayRate;
+      status.uplinkBacklog = backlog[UPLINK_OGN] + backlog[UPLINK_AW] + backlog[UPLINK_TRACCAR];
+      status.uplinkReplayRate = replayRate[UPLINK_OGN] + replayRate[UPLINK_AW] + replayRate[UPLINK_TRACCAR];
+    }
+    if (timeOver(tAct,tStats,UPLINK_STATINTERVALL)){
+      tStats = tAct;
+      switch (dest){
+      case UPLINK_OGN:
+        {
+          UplinkQueue::stats stat = ogn.getQueueStats();
+          log_i("OGN queued=%d sent=%d dropped=%d failed=%d waiting=%d latency=%d max=%d",stat.queued,stat.sent,stat.dropped,stat.failed,stat.waiting,stat.latency,stat.latencyMax);
+          Ogn::sendStats sendStat = ogn.getSendStats();
+          log_i("OGN writes=%d bytes=%d failed=%d stale=%d rateLimited=%d",sendStat.writes,sendStat.bytes,sendStat.failed,sendStat.stale,sendStat.rateLimited);
+        }
+        break;
+      case UPLINK_AW:
+        logUplinkStats("AW",&awQueue);
+        break;
+      default:
+        logUplinkStats("Traccar",&traccarQueue);
+        logHttpStats("Traccar",traccarHttp.getStats());
+        break;
+      }
+      logStoreStats(names[dest],pStore);
+    }
+    taskDiag.loopEnd(diagId);
+    delay(10);
+    if ((WebUpdateRunning) || (bPowerOff)) break;
+  }
+  pStore->end();
+  log_i("stop task");
+  vTaskDelete(xHandleUplink[dest]);
+}
+
 void powerOff(){
   axp.clearIRQ();
   bPowerOff = true;
@@ -3369,14 +3969,21 @@ void powerOff(){
   eTaskState tStandard = eDeleted;
   eTaskState tGSM = eDeleted;
   eTaskState tWeather = eDeleted;
+  eTaskState tFlightRecorder = eDeleted;
+  eTaskState tUplink = eDeleted;
   while(1){
     //wait until all tasks are stopped
     if (xHandleBaro != NULL) tBaro = eTaskGetState(xHandleBaro);
     if (xHandleEInk != NULL) tEInk = eTaskGetState(xHandleEInk);
     if (xHandleStandard != NULL) tStandard = eTaskGetState(xHandleStandard);
     if (xHandleWeather != NULL) tWeather = eTaskGetState(xHandleWeather);    
-    if ((tBaro == eDeleted) && (tEInk == eDeleted) && (tWeather == eDeleted) && (tStandard == eDeleted)) break; //now all tasks are stopped    
-    log_i("baro=%d,eink=%d,standard=%d,weather=%d",tBaro,tEInk,tStandard,tWeather);
+    if (xHandleFlightRecorder != NULL) tFlightRecorder = eTaskGetState(xHandleFlightRecorder);
+    tUplink = eDeleted;
+    for (int i = 0;i < UPLINK_DESTINATIONS;i++){
+      if ((xHandleUplink[i] != NULL) && (eTaskGetState(xHandleUplink[i]) != eDeleted)) tUplink = eTaskGetState(xHandleUplink[i]);
+    }
+    if ((tBaro == eDeleted) && (tEInk == eDeleted) && (tWeather == eDeleted) && (tStandard == eDeleted) && (tFlightRecorder == eDeleted) && (tUplink == eDeleted)) break; //now all tasks are stopped    
+    log_i("baro=%d,eink=%d,standard=%d,weather=%d,recorder=%d,uplink=%d",tBaro,tEInk,tStandard,tWeather,tFlightRecorder,tUplink);
     delay(1000);
   }
   #ifdef GSM_MODULE
@@ -3389,6 +3996,9 @@ void powerOff(){
     delay(1000);
   }
   #endif
+  #ifdef GSMODULE
+  if (bWarmSleep) write_warmState(&warm); //all tasks have added their state
+  #endif
 
   #ifdef OLED
   if (setting.displayType == OLED0_96){
@@ -3476,8 +4086,11 @@ void taskEInk(void *pvParameters){
   }
   Screen screen;
   screen.begin();
+  uint8_t diagId = taskDiag.add("eink",&xHandleEInk,500);
   while(1){
+    taskDiag.loopStart(diagId);
     screen.run();
+    taskDiag.loopEnd(diagId);
     delay(10);
     if ((WebUpdateRunning) || (bPowerOff)) break;
   }
@@ -3507,6 +4120,7 @@ void taskBackGround(void *pvParameters){
   static uint32_t warning_time=0;
   static uint8_t ntpOk = 0;
   static uint32_t tGetTime = millis();
+  uint32_t tResync = 0; //warm start: time of rtc is used, re-sync later
   uint32_t tBattEmpty = millis();
   uint32_t tRuntime = millis();
   uint32_t tGetWifiRssi = millis();  
@@ -3519,12 +4133,19 @@ void taskBackGround(void *pvParameters){
 
   if (startOption != 0){ //we start wifi
     log_i("stop task");
+    boot.skip(BOOT_WIFI);
     vTaskDelete(xHandleBackground);
     return;
   }
 
   setupWifi();
+  if ((status.bWarmStart) && (status.bTimeOk)){
+    ntpOk = 1; //no ntp/gsm-sync at start
+    tResync = millis();
+  }
+  uint8_t diagId = taskDiag.add("background",&xHandleBackground,100);
   while (1){
+    taskDiag.loopStart(diagId);
     uint32_t tAct = millis();
     #ifdef GSMODULE
     if (setting.Mode == MODE_GROUND_STATION){
@@ -3569,6 +4190,11 @@ void taskBackGround(void *pvParameters){
     }else{
       status.bInternetConnected = false;
     }
+    if ((status.bInternetConnected) && (status.bTimeOk)) boot.ready(BOOT_ONLINE);
+    if ((tResync) && (timeOver(tAct,tResync,WARM_RESYNC))){
+      tResync = 0;
+      ntpOk = 0; //correct drift of rtc-clock in deep-sleep
+    }
     if (timeOver(tAct,tGetWifiRssi,5000)){
       tGetWifiRssi = tAct;
       status.wifiRssi = WiFi.RSSI();
@@ -3599,40 +4225,26 @@ void taskBackGround(void *pvParameters){
     }else if ((status.modemstatus == MODEM_CONNECTED) && (setting.wifi.connect == MODE_WIFI_DISABLED)){
       if ((!ntpOk) && (timeOver(tAct,tGetTime,5000))){
         log_i("get ntp-time");
-        byte ret = -1;
-        xSemaphoreTake( xGsmMutex, portMAX_DELAY );
-        ret = modem.NTPServerSync("pool.ntp.org",0);
-        xSemaphoreGive( xGsmMutex );
-        //log_i("ret=%d",ret);
-        if (ret >= 0){
-          int year3 = 0;
-          int month3 = 0;
-          int day3 = 0;
-          int hour3 = 0;
-          int min3 = 0;
-          int sec3 = 0;
-          float timezone = 0;
-          xSemaphoreTake( xGsmMutex, portMAX_DELAY );
-          bool bret = modem.getNetworkTime(&year3, &month3, &day3, &hour3, &min3, &sec3,&timezone);
-          xSemaphoreGive( xGsmMutex );
-          log_i("h=%d,min=%d,sec=%d,day=%d,month=%d,year=%d,ret=%d",hour3,min3, sec3, day3,month3, year3,bret);
-          if (bret){
-            //log_i("set time");
-            adjustTime(0);
-            struct tm timeinfo;
-            timeinfo.tm_year = year3 - 1900;
-            timeinfo.tm_mon = month3-1;
-            timeinfo.tm_mday = day3;
-            timeinfo.tm_hour = hour3;
-            timeinfo.tm_min = min3;
-            timeinfo.tm_sec = sec3;
-            setAllTime(timeinfo);
-
-            //setTime(hour3,min3, sec3, day3,month3, year3);
-            
-            //log_i("timestatus = %d",timeStatus());
-          }
-        }        
+        gsmTime t;
+        memset(&t,0,sizeof(t));
+        bool bret = gsmModem.call(ModemManager::PRIO_NORMAL,gsmGetTime,&t); //modem is owned by taskGsm
+        log_i("h=%d,min=%d,sec=%d,day=%d,month=%d,year=%d,ret=%d",t.hour,t.min, t.sec, t.day,t.month, t.year,bret);
+        if (bret){
+          //log_i("set time");
+          adjustTime(0);
+          struct tm timeinfo;
+          timeinfo.tm_year = t.year - 1900;
+          timeinfo.tm_mon = t.month-1;
+          timeinfo.tm_mday = t.day;
+          timeinfo.tm_hour = t.hour;
+          timeinfo.tm_min = t.min;
+          timeinfo.tm_sec = t.sec;
+          setAllTime(timeinfo);
+
+          //setTime(hour3,min3, sec3, day3,month3, year3);
+          
+          //log_i("timestatus = %d",timeStatus());
+        }
         tGetTime = tAct;
         //log_i("print time");        
         if (printLocalTime() == true){
@@ -3642,7 +4254,7 @@ void taskBackGround(void *pvParameters){
       }
     #endif
     }else{
-      ntpOk = 0;
+      if (!tResync) ntpOk = 0;
       tGetTime = tAct;
     }
     if ((setting.wifi.connect == WIFI_CONNECT_ALWAYS) && (WiFi.status() != WL_CONNECTED) && (status.wifiStat)){
@@ -3712,6 +4324,8 @@ void taskBackGround(void *pvParameters){
       }
     }
     checkExtPowerOff(tAct);
+    taskDiag.run();
+    taskDiag.loopEnd(diagId);
     delay(1);
 	}
 }
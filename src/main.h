@@ -1,5 +1,6 @@
 #include <string.h>
 #include <FanetLora.h>
+#include <FixedString.h>
 
 #ifndef __MAIN_H__
 #define __MAIN_H__
@@ -170,6 +171,28 @@ SCL 14
 #define ARDUINO_RUNNING_CORE0 0
 #define ARDUINO_RUNNING_CORE1 1
 
+//placement of the task-groups on the cores (setting.corePlacement), core 0 runs also the wifi- and bt-stack
+#define CORES_SINGLE 0 //all groups on core 1
+#define CORES_SPLIT 1 //radio and sensor on core 1, io on core 0
+#define CORES_RADIO 2 //radio alone on core 1, sensor and io on core 0
+#define CORES_COUNT 3
+
+#define TASKGROUP_RADIO 0 //taskStandard (fanet-mac, gps, flarm-output)
+#define TASKGROUP_SENSOR 1 //taskBaro
+#define TASKGROUP_IO 2 //display, uplinks, wifi and web, bluetooth, weather, gsm, flight-recorder
+
+//stages of the start (BootSequence), dependencies are set in setup
+#define BOOT_CONFIG 0 //spiffs and settings
+#define BOOT_BOARD 1 //pins and power-management
+#define BOOT_DISPLAY 2 //splash-screen finished
+#define BOOT_RADIO 3 //fanet running, devId and host-name known
+#define BOOT_GPS 4 //first valid nmea-sentence
+#define BOOT_GPSFIX 5 //first fix
+#define BOOT_WIFI 6 //access-point and web-server
+#define BOOT_BLUETOOTH 7
+#define BOOT_FANETTX 8 //first fanet-frame sent
+#define BOOT_ONLINE 9 //internet and time ok
+
 #define RADAR_SCREEN_CENTER_X 32
 #define RADAR_SCREEN_CENTER_Y 38
 
@@ -217,6 +240,27 @@ SCL 14
 #define FLARM_UPDATE_RATE 1000
 #define FLARM_UPDATE_STATE 60000
 
+//events of taskStandard (bits of task-notification)
+#define EV_PPS 0x01
+#define EV_GPSFIX 0x02 //GGA-sentence received
+#define EV_GPSCYCLE 0x04 //gps-cycle processed
+#define EV_AXP 0x08 //interrupt of AXP192
+#define EV_MSG 0x10 //test- or weather-data to send
+#define EV_GPSDATA 0x20 //gps-uart received data
+#define EV_LORA 0x40 //dio0 of the radio, packet received
+
+//periods of the polled handlers [ms]
+#define GPS_POLL 10 //without uart-event (replay, old core), uart-buffer holds > 200ms @9600baud
+#define GPS_IDLE 1000 //uart posts EV_GPSDATA --> only gps-config
+#define GPS_MINCYCLE 800 //max. 1 position per sec.
+#define GPS_FIXTIMEOUT 1500 //no GGA --> handle gps-state anyway
+#define BENCH_POLL 20 //core-benchmark running, synthetic targets
+#define BENCH_IDLE 1000 //wait for start of core-benchmark
+#define SERIAL_POLL 20
+#define LK8EX_RATE 250
+#define DISPLAY_POLL 50
+#define HOUSEKEEPING_POLL 50
+
 //defines for display
 #define NO_DISPLAY 0
 #define OLED0_96 1
@@ -272,8 +316,8 @@ SCL 14
 
 struct weatherupload{
   bool enable;
-  String ID;
-  String KEY;
+  FixedString<32> ID;
+  FixedString<200> KEY; //windy-keys are long tokens
 };
 
 struct VarioSettings{
@@ -316,15 +360,15 @@ struct WeatherSettings{
 };
 
 struct GsmSettings{
-  String apn;
-  String user;
-  String pwd;
+  FixedString<64> apn;
+  FixedString<32> user;
+  FixedString<32> pwd;
 };
 
 struct WifiSettings{
-  String appw; //access-point-Password
-  String ssid; //WIFI SSID
-  String password; //WIFI PASSWORD
+  FixedString<64> appw; //access-point-Password
+  FixedString<32> ssid; //WIFI SSID
+  FixedString<64> password; //WIFI PASSWORD
   uint8_t connect; //1 connect to wifi, 2 connect to wifi and try to stay connected
   uint32_t tWifiStop; //time after wifi will be stopped to save energy 0 --> never
 };
@@ -336,7 +380,7 @@ struct SettingsData{
   uint8_t Mode; //Air-Module, GS-Station,
   uint8_t displayType;
   uint8_t BattType; //type of battery
-  String myDevId; //my device-ID
+  FixedString<8> myDevId; //my device-ID
   uint8_t band;
   uint8_t LoraPower; //output-Power 5-20db
   uint8_t outputLK8EX1;
@@ -346,18 +390,19 @@ struct SettingsData{
   bool bOutputSerial; //additional output over serial-interface
   uint8_t awLiveTracking; //airwhere live-tracking
   WifiSettings wifi;
-  String PilotName; //Pilotname
+  FixedString<MAXNAMELEN> PilotName; //Pilotname
   FanetLora::aircraft_t AircraftType; //Aircrafttype
-  String UDPServerIP; //UDP-IP-Adress for sending Pakets
+  FixedString<40> UDPServerIP; //UDP-IP-Adress for sending Pakets
   uint16_t UDPSendPort; //Port of udp-server
   uint8_t outputMode; //output-mode
   GSSettings gs;
   VarioSettings vario; //variosettings
   uint8_t OGNLiveTracking; //OGN-Live-Tracking
+  uint8_t ognMinInterval; //min. seconds between 2 positions of one aircraft to OGN
   uint8_t screenNumber; //number of default-screen
   uint8_t LegacyTxEnable; //OGN-Live-Tracking
   uint8_t traccarLiveTracking; //Traccar live-tracking
-  String TraccarSrv; //OGN-Live-Tracking  
+  FixedString<96> TraccarSrv; //OGN-Live-Tracking  
   WeatherSettings wd;
   weatherupload WUUpload; //weather-underground upload-settings
   weatherupload WindyUpload; //weather-underground upload-settings
@@ -365,6 +410,8 @@ struct SettingsData{
   bool bConfigGPS;
   uint8_t fanetMode; //fanet tracking-mode 0 ... switch between online-tracking and ground-tracking 1 ... always online-tracking
   uint16_t fanetpin; //pin for fanet (4 signs)
+  uint8_t flightRecorder; //record flights to flash
+  uint8_t corePlacement; //placement of tasks on the cores (CORES_...)
 };
 
 struct weatherStatus{
@@ -376,10 +423,30 @@ struct weatherStatus{
   float WindGust = NAN; //[km/h]
   float rain1h = NAN; // rain this hour [l/h]
   float rain1d = NAN; // rain this day [l/h]
+  float rain24h = NAN; // rain last 24h [l/h]
+};
+
+//values which are passed to tasks on the other core by Handoff, always a consistent set
+struct varioValues{
+  float pressure;
+  float alt;
+  float climb;
+  float temp;
+  float heading;
+};
+
+struct gpsValues{
+  uint8_t fix;
+  uint8_t numSat;
+  double lat;
+  double lon;
+  float alt;
+  float speed;
+  float course;
 };
 
 struct statusData{
-  String myIP; //my IP-Adress
+  FixedString<16> myIP; //my IP-Adress
   uint16_t vBatt; //battery-voltage 1/1000V
   uint8_t BattPerc; //battery-percent
   bool BattCharging;
@@ -417,6 +484,11 @@ struct statusData{
   bool bHasGSM;
   int16_t GSMSignalQuality;
   uint8_t displayStat; //stat of display
+  uint16_t uplinkBacklog; //records waiting in offline-store
+  float uplinkReplayRate; //replayed records/s
+  uint32_t tConfigLoad; //time for loading the settings [us]
+  bool bWarmStart; //state restored from rtc-memory after deep-sleep
+  uint32_t warmSleeps; //deep-sleeps since last cold start
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "warmStart.h"
+#include <rom/crc.h>
+
+static RTC_NOINIT_ATTR warmRecord rtcRecord; //survives deep-sleep and sw-reset, random after power-on
+
+static uint32_t calcCrc(warmRecord *pRecord){
+  return crc32_le(0,(const uint8_t *)&pRecord->data,sizeof(pRecord->data));
+}
+
+void write_warmState(warmData *pData){
+  rtcRecord.data = *pData;
+  rtcRecord.version = WARM_VERSION;
+  rtcRecord.size = sizeof(warmData);
+  rtcRecord.crc = calcCrc(&rtcRecord);
+  rtcRecord.magic = WARM_MAGIC;
+  log_i("warm-state saved %d bytes, %d names",sizeof(rtcRecord),pData->nameCount);
+}
+
+bool read_warmState(warmData *pData){
+  if (rtcRecord.magic != WARM_MAGIC) return false;
+  if ((rtcRecord.version != WARM_VERSION) || (rtcRecord.size != sizeof(warmData))){
+    log_i("warm-state version %d size %d not supported",rtcRecord.version,rtcRecord.size);
+    return false;
+  }
+  if (rtcRecord.crc != calcCrc(&rtcRecord)){
+    log_e("warm-state crc-error");
+    return false;
+  }
+  *pData = rtcRecord.data;
+  if (pData->nameCount > WARM_MAXNAMES) pData->nameCount = WARM_MAXNAMES;
+  //system-time runs on in deep-sleep --> has to be after the time of sleeping
+  time_t now;
+  time(&now);
+  int64_t tElapsed = (int64_t)now - pData->tSleep;
+  if ((tElapsed < 0) || (tElapsed > WARM_MAXAGE)){
+    log_i("warm-state too old %d s",(int32_t)tElapsed);
+    return false;
+  }
+  return true;
+}
+
+void clear_warmState(void){
+  rtcRecord.magic = 0;
+}
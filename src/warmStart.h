@@ -0,0 +1,41 @@
+#ifndef __WARMSTART_H__
+#define __WARMSTART_H__
+
+#include "main.h"
+
+#define WARM_MAGIC 0x4D525747 //"GWRM"
+#define WARM_VERSION 1 //increase, if warmData is changed
+#define WARM_MAXNAMES 24
+#define WARM_RAINHOURS 24
+#define WARM_MAXAGE 86400 //snapshot is too old after 1 day [s]
+#define WARM_RESYNC 1800000ul //time from rtc is used, re-sync with ntp/gsm only after 30min [ms]
+
+//state of a ground-station, kept in rtc-memory over deep-sleep
+//plain data only, rtc-noinit-memory must not be touched by constructors at start
+struct warmName{
+  uint32_t devId;
+  char name[MAXNAMELEN + 1];
+};
+
+struct warmData{
+  uint32_t sleeps; //deep-sleeps since last cold start
+  int64_t tSleep; //system-time, when deep-sleep was entered [s]
+  uint8_t bTimeOk;
+  uint8_t bOgnLoggedIn;
+  uint8_t nameCount;
+  warmName names[WARM_MAXNAMES]; //fanet-names of neighbours and weather-stations
+  uint16_t rainHours[WARM_RAINHOURS]; //rain-tips per hour before deep-sleep, [0] = last hour
+};
+
+struct warmRecord{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size; //size of data
+  uint32_t crc; //crc32 of data
+  warmData data;
+};
+
+void write_warmState(warmData *pData); //directly before deep-sleep
+bool read_warmState(warmData *pData); //false, if rtc-memory holds no valid snapshot
+void clear_warmState(void); //snapshot is used only once
+#endif
@@ -0,0 +1,112 @@
+/*!
+ * @file Adafruit_BME280.h
+ *
+ * BME280 for host builds (env:native)
+ * the sensor answers on the addresses set present on the TwoWire bus, values come from native::bme280()
+ */
+
+#ifndef __NATIVE_ADAFRUIT_BME280_H__
+#define __NATIVE_ADAFRUIT_BME280_H__
+
+#include <stdint.h>
+#include <math.h>
+#include "Wire.h"
+#include "SPI.h"
+
+#define BME280_ADDRESS (0x77)
+#define BME280_ADDRESS_ALTERNATE (0x76)
+
+namespace native {
+
+struct bme280State {
+  int32_t temp = 2000; //[0.01 °C]
+  uint32_t pressure = 101325; //[Pa]
+  uint32_t humidity = 5000; //[0.01 %]
+  uint32_t reads = 0; //count of readADCValues
+};
+
+inline bme280State &bme280(){
+  static bme280State state;
+  return state;
+}
+
+}
+
+class Adafruit_BME280 {
+public:
+  enum sensor_sampling {
+    SAMPLING_NONE = 0b000,
+    SAMPLING_X1 = 0b001,
+    SAMPLING_X2 = 0b010,
+    SAMPLING_X4 = 0b011,
+    SAMPLING_X8 = 0b100,
+    SAMPLING_X16 = 0b101
+  };
+  enum sensor_mode {
+    MODE_SLEEP = 0b00,
+    MODE_FORCED = 0b01,
+    MODE_NORMAL = 0b11
+  };
+  enum sensor_filter {
+    FILTER_OFF = 0b000,
+    FILTER_X2 = 0b001,
+    FILTER_X4 = 0b010,
+    FILTER_X8 = 0b011,
+    FILTER_X16 = 0b100
+  };
+  enum standby_duration {
+    STANDBY_MS_0_5 = 0b000,
+    STANDBY_MS_10 = 0b110,
+    STANDBY_MS_20 = 0b111,
+    STANDBY_MS_62_5 = 0b001,
+    STANDBY_MS_125 = 0b010,
+    STANDBY_MS_250 = 0b011,
+    STANDBY_MS_500 = 0b100,
+    STANDBY_MS_1000 = 0b101
+  };
+
+  Adafruit_BME280(){}
+  bool begin(uint8_t addr = BME280_ADDRESS,TwoWire *theWire = &Wire){
+    _i2caddr = addr;
+    theWire->beginTransmission(addr);
+    return (theWire->endTransmission() == 0);
+  }
+  bool begin(TwoWire *theWire){
+    return begin(BME280_ADDRESS,theWire);
+  }
+  void setSampling(sensor_mode mode = MODE_NORMAL,sensor_sampling tempSampling = SAMPLING_X16,sensor_sampling pressSampling = SAMPLING_X16,
+                   sensor_sampling humSampling = SAMPLING_X16,sensor_filter filter = FILTER_OFF,standby_duration duration = STANDBY_MS_0_5){
+    (void)mode;(void)tempSampling;(void)pressSampling;(void)humSampling;(void)filter;(void)duration;
+  }
+  void takeForcedMeasurement(){}
+  uint8_t readADCValues(void){
+    native::bme280().reads++;
+    return 1;
+  }
+  int32_t getTemp(void){
+    return native::bme280().temp;
+  }
+  uint32_t getPressure(void){
+    return native::bme280().pressure;
+  }
+  uint32_t getHumidity(void){
+    return native::bme280().humidity;
+  }
+  float readTemperature(void){
+    return (float)getTemp() / 100.;
+  }
+  float readPressure(void){
+    return (float)getPressure();
+  }
+  float readHumidity(void){
+    return (float)getHumidity() / 100.;
+  }
+  float readAltitude(float seaLevel){
+    return 44330.0 * (1.0 - pow(readPressure() / 100.0F / seaLevel,0.1903));
+  }
+
+private:
+  uint8_t _i2caddr = BME280_ADDRESS;
+};
+
+#endif
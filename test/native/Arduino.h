@@ -0,0 +1,360 @@
+/*!
+ * @file Arduino.h
+ *
+ * Arduino-esp32 core api for host builds (env:native)
+ * time, gpio, interrupts, hw-timers and ledc are backed by NativeHal.h
+ */
+
+#ifndef __NATIVE_ARDUINO_H__
+#define __NATIVE_ARDUINO_H__
+
+#ifndef ARDUINO
+#define ARDUINO 10805
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+#include <time.h>
+#include <sys/time.h>
+#include <algorithm>
+#include "NativeHal.h"
+#include "pgmspace.h"
+#include "binary.h"
+#include "WString.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef unsigned int word;
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_IRAM_ATTR
+#define EXT_RAM_ATTR
+
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p) (((p) < NATIVE_PINS) ? (p) : NOT_AN_INTERRUPT)
+
+#define lowByte(w) ((uint8_t)((w) & 0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define bitRead(value,bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value,bit) ((value) |= (1UL << (bit)))
+#define bitClear(value,bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value,bit,bitvalue) ((bitvalue) ? bitSet(value,bit) : bitClear(value,bit))
+#ifndef bit
+#define bit(b) (1UL << (b))
+#endif
+#define sq(x) ((x)*(x))
+#define radians(deg) ((deg)*DEG_TO_RAD)
+#define degrees(rad) ((rad)*RAD_TO_DEG)
+
+using std::min;
+using std::max;
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+//log-output is quiet, tests compile with -DNATIVE_LOG to see it
+#ifdef NATIVE_LOG
+#define log_e(format,...) printf("[E][%s:%u] %s(): " format "\r\n",__FILE__,__LINE__,__FUNCTION__,##__VA_ARGS__)
+#define log_w(format,...) printf("[W][%s:%u] %s(): " format "\r\n",__FILE__,__LINE__,__FUNCTION__,##__VA_ARGS__)
+#define log_i(format,...) printf("[I][%s:%u] %s(): " format "\r\n",__FILE__,__LINE__,__FUNCTION__,##__VA_ARGS__)
+#define log_d(format,...) printf("[D][%s:%u] %s(): " format "\r\n",__FILE__,__LINE__,__FUNCTION__,##__VA_ARGS__)
+#define log_v(format,...) printf("[V][%s:%u] %s(): " format "\r\n",__FILE__,__LINE__,__FUNCTION__,##__VA_ARGS__)
+#else
+//arguments are still checked by the compiler, but nothing is printed
+#define native_log(format,...) do { if (0) printf(format,##__VA_ARGS__); } while (0)
+#define log_e(format,...) native_log(format,##__VA_ARGS__)
+#define log_w(format,...) native_log(format,##__VA_ARGS__)
+#define log_i(format,...) native_log(format,##__VA_ARGS__)
+#define log_d(format,...) native_log(format,##__VA_ARGS__)
+#define log_v(format,...) native_log(format,##__VA_ARGS__)
+#endif
+
+/********** time **********/
+inline unsigned long millis(void){
+  return (unsigned long)(uint32_t)(native::micros64() / 1000);
+}
+
+inline unsigned long micros(void){
+  return (unsigned long)(uint32_t)native::micros64();
+}
+
+inline void delay(uint32_t ms){
+  vTaskDelay(ms);
+}
+
+inline void delayMicroseconds(uint32_t us){
+  if (native::isFakeTime()) native::advanceUs(us);
+  else std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+inline void yield(void){
+  std::this_thread::yield();
+}
+
+/********** gpio **********/
+inline void pinMode(uint8_t pin,uint8_t mode){
+  if (pin < NATIVE_PINS) native::hal().pins[pin].mode = mode;
+}
+
+inline void digitalWrite(uint8_t pin,uint8_t val){
+  if (pin < NATIVE_PINS) native::hal().pins[pin].level = (val) ? HIGH : LOW;
+}
+
+inline int digitalRead(uint8_t pin){
+  if (pin >= NATIVE_PINS) return LOW;
+  return native::hal().pins[pin].level;
+}
+
+inline uint16_t analogRead(uint8_t pin){
+  if (pin >= NATIVE_PINS) return 0;
+  return native::hal().pins[pin].analog;
+}
+
+inline uint32_t analogReadMilliVolts(uint8_t pin){
+  return (uint32_t)analogRead(pin) * 3300 / 4095;
+}
+
+inline void analogReadResolution(uint8_t bits){
+  (void)bits;
+}
+
+inline void analogSetAttenuation(int attenuation){
+  (void)attenuation;
+}
+
+inline void attachInterrupt(uint8_t pin,void (*isr)(void),int mode){
+  if (pin >= NATIVE_PINS) return;
+  native::pinState &p = native::hal().pins[pin];
+  p.isr = isr;
+  p.isrArg = NULL;
+  p.intMode = mode;
+}
+
+inline void attachInterruptArg(uint8_t pin,void (*isr)(void *),void *arg,int mode){
+  if (pin >= NATIVE_PINS) return;
+  native::pinState &p = native::hal().pins[pin];
+  p.isr = NULL;
+  p.isrArg = isr;
+  p.arg = arg;
+  p.intMode = mode;
+}
+
+inline void detachInterrupt(uint8_t pin){
+  if (pin >= NATIVE_PINS) return;
+  native::pinState &p = native::hal().pins[pin];
+  p.isr = NULL;
+  p.isrArg = NULL;
+  p.intMode = 0;
+}
+
+#define interrupts() native::hal().critical.unlock()
+#define noInterrupts() native::hal().critical.lock()
+
+/********** hw-timer **********/
+inline hw_timer_t *timerBegin(uint8_t num,uint16_t divider,bool countUp){
+  (void)countUp;
+  if (num >= NATIVE_TIMERS) return NULL;
+  hw_timer_t *t = &native::hal().timers[num];
+  t->num = num;
+  t->divider = divider;
+  return t;
+}
+
+inline void timerEnd(hw_timer_t *timer){
+  timer->bEnabled = false;
+  timer->fn = NULL;
+}
+
+inline void timerAttachInterrupt(hw_timer_t *timer,void (*fn)(void),bool edge){
+  (void)edge;
+  timer->fn = fn;
+}
+
+inline void timerDetachInterrupt(hw_timer_t *timer){
+  timer->fn = NULL;
+}
+
+inline void timerAlarmWrite(hw_timer_t *timer,uint64_t alarm,bool autoreload){
+  timer->alarm = alarm;
+  timer->bAutoReload = autoreload;
+}
+
+inline void timerAlarmEnable(hw_timer_t *timer){
+  timer->bEnabled = true;
+}
+
+inline void timerAlarmDisable(hw_timer_t *timer){
+  timer->bEnabled = false;
+}
+
+/********** ledc **********/
+inline double ledcSetup(uint8_t channel,double freq,uint8_t resolution){
+  native::ledcState &l = native::hal().ledc[channel % NATIVE_LEDC];
+  l.freq = freq;
+  l.resolution = resolution;
+  return freq;
+}
+
+inline void ledcAttachPin(uint8_t pin,uint8_t channel){
+  native::hal().ledc[channel % NATIVE_LEDC].pin = pin;
+}
+
+inline void ledcDetachPin(uint8_t pin){
+  for (int i = 0;i < NATIVE_LEDC;i++){
+    if (native::hal().ledc[i].pin == pin) native::hal().ledc[i].pin = -1;
+  }
+}
+
+inline void ledcWrite(uint8_t channel,uint32_t duty){
+  native::hal().ledc[channel % NATIVE_LEDC].duty = duty;
+}
+
+inline uint32_t ledcRead(uint8_t channel){
+  return native::hal().ledc[channel % NATIVE_LEDC].duty;
+}
+
+inline double ledcWriteTone(uint8_t channel,double freq){
+  native::ledcState &l = native::hal().ledc[channel % NATIVE_LEDC];
+  l.freq = freq;
+  l.duty = (freq > 0) ? 0x1FF : 0;
+  l.freqChanges++;
+  return freq;
+}
+
+inline double ledcChangeFrequency(uint8_t channel,double freq,uint8_t resolution){
+  native::ledcState &l = native::hal().ledc[channel % NATIVE_LEDC];
+  l.freq = freq;
+  l.resolution = resolution;
+  l.freqChanges++;
+  return freq;
+}
+
+inline double ledcReadFreq(uint8_t channel){
+  return native::hal().ledc[channel % NATIVE_LEDC].freq;
+}
+
+/********** characters (WCharacter.h) **********/
+inline bool isAlphaNumeric(int c){ return isalnum(c) != 0; }
+inline bool isAlpha(int c){ return isalpha(c) != 0; }
+inline bool isAscii(int c){ return (c & ~0x7F) == 0; }
+inline bool isWhitespace(int c){ return isblank(c) != 0; }
+inline bool isControl(int c){ return iscntrl(c) != 0; }
+inline bool isDigit(int c){ return isdigit(c) != 0; }
+inline bool isGraph(int c){ return isgraph(c) != 0; }
+inline bool isLowerCase(int c){ return islower(c) != 0; }
+inline bool isPrintable(int c){ return isprint(c) != 0; }
+inline bool isPunct(int c){ return ispunct(c) != 0; }
+inline bool isSpace(int c){ return isspace(c) != 0; }
+inline bool isUpperCase(int c){ return isupper(c) != 0; }
+inline bool isHexadecimalDigit(int c){ return isxdigit(c) != 0; }
+inline int toAscii(int c){ return c & 0x7F; }
+
+/********** random **********/
+inline void randomSeed(unsigned long seed){
+  if (seed) srand(seed);
+}
+
+inline long random(long howbig){
+  if (howbig <= 0) return 0;
+  return rand() % howbig;
+}
+
+inline long random(long howsmall,long howbig){
+  if (howsmall >= howbig) return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+inline long map(long x,long in_min,long in_max,long out_min,long out_max){
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+/********** system **********/
+inline void *ps_malloc(size_t size){
+  return malloc(size);
+}
+
+inline void *ps_calloc(size_t n,size_t size){
+  return calloc(n,size);
+}
+
+inline void esp_restart(void){
+  exit(0);
+}
+
+inline uint32_t esp_random(void){
+  return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+class EspClass {
+public:
+  uint32_t getCycleCount(){
+    return (uint32_t)(native::micros64() * NATIVE_CPU_MHZ);
+  }
+  uint32_t getCpuFreqMHz(){
+    return NATIVE_CPU_MHZ;
+  }
+  uint64_t getEfuseMac(){
+    return 0x00000000AB8D56A4ULL;
+  }
+  uint32_t getFreeHeap(){
+    return heap_caps_get_free_size(0);
+  }
+  uint32_t getHeapSize(){
+    return 327680;
+  }
+  uint32_t getMinFreeHeap(){
+    return heap_caps_get_minimum_free_size(0);
+  }
+  uint32_t getMaxAllocHeap(){
+    return heap_caps_get_largest_free_block(0);
+  }
+  uint32_t getPsramSize(){
+    return 0;
+  }
+  uint32_t getFreePsram(){
+    return 0;
+  }
+  const char *getSdkVersion(){
+    return "native";
+  }
+  void restart(){
+    esp_restart();
+  }
+};
+
+inline EspClass ESP;
+
+/********** sntp / local time **********/
+inline void configTime(long gmtOffset_sec,int daylightOffset_sec,const char *server1,const char *server2 = NULL,const char *server3 = NULL){
+  (void)gmtOffset_sec;(void)daylightOffset_sec;(void)server1;(void)server2;(void)server3;
+}
+
+inline bool getLocalTime(struct tm *info,uint32_t ms = 5000){
+  (void)ms;
+  time_t now = time(NULL);
+  localtime_r(&now,info);
+  return (info->tm_year > (2016 - 1900));
+}
+
+#endif
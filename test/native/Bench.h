@@ -0,0 +1,184 @@
+/*!
+ * @file Bench.h
+ *
+ * benchmark-runner for host builds (env:native)
+ * measures cycles/op, allocations/op (count and bytes) and p50/p99 of single operations
+ * and the peak of heap in use (glibc only)
+ * include it in one file of a test-suite only (it replaces malloc/free to count allocations)
+ */
+
+#ifndef __NATIVE_BENCH_H__
+#define __NATIVE_BENCH_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <new>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace bench {
+
+struct counters {
+  std::atomic<uint64_t> allocs{0};
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<uint64_t> frees{0};
+  std::atomic<int64_t> inUse{0}; //bytes of heap in use
+  std::atomic<int64_t> peak{0}; //max. of inUse since start of peakHeap
+};
+
+inline counters &count(){
+  static counters c;
+  return c;
+}
+
+//host cycle-counter (tsc on x86), elsewhere nanoseconds
+inline uint64_t cycles(){
+#if defined(__x86_64__) || defined(__i386__)
+  uint32_t lo,hi;
+  __asm__ __volatile__("rdtsc" : "=a"(lo),"=d"(hi));
+  return ((uint64_t)hi << 32) | lo;
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+typedef struct {
+  const char *name;
+  uint32_t ops;
+  double cyclesPerOp; //mean
+  double nsPerOp; //mean
+  double allocsPerOp;
+  double bytesPerOp;
+  uint64_t p50; //cycles
+  uint64_t p99; //cycles
+  uint64_t max; //cycles
+} result;
+
+//runs fn(i) ops times, each call is one sample
+template <typename F> result run(const char *name,uint32_t ops,F fn){
+  std::vector<uint64_t> samples(ops);
+  uint64_t allocs = count().allocs;
+  uint64_t bytes = count().bytes;
+  auto tStart = std::chrono::steady_clock::now();
+  uint64_t total = 0;
+  for (uint32_t i = 0;i < ops;i++){
+    uint64_t t0 = cycles();
+    fn(i);
+    uint64_t t = cycles() - t0;
+    samples[i] = t;
+    total += t;
+  }
+  double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tStart).count();
+  result r;
+  r.name = name;
+  r.ops = ops;
+  r.cyclesPerOp = (ops) ? (double)total / ops : 0;
+  r.nsPerOp = (ops) ? ns / ops : 0;
+  r.allocsPerOp = (ops) ? (double)(count().allocs - allocs) / ops : 0;
+  r.bytesPerOp = (ops) ? (double)(count().bytes - bytes) / ops : 0;
+  std::sort(samples.begin(),samples.end());
+  r.p50 = (ops) ? samples[ops / 2] : 0;
+  r.p99 = (ops) ? samples[std::min<uint32_t>(ops - 1,(uint32_t)((uint64_t)ops * 99 / 100))] : 0;
+  r.max = (ops) ? samples[ops - 1] : 0;
+  return r;
+}
+
+inline void print(const result &r){
+  printf("bench %-32s ops=%-8u cycles/op=%-10.0f ns/op=%-10.1f allocs/op=%-6.2f bytes/op=%-8.1f p50=%llu p99=%llu max=%llu\n",
+         r.name,r.ops,r.cyclesPerOp,r.nsPerOp,r.allocsPerOp,r.bytesPerOp,
+         (unsigned long long)r.p50,(unsigned long long)r.p99,(unsigned long long)r.max);
+  fflush(stdout);
+}
+
+//allocations done by fn (count), e.g. for a whole simulated run
+template <typename F> uint64_t allocations(F fn){
+  uint64_t allocs = count().allocs;
+  fn();
+  return count().allocs - allocs;
+}
+
+//peak of heap in use during fn, above the usage at start [bytes]
+template <typename F> int64_t peakHeap(F fn){
+  int64_t start = count().inUse;
+  count().peak = start;
+  fn();
+  return count().peak - start;
+}
+
+inline void used(int64_t bytes){
+  int64_t act = count().inUse += bytes;
+  int64_t peak = count().peak;
+  while ((act > peak) && (!count().peak.compare_exchange_weak(peak,act)));
+}
+
+}
+
+//count all allocations of the process (Strings, containers, new)
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n,size_t size);
+void *__libc_realloc(void *ptr,size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(size_t size){
+  bench::count().allocs++;
+  bench::count().bytes += size;
+  void *p = __libc_malloc(size);
+  if (p) bench::used(malloc_usable_size(p));
+  return p;
+}
+
+void *calloc(size_t n,size_t size){
+  bench::count().allocs++;
+  bench::count().bytes += n * size;
+  void *p = __libc_calloc(n,size);
+  if (p) bench::used(malloc_usable_size(p));
+  return p;
+}
+
+void *realloc(void *ptr,size_t size){
+  bench::count().allocs++;
+  bench::count().bytes += size;
+  int64_t old = (ptr) ? malloc_usable_size(ptr) : 0;
+  void *p = __libc_realloc(ptr,size);
+  if (p) bench::used((int64_t)malloc_usable_size(p) - old);
+  else if (size == 0) bench::used(-old);
+  return p;
+}
+
+void free(void *ptr){
+  if (ptr){
+    bench::count().frees++;
+    bench::used(-(int64_t)malloc_usable_size(ptr));
+  }
+  __libc_free(ptr);
+}
+}
+#else
+void *operator new(size_t size){
+  bench::count().allocs++;
+  bench::count().bytes += size;
+  void *p = malloc(size);
+  if (p == NULL) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *ptr) noexcept {
+  if (ptr) bench::count().frees++;
+  free(ptr);
+}
+
+void operator delete(void *ptr,size_t size) noexcept {
+  (void)size;
+  operator delete(ptr);
+}
+#endif
+
+#endif
@@ -0,0 +1,76 @@
+/*!
+ * @file DallasTemperature.h
+ *
+ * DS18B20 temperature-sensor for host builds (env:native)
+ * the test sets presence and temperature with native::ds18b20()
+ */
+
+#ifndef __NATIVE_DALLASTEMPERATURE_H__
+#define __NATIVE_DALLASTEMPERATURE_H__
+
+#include <stdint.h>
+#include <string.h>
+#include "OneWire.h"
+
+#define DEVICE_DISCONNECTED_C -127
+
+typedef uint8_t DeviceAddress[8];
+
+namespace native {
+
+struct ds18b20State {
+  bool bPresent = false;
+  float temp = 20.0;
+};
+
+inline ds18b20State &ds18b20(){
+  static ds18b20State state;
+  return state;
+}
+
+}
+
+class DallasTemperature {
+public:
+  DallasTemperature(){}
+  DallasTemperature(OneWire *oneWire) : _oneWire(oneWire){}
+  void setOneWire(OneWire *oneWire){
+    _oneWire = oneWire;
+  }
+  void begin(void){}
+  uint8_t getDeviceCount(void){
+    return (native::ds18b20().bPresent) ? 1 : 0;
+  }
+  bool getAddress(uint8_t *adr,uint8_t index){
+    if ((index > 0) || (!native::ds18b20().bPresent)) return false;
+    const uint8_t sensorAdr[8] = {0x28,0xFF,0x64,0x1E,0x0C,0x00,0x00,0x7B};
+    memcpy(adr,sensorAdr,sizeof(sensorAdr));
+    return true;
+  }
+  bool isConnected(const uint8_t *adr){
+    (void)adr;
+    return native::ds18b20().bPresent;
+  }
+  bool readPowerSupply(const uint8_t *adr = NULL){
+    (void)adr;
+    return false;
+  }
+  bool setResolution(const uint8_t *adr,uint8_t resolution,bool skipGlobalBitResolutionCalculation = false){
+    (void)adr;(void)resolution;(void)skipGlobalBitResolutionCalculation;
+    return true;
+  }
+  void setWaitForConversion(bool flag){
+    (void)flag;
+  }
+  void requestTemperatures(void){}
+  float getTempC(const uint8_t *adr){
+    (void)adr;
+    if (!native::ds18b20().bPresent) return DEVICE_DISCONNECTED_C;
+    return native::ds18b20().temp;
+  }
+
+private:
+  OneWire *_oneWire = NULL;
+};
+
+#endif
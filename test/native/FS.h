@@ -0,0 +1,191 @@
+/*!
+ * @file FS.h
+ *
+ * Arduino FS/File for host builds (env:native)
+ * files live in a temporary directory of the test-process
+ * writes, which would grow the files over totalBytes, are cut like on a full spiffs
+ */
+
+#ifndef __NATIVE_FS_H__
+#define __NATIVE_FS_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <memory>
+#include <string>
+#include <filesystem>
+#include "Stream.h"
+
+namespace fs {
+
+class FS;
+
+enum SeekMode {
+  SeekSet = 0,
+  SeekCur = 1,
+  SeekEnd = 2
+};
+
+class File : public Stream {
+public:
+  File(){}
+  File(FILE *f,const std::string &path,FS *pFs) : _f(f,fclose),_path(path),_fs(pFs){}
+
+  using Print::write;
+  size_t write(uint8_t c){
+    return write(&c,1);
+  }
+  size_t write(const uint8_t *buf,size_t size);
+  int available(){
+    if (!_f) return 0;
+    return size() - position();
+  }
+  int read(){
+    if (!_f) return -1;
+    return fgetc(_f.get());
+  }
+  size_t read(uint8_t *buf,size_t size){
+    if (!_f) return 0;
+    return fread(buf,1,size,_f.get());
+  }
+  size_t readBytes(char *buffer,size_t length){
+    return read((uint8_t *)buffer,length);
+  }
+  int peek(){
+    if (!_f) return -1;
+    int c = fgetc(_f.get());
+    if (c >= 0) ungetc(c,_f.get());
+    return c;
+  }
+  void flush(){
+    if (_f) fflush(_f.get());
+  }
+  bool seek(uint32_t pos,SeekMode mode = SeekSet){
+    if (!_f) return false;
+    int whence = (mode == SeekCur) ? SEEK_CUR : (mode == SeekEnd) ? SEEK_END : SEEK_SET;
+    return (fseek(_f.get(),pos,whence) == 0);
+  }
+  size_t position() const {
+    if (!_f) return 0;
+    return ftell(_f.get());
+  }
+  size_t size() const {
+    if (!_f) return 0;
+    long pos = ftell(_f.get());
+    fseek(_f.get(),0,SEEK_END);
+    long len = ftell(_f.get());
+    fseek(_f.get(),pos,SEEK_SET);
+    return len;
+  }
+  void close(){
+    _f.reset();
+  }
+  operator bool() const {
+    return (bool)_f;
+  }
+  const char *name() const {
+    return _path.c_str();
+  }
+  bool isDirectory(void){
+    return false;
+  }
+
+private:
+  std::shared_ptr<FILE> _f;
+  std::string _path;
+  FS *_fs = NULL;
+};
+
+class FS {
+public:
+  FS(){}
+  virtual ~FS(){
+    std::error_code ec;
+    if (_root.size()) std::filesystem::remove_all(_root,ec);
+  }
+  File open(const char *path,const char *mode = "r",const bool create = false){
+    (void)create;
+    std::string fullPath = root() + path;
+    const char *hostMode = mode;
+    if (strcmp(mode,"r") == 0) hostMode = "rb";
+    else if (strcmp(mode,"r+") == 0) hostMode = "r+b";
+    else if (strcmp(mode,"w") == 0) hostMode = "wb";
+    else if (strcmp(mode,"w+") == 0) hostMode = "w+b";
+    else if (strcmp(mode,"a") == 0) hostMode = "ab";
+    else if (strcmp(mode,"a+") == 0) hostMode = "a+b";
+    FILE *f = fopen(fullPath.c_str(),hostMode);
+    if (f == NULL) return File();
+    return File(f,path,this);
+  }
+  File open(const String &path,const char *mode = "r"){
+    return open(path.c_str(),mode);
+  }
+  bool exists(const char *path){
+    return std::filesystem::exists(root() + path);
+  }
+  bool exists(const String &path){
+    return exists(path.c_str());
+  }
+  bool remove(const char *path){
+    std::error_code ec;
+    return std::filesystem::remove(root() + path,ec);
+  }
+  bool remove(const String &path){
+    return remove(path.c_str());
+  }
+  bool rename(const char *pathFrom,const char *pathTo){
+    std::error_code ec;
+    std::filesystem::rename(root() + pathFrom,root() + pathTo,ec);
+    return !ec;
+  }
+  virtual size_t totalBytes(){
+    return SIZE_MAX;
+  }
+  size_t usedBytes(){
+    size_t used = 0;
+    std::error_code ec;
+    for (auto &entry : std::filesystem::directory_iterator(root(),ec)){
+      if (entry.is_regular_file()) used += entry.file_size();
+    }
+    return used;
+  }
+
+protected:
+  const std::string &root(){
+    if (_root.size() == 0){
+      char dirName[] = "/tmp/native_fsXXXXXX";
+      if (mkdtemp(dirName)) _root = dirName;
+    }
+    return _root;
+  }
+  std::string _root;
+};
+
+inline size_t File::write(const uint8_t *buf,size_t size){
+  if (!_f) return 0;
+  size_t pos = position();
+  size_t len = this->size();
+  if ((_fs) && (pos + size > len)){
+    //file grows --> only as far as there is space
+    fflush(_f.get());
+    size_t used = _fs->usedBytes();
+    size_t total = _fs->totalBytes();
+    size_t avail = (total > used) ? total - used : 0;
+    size_t growth = pos + size - len;
+    if (growth > avail) size -= growth - avail;
+  }
+  return fwrite(buf,1,size,_f.get());
+}
+
+}
+
+using fs::File;
+using fs::FS;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+#endif
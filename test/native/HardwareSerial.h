@@ -0,0 +1,108 @@
+/*!
+ * @file HardwareSerial.h
+ *
+ * Arduino HardwareSerial for host builds (env:native)
+ * received bytes are injected by the test, sent bytes are captured (and echoed for Serial if enabled)
+ */
+
+#ifndef __NATIVE_HARDWARESERIAL_H__
+#define __NATIVE_HARDWARESERIAL_H__
+
+#include <stdio.h>
+#include <deque>
+#include <string>
+#include <mutex>
+#include "Stream.h"
+
+#define SERIAL_8N1 0x800001c
+
+class HardwareSerial : public Stream {
+public:
+  HardwareSerial(int uart_nr) : _uart_nr(uart_nr){}
+
+  void begin(unsigned long baud,uint32_t config = SERIAL_8N1,int8_t rxPin = -1,int8_t txPin = -1,bool invert = false,unsigned long timeout_ms = 20000UL){
+    (void)config;(void)rxPin;(void)txPin;(void)invert;(void)timeout_ms;
+    _baud = baud;
+  }
+  void end(){}
+  void updateBaudRate(unsigned long baud){
+    _baud = baud;
+  }
+  uint32_t baudRate(){
+    return _baud;
+  }
+  void setRxBufferSize(size_t size){
+    (void)size;
+  }
+  void setDebugOutput(bool b){
+    (void)b;
+  }
+  int available(){
+    std::lock_guard<std::mutex> lock(_m);
+    return _rx.size();
+  }
+  int availableForWrite(){
+    return 128;
+  }
+  int peek(){
+    std::lock_guard<std::mutex> lock(_m);
+    if (_rx.empty()) return -1;
+    return _rx.front();
+  }
+  int read(){
+    std::lock_guard<std::mutex> lock(_m);
+    if (_rx.empty()) return -1;
+    uint8_t c = _rx.front();
+    _rx.pop_front();
+    return c;
+  }
+  using Print::write;
+  size_t write(uint8_t c){
+    return write(&c,1);
+  }
+  size_t write(const uint8_t *buffer,size_t size){
+    std::lock_guard<std::mutex> lock(_m);
+    if (_bCapture) _tx.append((const char *)buffer,size);
+    if (_bEcho) fwrite(buffer,1,size,stdout);
+    return size;
+  }
+  operator bool() const {
+    return true;
+  }
+
+  //test-side
+  void inject(const uint8_t *buffer,size_t size){
+    std::lock_guard<std::mutex> lock(_m);
+    _rx.insert(_rx.end(),buffer,buffer + size);
+  }
+  void inject(const char *str){
+    inject((const uint8_t *)str,strlen(str));
+  }
+  std::string takeOutput(){
+    std::lock_guard<std::mutex> lock(_m);
+    std::string ret;
+    ret.swap(_tx);
+    return ret;
+  }
+  void setCapture(bool bCapture){
+    _bCapture = bCapture;
+  }
+  void setEcho(bool bEcho){
+    _bEcho = bEcho;
+  }
+
+protected:
+  int _uart_nr;
+  unsigned long _baud = 0;
+  std::mutex _m;
+  std::deque<uint8_t> _rx;
+  std::string _tx;
+  bool _bCapture = false;
+  bool _bEcho = false;
+};
+
+inline HardwareSerial Serial(0);
+inline HardwareSerial Serial1(1);
+inline HardwareSerial Serial2(2);
+
+#endif
@@ -0,0 +1,70 @@
+/*!
+ * @file IPAddress.h
+ *
+ * Arduino IPAddress for host builds (env:native)
+ */
+
+#ifndef __NATIVE_IPADDRESS_H__
+#define __NATIVE_IPADDRESS_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include "WString.h"
+
+class IPAddress {
+public:
+  IPAddress(){
+    _address.dword = 0;
+  }
+  IPAddress(uint8_t b1,uint8_t b2,uint8_t b3,uint8_t b4){
+    _address.bytes[0] = b1;
+    _address.bytes[1] = b2;
+    _address.bytes[2] = b3;
+    _address.bytes[3] = b4;
+  }
+  IPAddress(uint32_t address){
+    _address.dword = address;
+  }
+  bool fromString(const char *address){
+    unsigned int b[4];
+    if (sscanf(address,"%u.%u.%u.%u",&b[0],&b[1],&b[2],&b[3]) != 4) return false;
+    for (int i = 0;i < 4;i++){
+      if (b[i] > 255) return false;
+      _address.bytes[i] = b[i];
+    }
+    return true;
+  }
+  bool fromString(const String &address){
+    return fromString(address.c_str());
+  }
+  operator uint32_t() const {
+    return _address.dword;
+  }
+  bool operator==(const IPAddress &addr) const {
+    return _address.dword == addr._address.dword;
+  }
+  bool operator!=(const IPAddress &addr) const {
+    return _address.dword != addr._address.dword;
+  }
+  uint8_t operator[](int index) const {
+    return _address.bytes[index];
+  }
+  uint8_t &operator[](int index){
+    return _address.bytes[index];
+  }
+  String toString() const {
+    char buf[16];
+    snprintf(buf,sizeof(buf),"%u.%u.%u.%u",_address.bytes[0],_address.bytes[1],_address.bytes[2],_address.bytes[3]);
+    return String(buf);
+  }
+
+private:
+  union {
+    uint8_t bytes[4];
+    uint32_t dword;
+  } _address;
+};
+
+inline const IPAddress INADDR_NONE(0,0,0,0);
+
+#endif
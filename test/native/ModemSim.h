@@ -0,0 +1,112 @@
+/*!
+ * @file ModemSim.h
+ *
+ * stand-in for a gsm-modem with several sockets for host builds (env:native)
+ * every socket-operation takes the AT-latency of the modem, overlapping operations are counted
+ * (a real modem has one uart --> all AT-traffic has to be serialized)
+ */
+
+#ifndef __NATIVE_MODEMSIM_H__
+#define __NATIVE_MODEMSIM_H__
+
+#include <atomic>
+#include <vector>
+#include "WiFi.h"
+
+class ModemSim {
+public:
+  typedef struct {
+    uint8_t socket;
+    char op; //c=connect, w=write, a=available, r=read, s=stop, ?=connected
+    uint32_t len;
+  } logEntry;
+
+  void enter(uint8_t socket,char op,uint32_t len){
+    if (busy.exchange(true)) overlaps++;
+    {
+      std::lock_guard<std::mutex> lock(_m);
+      opLog.push_back({socket,op,len});
+    }
+    if (latencyMs) std::this_thread::sleep_for(std::chrono::milliseconds(latencyMs));
+  }
+  void leave(void){
+    busy = false;
+  }
+  std::vector<logEntry> takeLog(void){
+    std::lock_guard<std::mutex> lock(_m);
+    std::vector<logEntry> ret;
+    ret.swap(opLog);
+    return ret;
+  }
+  uint32_t latencyMs = 0; //time of one AT-exchange
+  uint32_t maxWrite = 1460; //bytes per send-command
+  std::atomic<uint32_t> overlaps{0};
+
+private:
+  std::atomic<bool> busy{false};
+  std::mutex _m;
+  std::vector<logEntry> opLog;
+};
+
+//socket of the simulated modem, server-side like WiFiClient (inject/takeOutput)
+class ModemSimSocket : public WiFiClient {
+public:
+  ModemSimSocket(ModemSim *sim,uint8_t socket) : _sim(sim),_socket(socket){}
+  int connect(IPAddress ip,uint16_t port){
+    _sim->enter(_socket,'c',0);
+    int ret = WiFiClient::connect(ip,port);
+    _sim->leave();
+    return ret;
+  }
+  int connect(const char *host,uint16_t port){
+    _sim->enter(_socket,'c',0);
+    int ret = WiFiClient::connect(host,port);
+    _sim->leave();
+    return ret;
+  }
+  using Print::write;
+  size_t write(uint8_t c){
+    return write(&c,1);
+  }
+  size_t write(const uint8_t *buf,size_t size){
+    if (size > _sim->maxWrite) size = _sim->maxWrite;
+    _sim->enter(_socket,'w',size);
+    size_t ret = WiFiClient::write(buf,size);
+    _sim->leave();
+    return ret;
+  }
+  int available(){
+    _sim->enter(_socket,'a',0);
+    int ret = WiFiClient::available();
+    _sim->leave();
+    return ret;
+  }
+  int read(){
+    uint8_t c;
+    if (read(&c,1) == 1) return c;
+    return -1;
+  }
+  int read(uint8_t *buf,size_t size){
+    _sim->enter(_socket,'r',size);
+    int ret = WiFiClient::read(buf,size);
+    _sim->leave();
+    return ret;
+  }
+  void stop(){
+    _sim->enter(_socket,'s',0);
+    WiFiClient::stop();
+    _sim->leave();
+  }
+  uint8_t connected(){
+    _sim->enter(_socket,'?',0);
+    uint8_t ret = WiFiClient::connected();
+    _sim->leave();
+    return ret;
+  }
+
+private:
+  ModemSim *_sim;
+  uint8_t _socket;
+};
+
+#endif
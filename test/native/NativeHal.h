@@ -0,0 +1,161 @@
+/*!
+ * @file NativeHal.h
+ *
+ * state behind the host shims: clock, gpio, interrupts, hw-timers and ledc
+ * tests drive it to simulate time and hardware events
+ */
+
+#ifndef __NATIVE_HAL_H__
+#define __NATIVE_HAL_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+
+#define NATIVE_PINS 48
+#define NATIVE_LEDC 16
+#define NATIVE_TIMERS 4
+#define NATIVE_CPU_MHZ 240
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x02
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+#define OPEN_DRAIN 0x10
+#define OUTPUT_OPEN_DRAIN 0x12
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define ONLOW 0x04
+#define ONHIGH 0x05
+
+typedef struct hw_timer_s {
+  uint8_t num;
+  uint16_t divider;
+  bool bEnabled;
+  bool bAutoReload;
+  uint64_t alarm; //[ticks]
+  void (*fn)(void);
+} hw_timer_t;
+
+namespace native {
+
+struct pinState {
+  uint8_t mode;
+  uint8_t level;
+  uint16_t analog;
+  int intMode; //0 --> no interrupt
+  void (*isr)(void);
+  void (*isrArg)(void *);
+  void *arg;
+};
+
+struct ledcState {
+  double freq;
+  uint8_t resolution;
+  uint32_t duty;
+  int8_t pin;
+  uint32_t freqChanges; //count of frequency-writes
+};
+
+struct halState {
+  std::atomic<bool> bFakeTime{false};
+  std::atomic<int64_t> fakeUs{0};
+  std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+  pinState pins[NATIVE_PINS];
+  ledcState ledc[NATIVE_LEDC];
+  hw_timer_t timers[NATIVE_TIMERS];
+  std::recursive_mutex critical; //one lock for all critical sections, like interrupts off
+  halState(){
+    memset(pins,0,sizeof(pins));
+    memset(ledc,0,sizeof(ledc));
+    memset(timers,0,sizeof(timers));
+  }
+};
+
+inline halState &hal(){
+  static halState state;
+  return state;
+}
+
+//time [us] since start of the process, or the simulated time
+inline int64_t micros64(){
+  halState &h = hal();
+  if (h.bFakeTime) return h.fakeUs;
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - h.tStart).count();
+}
+
+//simulated time: millis(), micros(), cycle-counter and tick-count follow setTime/advance
+inline void setTime(int64_t us){
+  hal().fakeUs = us;
+  hal().bFakeTime = true;
+}
+
+inline void advanceUs(int64_t us){
+  hal().fakeUs += us;
+}
+
+inline void advanceMs(int64_t ms){
+  hal().fakeUs += ms * 1000;
+}
+
+inline void realTime(void){
+  hal().bFakeTime = false;
+}
+
+inline bool isFakeTime(void){
+  return hal().bFakeTime;
+}
+
+//analog value for analogRead
+inline void setAnalog(uint8_t pin,uint16_t value){
+  if (pin < NATIVE_PINS) hal().pins[pin].analog = value;
+}
+
+//changes the level of an input, calls the attached isr on a matching edge
+inline void setPin(uint8_t pin,uint8_t level){
+  if (pin >= NATIVE_PINS) return;
+  pinState &p = hal().pins[pin];
+  uint8_t old = p.level;
+  p.level = level;
+  bool bFire = false;
+  switch (p.intMode){
+    case RISING: bFire = ((old == LOW) && (level == HIGH)); break;
+    case FALLING: bFire = ((old == HIGH) && (level == LOW)); break;
+    case CHANGE: bFire = (old != level); break;
+    case ONLOW: bFire = (level == LOW); break;
+    case ONHIGH: bFire = (level == HIGH); break;
+  }
+  if (!bFire) return;
+  if (p.isr) p.isr();
+  if (p.isrArg) p.isrArg(p.arg);
+}
+
+//one pulse (rising + falling edge), e.g. anemometer or dio0 of the radio
+inline void pulsePin(uint8_t pin){
+  setPin(pin,HIGH);
+  setPin(pin,LOW);
+}
+
+//calls the isr of an enabled hw-timer, like the alarm would
+inline void fireTimer(uint8_t num){
+  if (num >= NATIVE_TIMERS) return;
+  hw_timer_t &t = hal().timers[num];
+  if ((t.bEnabled) && (t.fn)) t.fn();
+}
+
+inline const ledcState &getLedc(uint8_t channel){
+  return hal().ledc[channel % NATIVE_LEDC];
+}
+
+}
+
+#endif
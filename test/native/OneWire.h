@@ -0,0 +1,27 @@
+/*!
+ * @file OneWire.h
+ *
+ * OneWire bus for host builds (env:native), used only through DallasTemperature.h
+ */
+
+#ifndef __NATIVE_ONEWIRE_H__
+#define __NATIVE_ONEWIRE_H__
+
+#include <stdint.h>
+
+class OneWire {
+public:
+  OneWire(){}
+  OneWire(uint8_t pin) : _pin(pin){}
+  void begin(uint8_t pin){
+    _pin = pin;
+  }
+  uint8_t getPin(){
+    return _pin;
+  }
+
+private:
+  uint8_t _pin = 0xFF;
+};
+
+#endif
@@ -0,0 +1,109 @@
+/*!
+ * @file Print.h
+ *
+ * Arduino Print for host builds (env:native)
+ */
+
+#ifndef __NATIVE_PRINT_H__
+#define __NATIVE_PRINT_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print {
+public:
+  virtual ~Print(){}
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t *buffer,size_t size){
+    size_t n = 0;
+    while (size--){
+      if (write(*buffer++)) n++;
+      else break;
+    }
+    return n;
+  }
+  size_t write(const char *str){
+    if (str == NULL) return 0;
+    return write((const uint8_t *)str,strlen(str));
+  }
+  size_t write(const char *buffer,size_t size){
+    return write((const uint8_t *)buffer,size);
+  }
+  virtual void flush(){}
+
+  size_t printf(const char *format,...) __attribute__((format(printf,2,3))){
+    char buf[256];
+    va_list arg;
+    va_start(arg,format);
+    int len = vsnprintf(buf,sizeof(buf),format,arg);
+    va_end(arg);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(buf)) return write((const uint8_t *)buf,len);
+    char *temp = (char *)malloc(len + 1);
+    if (temp == NULL) return 0;
+    va_start(arg,format);
+    vsnprintf(temp,len + 1,format,arg);
+    va_end(arg);
+    len = write((const uint8_t *)temp,len);
+    free(temp);
+    return len;
+  }
+  size_t print(const __FlashStringHelper *s){
+    return print((const char *)s);
+  }
+  size_t print(const String &s){
+    return write(s.c_str(),s.length());
+  }
+  size_t print(const char *s){
+    return write(s);
+  }
+  size_t print(char c){
+    return write((uint8_t)c);
+  }
+  size_t print(unsigned char n,int base = DEC){
+    return print((unsigned long long)n,base);
+  }
+  size_t print(int n,int base = DEC){
+    return print((long long)n,base);
+  }
+  size_t print(unsigned int n,int base = DEC){
+    return print((unsigned long long)n,base);
+  }
+  size_t print(long n,int base = DEC){
+    return print((long long)n,base);
+  }
+  size_t print(unsigned long n,int base = DEC){
+    return print((unsigned long long)n,base);
+  }
+  size_t print(long long n,int base = DEC){
+    if ((base == DEC) || (n >= 0)) return print(String(n,(unsigned char)base));
+    return print(String((unsigned long long)n,(unsigned char)base));
+  }
+  size_t print(unsigned long long n,int base = DEC){
+    return print(String(n,(unsigned char)base));
+  }
+  size_t print(double n,int digits = 2){
+    return print(String(n,(unsigned int)digits));
+  }
+  size_t println(void){
+    return print("\r\n");
+  }
+  template <typename T> size_t println(const T &value){
+    size_t n = print(value);
+    return n + println();
+  }
+  template <typename T> size_t println(const T &value,int format){
+    size_t n = print(value,format);
+    return n + println();
+  }
+};
+
+#endif
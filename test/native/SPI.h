@@ -0,0 +1,80 @@
+/*!
+ * @file SPI.h
+ *
+ * Arduino SPI for host builds (env:native)
+ * transfers go to an optional device-callback of the test, otherwise 0 is read
+ */
+
+#ifndef __NATIVE_SPI_H__
+#define __NATIVE_SPI_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x01
+#define SPI_MODE2 0x02
+#define SPI_MODE3 0x03
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+class SPISettings {
+public:
+  SPISettings() : _clock(1000000),_bitOrder(MSBFIRST),_dataMode(SPI_MODE0){}
+  SPISettings(uint32_t clock,uint8_t bitOrder,uint8_t dataMode) : _clock(clock),_bitOrder(bitOrder),_dataMode(dataMode){}
+  uint32_t _clock;
+  uint8_t _bitOrder;
+  uint8_t _dataMode;
+};
+
+class SPIClass {
+public:
+  typedef uint8_t (*device_t)(uint8_t out,bool bFirst); //bFirst --> first byte of transaction (register-address)
+
+  void begin(int8_t sck = -1,int8_t miso = -1,int8_t mosi = -1,int8_t ss = -1){
+    (void)sck;(void)miso;(void)mosi;(void)ss;
+  }
+  void end(){}
+  void usingInterrupt(int interruptNumber){
+    (void)interruptNumber;
+  }
+  void notUsingInterrupt(int interruptNumber){
+    (void)interruptNumber;
+  }
+  void beginTransaction(SPISettings settings){
+    _settings = settings;
+    _bFirst = true;
+  }
+  void endTransaction(void){}
+  uint8_t transfer(uint8_t data){
+    uint8_t ret = (_device) ? _device(data,_bFirst) : 0;
+    _bFirst = false;
+    return ret;
+  }
+  void transferBytes(const uint8_t *data,uint8_t *out,uint32_t size){
+    for (uint32_t i = 0;i < size;i++){
+      uint8_t ret = transfer((data) ? data[i] : 0xFF);
+      if (out) out[i] = ret;
+    }
+  }
+  void transfer(void *data,uint32_t size){
+    transferBytes((const uint8_t *)data,(uint8_t *)data,size);
+  }
+  void writeBytes(const uint8_t *data,uint32_t size){
+    transferBytes(data,NULL,size);
+  }
+
+  //test-side
+  void setDevice(device_t device){
+    _device = device;
+  }
+
+private:
+  SPISettings _settings;
+  device_t _device = NULL;
+  bool _bFirst = true;
+};
+
+inline SPIClass SPI;
+
+#endif
@@ -0,0 +1,44 @@
+/*!
+ * @file SPIFFS.h
+ *
+ * SPIFFS for host builds (env:native)
+ * size is the spiffs-partition of min_spiffs.csv, tests can change it with setTotalBytes
+ */
+
+#ifndef __NATIVE_SPIFFS_H__
+#define __NATIVE_SPIFFS_H__
+
+#include "FS.h"
+
+namespace fs {
+
+class SPIFFSFS : public FS {
+public:
+  bool begin(bool formatOnFail = false,const char *basePath = "/spiffs",uint8_t maxOpenFiles = 10,const char *partitionLabel = NULL){
+    (void)formatOnFail;(void)basePath;(void)maxOpenFiles;(void)partitionLabel;
+    return root().size() > 0;
+  }
+  bool format(){
+    std::error_code ec;
+    for (auto &entry : std::filesystem::directory_iterator(root(),ec)) std::filesystem::remove_all(entry.path(),ec);
+    return true;
+  }
+  void end(){}
+  size_t totalBytes(){
+    return _totalBytes;
+  }
+
+  //test-side
+  void setTotalBytes(size_t totalBytes){
+    _totalBytes = totalBytes;
+  }
+
+private:
+  size_t _totalBytes = 0x30000;
+};
+
+}
+
+inline fs::SPIFFSFS SPIFFS;
+
+#endif
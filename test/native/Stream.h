@@ -0,0 +1,122 @@
+/*!
+ * @file Stream.h
+ *
+ * Arduino Stream for host builds (env:native)
+ */
+
+#ifndef __NATIVE_STREAM_H__
+#define __NATIVE_STREAM_H__
+
+#include "Print.h"
+#include "NativeHal.h"
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout){
+    _timeout = timeout;
+  }
+  unsigned long getTimeout(void){
+    return _timeout;
+  }
+  virtual size_t readBytes(char *buffer,size_t length){
+    size_t count = 0;
+    while (count < length){
+      int c = read();
+      if (c < 0) break;
+      *buffer++ = (char)c;
+      count++;
+    }
+    return count;
+  }
+  size_t readBytes(uint8_t *buffer,size_t length){
+    return readBytes((char *)buffer,length);
+  }
+  size_t readBytesUntil(char terminator,char *buffer,size_t length){
+    size_t index = 0;
+    while (index < length){
+      int c = read();
+      if ((c < 0) || (c == terminator)) break;
+      *buffer++ = (char)c;
+      index++;
+    }
+    return index;
+  }
+  String readString(){
+    String ret;
+    int c = read();
+    while (c >= 0){
+      ret += (char)c;
+      c = read();
+    }
+    return ret;
+  }
+  String readStringUntil(char terminator){
+    String ret;
+    int c = read();
+    while ((c >= 0) && (c != terminator)){
+      ret += (char)c;
+      c = read();
+    }
+    return ret;
+  }
+  bool find(const char *target){
+    size_t len = strlen(target);
+    size_t index = 0;
+    if (len == 0) return true;
+    int c;
+    while ((c = read()) >= 0){
+      if (c == target[index]){
+        if (++index >= len) return true;
+      }else{
+        index = (c == target[0]) ? 1 : 0;
+      }
+    }
+    return false;
+  }
+  bool find(char *target){
+    return find((const char *)target);
+  }
+  long parseInt(){
+    int c;
+    while (((c = peek()) >= 0) && (c != '-') && ((c < '0') || (c > '9'))) read();
+    bool bNegative = false;
+    long value = 0;
+    if (c == '-'){
+      bNegative = true;
+      read();
+    }
+    while (((c = peek()) >= '0') && (c <= '9')){
+      value = value * 10 + c - '0';
+      read();
+    }
+    return (bNegative) ? -value : value;
+  }
+
+protected:
+  //read with timeout like the arduino-core (the clock follows NativeHal.h)
+  int timedRead(){
+    int64_t tStart = native::micros64();
+    do {
+      int c = read();
+      if (c >= 0) return c;
+      std::this_thread::yield();
+    } while ((!native::isFakeTime()) && ((native::micros64() - tStart) < (int64_t)_timeout * 1000));
+    return -1;
+  }
+  int timedPeek(){
+    int64_t tStart = native::micros64();
+    do {
+      int c = peek();
+      if (c >= 0) return c;
+      std::this_thread::yield();
+    } while ((!native::isFakeTime()) && ((native::micros64() - tStart) < (int64_t)_timeout * 1000));
+    return -1;
+  }
+  unsigned long _timeout = 1000;
+};
+
+#endif
@@ -0,0 +1,536 @@
+/*!
+ * @file WString.h
+ *
+ * Arduino String for host builds (env:native)
+ * heap-buffer like the arduino core, so allocations/op of the benchmarks are comparable
+ */
+
+#ifndef __NATIVE_WSTRING_H__
+#define __NATIVE_WSTRING_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+class StringSumHelper;
+
+class String {
+public:
+  String(const char *cstr = ""){
+    init();
+    if (cstr) copy(cstr,strlen(cstr));
+  }
+  String(const String &str){
+    init();
+    *this = str;
+  }
+  String(String &&rval){
+    init();
+    move(rval);
+  }
+  String(const __FlashStringHelper *str){
+    init();
+    if (str) copy((const char *)str,strlen((const char *)str));
+  }
+  explicit String(char c){
+    init();
+    char buf[2] = {c,0};
+    copy(buf,1);
+  }
+  explicit String(unsigned char value,unsigned char base = 10){
+    init();
+    setUnsigned(value,base);
+  }
+  explicit String(int value,unsigned char base = 10){
+    init();
+    setSigned(value,base);
+  }
+  explicit String(unsigned int value,unsigned char base = 10){
+    init();
+    setUnsigned(value,base);
+  }
+  explicit String(long value,unsigned char base = 10){
+    init();
+    setSigned(value,base);
+  }
+  explicit String(unsigned long value,unsigned char base = 10){
+    init();
+    setUnsigned(value,base);
+  }
+  explicit String(long long value,unsigned char base = 10){
+    init();
+    setSigned(value,base);
+  }
+  explicit String(unsigned long long value,unsigned char base = 10){
+    init();
+    setUnsigned(value,base);
+  }
+  explicit String(float value,unsigned int decimalPlaces = 2){
+    init();
+    setFloat(value,decimalPlaces);
+  }
+  explicit String(double value,unsigned int decimalPlaces = 2){
+    init();
+    setFloat(value,decimalPlaces);
+  }
+  ~String(){
+    free(buffer);
+  }
+
+  unsigned char reserve(unsigned int size){
+    if (buffer && (capacity >= size)) return 1;
+    char *newBuffer = (char *)realloc(buffer,size + 1);
+    if (newBuffer == NULL) return 0;
+    if (buffer == NULL) newBuffer[0] = 0;
+    buffer = newBuffer;
+    capacity = size;
+    return 1;
+  }
+  unsigned int length(void) const{
+    return len;
+  }
+  bool isEmpty(void) const{
+    return (len == 0);
+  }
+
+  String &operator=(const String &rhs){
+    if (this == &rhs) return *this;
+    if (rhs.buffer) copy(rhs.buffer,rhs.len);
+    else invalidate();
+    return *this;
+  }
+  String &operator=(const char *cstr){
+    if (cstr) copy(cstr,strlen(cstr));
+    else invalidate();
+    return *this;
+  }
+  String &operator=(String &&rval){
+    if (this != &rval) move(rval);
+    return *this;
+  }
+
+  unsigned char concat(const String &str){
+    return concat(str.buffer,str.len);
+  }
+  unsigned char concat(const char *cstr){
+    if (!cstr) return 0;
+    return concat(cstr,strlen(cstr));
+  }
+  unsigned char concat(const char *cstr,unsigned int length){
+    if (!cstr) return 0;
+    if (length == 0) return 1;
+    unsigned int newlen = len + length;
+    if (!reserve(newlen)) return 0;
+    memmove(buffer + len,cstr,length);
+    len = newlen;
+    buffer[len] = 0;
+    return 1;
+  }
+  unsigned char concat(char c){
+    char buf[2] = {c,0};
+    return concat(buf,1);
+  }
+  unsigned char concat(unsigned char num){
+    return concat(String(num));
+  }
+  unsigned char concat(int num){
+    return concat(String(num));
+  }
+  unsigned char concat(unsigned int num){
+    return concat(String(num));
+  }
+  unsigned char concat(long num){
+    return concat(String(num));
+  }
+  unsigned char concat(unsigned long num){
+    return concat(String(num));
+  }
+  unsigned char concat(float num){
+    return concat(String(num));
+  }
+  unsigned char concat(double num){
+    return concat(String(num));
+  }
+
+  template <typename T> String &operator+=(const T &rhs){
+    concat(rhs);
+    return *this;
+  }
+  String &operator+=(const char *cstr){
+    concat(cstr);
+    return *this;
+  }
+
+  friend StringSumHelper &operator+(const StringSumHelper &lhs,const String &rhs);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs,const char *cstr);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs,char c);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs,unsigned char num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs,int num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs,unsigned int num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs,long num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs,unsigned long num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs,float num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs,double num);
+
+  //like the arduino-core: usable in if(), but no implicit conversion to a number
+  typedef void (String::*StringIfHelperType)() const;
+  void StringIfHelper() const{}
+  operator StringIfHelperType() const{
+    return (buffer) ? &String::StringIfHelper : 0;
+  }
+  int compareTo(const String &s) const{
+    if (!buffer || !s.buffer){
+      if (s.buffer && s.len > 0) return 0 - *(unsigned char *)s.buffer;
+      if (buffer && len > 0) return *(unsigned char *)buffer;
+      return 0;
+    }
+    return strcmp(buffer,s.buffer);
+  }
+  unsigned char equals(const String &s) const{
+    return ((len == s.len) && (compareTo(s) == 0));
+  }
+  unsigned char equals(const char *cstr) const{
+    if (len == 0) return ((cstr == NULL) || (*cstr == 0));
+    if (cstr == NULL) return buffer[0] == 0;
+    return (strcmp(buffer,cstr) == 0);
+  }
+  unsigned char operator==(const String &rhs) const{
+    return equals(rhs);
+  }
+  unsigned char operator==(const char *cstr) const{
+    return equals(cstr);
+  }
+  unsigned char operator!=(const String &rhs) const{
+    return !equals(rhs);
+  }
+  unsigned char operator!=(const char *cstr) const{
+    return !equals(cstr);
+  }
+  unsigned char operator<(const String &rhs) const{
+    return compareTo(rhs) < 0;
+  }
+  unsigned char operator>(const String &rhs) const{
+    return compareTo(rhs) > 0;
+  }
+  unsigned char equalsIgnoreCase(const String &s) const{
+    if (len != s.len) return 0;
+    for (unsigned int i = 0;i < len;i++){
+      if (tolower((unsigned char)buffer[i]) != tolower((unsigned char)s.buffer[i])) return 0;
+    }
+    return 1;
+  }
+  unsigned char startsWith(const String &prefix) const{
+    if (len < prefix.len) return 0;
+    return startsWith(prefix,0);
+  }
+  unsigned char startsWith(const String &prefix,unsigned int offset) const{
+    if ((offset > len - prefix.len) || !buffer || !prefix.buffer) return 0;
+    return (strncmp(&buffer[offset],prefix.buffer,prefix.len) == 0);
+  }
+  unsigned char endsWith(const String &suffix) const{
+    if ((len < suffix.len) || !buffer || !suffix.buffer) return 0;
+    return (strcmp(&buffer[len - suffix.len],suffix.buffer) == 0);
+  }
+
+  char charAt(unsigned int index) const{
+    return operator[](index);
+  }
+  void setCharAt(unsigned int index,char c){
+    if (index < len) buffer[index] = c;
+  }
+  char operator[](unsigned int index) const{
+    if ((index >= len) || !buffer) return 0;
+    return buffer[index];
+  }
+  char &operator[](unsigned int index){
+    static char dummy_writable_char;
+    if ((index >= len) || !buffer){
+      dummy_writable_char = 0;
+      return dummy_writable_char;
+    }
+    return buffer[index];
+  }
+  void getBytes(unsigned char *buf,unsigned int bufsize,unsigned int index = 0) const{
+    if (!bufsize || !buf) return;
+    if (index >= len){
+      buf[0] = 0;
+      return;
+    }
+    unsigned int n = bufsize - 1;
+    if (n > len - index) n = len - index;
+    strncpy((char *)buf,buffer + index,n);
+    buf[n] = 0;
+  }
+  void toCharArray(char *buf,unsigned int bufsize,unsigned int index = 0) const{
+    getBytes((unsigned char *)buf,bufsize,index);
+  }
+  const char *c_str() const{
+    return (buffer) ? buffer : "";
+  }
+  char *begin(){
+    return buffer;
+  }
+  char *end(){
+    return buffer + len;
+  }
+
+  int indexOf(char ch) const{
+    return indexOf(ch,0);
+  }
+  int indexOf(char ch,unsigned int fromIndex) const{
+    if (fromIndex >= len) return -1;
+    const char *temp = strchr(buffer + fromIndex,ch);
+    if (temp == NULL) return -1;
+    return temp - buffer;
+  }
+  int indexOf(const String &str) const{
+    return indexOf(str,0);
+  }
+  int indexOf(const String &str,unsigned int fromIndex) const{
+    if (fromIndex >= len) return -1;
+    const char *found = strstr(buffer + fromIndex,str.c_str());
+    if (found == NULL) return -1;
+    return found - buffer;
+  }
+  int lastIndexOf(char ch) const{
+    return lastIndexOf(ch,len - 1);
+  }
+  int lastIndexOf(char ch,unsigned int fromIndex) const{
+    if (fromIndex >= len) return -1;
+    for (int i = fromIndex;i >= 0;i--){
+      if (buffer[i] == ch) return i;
+    }
+    return -1;
+  }
+  int lastIndexOf(const String &str) const{
+    return lastIndexOf(str,len - str.len);
+  }
+  int lastIndexOf(const String &str,unsigned int fromIndex) const{
+    if ((str.len == 0) || (len == 0) || (str.len > len)) return -1;
+    if (fromIndex >= len) fromIndex = len - 1;
+    int found = -1;
+    for (char *p = buffer;p <= buffer + fromIndex;p++){
+      p = strstr(p,str.buffer);
+      if (!p) break;
+      if ((unsigned int)(p - buffer) <= fromIndex) found = p - buffer;
+    }
+    return found;
+  }
+  String substring(unsigned int beginIndex) const{
+    return substring(beginIndex,len);
+  }
+  String substring(unsigned int left,unsigned int right) const{
+    if (left > right){
+      unsigned int temp = right;
+      right = left;
+      left = temp;
+    }
+    String out;
+    if (left >= len) return out;
+    if (right > len) right = len;
+    out.copy(buffer + left,right - left);
+    return out;
+  }
+
+  void replace(char find,char replace){
+    if (!buffer) return;
+    for (char *p = buffer;*p;p++){
+      if (*p == find) *p = replace;
+    }
+  }
+  void replace(const String &find,const String &replace){
+    if ((len == 0) || (find.len == 0)) return;
+    String out;
+    unsigned int i = 0;
+    while (i < len){
+      if ((i + find.len <= len) && (strncmp(buffer + i,find.buffer,find.len) == 0)){
+        out.concat(replace);
+        i += find.len;
+      }else{
+        out.concat(buffer[i]);
+        i++;
+      }
+    }
+    *this = out;
+  }
+  void remove(unsigned int index){
+    remove(index,(unsigned int)-1);
+  }
+  void remove(unsigned int index,unsigned int count){
+    if (index >= len) return;
+    if (count <= 0) return;
+    if (count > len - index) count = len - index;
+    char *writeTo = buffer + index;
+    len = len - count;
+    memmove(writeTo,buffer + index + count,len - index);
+    buffer[len] = 0;
+  }
+  void toLowerCase(void){
+    if (!buffer) return;
+    for (char *p = buffer;*p;p++) *p = tolower((unsigned char)*p);
+  }
+  void toUpperCase(void){
+    if (!buffer) return;
+    for (char *p = buffer;*p;p++) *p = toupper((unsigned char)*p);
+  }
+  void trim(void){
+    if (!buffer || len == 0) return;
+    char *begin = buffer;
+    while (isspace((unsigned char)*begin)) begin++;
+    char *end = buffer + len - 1;
+    while (isspace((unsigned char)*end) && end >= begin) end--;
+    len = end + 1 - begin;
+    if (begin > buffer) memmove(buffer,begin,len);
+    buffer[len] = 0;
+  }
+
+  long toInt(void) const{
+    if (buffer) return atol(buffer);
+    return 0;
+  }
+  float toFloat(void) const{
+    if (buffer) return atof(buffer);
+    return 0;
+  }
+  double toDouble(void) const{
+    if (buffer) return atof(buffer);
+    return 0;
+  }
+
+protected:
+  char *buffer;
+  unsigned int capacity;
+  unsigned int len;
+
+  void init(void){
+    buffer = NULL;
+    capacity = 0;
+    len = 0;
+  }
+  void invalidate(void){
+    free(buffer);
+    init();
+  }
+  String &copy(const char *cstr,unsigned int length){
+    if (!reserve(length)){
+      invalidate();
+      return *this;
+    }
+    len = length;
+    memmove(buffer,cstr,length);
+    buffer[len] = 0;
+    return *this;
+  }
+  void move(String &rhs){
+    free(buffer);
+    buffer = rhs.buffer;
+    capacity = rhs.capacity;
+    len = rhs.len;
+    rhs.init();
+  }
+  void setSigned(long long value,unsigned char base){
+    if (base == 10){
+      char buf[24];
+      snprintf(buf,sizeof(buf),"%lld",value);
+      *this = buf;
+    }else{
+      if (value < 0){
+        setUnsigned((unsigned long long)(-value),base);
+        String minus("-");
+        minus.concat(*this);
+        *this = minus;
+      }else{
+        setUnsigned((unsigned long long)value,base);
+      }
+    }
+  }
+  void setUnsigned(unsigned long long value,unsigned char base){
+    char buf[66];
+    char *p = &buf[sizeof(buf) - 1];
+    *p = 0;
+    if (base < 2) base = 10;
+    do {
+      unsigned char digit = value % base;
+      *--p = (digit < 10) ? '0' + digit : 'a' + digit - 10;
+      value /= base;
+    } while (value);
+    *this = p;
+  }
+  void setFloat(double value,unsigned int decimalPlaces){
+    char buf[48];
+    snprintf(buf,sizeof(buf),"%.*f",decimalPlaces,value);
+    *this = buf;
+  }
+};
+
+class StringSumHelper : public String {
+public:
+  StringSumHelper(const String &s) : String(s){}
+  StringSumHelper(const char *p) : String(p){}
+  StringSumHelper(char c) : String(c){}
+  StringSumHelper(unsigned char num) : String(num){}
+  StringSumHelper(int num) : String(num){}
+  StringSumHelper(unsigned int num) : String(num){}
+  StringSumHelper(long num) : String(num){}
+  StringSumHelper(unsigned long num) : String(num){}
+  StringSumHelper(float num) : String(num){}
+  StringSumHelper(double num) : String(num){}
+};
+
+inline StringSumHelper &operator+(const StringSumHelper &lhs,const String &rhs){
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(rhs);
+  return a;
+}
+inline StringSumHelper &operator+(const StringSumHelper &lhs,const char *cstr){
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(cstr);
+  return a;
+}
+inline StringSumHelper &operator+(const StringSumHelper &lhs,char c){
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(c);
+  return a;
+}
+inline StringSumHelper &operator+(const StringSumHelper &lhs,unsigned char num){
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(num);
+  return a;
+}
+inline StringSumHelper &operator+(const StringSumHelper &lhs,int num){
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(num);
+  return a;
+}
+inline StringSumHelper &operator+(const StringSumHelper &lhs,unsigned int num){
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(num);
+  return a;
+}
+inline StringSumHelper &operator+(const StringSumHelper &lhs,long num){
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(num);
+  return a;
+}
+inline StringSumHelper &operator+(const StringSumHelper &lhs,unsigned long num){
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(num);
+  return a;
+}
+inline StringSumHelper &operator+(const StringSumHelper &lhs,float num){
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(num);
+  return a;
+}
+inline StringSumHelper &operator+(const StringSumHelper &lhs,double num){
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(num);
+  return a;
+}
+
+#endif
@@ -0,0 +1,175 @@
+/*!
+ * @file WiFi.h
+ *
+ * WiFi and WiFiClient for host builds (env:native)
+ * a WiFiClient is a socket-simulation: the test injects server-bytes and reads what was sent
+ */
+
+#ifndef __NATIVE_WIFI_H__
+#define __NATIVE_WIFI_H__
+
+#include <deque>
+#include <string>
+#include <mutex>
+#include "Arduino.h"
+#include "Client.h"
+#include "IPAddress.h"
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+class WiFiClient : public Client {
+public:
+  WiFiClient(){}
+  int connect(IPAddress ip,uint16_t port){
+    (void)ip;
+    return connect("",port);
+  }
+  int connect(const char *host,uint16_t port){
+    std::lock_guard<std::mutex> lock(_m);
+    _host = host;
+    _port = port;
+    connects++;
+    _bConnected = bAcceptConnect;
+    return (_bConnected) ? 1 : 0;
+  }
+  int connect(const char *host,uint16_t port,int32_t timeout){
+    (void)timeout;
+    return connect(host,port);
+  }
+  using Print::write;
+  size_t write(uint8_t c){
+    return write(&c,1);
+  }
+  size_t write(const uint8_t *buf,size_t size){
+    std::lock_guard<std::mutex> lock(_m);
+    if (!_bConnected) return 0;
+    _tx.append((const char *)buf,size);
+    writes++;
+    return size;
+  }
+  int available(){
+    std::lock_guard<std::mutex> lock(_m);
+    return _rx.size();
+  }
+  int read(){
+    std::lock_guard<std::mutex> lock(_m);
+    if (_rx.empty()) return -1;
+    uint8_t c = _rx.front();
+    _rx.pop_front();
+    return c;
+  }
+  int read(uint8_t *buf,size_t size){
+    std::lock_guard<std::mutex> lock(_m);
+    if (_rx.empty()) return -1;
+    size_t count = 0;
+    while ((count < size) && (!_rx.empty())){
+      buf[count++] = _rx.front();
+      _rx.pop_front();
+    }
+    return count;
+  }
+  int peek(){
+    std::lock_guard<std::mutex> lock(_m);
+    if (_rx.empty()) return -1;
+    return _rx.front();
+  }
+  void flush(){}
+  void stop(){
+    std::lock_guard<std::mutex> lock(_m);
+    _bConnected = false;
+    _rx.clear();
+  }
+  uint8_t connected(){
+    std::lock_guard<std::mutex> lock(_m);
+    return (_bConnected || !_rx.empty()) ? 1 : 0;
+  }
+  operator bool(){
+    return connected();
+  }
+  void setNoDelay(bool nodelay){
+    (void)nodelay;
+  }
+  void setTimeout(uint32_t seconds){
+    (void)seconds;
+  }
+
+  //test-side
+  void inject(const uint8_t *buf,size_t size){
+    std::lock_guard<std::mutex> lock(_m);
+    _rx.insert(_rx.end(),buf,buf + size);
+  }
+  void inject(const char *str){
+    inject((const uint8_t *)str,strlen(str));
+  }
+  void inject(const std::string &str){
+    inject((const uint8_t *)str.data(),str.size());
+  }
+  std::string takeOutput(){
+    std::lock_guard<std::mutex> lock(_m);
+    std::string ret;
+    ret.swap(_tx);
+    return ret;
+  }
+  void drop(){ //connection closed by the server
+    std::lock_guard<std::mutex> lock(_m);
+    _bConnected = false;
+  }
+  const std::string &host(){
+    return _host;
+  }
+  uint16_t port(){
+    return _port;
+  }
+  bool bAcceptConnect = true;
+  uint32_t connects = 0;
+  uint32_t writes = 0;
+
+private:
+  std::mutex _m;
+  std::deque<uint8_t> _rx;
+  std::string _tx;
+  std::string _host;
+  uint16_t _port = 0;
+  bool _bConnected = false;
+};
+
+class WiFiClass {
+public:
+  wl_status_t status(){
+    return wifiStatus;
+  }
+  int hostByName(const char *host,IPAddress &result){
+    (void)host;
+    dnsRequests++;
+    if (!bDnsOk) return 0;
+    result = IPAddress(192,0,2,1);
+    return 1;
+  }
+  IPAddress localIP(){
+    return IPAddress(192,168,4,2);
+  }
+  String macAddress(){
+    return "24:6F:28:8D:56:A4";
+  }
+  int8_t RSSI(){
+    return -60;
+  }
+
+  //test-side
+  wl_status_t wifiStatus = WL_CONNECTED;
+  bool bDnsOk = true;
+  uint32_t dnsRequests = 0;
+};
+
+inline WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,75 @@
+/*!
+ * @file Wire.h
+ *
+ * Arduino Wire (TwoWire) for host builds (env:native)
+ * a transmission is acknowledged if the address is set with setDevicePresent
+ */
+
+#ifndef __NATIVE_WIRE_H__
+#define __NATIVE_WIRE_H__
+
+#include <stdint.h>
+#include <string.h>
+#include "Stream.h"
+
+class TwoWire : public Stream {
+public:
+  TwoWire(uint8_t bus_num) : _bus_num(bus_num){
+    memset(_present,0,sizeof(_present));
+  }
+  bool begin(int sda = -1,int scl = -1,uint32_t frequency = 0){
+    (void)sda;(void)scl;(void)frequency;
+    return true;
+  }
+  bool end(){
+    return true;
+  }
+  void setClock(uint32_t frequency){
+    (void)frequency;
+  }
+  void beginTransmission(uint16_t address){
+    _address = address;
+  }
+  uint8_t endTransmission(bool sendStop = true){
+    (void)sendStop;
+    return ((_address < 128) && (_present[_address])) ? 0 : 2; //2 = nack on address
+  }
+  uint8_t requestFrom(uint16_t address,uint8_t size,bool sendStop = true){
+    (void)sendStop;
+    _address = address;
+    _rxCount = ((_address < 128) && (_present[_address])) ? size : 0;
+    return _rxCount;
+  }
+  using Print::write;
+  size_t write(uint8_t c){
+    (void)c;
+    return 1;
+  }
+  int available(){
+    return _rxCount;
+  }
+  int read(){
+    if (_rxCount == 0) return -1;
+    _rxCount--;
+    return 0;
+  }
+  int peek(){
+    return (_rxCount) ? 0 : -1;
+  }
+
+  //test-side
+  void setDevicePresent(uint8_t address,bool bPresent){
+    if (address < 128) _present[address] = bPresent;
+  }
+
+private:
+  uint8_t _bus_num;
+  uint16_t _address = 0;
+  uint8_t _rxCount = 0;
+  bool _present[128];
+};
+
+inline TwoWire Wire(0);
+inline TwoWire Wire1(1);
+
+#endif
@@ -0,0 +1,7 @@
+/*!
+ * @file pgmspace.h
+ *
+ * avr include path for host builds (env:native)
+ */
+
+#include "../pgmspace.h"
@@ -0,0 +1,25 @@
+/*!
+ * @file esp_freertos_hooks.h
+ *
+ * idle-hooks for host builds (env:native), there is no idle-task --> hooks are never called
+ */
+
+#ifndef __NATIVE_ESP_FREERTOS_HOOKS_H__
+#define __NATIVE_ESP_FREERTOS_HOOKS_H__
+
+#include "freertos/FreeRTOS.h"
+
+typedef bool (*esp_freertos_idle_cb_t)(void);
+
+inline int esp_register_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t cb,uint32_t cpuid){
+  (void)cb;
+  (void)cpuid;
+  return 0;
+}
+
+inline void esp_deregister_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t cb,uint32_t cpuid){
+  (void)cb;
+  (void)cpuid;
+}
+
+#endif
@@ -0,0 +1,39 @@
+/*!
+ * @file esp_heap_caps.h
+ *
+ * heap-info for host builds (env:native), fixed values of a typical esp32 heap
+ */
+
+#ifndef __NATIVE_ESP_HEAP_CAPS_H__
+#define __NATIVE_ESP_HEAP_CAPS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT (1<<2)
+#define MALLOC_CAP_INTERNAL (1<<11)
+#define MALLOC_CAP_SPIRAM (1<<10)
+#define MALLOC_CAP_DEFAULT (1<<12)
+
+inline size_t heap_caps_get_free_size(uint32_t caps){
+  (void)caps;
+  return 200000;
+}
+
+inline size_t heap_caps_get_minimum_free_size(uint32_t caps){
+  (void)caps;
+  return 150000;
+}
+
+inline size_t heap_caps_get_largest_free_block(uint32_t caps){
+  (void)caps;
+  return 110000;
+}
+
+inline void *heap_caps_malloc(size_t size,uint32_t caps){
+  (void)caps;
+  return malloc(size);
+}
+
+#endif
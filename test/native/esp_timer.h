@@ -0,0 +1,17 @@
+/*!
+ * @file esp_timer.h
+ *
+ * esp_timer for host builds (env:native), follows the clock of NativeHal.h
+ */
+
+#ifndef __NATIVE_ESP_TIMER_H__
+#define __NATIVE_ESP_TIMER_H__
+
+#include <stdint.h>
+#include "NativeHal.h"
+
+inline int64_t esp_timer_get_time(void){
+  return native::micros64();
+}
+
+#endif
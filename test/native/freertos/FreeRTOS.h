@@ -0,0 +1,461 @@
+/*!
+ * @file FreeRTOS.h
+ *
+ * FreeRTOS api for host builds (env:native)
+ * tasks are threads, queues/semaphores/event-groups are built on std::mutex and condition_variable
+ * 1 tick = 1 ms, critical sections share one lock (like interrupts off)
+ */
+
+#ifndef __NATIVE_FREERTOS_H__
+#define __NATIVE_FREERTOS_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include "../NativeHal.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t EventBits_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define portMAX_DELAY (TickType_t)0xffffffffUL
+#define portTICK_PERIOD_MS ((TickType_t)1)
+#define portTICK_RATE_MS portTICK_PERIOD_MS
+#define configTICK_RATE_HZ 1000
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(xTimeInMs))
+#define pdTICKS_TO_MS(xTicks) ((uint32_t)(xTicks))
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdPASS (pdTRUE)
+#define pdFAIL (pdFALSE)
+#define errQUEUE_EMPTY ((BaseType_t)0)
+#define errQUEUE_FULL ((BaseType_t)0)
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define tskIDLE_PRIORITY 0
+#define configMAX_PRIORITIES 25
+
+typedef struct {
+  uint32_t owner;
+  uint32_t count;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0,0}
+
+#define portENTER_CRITICAL(mux) native::hal().critical.lock()
+#define portEXIT_CRITICAL(mux) native::hal().critical.unlock()
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
+#define portENTER_CRITICAL_SAFE(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_SAFE(mux) portEXIT_CRITICAL(mux)
+#define taskENTER_CRITICAL(mux) portENTER_CRITICAL(mux)
+#define taskEXIT_CRITICAL(mux) portEXIT_CRITICAL(mux)
+#define portYIELD() std::this_thread::yield()
+#define portYIELD_FROM_ISR(...) do {} while (0)
+#define taskYIELD() portYIELD()
+
+namespace native {
+
+//waits on a condition with a timeout in ticks, portMAX_DELAY waits forever
+template <typename Pred> bool waitTicks(std::condition_variable &cv,std::unique_lock<std::mutex> &lock,TickType_t ticks,Pred pred){
+  if (ticks == portMAX_DELAY){
+    cv.wait(lock,pred);
+    return true;
+  }
+  if (ticks == 0) return pred(); //poll, a timed wait would sleep for the timer-slack
+  return cv.wait_for(lock,std::chrono::milliseconds(ticks),pred);
+}
+
+struct queue {
+  std::mutex m;
+  std::condition_variable cv;
+  std::deque<std::vector<uint8_t>> items;
+  UBaseType_t length;
+  UBaseType_t itemSize;
+  bool bRecursive;
+  std::thread::id owner;
+  UBaseType_t ownerCount;
+};
+
+struct task {
+  std::mutex m;
+  std::condition_variable cv;
+  uint32_t notifyValue = 0;
+  bool bNotified = false;
+  std::atomic<bool> bDeleted{false};
+  std::atomic<bool> bRunning{false};
+  const char *name = "";
+  UBaseType_t priority = 0;
+  BaseType_t core = 0;
+};
+
+struct taskExit {}; //vTaskDelete(NULL) ends the thread of the task
+
+inline task *&currentTask(){
+  static thread_local task *pTask = NULL;
+  return pTask;
+}
+
+inline task *mainTask(){
+  static task t;
+  return &t;
+}
+
+}
+
+typedef native::queue *QueueHandle_t;
+typedef native::queue *SemaphoreHandle_t;
+typedef native::task *TaskHandle_t;
+
+typedef enum {
+  eRunning = 0,
+  eReady,
+  eBlocked,
+  eSuspended,
+  eDeleted,
+  eInvalid
+} eTaskState;
+
+typedef enum {
+  eNoAction = 0,
+  eSetBits,
+  eIncrement,
+  eSetValueWithOverwrite,
+  eSetValueWithoutOverwrite
+} eNotifyAction;
+
+/********** queues **********/
+inline QueueHandle_t xQueueCreate(UBaseType_t length,UBaseType_t itemSize){
+  native::queue *q = new native::queue();
+  q->length = length;
+  q->itemSize = itemSize;
+  q->bRecursive = false;
+  q->ownerCount = 0;
+  return q;
+}
+
+inline void vQueueDelete(QueueHandle_t q){
+  delete q;
+}
+
+inline BaseType_t native_queueSend(QueueHandle_t q,const void *item,TickType_t ticks,bool bFront){
+  if (q == NULL) return pdFAIL;
+  std::unique_lock<std::mutex> lock(q->m);
+  if (!native::waitTicks(q->cv,lock,ticks,[q]{ return q->items.size() < q->length; })) return errQUEUE_FULL;
+  std::vector<uint8_t> data(q->itemSize);
+  if (q->itemSize) memcpy(data.data(),item,q->itemSize);
+  if (bFront) q->items.push_front(std::move(data));
+  else q->items.push_back(std::move(data));
+  q->cv.notify_all();
+  return pdPASS;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t q,const void *item,TickType_t ticks){
+  return native_queueSend(q,item,ticks,false);
+}
+
+inline BaseType_t xQueueSendToBack(QueueHandle_t q,const void *item,TickType_t ticks){
+  return native_queueSend(q,item,ticks,false);
+}
+
+inline BaseType_t xQueueSendToFront(QueueHandle_t q,const void *item,TickType_t ticks){
+  return native_queueSend(q,item,ticks,true);
+}
+
+inline BaseType_t xQueueSendFromISR(QueueHandle_t q,const void *item,BaseType_t *pxWoken){
+  if (pxWoken) *pxWoken = pdFALSE;
+  return native_queueSend(q,item,0,false);
+}
+
+inline BaseType_t xQueueSendToBackFromISR(QueueHandle_t q,const void *item,BaseType_t *pxWoken){
+  return xQueueSendFromISR(q,item,pxWoken);
+}
+
+inline BaseType_t xQueueOverwrite(QueueHandle_t q,const void *item){
+  std::unique_lock<std::mutex> lock(q->m);
+  q->items.clear();
+  std::vector<uint8_t> data(q->itemSize);
+  if (q->itemSize) memcpy(data.data(),item,q->itemSize);
+  q->items.push_back(std::move(data));
+  q->cv.notify_all();
+  return pdPASS;
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t q,void *item,TickType_t ticks){
+  if (q == NULL) return pdFAIL;
+  std::unique_lock<std::mutex> lock(q->m);
+  if (!native::waitTicks(q->cv,lock,ticks,[q]{ return !q->items.empty(); })) return errQUEUE_EMPTY;
+  if ((item) && (q->itemSize)) memcpy(item,q->items.front().data(),q->itemSize);
+  q->items.pop_front();
+  q->cv.notify_all();
+  return pdPASS;
+}
+
+inline BaseType_t xQueueReceiveFromISR(QueueHandle_t q,void *item,BaseType_t *pxWoken){
+  if (pxWoken) *pxWoken = pdFALSE;
+  return xQueueReceive(q,item,0);
+}
+
+inline BaseType_t xQueuePeek(QueueHandle_t q,void *item,TickType_t ticks){
+  std::unique_lock<std::mutex> lock(q->m);
+  if (!native::waitTicks(q->cv,lock,ticks,[q]{ return !q->items.empty(); })) return errQUEUE_EMPTY;
+  if ((item) && (q->itemSize)) memcpy(item,q->items.front().data(),q->itemSize);
+  return pdPASS;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q){
+  std::unique_lock<std::mutex> lock(q->m);
+  return q->items.size();
+}
+
+inline UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q){
+  std::unique_lock<std::mutex> lock(q->m);
+  return q->length - q->items.size();
+}
+
+inline BaseType_t xQueueReset(QueueHandle_t q){
+  std::unique_lock<std::mutex> lock(q->m);
+  q->items.clear();
+  q->cv.notify_all();
+  return pdPASS;
+}
+
+/********** semaphores (queues with item-size 0) **********/
+inline SemaphoreHandle_t xSemaphoreCreateBinary(void){
+  return xQueueCreate(1,0);
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount,UBaseType_t initialCount){
+  SemaphoreHandle_t s = xQueueCreate(maxCount,0);
+  for (UBaseType_t i = 0;i < initialCount;i++) xQueueSend(s,NULL,0);
+  return s;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex(void){
+  SemaphoreHandle_t s = xQueueCreate(1,0);
+  xQueueSend(s,NULL,0);
+  return s;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void){
+  SemaphoreHandle_t s = xSemaphoreCreateMutex();
+  s->bRecursive = true;
+  return s;
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t s){
+  vQueueDelete(s);
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s,TickType_t ticks){
+  return xQueueReceive(s,NULL,ticks);
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s){
+  return xQueueSend(s,NULL,0);
+}
+
+inline BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t s,BaseType_t *pxWoken){
+  return xQueueReceiveFromISR(s,NULL,pxWoken);
+}
+
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t s,BaseType_t *pxWoken){
+  return xQueueSendFromISR(s,NULL,pxWoken);
+}
+
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t s,TickType_t ticks){
+  if ((s->ownerCount) && (s->owner == std::this_thread::get_id())){
+    s->ownerCount++;
+    return pdPASS;
+  }
+  if (xQueueReceive(s,NULL,ticks) != pdPASS) return pdFAIL;
+  s->owner = std::this_thread::get_id();
+  s->ownerCount = 1;
+  return pdPASS;
+}
+
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t s){
+  if ((s->ownerCount == 0) || (s->owner != std::this_thread::get_id())) return pdFAIL;
+  if (--s->ownerCount) return pdPASS;
+  return xQueueSend(s,NULL,0);
+}
+
+inline UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t s){
+  return uxQueueMessagesWaiting(s);
+}
+
+/********** tasks **********/
+inline TickType_t xTaskGetTickCount(void){
+  return (TickType_t)(native::micros64() / 1000);
+}
+
+inline TickType_t xTaskGetTickCountFromISR(void){
+  return xTaskGetTickCount();
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle(void){
+  native::task *pTask = native::currentTask();
+  return (pTask) ? pTask : native::mainTask();
+}
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn,const char *name,uint32_t stackDepth,void *param,UBaseType_t priority,TaskHandle_t *pHandle,BaseType_t core){
+  (void)stackDepth;
+  native::task *pTask = new native::task();
+  pTask->name = name;
+  pTask->priority = priority;
+  pTask->core = core;
+  pTask->bRunning = true;
+  if (pHandle) *pHandle = pTask;
+  std::thread([fn,param,pTask](){
+    native::currentTask() = pTask;
+    try {
+      fn(param);
+    } catch (native::taskExit &){
+    }
+    pTask->bRunning = false;
+    pTask->bDeleted = true;
+  }).detach();
+  return pdPASS;
+}
+
+inline BaseType_t xTaskCreate(TaskFunction_t fn,const char *name,uint32_t stackDepth,void *param,UBaseType_t priority,TaskHandle_t *pHandle){
+  return xTaskCreatePinnedToCore(fn,name,stackDepth,param,priority,pHandle,tskNO_AFFINITY);
+}
+
+//deleting the own task ends its thread, other tasks are only marked (threads can't be killed)
+inline void vTaskDelete(TaskHandle_t handle){
+  native::task *pSelf = native::currentTask();
+  if ((handle == NULL) || (handle == pSelf)){
+    if (pSelf == NULL) return; //main-thread
+    throw native::taskExit();
+  }
+  handle->bDeleted = true;
+}
+
+inline eTaskState eTaskGetState(TaskHandle_t handle){
+  if (handle == NULL) return eInvalid;
+  if ((handle->bDeleted) || (!handle->bRunning && handle != native::mainTask())) return eDeleted;
+  return eRunning;
+}
+
+inline void vTaskDelay(TickType_t ticks){
+  if (native::isFakeTime()){
+    native::advanceMs(ticks);
+    std::this_thread::yield();
+  }else{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+  }
+}
+
+inline void vTaskDelayUntil(TickType_t *pPrevious,TickType_t increment){
+  TickType_t target = *pPrevious + increment;
+  TickType_t now = xTaskGetTickCount();
+  if ((int32_t)(target - now) > 0) vTaskDelay(target - now);
+  *pPrevious = target;
+}
+
+inline BaseType_t xTaskDelayUntil(TickType_t *pPrevious,TickType_t increment){
+  vTaskDelayUntil(pPrevious,increment);
+  return pdTRUE;
+}
+
+inline void vTaskSuspend(TaskHandle_t handle){
+  (void)handle;
+}
+
+inline void vTaskResume(TaskHandle_t handle){
+  (void)handle;
+}
+
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t handle){
+  (void)handle;
+  return 0;
+}
+
+inline UBaseType_t uxTaskPriorityGet(TaskHandle_t handle){
+  return (handle) ? handle->priority : 0;
+}
+
+inline char *pcTaskGetTaskName(TaskHandle_t handle){
+  TaskHandle_t t = (handle) ? handle : xTaskGetCurrentTaskHandle();
+  return (char *)t->name;
+}
+
+inline BaseType_t xPortGetCoreID(void){
+  native::task *pTask = native::currentTask();
+  return ((pTask) && (pTask->core != tskNO_AFFINITY)) ? pTask->core : 0;
+}
+
+inline uint32_t xPortGetFreeHeapSize(void){
+  return 200000;
+}
+
+inline uint32_t xPortGetMinimumEverFreeHeapSize(void){
+  return 150000;
+}
+
+/********** task-notifications **********/
+inline BaseType_t xTaskNotify(TaskHandle_t handle,uint32_t value,eNotifyAction action){
+  std::unique_lock<std::mutex> lock(handle->m);
+  switch (action){
+    case eSetBits: handle->notifyValue |= value; break;
+    case eIncrement: handle->notifyValue++; break;
+    case eSetValueWithOverwrite: handle->notifyValue = value; break;
+    case eSetValueWithoutOverwrite:
+      if (handle->bNotified) return pdFAIL;
+      handle->notifyValue = value;
+      break;
+    default: break;
+  }
+  handle->bNotified = true;
+  handle->cv.notify_all();
+  return pdPASS;
+}
+
+inline BaseType_t xTaskNotifyFromISR(TaskHandle_t handle,uint32_t value,eNotifyAction action,BaseType_t *pxWoken){
+  if (pxWoken) *pxWoken = pdFALSE;
+  return xTaskNotify(handle,value,action);
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t handle){
+  return xTaskNotify(handle,0,eIncrement);
+}
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t handle,BaseType_t *pxWoken){
+  if (pxWoken) *pxWoken = pdFALSE;
+  xTaskNotify(handle,0,eIncrement);
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clearOnExit,TickType_t ticks){
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  std::unique_lock<std::mutex> lock(self->m);
+  native::waitTicks(self->cv,lock,ticks,[self]{ return self->notifyValue != 0; });
+  uint32_t value = self->notifyValue;
+  if (value){
+    if (clearOnExit) self->notifyValue = 0;
+    else self->notifyValue--;
+  }
+  self->bNotified = false;
+  return value;
+}
+
+inline BaseType_t xTaskNotifyWait(uint32_t clearOnEntry,uint32_t clearOnExit,uint32_t *pValue,TickType_t ticks){
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  std::unique_lock<std::mutex> lock(self->m);
+  if (!self->bNotified) self->notifyValue &= ~clearOnEntry;
+  bool bRet = native::waitTicks(self->cv,lock,ticks,[self]{ return self->bNotified; });
+  if (pValue) *pValue = self->notifyValue;
+  if (bRet){
+    self->notifyValue &= ~clearOnExit;
+    self->bNotified = false;
+  }
+  return (bRet) ? pdTRUE : pdFALSE;
+}
+
+#endif
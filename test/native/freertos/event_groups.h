@@ -0,0 +1,68 @@
+/*!
+ * @file event_groups.h
+ *
+ * FreeRTOS event-groups for host builds (env:native)
+ */
+
+#ifndef __NATIVE_EVENT_GROUPS_H__
+#define __NATIVE_EVENT_GROUPS_H__
+
+#include "FreeRTOS.h"
+
+namespace native {
+
+struct eventGroup {
+  std::mutex m;
+  std::condition_variable cv;
+  EventBits_t bits = 0;
+};
+
+}
+
+typedef native::eventGroup *EventGroupHandle_t;
+
+inline EventGroupHandle_t xEventGroupCreate(void){
+  return new native::eventGroup();
+}
+
+inline void vEventGroupDelete(EventGroupHandle_t group){
+  delete group;
+}
+
+inline EventBits_t xEventGroupSetBits(EventGroupHandle_t group,EventBits_t bits){
+  std::unique_lock<std::mutex> lock(group->m);
+  group->bits |= bits;
+  group->cv.notify_all();
+  return group->bits;
+}
+
+inline BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t group,EventBits_t bits,BaseType_t *pxWoken){
+  if (pxWoken) *pxWoken = pdFALSE;
+  xEventGroupSetBits(group,bits);
+  return pdPASS;
+}
+
+inline EventBits_t xEventGroupClearBits(EventGroupHandle_t group,EventBits_t bits){
+  std::unique_lock<std::mutex> lock(group->m);
+  EventBits_t ret = group->bits;
+  group->bits &= ~bits;
+  return ret;
+}
+
+inline EventBits_t xEventGroupGetBits(EventGroupHandle_t group){
+  std::unique_lock<std::mutex> lock(group->m);
+  return group->bits;
+}
+
+inline EventBits_t xEventGroupWaitBits(EventGroupHandle_t group,EventBits_t bits,BaseType_t clearOnExit,BaseType_t waitForAll,TickType_t ticks){
+  std::unique_lock<std::mutex> lock(group->m);
+  auto pred = [group,bits,waitForAll]{
+    return (waitForAll) ? ((group->bits & bits) == bits) : ((group->bits & bits) != 0);
+  };
+  bool bRet = native::waitTicks(group->cv,lock,ticks,pred);
+  EventBits_t ret = group->bits;
+  if ((bRet) && (clearOnExit)) group->bits &= ~bits;
+  return ret;
+}
+
+#endif
@@ -0,0 +1,7 @@
+/*!
+ * @file queue.h
+ *
+ * included by FreeRTOS.h for host builds (env:native)
+ */
+
+#include "FreeRTOS.h"
@@ -0,0 +1,7 @@
+/*!
+ * @file semphr.h
+ *
+ * included by FreeRTOS.h for host builds (env:native)
+ */
+
+#include "FreeRTOS.h"
@@ -0,0 +1,114 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for the vario beeper (tone on the ledc-channel of toneAC)
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Bench.h>
+#include <beeper.h>
+#include <toneAC.h>
+
+//ledc-freq for a climb-rate, toneAC adds 300Hz
+static double climbFreq(double velocity){
+  return (uint16_t)(CLIMBING_BEEP_FREQ_COEFF * velocity + CLIMBING_BEEP_BASE_FREQ) + 300;
+}
+
+//like taskBaro: new velocity every 10ms, update() every 1ms
+static void run(beeper &b,uint32_t ms,double velocity){
+  for (uint32_t t = 0;t < ms;t++){
+    if ((millis() % 10) == 0) b.setVelocity(velocity);
+    b.update();
+    native::advanceMs(1);
+  }
+}
+
+void setUp(void){
+  native::setTime(1000000);
+}
+
+void tearDown(void){
+}
+
+void test_climbing_beep(void){
+  beeper b;
+  run(b,5,1.0);
+  const native::ledcState &l = native::getLedc(BEEPERCHANNEL);
+  TEST_ASSERT_EQUAL_FLOAT(climbFreq(1.0),l.freq);
+  TEST_ASSERT_EQUAL(BEEP_DEFAULT_VOLUME,l.duty);
+  //cadence at 1m/s: 0.51 * 1 + 1.62 --> high phase of 500ms lasts ~235ms
+  run(b,300,1.0);
+  TEST_ASSERT_EQUAL(0,l.duty);
+}
+
+void test_freq_changes_within_beep(void){
+  beeper b;
+  run(b,20,1.0);
+  const native::ledcState &l = native::getLedc(BEEPERCHANNEL);
+  TEST_ASSERT_EQUAL_FLOAT(climbFreq(1.0),l.freq);
+  //climb-rate changes in the middle of the beep --> new freq with the next update
+  b.setVelocity(2.0);
+  b.update();
+  TEST_ASSERT_EQUAL_FLOAT(climbFreq(2.0),l.freq);
+  TEST_ASSERT_EQUAL(BEEP_DEFAULT_VOLUME,l.duty);
+  //changes below the sensitivity keep the freq
+  b.setVelocity(2.0 + BEEP_VELOCITY_SENSITIVITY / 2);
+  b.update();
+  TEST_ASSERT_EQUAL_FLOAT(climbFreq(2.0),l.freq);
+}
+
+void test_ledc_writes_only_on_change(void){
+  beeper b;
+  run(b,20,1.5);
+  uint32_t changes = native::getLedc(BEEPERCHANNEL).freqChanges;
+  run(b,100,1.5); //still in the high phase
+  TEST_ASSERT_EQUAL(changes,native::getLedc(BEEPERCHANNEL).freqChanges);
+}
+
+void test_sinking_beep(void){
+  beeper b;
+  run(b,20,-3.0);
+  const native::ledcState &l = native::getLedc(BEEPERCHANNEL);
+  TEST_ASSERT_EQUAL_FLOAT((uint16_t)(SINKING_BEEP_FREQ_COEFF * -3.0 + SINKING_BEEP_BASE_FREQ) + 300,l.freq);
+  TEST_ASSERT_EQUAL(BEEP_DEFAULT_VOLUME,l.duty);
+  run(b,20,0.0); //silent
+  TEST_ASSERT_EQUAL(0,l.duty);
+}
+
+void bench_update(void){
+  //climb-rate of a thermal: sine between -1.5 and 3.5 m/s, 10s period, new value every 10ms
+  //one op = 1s of taskBaro (1000 updates), a single update is below the resolution of the cycle-counter
+  static float velocity[1000];
+  for (int i = 0;i < 1000;i++) velocity[i] = 1.0 + 2.5 * sin(i * 10 * 2 * PI / 10000.0);
+  beeper b;
+  uint32_t changes = native::getLedc(BEEPERCHANNEL).freqChanges;
+  uint32_t t = 0;
+  //the clock alone, subtracted from the result
+  bench::result r0 = bench::run("clock only (1kHz)",600,[&](uint32_t i){
+    for (int j = 0;j < 1000;j++) native::advanceMs(1);
+  });
+  bench::result r = bench::run("beeper 1s update (1kHz, thermal)",600,[&](uint32_t i){
+    for (int j = 0;j < 1000;j++){
+      if ((t % 10) == 0) b.setVelocity(velocity[(t / 10) % 1000]);
+      b.update();
+      native::advanceMs(1);
+      t++;
+    }
+  });
+  bench::print(r0);
+  bench::print(r);
+  printf("cycles per update(): %.1f, ledc freq-writes per minute: %.0f\n",(r.cyclesPerOp - r0.cyclesPerOp) / 1000,
+         (native::getLedc(BEEPERCHANNEL).freqChanges - changes) / 10.0);
+  TEST_ASSERT_EQUAL(0,r.allocsPerOp);
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_climbing_beep);
+  RUN_TEST(test_freq_changes_within_beep);
+  RUN_TEST(test_ledc_writes_only_on_change);
+  RUN_TEST(test_sinking_beep);
+  RUN_TEST(bench_update);
+  return UNITY_END();
+}
@@ -0,0 +1,114 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for BootSequence (stages in own tasks, dependencies, skip and timeout)
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <BootSequence.h>
+
+#define STAGE_GPS 0
+#define STAGE_RADIO 1
+#define STAGE_WIFI 2
+#define STAGE_BT 3
+#define STAGE_GSM 4
+
+//stage in its own task: waits for its dependencies, works for ms and is ready
+typedef struct {
+  BootSequence *boot;
+  uint8_t id;
+  uint32_t workMs;
+  volatile bool bDone;
+} stageTask;
+
+void taskStage(void *pvParameters){
+  stageTask *pStage = (stageTask *)pvParameters;
+  pStage->boot->start(pStage->id);
+  delay(pStage->workMs);
+  pStage->boot->ready(pStage->id);
+  pStage->bDone = true;
+  vTaskDelete(NULL);
+}
+
+void setUp(void){
+  native::realTime(); //stages run in their own threads
+}
+
+void tearDown(void){
+}
+
+//radio waits for gps, wifi for radio, bluetooth for wifi --> each starts after its dependency is ready
+void test_dependencies(void){
+  BootSequence boot;
+  boot.begin();
+  boot.add(STAGE_GPS,"gps",0);
+  boot.add(STAGE_RADIO,"radio",BOOT_BIT(STAGE_GPS));
+  boot.add(STAGE_WIFI,"wifi",BOOT_BIT(STAGE_RADIO));
+  boot.add(STAGE_BT,"bluetooth",BOOT_BIT(STAGE_WIFI));
+  stageTask tasks[4];
+  //created in reverse order --> the waits do the ordering
+  for (int i = 3;i >= 0;i--){
+    tasks[i] = {&boot,(uint8_t)i,20,false};
+    xTaskCreatePinnedToCore(taskStage,"stage",4096,&tasks[i],5,NULL,i % 2);
+  }
+  uint32_t tStart = millis();
+  while ((!tasks[STAGE_BT].bDone) && ((millis() - tStart) < 2000)) delay(1);
+  TEST_ASSERT_TRUE(boot.isReady(STAGE_BT));
+  BootSequence::stage stages[4];
+  for (int i = 0;i < 4;i++) TEST_ASSERT_TRUE(boot.getStage(i,&stages[i]));
+  for (int i = 1;i < 4;i++){
+    TEST_ASSERT_EQUAL(BOOT_READY,stages[i].state);
+    TEST_ASSERT_FALSE(stages[i].bTimeout);
+    TEST_ASSERT_TRUE(stages[i].tStart >= stages[i - 1].tReady);
+    TEST_ASSERT_TRUE(stages[i].tWait <= stages[i - 1].tReady); //waited for it
+  }
+}
+
+//a skipped stage counts as ready, a missing one times out
+void test_skip_timeout(void){
+  BootSequence boot;
+  boot.begin();
+  boot.add(STAGE_GSM,"gsm",0);
+  boot.add(STAGE_WIFI,"wifi",BOOT_BIT(STAGE_GSM));
+  boot.add(STAGE_BT,"bluetooth",BOOT_BIT(STAGE_RADIO));
+  boot.add(STAGE_RADIO,"radio",0);
+  boot.skip(STAGE_GSM);
+  TEST_ASSERT_TRUE(boot.isReady(STAGE_GSM));
+  TEST_ASSERT_TRUE(boot.start(STAGE_WIFI,10));
+  uint32_t tStart = millis();
+  TEST_ASSERT_FALSE(boot.start(STAGE_BT,50));
+  TEST_ASSERT_UINT32_WITHIN(20,50,millis() - tStart);
+  BootSequence::stage st;
+  boot.getStage(STAGE_BT,&st);
+  TEST_ASSERT_TRUE(st.bTimeout);
+  TEST_ASSERT_EQUAL(BOOT_RUNNING,st.state);
+  TEST_ASSERT_FALSE(boot.waitReady(STAGE_RADIO,10));
+}
+
+//ready without start (first gps-sentence), only the first signal counts
+void test_signal(void){
+  BootSequence boot;
+  boot.begin();
+  boot.add(STAGE_GPS,"gps",0);
+  delay(5);
+  boot.ready(STAGE_GPS);
+  BootSequence::stage st;
+  boot.getStage(STAGE_GPS,&st);
+  uint32_t tReady = st.tReady;
+  TEST_ASSERT_EQUAL(tReady,st.tWait);
+  delay(5);
+  boot.ready(STAGE_GPS);
+  boot.getStage(STAGE_GPS,&st);
+  TEST_ASSERT_EQUAL(tReady,st.tReady);
+  TEST_ASSERT_TRUE(boot.waitReady(STAGE_GPS,0));
+  TEST_ASSERT_FALSE(boot.getStage(STAGE_RADIO,&st)); //not added
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_dependencies);
+  RUN_TEST(test_skip_timeout);
+  RUN_TEST(test_signal);
+  return UNITY_END();
+}
@@ -0,0 +1,84 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for CalcTools and kalmanvert
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Bench.h>
+#include <CalcTools.h>
+#include <kalmanvert.h>
+
+void setUp(void){
+}
+
+void tearDown(void){
+}
+
+void test_distance(void){
+  //1 deg of latitude = 60 nautical miles
+  TEST_ASSERT_FLOAT_WITHIN(0.5,111.2,distance(47.0,13.0,48.0,13.0,'K'));
+  TEST_ASSERT_FLOAT_WITHIN(0.1,60.0,distance(47.0,13.0,48.0,13.0,'N'));
+  TEST_ASSERT_FLOAT_WITHIN(0.001,0.0,distance(47.0,13.0,47.0,13.0,'K'));
+}
+
+void test_bearing(void){
+  TEST_ASSERT_EQUAL(0,CalcBearingA(47.0,13.0,48.0,13.0));
+  TEST_ASSERT_INT_WITHIN(1,90,CalcBearingA(47.0,13.0,47.0,14.0));
+  TEST_ASSERT_INT_WITHIN(1,180,CalcBearingA(48.0,13.0,47.0,13.0));
+  TEST_ASSERT_INT_WITHIN(1,270,CalcBearingA(47.0,14.0,47.0,13.0));
+}
+
+void test_sinDeg(void){
+  for (int16_t deg = -720;deg <= 720;deg++){
+    TEST_ASSERT_INT_WITHIN(1,lround(sin(deg * DEG_TO_RAD) * SINTAB_SCALE),sinDeg(deg));
+    TEST_ASSERT_INT_WITHIN(1,lround(cos(deg * DEG_TO_RAD) * SINTAB_SCALE),cosDeg(deg));
+  }
+}
+
+void test_kalman_climb(void){
+  //constant climb of 2m/s, baro sampled every 10ms
+  kalmanvert kf;
+  kf.init(1000.0,0.0,0.1,0.3,0);
+  for (unsigned long t = 10;t <= 20000;t += 10){
+    kf.update(1000.0 + 2.0 * t / 1000.0,0.0,t);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.05,2.0,kf.getVelocity());
+  TEST_ASSERT_FLOAT_WITHIN(0.5,1040.0,kf.getPosition());
+}
+
+void bench_calctools(void){
+  volatile double sum = 0;
+  bench::result r = bench::run("distance",10000,[&](uint32_t i){
+    sum += distance(47.0,13.0,47.0 + i * 1e-5,13.0 + i * 1e-5,'K');
+  });
+  bench::print(r);
+  TEST_ASSERT_EQUAL(0,r.allocsPerOp);
+  r = bench::run("CalcBearingA",10000,[&](uint32_t i){
+    sum += CalcBearingA(47.0,13.0,47.0 + i * 1e-5,13.0 - i * 1e-5);
+  });
+  bench::print(r);
+  volatile int32_t isum = 0;
+  r = bench::run("sinDeg",10000,[&](uint32_t i){
+    isum += sinDeg(i % 360);
+  });
+  bench::print(r);
+  kalmanvert kf;
+  kf.init(1000.0,0.0,0.1,0.3,0);
+  r = bench::run("kalmanvert.update",10000,[&](uint32_t i){
+    kf.update(1000.0,0.0,(i + 1) * 10);
+  });
+  bench::print(r);
+  TEST_ASSERT_EQUAL(0,r.allocsPerOp);
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_distance);
+  RUN_TEST(test_bearing);
+  RUN_TEST(test_sinDeg);
+  RUN_TEST(test_kalman_climb);
+  RUN_TEST(bench_calctools);
+  return UNITY_END();
+}
@@ -0,0 +1,110 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for TaskDiag (loop-periods, deadline-misses, cpu-share, heap-history) in simulated time
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Bench.h>
+#include <TaskDiag.h>
+
+//one loop of a task: busy for busyMs, then waits until the period is over
+static void loop(TaskDiag &diag,uint8_t id,uint32_t periodMs,uint32_t busyMs){
+  diag.loopStart(id);
+  native::advanceMs(busyMs);
+  diag.loopEnd(id);
+  native::advanceMs(periodMs - busyMs);
+}
+
+void setUp(void){
+  native::setTime(1000000);
+}
+
+void tearDown(void){
+}
+
+void test_add(void){
+  TaskDiag diag;
+  TEST_ASSERT_EQUAL(0,diag.add("taskStandard",NULL,20));
+  TEST_ASSERT_EQUAL(1,diag.add("taskBaro",NULL,20));
+  TEST_ASSERT_EQUAL(0,diag.add("taskStandard",NULL,20)); //same name --> same id
+  static const char *names[DIAG_MAXTASKS] = {"","","2","3","4","5","6","7","8","9"}; //name is not copied
+  for (int i = 2;i < DIAG_MAXTASKS;i++) diag.add(names[i],NULL,10);
+  TEST_ASSERT_EQUAL(DIAG_MAXTASKS,diag.add("one too many",NULL,10));
+  TaskDiag::taskStats stats;
+  TEST_ASSERT_FALSE(diag.getTask(DIAG_MAXTASKS,&stats));
+}
+
+//period 10ms --> bucket 10..20ms, every 10th loop takes 60ms --> deadline 20ms missed
+void test_periods(void){
+  TaskDiag diag;
+  uint8_t id = diag.add("taskStandard",NULL,20);
+  for (int i = 0;i < 101;i++){
+    loop(diag,id,(i % 10 == 9) ? 60 : 10,1);
+  }
+  TaskDiag::taskStats stats;
+  TEST_ASSERT_TRUE(diag.getTask(id,&stats));
+  TEST_ASSERT_EQUAL(100,stats.loops); //first loopStart has no period
+  TEST_ASSERT_EQUAL(10,stats.misses);
+  TEST_ASSERT_EQUAL(60000,stats.periodMax);
+  TEST_ASSERT_EQUAL(90,stats.histogram[3]); //10..20ms
+  TEST_ASSERT_EQUAL(10,stats.histogram[5]); //50..100ms
+}
+
+//busy 5ms of 20ms --> 25%, a loop running over the sample-window is split
+void test_cpu(void){
+  TaskDiag diag;
+  native::advanceMs(1000);
+  diag.run(); //start of sample-window
+  uint8_t id = diag.add("taskBaro",NULL,20);
+  for (int i = 0;i < 50;i++) loop(diag,id,20,5);
+  diag.run();
+  TaskDiag::taskStats stats;
+  diag.getTask(id,&stats);
+  TEST_ASSERT_UINT32_WITHIN(5,250,stats.cpu);
+  diag.loopStart(id); //blocked for the whole window
+  native::advanceMs(1000);
+  diag.run();
+  diag.getTask(id,&stats);
+  TEST_ASSERT_UINT32_WITHIN(5,1000,stats.cpu);
+}
+
+void test_heap(void){
+  TaskDiag diag;
+  native::advanceMs(1000);
+  diag.run();
+  TaskDiag::heapStats heap = diag.getHeap();
+  TEST_ASSERT_EQUAL(200000,heap.freeHeap);
+  TEST_ASSERT_EQUAL(110000,heap.largestBlock);
+  TEST_ASSERT_EQUAL(45,heap.fragmentation);
+  //history holds max. DIAG_HEAPHISTORY samples, one every DIAG_HEAPINTERVALL
+  for (int i = 0;i < DIAG_HEAPHISTORY + 5;i++){
+    native::advanceMs(DIAG_HEAPINTERVALL);
+    diag.run();
+  }
+  DynamicJsonDocument doc(4096);
+  diag.getJson(doc);
+  TEST_ASSERT_EQUAL(DIAG_HEAPHISTORY,doc["heap"]["hist"].size());
+}
+
+void bench_diag(void){
+  TaskDiag diag;
+  uint8_t id = diag.add("taskStandard",NULL,20);
+  bench::result r = bench::run("TaskDiag loopStart + loopEnd",10000,[&](uint32_t i){
+    diag.loopStart(id);
+    diag.loopEnd(id);
+  });
+  bench::print(r);
+  TEST_ASSERT_EQUAL(0,r.allocsPerOp);
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_add);
+  RUN_TEST(test_periods);
+  RUN_TEST(test_cpu);
+  RUN_TEST(test_heap);
+  RUN_TEST(bench_diag);
+  return UNITY_END();
+}
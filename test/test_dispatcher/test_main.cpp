@@ -0,0 +1,104 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for Dispatcher (events, periods, wakeups of the waiting task)
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Bench.h>
+#include <thread>
+#include <Dispatcher.h>
+
+#define EV_A 0x01
+#define EV_B 0x02
+
+static uint32_t calls[3];
+static uint32_t lastEvents[3];
+
+static void handler0(uint32_t tAct,uint32_t events){ calls[0]++; lastEvents[0] = events; }
+static void handler1(uint32_t tAct,uint32_t events){ calls[1]++; lastEvents[1] = events; }
+static void handler2(uint32_t tAct,uint32_t events){ calls[2]++; lastEvents[2] = events; }
+
+void setUp(void){
+  native::setTime(1000000);
+  memset(calls,0,sizeof(calls));
+  memset(lastEvents,0,sizeof(lastEvents));
+}
+
+void tearDown(void){
+}
+
+//handler with period is called when it ran out, handler without period only on its events
+void test_dispatch(void){
+  Dispatcher dispatcher;
+  dispatcher.add("poll",handler0,0,10);
+  dispatcher.add("event",handler1,EV_A,0);
+  dispatcher.add("both",handler2,EV_B,50);
+  for (int i = 0;i < 100;i++){
+    native::advanceMs(1);
+    dispatcher.dispatch(0);
+  }
+  TEST_ASSERT_EQUAL(10,calls[0]);
+  TEST_ASSERT_EQUAL(0,calls[1]);
+  TEST_ASSERT_EQUAL(2,calls[2]);
+  dispatcher.dispatch(EV_A | EV_B);
+  TEST_ASSERT_EQUAL(10,calls[0]);
+  TEST_ASSERT_EQUAL(1,calls[1]);
+  TEST_ASSERT_EQUAL(EV_A,lastEvents[1]); //only its own events
+  TEST_ASSERT_EQUAL(3,calls[2]);
+  TEST_ASSERT_EQUAL(EV_B,lastEvents[2]);
+  native::advanceMs(49);
+  dispatcher.dispatch(0);
+  TEST_ASSERT_EQUAL(3,calls[2]); //period restarts with the event
+  Dispatcher::handlerStats stats;
+  TEST_ASSERT_TRUE(dispatcher.getStats(0,&stats));
+  TEST_ASSERT_EQUAL_STRING("poll",stats.name);
+  TEST_ASSERT_EQUAL(11,stats.calls);
+  TEST_ASSERT_FALSE(dispatcher.getStats(3,&stats));
+}
+
+//the task sleeps until the next period or an event from another task/isr
+void test_wait(void){
+  native::realTime();
+  Dispatcher dispatcher;
+  dispatcher.begin(xTaskGetCurrentTaskHandle());
+  dispatcher.add("poll",handler0,0,30);
+  uint32_t tStart = millis();
+  TEST_ASSERT_EQUAL(0,dispatcher.wait());
+  uint32_t tWait = millis() - tStart;
+  TEST_ASSERT_UINT32_WITHIN(10,30,tWait);
+  dispatcher.dispatch(0);
+  TEST_ASSERT_EQUAL(1,calls[0]);
+  std::thread isr([&](){
+    delay(5);
+    dispatcher.postFromISR(EV_A);
+  });
+  tStart = millis();
+  TEST_ASSERT_EQUAL(EV_A,dispatcher.wait());
+  TEST_ASSERT_TRUE((millis() - tStart) < 25);
+  isr.join();
+  dispatcher.post(EV_B);
+  dispatcher.post(EV_A);
+  TEST_ASSERT_EQUAL(EV_A | EV_B,dispatcher.wait()); //posted events are collected
+  TEST_ASSERT_EQUAL(3,dispatcher.getWakeups());
+}
+
+void bench_dispatcher(void){
+  Dispatcher dispatcher;
+  for (int i = 0;i < 8;i++) dispatcher.add("poll",handler0,EV_B,1000);
+  bench::result r = bench::run("Dispatcher dispatch (nothing due)",10000,[&](uint32_t i){
+    dispatcher.dispatch(EV_A);
+  });
+  bench::print(r);
+  TEST_ASSERT_EQUAL(0,calls[0]);
+  TEST_ASSERT_EQUAL(0,r.allocsPerOp);
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_dispatch);
+  RUN_TEST(test_wait);
+  RUN_TEST(bench_dispatcher);
+  return UNITY_END();
+}
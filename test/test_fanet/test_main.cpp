@@ -0,0 +1,164 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for FanetLora (frame decoding, neighbour-list) and Flarm sentences
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Bench.h>
+#include <FanetLora.h>
+#include <Flarm.h>
+
+FanetLora fanet;
+
+void setUp(void){
+  native::setTime(1000000);
+}
+
+void tearDown(void){
+}
+
+static FanetLora::trackingData makeTracking(uint32_t devId,float lat,float lon){
+  FanetLora::trackingData data;
+  memset(&data,0,sizeof(data));
+  data.devId = devId;
+  data.lat = lat;
+  data.lon = lon;
+  data.altitude = 1500;
+  data.aircraftType = FanetLora::paraglider;
+  data.speed = 36.0;
+  data.climb = 1.5;
+  data.heading = 90.0;
+  data.OnlineTracking = true;
+  data.rssi = -80;
+  data.snr = 5;
+  return data;
+}
+
+void test_tracking_roundtrip(void){
+  FanetLora::trackingData tx = makeTracking(0x081234,47.5,13.25);
+  FanetLora::trackingData rx;
+  while (fanet.getTrackingData(&rx)); //empty queue
+  fanet.simulateTracking(&tx);
+  TEST_ASSERT_TRUE(fanet.getTrackingData(&rx));
+  TEST_ASSERT_EQUAL_HEX32(0x081234,rx.devId);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001,47.5,rx.lat);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001,13.25,rx.lon);
+  TEST_ASSERT_FLOAT_WITHIN(1.0,1500,rx.altitude);
+  TEST_ASSERT_EQUAL(FanetLora::paraglider,rx.aircraftType);
+  TEST_ASSERT_FLOAT_WITHIN(1.0,36.0,rx.speed);
+  TEST_ASSERT_FLOAT_WITHIN(0.2,1.5,rx.climb);
+  TEST_ASSERT_FLOAT_WITHIN(2.0,90.0,rx.heading);
+  TEST_ASSERT_EQUAL(-80,rx.rssi);
+  TEST_ASSERT_FALSE(fanet.getTrackingData(&rx));
+}
+
+void test_neighbour_list(void){
+  uint8_t count = fanet.getNeighboursCount();
+  uint32_t changes = fanet.getNeighbourChanges();
+  FanetLora::trackingData tx = makeTracking(0x08ABCD,47.6,13.3);
+  fanet.simulateTracking(&tx);
+  TEST_ASSERT_EQUAL(count + 1,fanet.getNeighboursCount());
+  TEST_ASSERT_NOT_EQUAL(changes,fanet.getNeighbourChanges()); //proximity is updated
+  changes = fanet.getNeighbourChanges();
+  fanet.simulateTracking(&tx); //same station --> same slot
+  TEST_ASSERT_EQUAL(count + 1,fanet.getNeighboursCount());
+  TEST_ASSERT_NOT_EQUAL(changes,fanet.getNeighbourChanges()); //new position
+  FanetLora::neighbour n;
+  bool bFound = false;
+  for (int i = 0;i < MAXNEIGHBOURS;i++){
+    if ((fanet.getNeighbour(i,&n)) && (n.devId == 0x08ABCD)){
+      bFound = true;
+      TEST_ASSERT_FLOAT_WITHIN(0.0001,47.6,n.lat);
+      TEST_ASSERT_EQUAL_UINT32(millis(),n.tLastMsg);
+    }
+  }
+  TEST_ASSERT_TRUE(bFound);
+}
+
+//100 frames arrive before the application polls, taskStandard drains them in batches
+void test_rx_burst(void){
+  FanetLora::trackingData tx = makeTracking(0x082000,47.5,13.25);
+  FanetLora::trackingData rx;
+  rxQueueStats before,after,name,weather;
+  while (fanet.getTrackingData(&rx)); //empty queue
+  fanet.getRxStats(&before,&name,&weather);
+  for (int i = 0;i < 100;i++){
+    tx.devId = 0x082000 + i;
+    tx.lat = 47.5 + i * 0.001;
+    fanet.simulateTracking(&tx);
+  }
+  int received = 0;
+  while (fanet.getTrackingData(&rx)){
+    TEST_ASSERT_EQUAL_HEX32(0x082000 + received,rx.devId); //in order of reception
+    TEST_ASSERT_FLOAT_WITHIN(0.0001,47.5 + received * 0.001,rx.lat);
+    received++;
+  }
+  TEST_ASSERT_EQUAL(100,received);
+  fanet.getRxStats(&after,&name,&weather);
+  TEST_ASSERT_EQUAL(100,after.pushed - before.pushed);
+  TEST_ASSERT_EQUAL(before.overflow,after.overflow);
+  TEST_ASSERT_TRUE(after.maxFill >= 100);
+  //one frame more than the queue holds --> oldest is dropped and counted
+  for (int i = 0;i < RXQUEUE_TRACKING + 1;i++){
+    tx.devId = 0x083000 + i;
+    fanet.simulateTracking(&tx);
+  }
+  TEST_ASSERT_TRUE(fanet.getTrackingData(&rx));
+  TEST_ASSERT_EQUAL_HEX32(0x083001,rx.devId);
+  while (fanet.getTrackingData(&rx));
+  fanet.getRxStats(&after,&name,&weather);
+  TEST_ASSERT_EQUAL(before.overflow + 1,after.overflow);
+}
+
+void test_flarm_sentence(void){
+  Flarm flarm;
+  FlarmtrackingData pilot;
+  pilot.DevId = "08ABCD";
+  pilot.lat = 47.5;
+  pilot.lon = 13.25;
+  pilot.altitude = 1500;
+  pilot.aircraftType = eFlarmAircraftType::PARA_GLIDER;
+  pilot.speed = 36.0;
+  pilot.climb = 1.5;
+  pilot.heading = 90.0;
+  String s = flarm.writeFlarmData(100.0,-200.0,50.0,&pilot);
+  String sentence = s.substring(0,s.indexOf('*') + 1);
+  TEST_ASSERT_EQUAL_STRING("$PFLAA,0,100,-200,50,2,08ABCD,90,0,10.0,1.5,7*",sentence.c_str());
+  //checksum is xor of all chars between $ and *
+  uint8_t chk = 0;
+  for (int i = 1;i < s.indexOf('*');i++) chk ^= s[i];
+  TEST_ASSERT_EQUAL(chk,strtol(s.substring(s.indexOf('*') + 1,s.indexOf('*') + 3).c_str(),NULL,16));
+  TEST_ASSERT_TRUE(s.endsWith("\r\n"));
+}
+
+void bench_fanet(void){
+  FanetLora::trackingData tx = makeTracking(0x081000,47.5,13.25);
+  FanetLora::trackingData rx;
+  bench::result r = bench::run("FanetLora rx tracking-frame",2000,[&](uint32_t i){
+    tx.devId = 0x081000 + (i % 32);
+    fanet.simulateTracking(&tx);
+    fanet.getTrackingData(&rx);
+    if (fanet.isNewMsg()) fanet.getactMsg(); //like taskStandard
+  });
+  bench::print(r);
+  Flarm flarm;
+  FlarmtrackingData me = {"000001",47.5,13.25,1500,eFlarmAircraftType::PARA_GLIDER,0,0,0};
+  FlarmtrackingData pilot = {"08ABCD",47.51,13.26,1550,eFlarmAircraftType::PARA_GLIDER,36.0,1.5,90.0};
+  volatile size_t len = 0;
+  r = bench::run("Flarm writeFlarmData",2000,[&](uint32_t i){
+    len += flarm.writeFlarmData(&me,&pilot).length();
+  });
+  bench::print(r);
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_tracking_roundtrip);
+  RUN_TEST(test_neighbour_list);
+  RUN_TEST(test_rx_burst);
+  RUN_TEST(test_flarm_sentence);
+  RUN_TEST(bench_fanet);
+  return UNITY_END();
+}
@@ -0,0 +1,194 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for FixedString (cut, utf-8, compare) and copy-cost/heap-traffic against String over a simulated day of fanet-traffic
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Bench.h>
+#include <type_traits>
+#include <FixedString.h>
+#include <FanetLora.h>
+
+#define SIM_NEIGHBOURS 20 //stations around a ground-station
+#define SIM_SECONDS 86400 //24h
+#define SIM_NAMEINTERVAL 240 //every station sends its name every 4min [s]
+
+//neighbour-entry before FixedString (name on the heap)
+typedef struct {
+  uint32_t devId;
+  String name;
+  float lat;
+  float lon;
+  float altitude;
+  uint32_t tLastMsg;
+} neighbourString;
+
+static_assert(std::is_trivially_copyable<FixedString<32>>::value,"FixedString has to be copyable with memcpy");
+static_assert(std::is_trivially_copyable<FanetLora::neighbour>::value,"neighbour has to be copyable with memcpy");
+
+void setUp(void){
+  native::setTime(1000000);
+}
+
+void tearDown(void){
+}
+
+void test_cut(void){
+  FixedString<8> s;
+  TEST_ASSERT_TRUE(s.assign("01234567"));
+  TEST_ASSERT_EQUAL_STRING("01234567",s.c_str());
+  TEST_ASSERT_FALSE(s.assign("0123456789"));
+  TEST_ASSERT_EQUAL_STRING("01234567",s.c_str());
+  TEST_ASSERT_EQUAL(8,s.length());
+  TEST_ASSERT_TRUE(s.assign(""));
+  TEST_ASSERT_EQUAL(0,s.length());
+  TEST_ASSERT_TRUE(s.assign(NULL));
+  TEST_ASSERT_EQUAL(0,s.length());
+}
+
+//a multibyte-char at the end is dropped completely
+void test_utf8(void){
+  FixedString<4> s;
+  TEST_ASSERT_FALSE(s.assign("abc\xC3\xA4")); //"abcä" = 5 bytes
+  TEST_ASSERT_EQUAL_STRING("abc",s.c_str());
+  TEST_ASSERT_FALSE(s.assign("a\xE2\x82\xAC\x62")); //"a€b" = 5 bytes
+  TEST_ASSERT_EQUAL_STRING("a\xE2\x82\xAC",s.c_str());
+  TEST_ASSERT_TRUE(s.assign("\xC3\xA4\xC3\xB6")); //"äö" fits
+  TEST_ASSERT_EQUAL(4,s.length());
+}
+
+//equal strings are equal in memory --> settings are compared with memcmp
+void test_compare(void){
+  FixedString<16> a("long name here");
+  FixedString<16> b("x");
+  a = "x";
+  TEST_ASSERT_TRUE(a == b);
+  TEST_ASSERT_EQUAL(0,memcmp(&a,&b,sizeof(a)));
+  FixedString<32> c("x");
+  TEST_ASSERT_TRUE(a == c);
+  TEST_ASSERT_TRUE(a != "y");
+  String s = a;
+  TEST_ASSERT_EQUAL_STRING("x",s.c_str());
+  TEST_ASSERT_EQUAL(200,FixedString<200>::capacity());
+}
+
+//copy of one neighbour, like getNeighbour for display and proximity
+void bench_copy(void){
+  FanetLora::neighbour fixedSrc = FanetLora::neighbour();
+  fixedSrc.devId = 0x08ABCD;
+  fixedSrc.name = "Paraglider Pilot Name";
+  FanetLora::neighbour fixedDst;
+  bench::result rFixed = bench::run("copy neighbour FixedString<32>",100000,[&](uint32_t i){
+    fixedDst = fixedSrc;
+    __asm__ __volatile__("" : : "r"(&fixedDst) : "memory");
+  });
+  bench::print(rFixed);
+  neighbourString stringSrc;
+  stringSrc.devId = 0x08ABCD;
+  stringSrc.name = "Paraglider Pilot Name";
+  neighbourString stringDst;
+  bench::result rString = bench::run("copy neighbour String",100000,[&](uint32_t i){
+    neighbourString tmp = stringSrc; //copy into the caller (returned by value)
+    stringDst = tmp;
+    __asm__ __volatile__("" : : "r"(&stringDst) : "memory");
+  });
+  bench::print(rString);
+  TEST_ASSERT_EQUAL(0,rFixed.allocsPerOp);
+  TEST_ASSERT_TRUE(rString.allocsPerOp >= 1);
+  TEST_ASSERT_EQUAL_STRING("Paraglider Pilot Name",fixedDst.name.c_str());
+}
+
+//one day of a ground-station: every station sends tracking every second and its name every 4min
+//every second the neighbour-list is copied (display, proximity) and the rx-queues are drained (ogn)
+//heap-traffic of the copies: every alloc/free of a String is a chance to fragment the heap
+void bench_day(void){
+  FanetLora fanet;
+  FanetLora::trackingData tx;
+  memset(&tx,0,sizeof(tx));
+  tx.aircraftType = FanetLora::paraglider;
+  tx.altitude = 1500;
+  tx.OnlineTracking = true;
+  uint8_t nameFrame[4 + 24] = {0x02,0x08,0x00,0x00};
+  FanetLora::neighbour copyFixed[MAXNEIGHBOURS];
+  neighbourString tableString[MAXNEIGHBOURS]; //old neighbour-list, copied by value
+  float sum = 0;
+  FanetLora::trackingData rxTracking;
+  FanetLora::nameData rxName;
+  uint64_t copies = 0;
+  uint64_t allocsFixed = 0;
+  uint64_t allocsString = 0;
+  uint64_t cyclesFixed = 0;
+  uint64_t cyclesString = 0;
+  int64_t heapStart = 0;
+  int64_t heapMax = 0;
+  for (uint32_t sec = 0;sec < SIM_SECONDS;sec++){
+    native::advanceMs(1000);
+    //producer (radio), not measured: String-temporaries of the frame-decoding
+    for (int i = 0;i < SIM_NEIGHBOURS;i++){
+      tx.devId = 0x080100 + i;
+      tx.lat = 47.0 + i * 0.01 + (sec % 100) * 0.0001;
+      tx.lon = 13.0 + i * 0.01;
+      fanet.simulateTracking(&tx);
+      if (((sec + i * 7) % SIM_NAMEINTERVAL) == 0){
+        nameFrame[2] = (0x0100 + i) & 0xFF;
+        nameFrame[3] = (0x0100 + i) >> 8;
+        int len = sprintf((char *)&nameFrame[4],"Pilot %02d Schoeckl Nord",i);
+        Frame *frm = new Frame(4 + len,nameFrame);
+        fanet.handle_frame(frm);
+        delete frm;
+        tableString[i].devId = tx.devId;
+        tableString[i].name = (const char *)&nameFrame[4];
+      }
+      tableString[i].lat = tx.lat;
+      tableString[i].lon = tx.lon;
+    }
+    if (fanet.isNewMsg()) fanet.getactMsg(); //like handleFanet
+    //consumers: FixedString
+    uint64_t t0 = bench::cycles();
+    allocsFixed += bench::allocations([&](){
+      for (int i = 0;i < MAXNEIGHBOURS;i++) fanet.getNeighbour(i,&copyFixed[i]);
+      while (fanet.getTrackingData(&rxTracking));
+      while (fanet.getNameData(&rxName));
+    });
+    cyclesFixed += bench::cycles() - t0;
+    //consumers: String, same number of copies
+    t0 = bench::cycles();
+    allocsString += bench::allocations([&](){
+      for (int i = 0;i < MAXNEIGHBOURS;i++){
+        neighbourString n = tableString[i];
+        sum += n.lat;
+      }
+    });
+    cyclesString += bench::cycles() - t0;
+    copies += MAXNEIGHBOURS;
+    //heap in use after the first hour (all stations known) must not grow
+    if (sec == 3600) heapStart = bench::count().inUse;
+    if ((sec > 3600) && ((bench::count().inUse - heapStart) > heapMax)) heapMax = bench::count().inUse - heapStart;
+  }
+  printf("bench 24h FixedString  copies=%llu allocs=%llu cycles/copy=%.1f\n",(unsigned long long)copies,(unsigned long long)allocsFixed,(double)cyclesFixed / copies);
+  printf("bench 24h String       copies=%llu allocs=%llu cycles/copy=%.1f\n",(unsigned long long)copies,(unsigned long long)allocsString,(double)cyclesString / copies);
+  printf("bench 24h heap in use  growth after 1st hour max=%lld bytes\n",(long long)heapMax);
+  fflush(stdout);
+  TEST_ASSERT_EQUAL(0,allocsFixed); //no heap-traffic --> no fragmentation by the copies
+  TEST_ASSERT_TRUE(allocsString >= copies / 2); //names are longer than the sso-buffer
+  TEST_ASSERT_TRUE(heapMax < 1024); //no leak, no growing buffers
+  TEST_ASSERT_TRUE(sum != 0);
+  TEST_ASSERT_TRUE(fanet.getNeighboursCount() >= SIM_NEIGHBOURS);
+  bool bName = false;
+  for (int i = 0;i < MAXNEIGHBOURS;i++){
+    if ((copyFixed[i].devId == 0x080100) && (copyFixed[i].name == "Pilot 00 Schoeckl Nord")) bName = true;
+  }
+  TEST_ASSERT_TRUE(bName);
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_cut);
+  RUN_TEST(test_utf8);
+  RUN_TEST(test_compare);
+  RUN_TEST(bench_copy);
+  RUN_TEST(bench_day);
+  return UNITY_END();
+}
@@ -0,0 +1,330 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for FlightRecorder: ring-size, space of other rings, compact fixes, wrap, igc-reader and export-benchmark
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Bench.h>
+#include <FlightRecorder.h>
+#include <UplinkStore.h>
+#include <vector>
+#include <string>
+#include <thread>
+
+#define SPIFFS_SIZE 172032 //usable bytes of the 0x30000-partition
+#define WEBFILES_SIZE 100000
+#define START_UTC 1656680400 //2022-07-01 13:00:00
+
+typedef struct {
+  uint32_t utc;
+  int32_t lat; //1/60000 deg
+  int32_t lon;
+  int32_t baroAlt;
+  int32_t gpsAlt;
+} igcFix;
+
+static std::vector<igcFix> track; //what was recorded
+static uint32_t utc;
+static double lat,lon,alt,heading;
+static uint32_t seed;
+
+static int noise(void){
+  seed = seed * 1103515245 + 12345;
+  return (int)((seed >> 16) % 5) - 2; //+-2m
+}
+
+static void pump(FlightRecorder &rec){
+  //recorder-task of the firmware
+  xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+  rec.run();
+}
+
+static void fillSpiffs(size_t totalBytes,size_t webBytes){
+  SPIFFS.format();
+  SPIFFS.setTotalBytes(totalBytes);
+  File f = SPIFFS.open("/web.bin","w");
+  std::vector<uint8_t> data(webBytes,0x55);
+  f.write(data.data(),data.size());
+  f.close();
+}
+
+static void startFlight(FlightRecorder &rec){
+  track.clear();
+  utc = START_UTC;
+  lat = 47.5;
+  lon = 13.3;
+  alt = 1500;
+  heading = 0;
+  seed = 1;
+  rec.start();
+  pump(rec);
+}
+
+//1Hz fixes and baro, like taskStandard/taskBaro: 5min thermal (circles, +2m/s), 5min glide (10m/s, -1m/s)
+static void fly(FlightRecorder &rec,uint32_t seconds,int neighbours){
+  int16_t accel[3] = {0,0,1000};
+  int16_t gyro[3] = {0,0,0};
+  for (uint32_t s = 0;s < seconds;s++){
+    native::advanceMs(1000);
+    utc++;
+    bool bThermal = ((utc / 300) % 2) == 0;
+    double speed = (bThermal) ? 9.5 : 10.0;
+    if (bThermal) heading += 18.0; //20s per circle
+    alt += (bThermal) ? 2.0 : -1.0;
+    lat += speed * cos(heading * PI / 180.0) / 111120.0;
+    lon += (speed * sin(heading * PI / 180.0) + 3.0) / (111120.0 * cos(lat * PI / 180.0)); //3m/s wind
+    double gpsAlt = alt + 50 + noise();
+    rec.logBaro(1013.25 - alt / 8.3,alt,(bThermal) ? 2.0 : -1.0,15.0);
+    rec.logImu(accel,gyro);
+    rec.logGps(utc,lat,lon,gpsAlt);
+    if ((utc % 300) == 0){
+      for (int i = 0;i < neighbours;i++) rec.logNeighbour(0x110000 + i,lat + 0.01 * i,lon - 0.01 * i,alt + 100,1,-90);
+    }
+    igcFix fix = {utc,(int32_t)lround(lat * 60000.0),(int32_t)lround(lon * 60000.0),(int32_t)alt,(int32_t)gpsAlt};
+    track.push_back(fix);
+    pump(rec);
+  }
+}
+
+static std::string exportIgc(FlightRecorder &rec,size_t chunk){
+  std::string igc;
+  std::vector<uint8_t> buffer(chunk);
+  if (!rec.igcOpen()) return igc;
+  while (1){
+    size_t len = rec.igcRead(buffer.data(),chunk);
+    if (len == 0) break;
+    igc.append((const char *)buffer.data(),len);
+  }
+  return igc;
+}
+
+//igc-reader: B-records of a file, false on a malformed line
+static bool parseIgc(const std::string &igc,std::vector<igcFix> &fixes,std::vector<std::string> *pOther = NULL){
+  size_t pos = 0;
+  fixes.clear();
+  while (pos < igc.size()){
+    size_t end = igc.find("\r\n",pos);
+    if (end == std::string::npos) return false;
+    const char *l = igc.c_str() + pos;
+    size_t len = end - pos;
+    pos = end + 2;
+    if (l[0] != 'B'){
+      if (pOther) pOther->push_back(std::string(l,len));
+      continue;
+    }
+    if (len != 35) return false;
+    int hh,mm,ss,latD,latM,lonD,lonM,baro,gps;
+    char ns,ew,v;
+    if (sscanf(l,"B%2d%2d%2d%2d%5d%c%3d%5d%c%c%5d%5d",&hh,&mm,&ss,&latD,&latM,&ns,&lonD,&lonM,&ew,&v,&baro,&gps) != 12) return false;
+    if (((ns != 'N') && (ns != 'S')) || ((ew != 'E') && (ew != 'W')) || (v != 'A')) return false;
+    igcFix fix;
+    fix.utc = hh * 3600 + mm * 60 + ss; //time of day
+    fix.lat = (latD * 60000 + latM) * ((ns == 'S') ? -1 : 1);
+    fix.lon = (lonD * 60000 + lonM) * ((ew == 'W') ? -1 : 1);
+    fix.baroAlt = baro;
+    fix.gpsAlt = gps;
+    fixes.push_back(fix);
+  }
+  return true;
+}
+
+static void assertTrack(const std::vector<igcFix> &fixes,size_t offset){
+  TEST_ASSERT_EQUAL(track.size() - offset,fixes.size());
+  for (size_t i = 0;i < fixes.size();i++){
+    const igcFix &exp = track[i + offset];
+    if ((fixes[i].lat != exp.lat) || (fixes[i].lon != exp.lon) || (fixes[i].baroAlt != exp.baroAlt) || (fixes[i].gpsAlt != exp.gpsAlt) || (fixes[i].utc != (exp.utc % 86400))){
+      char msg[120];
+      snprintf(msg,sizeof(msg),"fix %u: %d/%d %d/%d %d/%d %d/%d",(unsigned)i,fixes[i].lat,exp.lat,fixes[i].lon,exp.lon,fixes[i].baroAlt,exp.baroAlt,fixes[i].gpsAlt,exp.gpsAlt);
+      TEST_FAIL_MESSAGE(msg);
+    }
+  }
+}
+
+void setUp(void){
+  native::setTime(1000000);
+  fillSpiffs(SPIFFS_SIZE,WEBFILES_SIZE);
+}
+
+void tearDown(void){
+}
+
+void test_ring_uses_free_space(void){
+  FlightRecorder rec;
+  TEST_ASSERT_TRUE(rec.begin("pilot","paraglider"));
+  TEST_ASSERT_EQUAL((SPIFFS_SIZE - WEBFILES_SIZE - FLIGHTRECORDER_MINFREE) / FLIGHTRECORDER_BLOCKSIZE,rec.getRingBlocks());
+  rec.end();
+  //existing ring is kept (recorded flights), if free space is nearly the same
+  File f = SPIFFS.open("/settings.bin","w");
+  uint8_t data[1000] = {0};
+  f.write(data,sizeof(data));
+  f.close();
+  FlightRecorder rec2;
+  TEST_ASSERT_TRUE(rec2.begin("pilot","paraglider"));
+  TEST_ASSERT_EQUAL(rec.getRingBlocks(),rec2.getRingBlocks());
+  rec2.end();
+  //more space --> bigger ring
+  SPIFFS.remove("/web.bin");
+  FlightRecorder rec3;
+  TEST_ASSERT_TRUE(rec3.begin("pilot","paraglider"));
+  TEST_ASSERT_EQUAL((SPIFFS_SIZE - 1000 - FLIGHTRECORDER_MINFREE) / FLIGHTRECORDER_BLOCKSIZE,rec3.getRingBlocks());
+  rec3.end();
+}
+
+//uplink-store is created after the ring --> it gets the space reserved for it
+void test_ring_keeps_reserved_space(void){
+  UplinkStore store("/traccar.bin",128,200);
+  FlightRecorder rec;
+  rec.reserveSpace(store.getFileName(),store.getFileSize());
+  TEST_ASSERT_TRUE(rec.begin("pilot","paraglider"));
+  TEST_ASSERT_EQUAL((SPIFFS_SIZE - WEBFILES_SIZE - FLIGHTRECORDER_MINFREE - store.getFileSize()) / FLIGHTRECORDER_BLOCKSIZE,rec.getRingBlocks());
+  TEST_ASSERT_TRUE(store.begin(86400,500));
+  store.end();
+  rec.end();
+  //existing store is already in the used space --> same ring after restart
+  FlightRecorder rec2;
+  rec2.reserveSpace(store.getFileName(),store.getFileSize());
+  TEST_ASSERT_TRUE(rec2.begin("pilot","paraglider"));
+  TEST_ASSERT_EQUAL(rec.getRingBlocks(),rec2.getRingBlocks());
+  rec2.end();
+  //without reservation the store doesn't fit anymore
+  SPIFFS.remove("/traccar.bin");
+  SPIFFS.remove(FLIGHTRECORDER_FILE);
+  FlightRecorder rec3;
+  TEST_ASSERT_TRUE(rec3.begin("pilot","paraglider"));
+  TEST_ASSERT_FALSE(store.begin(86400,500));
+  rec3.end();
+}
+
+void test_igc_roundtrip(void){
+  FlightRecorder rec;
+  TEST_ASSERT_TRUE(rec.begin("Max Muster","paraglider"));
+  startFlight(rec);
+  fly(rec,3600,3);
+  rec.stop();
+  pump(rec);
+  std::string igc = exportIgc(rec,1436);
+  TEST_ASSERT_EQUAL_STRING_LEN("AXGXGXAirCom\r\nHFDTE010722\r\nHFPLTPILOTINCHARGE:Max Muster\r\n",igc.c_str(),56);
+  std::vector<igcFix> fixes;
+  std::vector<std::string> other;
+  TEST_ASSERT_TRUE(parseIgc(igc,fixes,&other));
+  assertTrack(fixes,0);
+  for (size_t i = 0;i < other.size();i++) TEST_ASSERT_TRUE(other[i][0] != 'L'); //not wrapped
+  TEST_ASSERT_EQUAL(0,rec.getDropCount());
+  rec.end();
+}
+
+void test_six_hour_flight_fits(void){
+  FlightRecorder rec;
+  TEST_ASSERT_TRUE(rec.begin("pilot","paraglider"));
+  startFlight(rec);
+  uint32_t blocks = rec.getBlockCount();
+  fly(rec,6 * 3600,3);
+  rec.stop();
+  pump(rec);
+  blocks = rec.getBlockCount() - blocks;
+  printf("ring %d blocks, 6h flight (1Hz, 3 neighbours) = %u blocks, %.1f bytes/s\n",rec.getRingBlocks(),blocks,blocks * (float)FLIGHTRECORDER_BLOCKSIZE / (6 * 3600));
+  TEST_ASSERT_EQUAL(0,rec.getWrapCount());
+  std::vector<igcFix> fixes;
+  TEST_ASSERT_TRUE(parseIgc(exportIgc(rec,1436),fixes));
+  assertTrack(fixes,0);
+  rec.end();
+}
+
+void test_wrap_reported(void){
+  fillSpiffs(SPIFFS_SIZE,SPIFFS_SIZE - FLIGHTRECORDER_MINFREE - 4 * FLIGHTRECORDER_BLOCKSIZE);
+  FlightRecorder rec;
+  TEST_ASSERT_TRUE(rec.begin("pilot","paraglider"));
+  TEST_ASSERT_EQUAL(4,rec.getRingBlocks());
+  startFlight(rec);
+  fly(rec,3 * 3600,3);
+  rec.stop();
+  pump(rec);
+  TEST_ASSERT_TRUE(rec.getWrapCount() > 0);
+  std::vector<igcFix> fixes;
+  std::vector<std::string> other;
+  TEST_ASSERT_TRUE(parseIgc(exportIgc(rec,1436),fixes,&other));
+  TEST_ASSERT_TRUE(other.size() > 0);
+  TEST_ASSERT_EQUAL_STRING("LGXARING FULL, START OF FLIGHT OVERWRITTEN",other.back().c_str());
+  //end of the flight is complete
+  TEST_ASSERT_TRUE(fixes.size() < track.size());
+  assertTrack(fixes,track.size() - fixes.size());
+  rec.end();
+}
+
+void test_export_while_recording(void){
+  //recorder-task writes blocks while the web-server exports --> file-access is serialized
+  FlightRecorder rec;
+  TEST_ASSERT_TRUE(rec.begin("pilot","paraglider"));
+  startFlight(rec);
+  fly(rec,2 * 3600,3);
+  volatile bool bRun = true;
+  std::thread recorder([&]{
+    while (bRun){
+      for (int i = 0;i < 100;i++) rec.logNeighbour(0x110000 + i,47.5,13.3,1000,1,-90); //fills blocks fast
+      xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+      rec.run();
+    }
+  });
+  for (int i = 0;i < 20;i++){
+    std::vector<igcFix> fixes;
+    TEST_ASSERT_TRUE(parseIgc(exportIgc(rec,512),fixes));
+    for (size_t j = 1;j < fixes.size();j++) TEST_ASSERT_EQUAL(fixes[j - 1].utc + 1,fixes[j].utc);
+  }
+  bRun = false;
+  recorder.join();
+  rec.stop();
+  pump(rec);
+  rec.end();
+}
+
+void bench_log_fix(void){
+  FlightRecorder rec;
+  TEST_ASSERT_TRUE(rec.begin("pilot","paraglider"));
+  startFlight(rec);
+  bench::result r = bench::run("logGps (1Hz track)",3600,[&](uint32_t i){
+    utc++;
+    lat += 0.00008;
+    rec.logGps(utc,lat,lon,alt);
+    if ((i % 512) == 0) pump(rec);
+  });
+  bench::print(r);
+  TEST_ASSERT_EQUAL(0,r.allocsPerOp);
+  rec.stop();
+  pump(rec);
+  rec.end();
+}
+
+void bench_igc_export(void){
+  //multi-hour log: igc-reader over the whole export has to be below 1s
+  FlightRecorder rec;
+  TEST_ASSERT_TRUE(rec.begin("pilot","paraglider"));
+  startFlight(rec);
+  fly(rec,6 * 3600,3);
+  rec.stop();
+  pump(rec);
+  size_t count = 0;
+  bench::result r = bench::run("igc export+parse (6h log)",5,[&](uint32_t i){
+    std::vector<igcFix> fixes;
+    parseIgc(exportIgc(rec,1436),fixes);
+    count = fixes.size();
+  });
+  bench::print(r);
+  TEST_ASSERT_EQUAL(6 * 3600,count);
+  TEST_ASSERT_TRUE(r.nsPerOp < 1e9);
+  rec.end();
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_ring_uses_free_space);
+  RUN_TEST(test_ring_keeps_reserved_space);
+  RUN_TEST(test_igc_roundtrip);
+  RUN_TEST(test_six_hour_flight_fits);
+  RUN_TEST(test_wrap_reported);
+  RUN_TEST(test_export_while_recording);
+  RUN_TEST(bench_log_fix);
+  RUN_TEST(bench_igc_export);
+  return UNITY_END();
+}
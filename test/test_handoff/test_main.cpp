@@ -0,0 +1,112 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for Handoff (sequence-lock between a writer-task and readers on the other core)
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Bench.h>
+#include <Handoff.h>
+
+#define HANDOFF_TESTTIME 500 //[ms]
+
+//like the gps-fix: doubles can tear, if they are copied while the writer changes them
+typedef struct {
+  uint32_t count;
+  double lat;
+  double lon;
+  float altitude;
+  uint32_t check; //~count
+} testFix;
+
+Handoff<testFix> handoff;
+static volatile bool bWriterStop = false;
+static volatile uint32_t writes = 0;
+
+static testFix makeFix(uint32_t count){
+  testFix fix;
+  fix.count = count;
+  fix.lat = 47.0 + count * 1e-7;
+  fix.lon = 13.0 + count * 1e-7;
+  fix.altitude = count % 5000;
+  fix.check = ~count;
+  return fix;
+}
+
+void taskWriter(void *pvParameters){
+  uint32_t i = 0;
+  while (!bWriterStop) handoff.write(makeFix(++i));
+  writes = i;
+  vTaskDelete(NULL);
+}
+
+void setUp(void){
+  native::realTime(); //writer and reader run in their own threads
+}
+
+void tearDown(void){
+}
+
+void test_version(void){
+  Handoff<testFix> h;
+  testFix fix;
+  h.read(&fix);
+  TEST_ASSERT_EQUAL(0,fix.count); //starts zeroed
+  TEST_ASSERT_EQUAL(0,h.getVersion());
+  h.write(makeFix(5));
+  h.write(makeFix(6));
+  TEST_ASSERT_EQUAL(2,h.getVersion());
+  h.read(&fix);
+  TEST_ASSERT_EQUAL(6,fix.count);
+}
+
+//reader on core 0 while the writer on core 1 writes as fast as it can --> no torn copies, counts never go back
+void test_no_torn_reads(void){
+  bWriterStop = false;
+  TaskHandle_t xWriter;
+  xTaskCreatePinnedToCore(taskWriter,"writer",4096,NULL,5,&xWriter,1);
+  uint32_t reads = 0;
+  uint32_t torn = 0;
+  uint32_t last = 0;
+  bool bBack = false;
+  uint32_t tStart = millis();
+  while ((millis() - tStart) < HANDOFF_TESTTIME){
+    testFix fix;
+    handoff.read(&fix);
+    if (fix.count == 0) continue; //nothing written yet
+    testFix expected = makeFix(fix.count);
+    if ((fix.lat != expected.lat) || (fix.lon != expected.lon) || (fix.altitude != expected.altitude) || (fix.check != expected.check)) torn++;
+    if (fix.count < last) bBack = true;
+    last = fix.count;
+    reads++;
+  }
+  bWriterStop = true;
+  while (eTaskGetState(xWriter) != eDeleted) delay(1);
+  printf("bench Handoff writes=%u reads=%u torn=%u\n",writes,reads,torn);
+  TEST_ASSERT_EQUAL(0,torn);
+  TEST_ASSERT_FALSE(bBack);
+  TEST_ASSERT_TRUE(reads > 1000);
+  TEST_ASSERT_EQUAL(writes,handoff.getVersion());
+}
+
+void bench_handoff(void){
+  testFix fix = makeFix(1);
+  bench::result r = bench::run("Handoff write",10000,[&](uint32_t i){
+    handoff.write(fix);
+  });
+  bench::print(r);
+  r = bench::run("Handoff read",10000,[&](uint32_t i){
+    handoff.read(&fix);
+  });
+  bench::print(r);
+  TEST_ASSERT_EQUAL(0,r.allocsPerOp);
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_version);
+  RUN_TEST(test_no_torn_reads);
+  RUN_TEST(bench_handoff);
+  return UNITY_END();
+}
@@ -0,0 +1,239 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for ModemManager/ModemClient against the simulated modem (order, priorities, queueing-delay)
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Bench.h>
+#include <ModemSim.h>
+#include <ModemManager.h>
+#include <ModemClient.h>
+
+ModemSim sim;
+ModemSimSocket ognSocket(&sim,0);
+ModemSimSocket wuSocket(&sim,1);
+ModemManager manager;
+TaskHandle_t xHandleModem = NULL;
+volatile bool bModemRun = false;
+
+//like taskGsm: owns the modem and serves the requests
+void taskModem(void *pvParameters){
+  while (bModemRun) manager.run(10);
+  vTaskDelete(NULL);
+}
+
+static void startModem(void){
+  manager.begin();
+  manager.setOnline(true);
+  bModemRun = true;
+  xTaskCreatePinnedToCore(taskModem,"taskModem",4096,NULL,6,&xHandleModem,1);
+}
+
+//like the end of taskGsm: waiting requests are failed
+static void stopModem(void){
+  bModemRun = false;
+  while (eTaskGetState(xHandleModem) != eDeleted) delay(1);
+  manager.end();
+}
+
+//waits until the modem-task has fetched data for the client
+static int waitAvailable(Client *client,uint32_t timeout){
+  uint32_t tStart = millis();
+  while ((client->available() == 0) && ((millis() - tStart) < timeout)) delay(1);
+  return client->available();
+}
+
+void setUp(void){
+  native::realTime(); //modem-task runs in its own thread
+  sim.latencyMs = 0;
+  sim.maxWrite = 1460;
+  sim.overlaps = 0;
+  sim.takeLog();
+  ognSocket.takeOutput();
+  wuSocket.takeOutput();
+}
+
+void tearDown(void){
+}
+
+void test_roundtrip(void){
+  ModemClient client(&manager,&ognSocket,ModemManager::PRIO_HIGH);
+  startModem();
+  TEST_ASSERT_EQUAL(1,client.connect("aprs.glidernet.org",14580));
+  TEST_ASSERT_EQUAL_STRING("aprs.glidernet.org",ognSocket.host().c_str());
+  TEST_ASSERT_EQUAL(5,client.write((const uint8_t *)"hello",5));
+  client.flush(); //sent by the modem-task
+  TEST_ASSERT_EQUAL_STRING("hello",ognSocket.takeOutput().c_str());
+  ognSocket.inject("# logresp\r\n");
+  TEST_ASSERT_EQUAL(11,waitAvailable(&client,1000));
+  char buf[16];
+  TEST_ASSERT_EQUAL(11,client.read((uint8_t *)buf,sizeof(buf)));
+  buf[11] = 0;
+  TEST_ASSERT_EQUAL_STRING("# logresp\r\n",buf);
+  TEST_ASSERT_EQUAL(-1,client.read());
+  client.stop();
+  uint32_t tStart = millis();
+  while ((ognSocket.connected()) && ((millis() - tStart) < 1000)) delay(1);
+  TEST_ASSERT_FALSE(ognSocket.connected());
+  stopModem();
+}
+
+//upload in progress --> ogn-line waits max. for one AT-exchange
+void test_priority(void){
+  ModemClient ogn(&manager,&ognSocket,ModemManager::PRIO_HIGH);
+  ModemClient wu(&manager,&wuSocket,ModemManager::PRIO_LOW);
+  startModem();
+  TEST_ASSERT_EQUAL(1,ogn.connect("aprs.glidernet.org",14580));
+  TEST_ASSERT_EQUAL(1,wu.connect("weatherstation.wunderground.com",80));
+  sim.latencyMs = 20;
+  sim.maxWrite = 256;
+  sim.takeLog();
+  ModemManager::stats before = manager.getStats(ModemManager::PRIO_HIGH);
+  uint8_t upload[MODEMCLIENT_TXBUF];
+  memset(upload,'u',sizeof(upload));
+  uint32_t tStart = millis();
+  TEST_ASSERT_EQUAL(sizeof(upload),wu.write(upload,sizeof(upload))); //doesn't wait for the modem
+  TEST_ASSERT_TRUE((millis() - tStart) < 20);
+  delay(30); //upload is running
+  ogn.write((const uint8_t *)"position\r\n",10);
+  ogn.flush();
+  wu.flush();
+  std::vector<ModemSim::logEntry> opLog = sim.takeLog();
+  int ognWrite = -1;
+  int lastWuWrite = -1;
+  for (int i = 0;i < (int)opLog.size();i++){
+    if ((opLog[i].op == 'w') && (opLog[i].socket == 0)) ognWrite = i;
+    if ((opLog[i].op == 'w') && (opLog[i].socket == 1)) lastWuWrite = i;
+  }
+  TEST_ASSERT_TRUE(ognWrite >= 0);
+  TEST_ASSERT_TRUE(ognWrite < lastWuWrite); //ogn goes between the blocks of the upload
+  TEST_ASSERT_EQUAL(sizeof(upload),wuSocket.takeOutput().size());
+  TEST_ASSERT_EQUAL_STRING("position\r\n",ognSocket.takeOutput().c_str());
+  ModemManager::stats after = manager.getStats(ModemManager::PRIO_HIGH);
+  TEST_ASSERT_TRUE(after.count > before.count);
+  TEST_ASSERT_TRUE(after.waitMax <= 2 * sim.latencyMs + 10); //queueing-delay: max. one running exchange
+  ModemManager::stats low = manager.getStats(ModemManager::PRIO_LOW);
+  TEST_ASSERT_TRUE(low.busySum >= 6 * sim.latencyMs); //1536 bytes in 256 byte blocks
+  TEST_ASSERT_EQUAL(0,sim.overlaps);
+  stopModem();
+}
+
+//several tasks use the modem at the same time --> AT-traffic is serialized
+static ModemClient *pStress[2];
+static volatile int stressDone = 0;
+
+void taskStress(void *pvParameters){
+  ModemClient *client = pStress[(intptr_t)pvParameters];
+  for (int i = 0;i < 50;i++){
+    client->write((const uint8_t *)"0123456789",10);
+    client->available();
+    client->connected();
+    delay(1);
+  }
+  client->flush();
+  stressDone++;
+  vTaskDelete(NULL);
+}
+
+void test_serialized(void){
+  ModemClient ogn(&manager,&ognSocket,ModemManager::PRIO_HIGH);
+  ModemClient wu(&manager,&wuSocket,ModemManager::PRIO_LOW);
+  startModem();
+  TEST_ASSERT_EQUAL(1,ogn.connect("aprs.glidernet.org",14580));
+  TEST_ASSERT_EQUAL(1,wu.connect("weatherstation.wunderground.com",80));
+  sim.latencyMs = 1;
+  pStress[0] = &ogn;
+  pStress[1] = &wu;
+  stressDone = 0;
+  xTaskCreatePinnedToCore(taskStress,"stress0",4096,(void *)0,5,NULL,0);
+  xTaskCreatePinnedToCore(taskStress,"stress1",4096,(void *)1,5,NULL,1);
+  uint32_t tStart = millis();
+  while ((stressDone < 2) && ((millis() - tStart) < 5000)) delay(5);
+  TEST_ASSERT_EQUAL(2,stressDone);
+  TEST_ASSERT_EQUAL(0,sim.overlaps);
+  TEST_ASSERT_EQUAL(500,ognSocket.takeOutput().size());
+  TEST_ASSERT_EQUAL(500,wuSocket.takeOutput().size());
+  stopModem();
+}
+
+static bool modemTaskCall(void *arg){
+  *(TaskHandle_t *)arg = xTaskGetCurrentTaskHandle();
+  return true;
+}
+
+void test_call(void){
+  startModem();
+  TaskHandle_t caller = NULL;
+  TEST_ASSERT_TRUE(manager.call(ModemManager::PRIO_NORMAL,modemTaskCall,&caller));
+  TEST_ASSERT_TRUE(caller == xHandleModem); //executed by the owner of the modem
+  stopModem();
+}
+
+void test_offline(void){
+  ModemClient ogn(&manager,&ognSocket,ModemManager::PRIO_HIGH);
+  startModem();
+  manager.setOnline(false);
+  sim.takeLog();
+  TEST_ASSERT_EQUAL(0,ogn.connect("aprs.glidernet.org",14580));
+  TEST_ASSERT_EQUAL(0,ogn.write((const uint8_t *)"x",1));
+  TEST_ASSERT_FALSE(ogn.connected());
+  delay(20);
+  TEST_ASSERT_EQUAL(0,sim.takeLog().size()); //modem not used
+  stopModem();
+}
+
+//modem-task stops --> a waiting caller gets an error
+static volatile int connectResult = -1;
+
+void taskConnect(void *pvParameters){
+  connectResult = ((ModemClient *)pvParameters)->connect("aprs.glidernet.org",14580);
+  vTaskDelete(NULL);
+}
+
+void test_end(void){
+  ModemClient ogn(&manager,&ognSocket,ModemManager::PRIO_HIGH);
+  manager.begin(); //no modem-task --> request stays in queue
+  manager.setOnline(true);
+  connectResult = -1;
+  xTaskCreatePinnedToCore(taskConnect,"connect",4096,&ogn,5,NULL,0);
+  delay(20);
+  TEST_ASSERT_EQUAL(-1,connectResult);
+  manager.end();
+  uint32_t tStart = millis();
+  while ((connectResult == -1) && ((millis() - tStart) < 1000)) delay(1);
+  TEST_ASSERT_EQUAL(0,connectResult);
+  TEST_ASSERT_EQUAL(0,ogn.connect("aprs.glidernet.org",14580)); //no new requests after end
+}
+
+//one aprs-line from write() until the modem has sent it (modem without latency)
+void bench_modem(void){
+  ModemClient ogn(&manager,&ognSocket,ModemManager::PRIO_HIGH);
+  startModem();
+  ogn.connect("aprs.glidernet.org",14580);
+  char line[] = "FNT08ABCD>OGNFNT,qAS,FNB123456:/123015h4730.00N/01315.00Eg090/019/A=004921\r\n";
+  uint32_t writes = ognSocket.writes;
+  bench::result r = bench::run("ModemClient write -> modem",2000,[&](uint32_t i){
+    ogn.write((const uint8_t *)line,sizeof(line) - 1);
+    while (ognSocket.writes == writes) yield();
+    writes = ognSocket.writes;
+  });
+  bench::print(r);
+  TEST_ASSERT_EQUAL(2000 * (sizeof(line) - 1),ognSocket.takeOutput().size());
+  ModemManager::stats stat = manager.getStats(ModemManager::PRIO_HIGH);
+  printf("bench ModemManager queue               count=%u wait avg=%.3fms max=%ums\n",stat.count,(float)stat.waitSum / stat.count,stat.waitMax);
+  stopModem();
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_roundtrip);
+  RUN_TEST(test_priority);
+  RUN_TEST(test_serialized);
+  RUN_TEST(test_call);
+  RUN_TEST(test_offline);
+  RUN_TEST(test_end);
+  RUN_TEST(bench_modem);
+  return UNITY_END();
+}
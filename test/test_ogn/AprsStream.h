@@ -0,0 +1,86 @@
+/*!
+ * @file AprsStream.h
+ *
+ * aprs-is stream as a glidernet-server sends it to a receiver with a range-filter:
+ * keepalives, receiver-beacons and aircraft-positions (73 lines, 8986 bytes)
+ */
+
+#ifndef __APRSSTREAM_H__
+#define __APRSSTREAM_H__
+
+static const char aprsStream[] =
+  "# aprsc 2.1.10-gd72a17c 1 Jun 2021 12:30:15 GMT GLIDERN1 1.2.3.4:14580\r\n"
+  "ICA440C51>OGFLR,qAS,Gaisberg:/123015h4752.83N/01301.09E'274/027/A=005495 !W90! id1E440C51 -524fpm -2.5rot 14.3dB 1e -4.1kHz gps4x1\r\n"
+  "ICA4B0E3A>OGFLR,qAS,Gaisberg:/123017h4758.07N/01318.74E'203/021/A=004311 !W08! id1E4B0E3A -007fpm -0.5rot 17.6dB 2e +0.6kHz gps2x1\r\n"
+  "OGNF0A123>OGNTRK,qAS,Unterberg:/123019h4743.70N/01322.08E'288/022/A=007570 !W37! id05F0A123 +043fpm -0.2rot 27.9dB 2e -2.0kHz gps2x2\r\n"
+  "FLRDD8F21>OGFLR,qAS,Schmittn:/123019h4755.43N/01323.57E'147/024/A=003467 !W86! id1EDD8F21 +100fpm -2.1rot 16.2dB 0e +4.6kHz gps1x5\r\n"
+  "ICA440C51>OGFLR,qAS,Unterberg:/123021h4751.76N/01315.74E'233/023/A=003266 !W47! id06440C51 -476fpm +1.4rot 11.4dB 3e -2.2kHz gps4x3\r\n"
+  "Zwoelferh>OGNSDR,TCPIP*,qAC,GLIDERN2:/123021h4747.45NI01302.21E&/A=003802\r\n"
+  "ICA4B0E3A>OGFLR,qAS,Zwoelferh:/123021h4741.27N/01324.36E'066/046/A=005759 !W67! id064B0E3A -260fpm -0.3rot 17.8dB 1e +3.2kHz gps5x3\r\n"
+  "FNT11A0F3>OGNFNT,qAS,Unterberg:/123023h4752.29N/01304.10E'090/034/A=004400 !W30! id0511A0F3 +606fpm -1.9rot 10.6dB 1e -0.8kHz gps3x5\r\n"
+  "ICA440C51>OGFLR,qAS,Gaisberg:/123025h4756.79N/01320.86E'027/073/A=008889 !W86! id05440C51 +217fpm -0.6rot 16.0dB 3e -4.4kHz gps1x2\r\n"
+  "FNT08ABCD>OGNFNT,qAS,LOWS:/123026h4750.76N/01301.13E'000/034/A=006895 !W15! id0608ABCD -456fpm +2.2rot 19.6dB 1e +1.3kHz gps3x5\r\n"
+  "FLRDDB7E4>OGFLR,qAS,LOWS:/123027h4743.62N/01314.61E'247/054/A=003203 !W21! id21DDB7E4 -058fpm -0.1rot 21.7dB 0e -2.9kHz gps5x3\r\n"
+  "FLRDDA5BA>OGFLR,qAS,Schmittn:/123027h4749.82N/01327.11E'356/048/A=006746 !W52! id21DDA5BA -144fpm +0.2rot 24.0dB 2e +1.4kHz gps5x2\r\n"
+  "FNT11A0F3>OGNFNT,qAS,LOWL:/123027h4747.25N/01316.63E'182/018/A=002728 !W47! id2111A0F3 -204fpm +1.2rot 28.8dB 3e +3.1kHz gps3x3\r\n"
+  "OGNF0A123>OGNTRK,qAS,LOWS:/123027h4747.60N/01306.43E'104/076/A=007612 !W90! id05F0A123 +737fpm -0.9rot 20.4dB 0e +4.1kHz gps2x4\r\n"
+  "FNT11A0F3>OGNFNT,qAS,LOWL:/123027h4750.11N/01325.92E'202/074/A=005788 !W12! id1E11A0F3 -340fpm -2.8rot 19.0dB 3e +3.1kHz gps2x5\r\n"
+  "FLRDDB7E4>OGFLR,qAS,LOWL:/123029h4751.19N/01317.70E'067/017/A=002616 !W18! id1EDDB7E4 +288fpm +2.9rot 8.3dB 1e -4.7kHz gps2x3\r\n"
+  "OGNF0A123>OGNTRK,qAS,Schmittn:/123031h4750.33N/01317.53E'067/022/A=008561 !W57! id05F0A123 +427fpm -2.2rot 7.1dB 0e +3.7kHz gps2x5\r\n"
+  "Gaisberg>OGNSDR,TCPIP*,qAC,GLIDERN2:/123031h4747.22NI01302.18E&/A=003239\r\n"
+  "ICA4B0E3A>OGFLR,qAS,Schmittn:/123031h4741.41N/01321.66E'271/076/A=008924 !W18! id064B0E3A -092fpm -1.9rot 4.1dB 0e +0.1kHz gps5x1\r\n"
+  "FLRDDB7E4>OGFLR,qAS,Unterberg:/123031h4759.64N/01319.65E'102/050/A=006205 !W88! id05DDB7E4 +439fpm +2.6rot 21.9dB 2e +4.2kHz gps2x4\r\n"
+  "FNT11A0F3>OGNFNT,qAS,LOWS:/123031h4752.56N/01310.09E'343/045/A=006008 !W13! id2111A0F3 -350fpm +2.4rot 7.2dB 2e -3.6kHz gps2x4\r\n"
+  "ICA4B0E3A>OGFLR,qAS,Zwoelferh:/123031h4755.20N/01321.28E'082/070/A=006723 !W65! id054B0E3A -200fpm -0.9rot 5.5dB 2e -4.8kHz gps5x4\r\n"
+  "FLRDDA5BA>OGFLR,qAS,Zwoelferh:/123032h4750.66N/01319.37E'262/023/A=003424 !W31! id06DDA5BA -057fpm -1.4rot 27.5dB 1e -2.3kHz gps2x4\r\n"
+  "# aprsc 2.1.10-gd72a17c 1 Jun 2021 12:30:34 GMT GLIDERN1 1.2.3.4:14580\r\n"
+  "FLRDD8F21>OGFLR,qAS,Zwoelferh:/123034h4744.68N/01329.65E'292/078/A=008237 !W51! id21DD8F21 -483fpm +1.8rot 8.0dB 0e -2.3kHz gps1x1\r\n"
+  "ICA4B0E3A>OGFLR,qAS,Schmittn:/123035h4747.08N/01308.15E'232/016/A=005278 !W86! id214B0E3A +673fpm -2.2rot 17.2dB 1e +4.4kHz gps2x3\r\n"
+  "FNT08ABCD>OGNFNT,qAS,Gaisberg:/123035h4749.80N/01309.67E'105/052/A=006151 !W82! id2108ABCD +110fpm +1.8rot 29.9dB 0e -4.8kHz gps5x5\r\n"
+  "FLRDDB7E4>OGFLR,qAS,Gaisberg:/123035h4754.13N/01321.83E'221/078/A=006972 !W68! id21DDB7E4 -160fpm +2.9rot 12.3dB 1e -1.0kHz gps3x1\r\n"
+  "FLRDDA5BA>OGFLR,qAS,LOWS:/123035h4748.55N/01305.07E'043/063/A=006644 !W49! id1EDDA5BA +000fpm -2.7rot 8.0dB 2e -0.5kHz gps3x3\r\n"
+  "Schmittn>OGNSDR,TCPIP*,qAC,GLIDERN2:/123036h4747.41NI01302.31E&/A=001441\r\n"
+  "FLRDD8F21>OGFLR,qAS,Gaisberg:/123036h4751.23N/01300.42E'195/025/A=006388 !W48! id1EDD8F21 -092fpm +0.0rot 3.1dB 2e +3.2kHz gps2x4\r\n"
+  "FLRDDA5BA>OGFLR,qAS,Zwoelferh:/123038h4740.38N/01309.80E'119/025/A=007297 !W82! id05DDA5BA +067fpm +1.3rot 16.3dB 2e +2.2kHz gps2x1\r\n"
+  "FNT11A0F3>OGNFNT,qAS,LOWL:/123040h4756.17N/01329.67E'258/017/A=008123 !W93! id0611A0F3 -537fpm -2.7rot 20.2dB 0e -1.2kHz gps4x5\r\n"
+  "FLRDDA5BA>OGFLR,qAS,LOWL:/123040h4757.87N/01307.62E'135/015/A=006243 !W18! id06DDA5BA +750fpm +0.2rot 23.1dB 3e -2.5kHz gps1x3\r\n"
+  "OGNF0A123>OGNTRK,qAS,Gaisberg:/123040h4754.63N/01327.48E'039/076/A=008100 !W40! id1EF0A123 -442fpm +0.6rot 12.0dB 2e +1.2kHz gps2x1\r\n"
+  "FLRDDA5BA>OGFLR,qAS,Zwoelferh:/123041h4748.86N/01303.88E'111/077/A=004882 !W84! id05DDA5BA +354fpm -0.2rot 6.2dB 1e -1.9kHz gps1x4\r\n"
+  "FLRDD8F21>OGFLR,qAS,Zwoelferh:/123041h4742.64N/01330.57E'137/064/A=004218 !W31! id06DD8F21 -310fpm +1.5rot 10.1dB 2e -3.7kHz gps5x3\r\n"
+  "ICA440C51>OGFLR,qAS,Gaisberg:/123041h4755.62N/01312.03E'081/015/A=006527 !W76! id21440C51 -312fpm -0.5rot 13.2dB 0e +3.4kHz gps1x3\r\n"
+  "FNT11A0F3>OGNFNT,qAS,LOWS:/123042h4746.91N/01300.94E'148/047/A=005549 !W16! id0511A0F3 +606fpm -2.5rot 28.0dB 2e +3.5kHz gps3x1\r\n"
+  "FLRDD8F21>OGFLR,qAS,LOWL:/123042h4744.31N/01308.55E'261/055/A=004055 !W56! id06DD8F21 +692fpm -0.6rot 26.6dB 1e +2.2kHz gps1x4\r\n"
+  "FNT08ABCD>OGNFNT,qAS,LOWL:/123043h4749.62N/01301.70E'065/036/A=006368 !W65! id2108ABCD +009fpm -1.5rot 22.9dB 2e -0.9kHz gps2x3\r\n"
+  "Schmittn>OGNSDR,TCPIP*,qAC,GLIDERN2:/123044h4747.85NI01302.50E&/A=001790\r\n"
+  "FNT08ABCD>OGNFNT,qAS,LOWL:/123044h4745.09N/01306.64E'254/043/A=006210 !W57! id0508ABCD -315fpm +0.3rot 9.6dB 1e -1.6kHz gps1x3\r\n"
+  "ICA440C51>OGFLR,qAS,Unterberg:/123044h4758.25N/01328.02E'211/064/A=005890 !W83! id05440C51 -047fpm -1.0rot 4.7dB 2e +0.7kHz gps3x2\r\n"
+  "OGNF0A123>OGNTRK,qAS,LOWS:/123046h4748.31N/01312.51E'330/072/A=006037 !W40! id1EF0A123 -534fpm -0.4rot 23.6dB 3e +4.7kHz gps4x1\r\n"
+  "FNT11A0F3>OGNFNT,qAS,Schmittn:/123046h4754.57N/01307.13E'114/034/A=003745 !W81! id0511A0F3 -426fpm +0.3rot 4.1dB 1e -2.7kHz gps1x3\r\n"
+  "FLRDD8F21>OGFLR,qAS,Schmittn:/123046h4753.89N/01324.14E'050/024/A=004960 !W89! id1EDD8F21 +194fpm -1.4rot 24.3dB 0e -4.9kHz gps3x4\r\n"
+  "# aprsc 2.1.10-gd72a17c 1 Jun 2021 12:30:47 GMT GLIDERN1 1.2.3.4:14580\r\n"
+  "ICA440C51>OGFLR,qAS,LOWL:/123047h4747.60N/01316.30E'280/046/A=002739 !W64! id06440C51 -556fpm -1.8rot 26.9dB 3e -4.2kHz gps2x4\r\n"
+  "OGNF0A123>OGNTRK,qAS,Zwoelferh:/123048h4741.89N/01310.91E'215/061/A=008091 !W63! id06F0A123 -002fpm +1.4rot 16.6dB 1e -0.0kHz gps2x3\r\n"
+  "OGNF0A123>OGNTRK,qAS,Zwoelferh:/123048h4747.33N/01324.37E'055/078/A=007497 !W23! id05F0A123 +254fpm +2.5rot 4.5dB 1e +4.2kHz gps1x2\r\n"
+  "FNT08ABCD>OGNFNT,qAS,Zwoelferh:/123048h4741.90N/01301.23E'201/072/A=008332 !W51! id0608ABCD -261fpm -1.0rot 8.0dB 3e -4.7kHz gps4x3\r\n"
+  "FLRDDB7E4>OGFLR,qAS,Gaisberg:/123049h4743.00N/01302.35E'041/059/A=005942 !W18! id1EDDB7E4 +178fpm -0.9rot 25.2dB 3e -4.1kHz gps4x2\r\n"
+  "Schmittn>OGNSDR,TCPIP*,qAC,GLIDERN2:/123050h4747.57NI01302.24E&/A=002624\r\n"
+  "ICA440C51>OGFLR,qAS,LOWL:/123050h4755.03N/01320.52E'126/066/A=002833 !W60! id05440C51 -472fpm +1.8rot 4.7dB 1e +2.5kHz gps5x3\r\n"
+  "FLRDD8F21>OGFLR,qAS,Unterberg:/123051h4759.05N/01308.95E'353/055/A=004757 !W40! id06DD8F21 -551fpm +2.0rot 5.9dB 3e +4.5kHz gps4x3\r\n"
+  "FLRDDB7E4>OGFLR,qAS,Gaisberg:/123052h4755.23N/01300.94E'155/034/A=007474 !W35! id21DDB7E4 +343fpm -0.8rot 24.1dB 0e +0.1kHz gps4x2\r\n"
+  "FNT11A0F3>OGNFNT,qAS,LOWS:/123052h4741.61N/01317.69E'166/035/A=005994 !W11! id2111A0F3 +679fpm -2.5rot 5.6dB 3e +4.9kHz gps4x2\r\n"
+  "FNT08ABCD>OGNFNT,qAS,Zwoelferh:/123052h4754.79N/01328.86E'120/030/A=008887 !W44! id2108ABCD +560fpm -1.4rot 9.9dB 2e -3.0kHz gps2x2\r\n"
+  "OGNF0A123>OGNTRK,qAS,Gaisberg:/123052h4749.74N/01306.41E'033/065/A=004561 !W38! id1EF0A123 +730fpm +1.9rot 20.6dB 0e -4.0kHz gps4x2\r\n"
+  "ICA440C51>OGFLR,qAS,LOWS:/123053h4749.29N/01303.06E'097/039/A=003115 !W58! id1E440C51 +319fpm +0.6rot 23.9dB 0e -3.9kHz gps5x5\r\n"
+  "OGNF0A123>OGNTRK,qAS,LOWS:/123054h4751.43N/01304.05E'104/047/A=002813 !W93! id06F0A123 +070fpm -0.5rot 13.0dB 2e -4.2kHz gps1x4\r\n"
+  "FLRDDB7E4>OGFLR,qAS,LOWS:/123056h4753.12N/01325.50E'339/034/A=007736 !W81! id1EDDB7E4 +214fpm +1.2rot 14.1dB 2e +1.7kHz gps4x1\r\n"
+  "ICA440C51>OGFLR,qAS,Zwoelferh:/123057h4753.02N/01327.98E'186/040/A=005700 !W63! id06440C51 +289fpm +2.4rot 14.4dB 0e -0.9kHz gps3x4\r\n"
+  "FNT08ABCD>OGNFNT,qAS,LOWS:/123057h4741.70N/01304.82E'203/026/A=007192 !W95! id1E08ABCD -302fpm -0.9rot 7.4dB 1e +4.3kHz gps1x4\r\n"
+  "Gaisberg>OGNSDR,TCPIP*,qAC,GLIDERN2:/123058h4747.38NI01302.16E&/A=004729\r\n"
+  "FLRDDA5BA>OGFLR,qAS,Zwoelferh:/123058h4750.06N/01319.81E'198/026/A=008335 !W92! id1EDDA5BA +671fpm -0.6rot 25.9dB 3e -3.2kHz gps2x1\r\n"
+  "FNT08ABCD>OGNFNT,qAS,Zwoelferh:/123059h4751.15N/01304.31E'098/020/A=007106 !W05! id0608ABCD +198fpm +0.6rot 17.9dB 2e +1.5kHz gps3x5\r\n"
+  "FNT11A0F3>OGNFNT,qAS,Zwoelferh:/123059h4751.57N/01316.56E'091/017/A=002528 !W97! id0511A0F3 -119fpm -0.3rot 19.7dB 3e +3.4kHz gps4x4\r\n"
+  "ICA4B0E3A>OGFLR,qAS,Gaisberg:/123059h4751.55N/01311.11E'226/079/A=006679 !W00! id1E4B0E3A -432fpm +2.5rot 11.5dB 0e -4.5kHz gps5x4\r\n"
+  "FNT08ABCD>OGNFNT,qAS,LOWS:/123101h4742.78N/01323.88E'056/039/A=003578 !W74! id1E08ABCD -148fpm -2.6rot 12.5dB 2e -3.4kHz gps5x3\r\n"
+  "# aprsc 2.1.10-gd72a17c 1 Jun 2021 12:31:02 GMT GLIDERN1 1.2.3.4:14580\r\n";
+
+#endif
@@ -0,0 +1,214 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for Ogn (login, receiver-beacon, aprs-lines, rate-limit) against a simulated aprs-server
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Bench.h>
+#include <WiFi.h>
+#include <TimeLib.h>
+#include <Ogn.h>
+#include <FanetLora.h>
+#include "AprsStream.h"
+
+WiFiClient server; //server-side of the aprs-is connection
+
+//runs ogn like taskUplink (every 10ms)
+static void runFor(Ogn &ogn,uint32_t ms){
+  for (uint32_t t = 0;t < ms;t += 10){
+    native::advanceMs(10);
+    ogn.run(true);
+  }
+}
+
+//connect, login and first receiver-beacon --> ready to send aprs-lines
+static void login(Ogn &ogn){
+  ogn.setClient(&server);
+  ogn.begin("FNB123456","v1.0.0");
+  ogn.setGPS(47.5,13.25,800,0,0);
+  ogn.connectNow();
+  runFor(ogn,10);
+  server.inject("# aprsc 2.1.10-gd72a17c 1 Jan 2021 12:00:00 GMT GLIDERN1 1.2.3.4:14580\r\n");
+  server.inject("# logresp FNB123456 verified, server GLIDERN1\r\n");
+  runFor(ogn,20);
+}
+
+void setUp(void){
+  native::setTime(1000000);
+  setTime(12,30,15,1,6,2021); //TimeLib
+  server.takeOutput();
+}
+
+void tearDown(void){
+}
+
+void test_login(void){
+  Ogn ogn;
+  login(ogn);
+  TEST_ASSERT_EQUAL_STRING("aprs.glidernet.org",server.host().c_str());
+  TEST_ASSERT_EQUAL(14580,server.port());
+  std::string out = server.takeOutput();
+  //pass is the aprs-hash of the callsign
+  TEST_ASSERT_TRUE(out.find("user FNB123456 pass ") == 0);
+  TEST_ASSERT_TRUE(out.find(" vers v1.0.0\r\n") != std::string::npos);
+  //receiver-beacon after login
+  TEST_ASSERT_TRUE(out.find("FNB123456>OGNFNT,TCPIP*,qAC,GLIDERN1:/1230") != std::string::npos);
+  TEST_ASSERT_TRUE(ogn.isLoggedIn());
+}
+
+void test_tracking_line(void){
+  Ogn ogn;
+  login(ogn);
+  server.takeOutput();
+  ogn.sendTrackingData(47.5,13.25,1500,36,90,1.5,"08ABCD",Ogn::paraglider,true,5.0);
+  runFor(ogn,OGN_FLUSHTIME + 20);
+  std::string out = server.takeOutput();
+  TEST_ASSERT_TRUE(out.find("FNT08ABCD>OGNFNT,qAS,FNB123456:/1230") == 0);
+  TEST_ASSERT_TRUE(out.find("h4730.00N/01315.00Eg090/019/A=004921 !W00! id1F08ABCD +295fpm FNT11 5.0dB\r\n") != std::string::npos);
+}
+
+//count of aprs-position-lines in output
+static int countPositions(const std::string &out){
+  int count = 0;
+  for (size_t pos = out.find("OGNFNT,qAS");pos != std::string::npos;pos = out.find("OGNFNT,qAS",pos + 1)) count++;
+  return count;
+}
+
+//positions of different aircrafts, not more than the send-queue holds between 2 runs
+static void sendAircrafts(Ogn &ogn,int from,int count){
+  for (int i = from;i < from + count;i++){
+    char devId[8];
+    snprintf(devId,sizeof(devId),"08%04X",i);
+    ogn.sendTrackingData(47.5,13.25,1500,36,90,1.5,devId,Ogn::paraglider,true,5.0);
+    if ((i % 8) == 7) runFor(ogn,10);
+  }
+  runFor(ogn,OGN_FLUSHTIME + 20);
+}
+
+void test_stale_replaced(void){
+  Ogn ogn;
+  login(ogn);
+  server.takeOutput();
+  ogn.sendTrackingData(47.5,13.25,1500,36,90,1.5,"08ABCD",Ogn::paraglider,true,5.0);
+  runFor(ogn,10);
+  ogn.sendTrackingData(47.6,13.25,1500,36,90,1.5,"08ABCD",Ogn::paraglider,true,5.0); //before the write
+  runFor(ogn,OGN_FLUSHTIME + 20);
+  std::string out = server.takeOutput();
+  TEST_ASSERT_EQUAL(1,countPositions(out));
+  TEST_ASSERT_TRUE(out.find("h4736.00N/01315.00E") != std::string::npos); //only the newer position
+  TEST_ASSERT_EQUAL(1,ogn.getSendStats().stale);
+}
+
+void test_rate_limit(void){
+  Ogn ogn;
+  login(ogn);
+  ogn.setMinInterval(5);
+  server.takeOutput();
+  sendAircrafts(ogn,0,1);
+  sendAircrafts(ogn,0,1); //within 5s
+  TEST_ASSERT_EQUAL(1,countPositions(server.takeOutput()));
+  TEST_ASSERT_EQUAL(1,ogn.getSendStats().rateLimited);
+  runFor(ogn,5000);
+  sendAircrafts(ogn,0,1);
+  TEST_ASSERT_EQUAL(1,countPositions(server.takeOutput()));
+  TEST_ASSERT_EQUAL(1,ogn.getSendStats().rateLimited);
+}
+
+//more aircrafts than entries --> rate-limit of the known aircrafts still applies
+void test_rate_limit_full(void){
+  Ogn ogn;
+  login(ogn);
+  ogn.setMinInterval(5);
+  server.takeOutput();
+  sendAircrafts(ogn,0,OGN_MAXAIRCRAFT + 8);
+  TEST_ASSERT_EQUAL(OGN_MAXAIRCRAFT,countPositions(server.takeOutput()));
+  TEST_ASSERT_EQUAL(8,ogn.getSendStats().rateLimited); //no entry free
+  sendAircrafts(ogn,0,OGN_MAXAIRCRAFT); //again within 5s
+  TEST_ASSERT_EQUAL(0,countPositions(server.takeOutput()));
+  TEST_ASSERT_EQUAL(8 + OGN_MAXAIRCRAFT,ogn.getSendStats().rateLimited);
+  runFor(ogn,5000);
+  sendAircrafts(ogn,OGN_MAXAIRCRAFT,8); //entries of expired aircrafts are reused
+  TEST_ASSERT_EQUAL(8,countPositions(server.takeOutput()));
+}
+
+//recorded fanet tracking-frame (header, src 08:ABCD, type 1 payload) --> aprs-line like taskStandard sends it
+void test_fanet_replay(void){
+  static uint8_t rxFrame[] = {0x01,0x08,0xCD,0xAB,0x15,0x8E,0x43,0x12,0x6C,0x09,0xDC,0x95,0x48,0x0F,0x40};
+  FanetLora fanet;
+  FanetLora::trackingData data;
+  Frame *frm = new Frame(sizeof(rxFrame),rxFrame);
+  frm->rssi = -70;
+  frm->snr = 50;
+  fanet.handle_frame(frm);
+  delete frm;
+  TEST_ASSERT_TRUE(fanet.getTrackingData(&data));
+  Ogn ogn;
+  login(ogn);
+  server.takeOutput();
+  ogn.sendTrackingData(data.lat ,data.lon,data.altitude,data.speed,data.heading,data.climb,fanet.getDevId(data.devId) ,(Ogn::aircraft_t)data.aircraftType,data.OnlineTracking,(float)data.snr / 10.0);
+  runFor(ogn,OGN_FLUSHTIME + 20);
+  std::string out = server.takeOutput();
+  TEST_ASSERT_EQUAL_STRING("FNT08ABCD>OGNFNT,qAS,FNB123456:/123015h4730.00N/01315.00Eg090/019/A=004921 !W00! id1F08ABCD +295fpm FNT11 5.0dB\r\n",out.c_str());
+}
+
+void bench_ogn(void){
+  Ogn ogn;
+  login(ogn);
+  bench::result r = bench::run("Ogn sendTrackingData",2000,[&](uint32_t i){
+    char devId[8];
+    snprintf(devId,sizeof(devId),"08%04X",i % 64);
+    ogn.sendTrackingData(47.5 + i * 1e-5,13.25,1500,36,90,1.5,devId,Ogn::paraglider,true,5.0);
+    if ((i % 8) == 7) runFor(ogn,10);
+  });
+  bench::print(r);
+}
+
+//recorded server-stream is available, every run reads one chunk and parses its lines
+void bench_read_client(void){
+  Ogn ogn;
+  login(ogn);
+  server.takeOutput();
+  for (int i = 0;i < 20;i++) server.inject(aprsStream);
+  size_t avail = server.available();
+  bench::result r = bench::run("Ogn readClient (aprs-is stream)",300,[&](uint32_t i){
+    native::advanceMs(10);
+    ogn.run(true);
+  });
+  size_t bytes = avail - server.available();
+  bench::print(r);
+  printf("bench Ogn readClient                   bytes/run=%.0f ns/byte=%.2f lines/run=%.1f\n",(double)bytes / r.ops,r.nsPerOp * r.ops / bytes,(double)bytes / r.ops * 73 / (sizeof(aprsStream) - 1));
+  TEST_ASSERT_TRUE(bytes > (size_t)r.ops * OGN_RXBUF / 2); //reads in chunks, not byte by byte
+  TEST_ASSERT_TRUE(r.allocsPerOp < 0.1); //no String per line, only the receiver-beacon allocates
+  TEST_ASSERT_TRUE(ogn.isLoggedIn());
+  //reference: reading byte by byte into a String, lock held for the whole chunk
+  for (int i = 0;i < 20;i++) server.inject(aprsStream);
+  size_t chunk = bytes / r.ops;
+  String line = "";
+  volatile uint32_t lines = 0;
+  r = bench::run("reference per-char String readline",300,[&](uint32_t i){
+    for (size_t n = 0;(n < chunk) && (server.available());n++){
+      char c = server.read();
+      line += c;
+      if (c == '\n'){
+        lines++;
+        line = "";
+      }
+    }
+  });
+  bench::print(r);
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_login);
+  RUN_TEST(test_tracking_line);
+  RUN_TEST(test_stale_replaced);
+  RUN_TEST(test_rate_limit);
+  RUN_TEST(test_rate_limit_full);
+  RUN_TEST(test_fanet_replay);
+  RUN_TEST(bench_ogn);
+  RUN_TEST(bench_read_client);
+  return UNITY_END();
+}
@@ -0,0 +1,116 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for Proximity: geometry against CalcTools, order by distance and update-benchmark
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Bench.h>
+#include <Proximity.h>
+#include <CalcTools.h>
+
+#define MY_LAT 47.5
+#define MY_LON 13.3
+
+//targets spread around the own position up to 20km, moving slowly like received fanet-positions
+typedef struct {
+  float lat;
+  float lon;
+} position;
+
+static void moveTargets(position *pos,uint16_t count,uint32_t step){
+  for (uint16_t i = 0;i < count;i++){
+    float r = 0.002 + 0.18 * ((i * 37) % count) / count; //deg
+    float a = i * 2.4 + step * 0.001;
+    pos[i].lat = MY_LAT + r * cos(a);
+    pos[i].lon = MY_LON + r * sin(a) / cos(MY_LAT * PI / 180.0);
+  }
+}
+
+static void addTargets(Proximity &prox,const position *pos,uint16_t count){
+  prox.startUpdate(MY_LAT,MY_LON,1500);
+  for (uint16_t i = 0;i < count;i++) prox.addTarget(i % 64,0x110000 + i,pos[i].lat,pos[i].lon,1000 + i);
+  prox.finishUpdate();
+}
+
+static void assertSorted(Proximity &prox){
+  for (uint16_t n = 1;n < prox.count();n++){
+    TEST_ASSERT_TRUE(prox.get(n - 1)->distance <= prox.get(n)->distance);
+  }
+}
+
+void setUp(void){
+}
+
+void tearDown(void){
+}
+
+void test_geometry(void){
+  Proximity prox;
+  prox.startUpdate(MY_LAT,MY_LON,1500);
+  prox.addTarget(3,0x110003,47.52,13.33,1800);
+  prox.finishUpdate();
+  TEST_ASSERT_EQUAL(1,prox.count());
+  Proximity::target *pTarget = prox.get(0);
+  TEST_ASSERT_EQUAL(3,pTarget->index);
+  TEST_ASSERT_EQUAL_HEX32(0x110003,pTarget->devId);
+  //flat-earth projection is within 0.5% of the haversine-distance at 3km
+  float dist = distance(MY_LAT,MY_LON,47.52,13.33,'K') * 1000;
+  TEST_ASSERT_FLOAT_WITHIN(dist * 0.005,dist,pTarget->distance);
+  TEST_ASSERT_FLOAT_WITHIN(0.5,CalcBearingA(MY_LAT,MY_LON,47.52,13.33),pTarget->bearing);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,300,pTarget->relVert);
+  TEST_ASSERT_TRUE(pTarget->relNorth > 0);
+  TEST_ASSERT_TRUE(pTarget->relEast > 0);
+}
+
+void test_sorted_by_distance(void){
+  Proximity prox(256);
+  position pos[256];
+  for (uint32_t step = 0;step < 2000;step += 100){
+    moveTargets(pos,256,step);
+    addTargets(prox,pos,(step % 200) ? 256 : 200); //targets come and go
+    TEST_ASSERT_EQUAL((step % 200) ? 256 : 200,prox.count());
+    assertSorted(prox);
+  }
+  TEST_ASSERT_NULL(prox.get(256));
+}
+
+void test_capacity(void){
+  Proximity prox;
+  position pos[100];
+  moveTargets(pos,100,0);
+  addTargets(prox,pos,100);
+  TEST_ASSERT_EQUAL(PROXIMITY_MAXTARGETS,prox.count());
+  assertSorted(prox);
+}
+
+//one update per received position, positions are generated before
+static void benchTargets(uint16_t count,const char *name){
+  Proximity prox(count);
+  static position pos[16][256];
+  for (int i = 0;i < 16;i++) moveTargets(pos[i],count,i * 100);
+  bench::result r = bench::run(name,2000,[&](uint32_t i){
+    addTargets(prox,pos[(i / 125) % 16],count);
+  });
+  bench::print(r);
+  TEST_ASSERT_EQUAL(0,r.allocsPerOp);
+}
+
+void bench_update_64(void){
+  benchTargets(64,"proximity update (64 targets)");
+}
+
+void bench_update_256(void){
+  benchTargets(256,"proximity update (256 targets)");
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_geometry);
+  RUN_TEST(test_sorted_by_distance);
+  RUN_TEST(test_capacity);
+  RUN_TEST(bench_update_64);
+  RUN_TEST(bench_update_256);
+  return UNITY_END();
+}
@@ -0,0 +1,204 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host replay-driver: recorded gps-sentences, fanet-frames and baro-samples in simulated time, latency of the outputs per sentence
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <math.h>
+#include <Replay.h>
+#include <FanetLora.h>
+#include <Flarm.h>
+#include <Handoff.h>
+#include <kalmanvert.h>
+
+#define REPLAY_SECONDS 30
+#define GPS_RMC 5 //gps-cycle: $GPRMC at 5ms, $GPGGA at 45ms of every second
+#define GPS_GGA 45
+#define STANDARD_CYCLE 10 //taskStandard reads the gps and the fanet-queue [ms]
+#define BARO_CYCLE 20 //taskBaro [ms]
+#define LK8EX_RATE 250 //like main.h
+#define CLIMB 2.0 //[m/s]
+
+//recorded fanet-frames: pilot 1 every 3s at 300ms, pilot 2 every 5s at 700ms of the gps-second
+#define PILOT1 0x081001
+#define PILOT2 0x081002
+#define PILOT1_FRAMES 9
+#define PILOT2_FRAMES 6
+
+FanetLora fanet;
+Flarm flarm;
+Replay replay;
+
+//like varioValues in main.h
+typedef struct {
+  float pressure; //[hPa]
+  float alt;
+  float climb;
+  float temp;
+} varioSample;
+
+Handoff<varioSample> varioHandoff;
+kalmanvert kf;
+static bool bKalmanInit;
+static uint32_t tLK8EX;
+static String lastLK8EX;
+
+static String makeSentence(const char *fmt,uint32_t sec){
+  char buf[100];
+  snprintf(buf,sizeof(buf),fmt,13 + sec / 3600,(sec / 60) % 60,sec % 60);
+  return flarm.addChecksum(buf);
+}
+
+//records the gps-sentences of REPLAY_SECONDS like readGPS on the device
+static void recordGps(void){
+  TEST_ASSERT_TRUE(replay.beginRecord(REPLAY_FILE));
+  uint32_t t = 0;
+  for (uint32_t sec = 0;sec < REPLAY_SECONDS;sec++){
+    native::advanceMs(sec * 1000 + GPS_RMC - t);
+    t = sec * 1000 + GPS_RMC;
+    replay.record(makeSentence("$GPRMC,%02u%02u%02u.00,A,4730.000,N,01315.000,E,0.0,0.0,010722,,,A",sec).c_str());
+    native::advanceMs(GPS_GGA - GPS_RMC);
+    t += GPS_GGA - GPS_RMC;
+    replay.record(makeSentence("$GPGGA,%02u%02u%02u.00,4730.000,N,01315.000,E,1,08,1.0,1500.0,M,47.0,M,,",sec).c_str());
+  }
+  replay.end();
+}
+
+//fanet-frame due at time t since start of the recording
+static bool getFrame(uint32_t t,FanetLora::trackingData *tData){
+  memset(tData,0,sizeof(FanetLora::trackingData));
+  if ((t >= 2300) && ((t - 2300) % 3000 == 0)){
+    tData->devId = PILOT1;
+    tData->lat = 47.51;
+    tData->lon = 13.25;
+  }else if ((t >= 2700) && ((t - 2700) % 5000 == 0)){
+    tData->devId = PILOT2;
+    tData->lat = 47.5;
+    tData->lon = 13.26;
+  }else{
+    return false;
+  }
+  tData->altitude = 1600;
+  tData->aircraftType = FanetLora::paraglider;
+  tData->speed = 30.0;
+  tData->heading = 180.0;
+  tData->OnlineTracking = true;
+  return true;
+}
+
+//taskBaro: pressure of the climb-profile --> altitude (like MS5611) --> kalman-filter --> handoff
+static void baroSample(uint32_t t){
+  float alt = 1500.0 + CLIMB * t / 1000.0;
+  float pressure = 101325.0 * pow(1.0 - alt / 44330.0,5.255);
+  float baroAlt = 44330.0 * (1.0 - pow(pressure / 101325.0,0.1902949));
+  if (!bKalmanInit){
+    kf.init(baroAlt,0.0,0.1,0.3,millis());
+    bKalmanInit = true;
+  }
+  kf.update(baroAlt,0.0,millis());
+  varioSample vario = {pressure / 100.0f,(float)kf.getPosition(),(float)kf.getVelocity(),20.0};
+  varioHandoff.write(vario);
+}
+
+static void sendData2Client(String s){
+  replay.output(s.c_str());
+}
+
+//taskStandard: gps-sentences from the replay, received frames as $PFLAA, $LK8EX1 every LK8EX_RATE
+static void standardCycle(void){
+  static char lineBuffer[REPLAY_MAXLINE + 2];
+  static uint16_t len = 0;
+  while (replay.available()){
+    char c = replay.read();
+    if (len < sizeof(lineBuffer) - 1) lineBuffer[len++] = c;
+    if (c == '\n'){
+      lineBuffer[len] = 0;
+      sendData2Client(lineBuffer);
+      len = 0;
+    }
+  }
+  FanetLora::trackingData rx;
+  FlarmtrackingData me = {"000001",47.5,13.25,1500,eFlarmAircraftType::PARA_GLIDER,0,0,0};
+  while (fanet.getTrackingData(&rx)){
+    FlarmtrackingData pilot = {fanet.getDevId(rx.devId),rx.lat,rx.lon,(uint16_t)rx.altitude,eFlarmAircraftType::PARA_GLIDER,rx.speed,rx.climb,rx.heading};
+    sendData2Client(flarm.writeFlarmData(&me,&pilot));
+  }
+  if ((millis() - tLK8EX) >= LK8EX_RATE){
+    tLK8EX += LK8EX_RATE;
+    varioSample vario;
+    varioHandoff.read(&vario);
+    String s = "$LK8EX1," + String(vario.pressure,2) + "," + String(vario.alt,2) + "," + String((int32_t)(vario.climb * 100.0)) + "," + String(vario.temp,1) + ",4.10,";
+    lastLK8EX = flarm.addChecksum(s);
+    sendData2Client(lastLK8EX);
+  }
+}
+
+static bool getStats(const char *type,Replay::outputStats *pStats){
+  for (int i = 0;replay.getStats(i,pStats);i++){
+    if (strcmp(pStats->type,type) == 0) return true;
+  }
+  return false;
+}
+
+void setUp(void){
+  native::setTime(1000000);
+  SPIFFS.format();
+}
+
+void tearDown(void){
+}
+
+//plays the recording in 1ms-steps, frames and baro-samples are injected at their time
+void test_replay(void){
+  recordGps();
+  native::advanceMs(5000);
+  TEST_ASSERT_TRUE(replay.beginPlay(REPLAY_FILE));
+  uint32_t tStart = millis();
+  tLK8EX = tStart;
+  bKalmanInit = false;
+  uint32_t frames = 0;
+  for (uint32_t t = 1;(replay.isPlaying()) && (t <= (REPLAY_SECONDS + 1) * 1000);t++){
+    native::advanceMs(1);
+    FanetLora::trackingData tx;
+    if (getFrame(t,&tx)){
+      fanet.simulateTracking(&tx); //radio-isr
+      frames++;
+    }
+    if (t % BARO_CYCLE == 0) baroSample(t);
+    if (t % STANDARD_CYCLE == 0) standardCycle();
+  }
+  TEST_ASSERT_FALSE(replay.isPlaying()); //whole file played
+  TEST_ASSERT_UINT32_WITHIN(STANDARD_CYCLE,(REPLAY_SECONDS - 1) * 1000 + GPS_GGA,millis() - tStart);
+  TEST_ASSERT_EQUAL(REPLAY_SECONDS * 2,replay.getInputCount());
+  TEST_ASSERT_EQUAL(PILOT1_FRAMES + PILOT2_FRAMES,frames);
+  Replay::outputStats stats;
+  //gps-sentences are passed on in the next cycle
+  TEST_ASSERT_TRUE(getStats("$GPRMC",&stats));
+  TEST_ASSERT_EQUAL(REPLAY_SECONDS,stats.count);
+  TEST_ASSERT_EQUAL(STANDARD_CYCLE - GPS_RMC,stats.latencyMax);
+  TEST_ASSERT_TRUE(getStats("$GPGGA",&stats));
+  TEST_ASSERT_EQUAL(REPLAY_SECONDS,stats.count);
+  TEST_ASSERT_EQUAL(STANDARD_CYCLE - GPS_GGA % STANDARD_CYCLE,stats.latencyMax);
+  //frames are measured against the $GPGGA before them
+  TEST_ASSERT_TRUE(getStats("$PFLAA",&stats));
+  TEST_ASSERT_EQUAL(PILOT1_FRAMES + PILOT2_FRAMES,stats.count);
+  TEST_ASSERT_EQUAL(700 - GPS_GGA,stats.latencyMax);
+  TEST_ASSERT_EQUAL(PILOT1_FRAMES * (300 - GPS_GGA) + PILOT2_FRAMES * (700 - GPS_GGA),stats.latencySum);
+  //vario-output until the last sentence, the one at a full second waits longest
+  TEST_ASSERT_TRUE(getStats("$LK8EX",&stats));
+  TEST_ASSERT_EQUAL((REPLAY_SECONDS - 1) * 1000 / LK8EX_RATE,stats.count);
+  TEST_ASSERT_EQUAL(1000 - GPS_GGA,stats.latencyMax);
+  TEST_ASSERT_FALSE(getStats("$PFLAU",&stats));
+  //kalman-filter follows the climb of the baro-samples
+  int climb = 0;
+  TEST_ASSERT_EQUAL(1,sscanf(lastLK8EX.c_str(),"$LK8EX1,%*[^,],%*[^,],%d",&climb));
+  TEST_ASSERT_INT_WITHIN(10,CLIMB * 100,climb);
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_replay);
+  return UNITY_END();
+}
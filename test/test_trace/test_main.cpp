@@ -0,0 +1,124 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for Trace (ring, time-anchors over cycle-counter-wraps, chrome-trace-export) in simulated time
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Bench.h>
+#include <ArduinoJson.h>
+#include <Trace.h>
+
+//reads the export in small chunks, like the web-server
+static std::string exportAll(void){
+  std::string out;
+  uint8_t buf[64];
+  TEST_ASSERT_TRUE(trace.exportOpen());
+  size_t len;
+  while ((len = trace.exportRead(buf,sizeof(buf))) > 0) out.append((const char *)buf,len);
+  return out;
+}
+
+//events of core 0 without the metadata
+static size_t getEvents(DynamicJsonDocument &doc,const std::string &json){
+  TEST_ASSERT_EQUAL(DeserializationError::Ok,deserializeJson(doc,json).code());
+  size_t count = 0;
+  for (JsonObject ev : doc["traceEvents"].as<JsonArray>()){
+    if (strcmp(ev["ph"] | "","M") != 0) count++;
+  }
+  return count;
+}
+
+void setUp(void){
+  native::setTime(1000000);
+}
+
+void tearDown(void){
+}
+
+void test_not_started(void){
+  trace.setEnabled(true); //no rings yet
+  TEST_ASSERT_FALSE(trace.isEnabled());
+  trace.mark(TRACE_PPS);
+  TEST_ASSERT_FALSE(trace.exportOpen());
+  TEST_ASSERT_TRUE(trace.begin(false));
+}
+
+void test_export(void){
+  trace.setEnabled(true);
+  trace.start(TRACE_BARO,7);
+  native::advanceMs(2);
+  trace.stop(TRACE_BARO,7);
+  trace.mark(TRACE_PPS);
+  DynamicJsonDocument doc(16384);
+  TEST_ASSERT_EQUAL(3,getEvents(doc,exportAll()));
+  JsonArray events = doc["traceEvents"];
+  TEST_ASSERT_EQUAL_STRING("baro",events[0]["name"]);
+  TEST_ASSERT_EQUAL_STRING("B",events[0]["ph"]);
+  TEST_ASSERT_EQUAL(7,events[0]["args"]["arg"].as<int>());
+  TEST_ASSERT_FLOAT_WITHIN(0.01,0.0,events[0]["ts"].as<float>());
+  TEST_ASSERT_EQUAL_STRING("E",events[1]["ph"]);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,2000.0,events[1]["ts"].as<float>());
+  TEST_ASSERT_EQUAL_STRING("pps",events[2]["name"]);
+  TEST_ASSERT_EQUAL_STRING("t",events[2]["s"]);
+  TEST_ASSERT_EQUAL_STRING("core 0",events[3]["args"]["name"]);
+  TEST_ASSERT_TRUE(trace.isEnabled()); //recording continues after the export
+  trace.setEnabled(false);
+}
+
+//100s --> cycle-counter wraps 5 times, ring keeps the last TRACE_EVENTS, times stay exact by the anchors
+void test_wrap(void){
+  trace.setEnabled(true);
+  for (int i = 0;i < 1000;i++){
+    trace.mark(TRACE_MAC_RX,i);
+    native::advanceMs(100);
+  }
+  trace.setEnabled(false);
+  DynamicJsonDocument doc(131072);
+  TEST_ASSERT_EQUAL(TRACE_EVENTS,getEvents(doc,exportAll()));
+  JsonArray events = doc["traceEvents"];
+  for (int i = 0;i < TRACE_EVENTS;i++){
+    uint32_t arg = events[i]["args"]["arg"];
+    TEST_ASSERT_EQUAL(1000 - TRACE_EVENTS + i,arg);
+    TEST_ASSERT_FLOAT_WITHIN(1.0,arg * 100000.0,events[i]["ts"].as<double>());
+  }
+}
+
+//events during the download would overwrite the ring --> recording is paused
+void test_pause(void){
+  trace.setEnabled(true);
+  trace.mark(TRACE_PPS);
+  TEST_ASSERT_TRUE(trace.exportOpen());
+  TEST_ASSERT_FALSE(trace.isEnabled());
+  trace.mark(TRACE_LORA_IRQ);
+  trace.exportClose();
+  TEST_ASSERT_TRUE(trace.isEnabled());
+  DynamicJsonDocument doc(16384);
+  TEST_ASSERT_EQUAL(1,getEvents(doc,exportAll()));
+  trace.setEnabled(false);
+}
+
+void bench_trace(void){
+  bench::result r = bench::run("Trace mark (off)",10000,[&](uint32_t i){
+    trace.mark(TRACE_MAC_RX,i);
+  });
+  bench::print(r);
+  trace.setEnabled(true);
+  r = bench::run("Trace mark (on)",10000,[&](uint32_t i){
+    trace.mark(TRACE_MAC_RX,i);
+  });
+  bench::print(r);
+  trace.setEnabled(false);
+  TEST_ASSERT_EQUAL(0,r.allocsPerOp);
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_not_started);
+  RUN_TEST(test_export);
+  RUN_TEST(test_wrap);
+  RUN_TEST(test_pause);
+  RUN_TEST(bench_trace);
+  return UNITY_END();
+}
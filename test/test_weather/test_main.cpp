@@ -0,0 +1,309 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for Weather (bme280, anemometer, rain) with simulated sensors and WeatherRing (window-means, gust, rain-history)
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Bench.h>
+#include <Weather.h>
+#include <WeatherRing.h>
+
+#define PIN_WINDDIR 34
+#define PIN_WINDSPEED 25
+#define PIN_RAIN 26
+
+Weather weather;
+extern volatile uint32_t pulseHead; //pulses counted by the anemometer-isr
+static int64_t tNextPulse = 0; //[us]
+
+//simulates seconds of the weather-task: anemometer-pulses with freq [Hz], timer-tick every second, run() after the tick
+static void simulate(uint32_t seconds,float freq){
+  for (uint32_t s = 0;s < seconds;s++){
+    int64_t tTick = native::micros64() + 1000000;
+    if (freq > 0){
+      int64_t period = (int64_t)(1000000.0 / freq);
+      if (tNextPulse < native::micros64()) tNextPulse = native::micros64() + period;
+      while (tNextPulse <= tTick){
+        native::setTime(tNextPulse);
+        native::pulsePin(PIN_WINDSPEED);
+        tNextPulse += period;
+      }
+    }
+    native::setTime(tTick);
+    native::fireTimer(0);
+    weather.run();
+  }
+}
+
+void setUp(void){
+}
+
+void tearDown(void){
+}
+
+void test_begin(void){
+  native::setTime(1000000);
+  native::bme280().temp = 2150;
+  native::bme280().pressure = 95000;
+  native::bme280().humidity = 6000;
+  native::setAnalog(PIN_WINDDIR,512);
+  Wire.setDevicePresent(0x76,true);
+  TEST_ASSERT_TRUE(weather.begin(&Wire,0,-1,PIN_WINDDIR,PIN_WINDSPEED,PIN_RAIN));
+  simulate(5,0);
+  Weather::weatherData data;
+  weather.getValues(&data);
+  TEST_ASSERT_TRUE(data.bTemp);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,21.5,data.temp);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,950.0,data.Pressure);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,60.0,data.Humidity);
+  TEST_ASSERT_TRUE(data.bWindSpeed);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,0.0,data.WindSpeed);
+}
+
+void test_no_sensor(void){
+  Weather w;
+  Wire.setDevicePresent(0x76,false);
+  TEST_ASSERT_FALSE(w.begin(&Wire,0,-1,-1,-1,-1));
+  Wire.setDevicePresent(0x76,true);
+}
+
+void test_constant_wind(void){
+  //10 pulses/s = 36.2 km/h
+  simulate(60,10.0);
+  Weather::weatherData data;
+  weather.getValues(&data,10);
+  TEST_ASSERT_FLOAT_WITHIN(0.5,36.2,data.WindSpeed);
+  TEST_ASSERT_FLOAT_WITHIN(0.5,36.2,data.WindGust);
+  TEST_ASSERT_FLOAT_WITHIN(1.0,179.0,data.WindDir);
+}
+
+//pulse-trains through the anemometer-isr: slow wind (less than 2 pulses per tick)
+void test_wind_low(void){
+  simulate(60,1.3);
+  Weather::weatherData data;
+  weather.getValues(&data,30);
+  TEST_ASSERT_FLOAT_WITHIN(0.1,WIND_PULSE_FACTOR * 1.3,data.WindSpeed);
+  TEST_ASSERT_FLOAT_WITHIN(0.1,WIND_PULSE_FACTOR * 1.3,data.WindGust);
+}
+
+//strong wind: period (16.7ms) just above debounce, no pulse lost in the ring
+void test_wind_high(void){
+  uint32_t head = pulseHead;
+  tNextPulse = 0; //new pulse-train
+  simulate(60,60.0);
+  TEST_ASSERT_UINT32_WITHIN(1,3600,pulseHead - head);
+  Weather::weatherData data;
+  weather.getValues(&data,30);
+  TEST_ASSERT_FLOAT_WITHIN(1.0,WIND_PULSE_FACTOR * 60.0,data.WindSpeed);
+  TEST_ASSERT_FLOAT_WITHIN(1.0,WIND_PULSE_FACTOR * 60.0,data.WindGust);
+}
+
+//contact bounces within the debounce-time are no pulses
+void test_wind_bounce(void){
+  uint32_t head = pulseHead;
+  for (int i = 0;i < 10;i++){
+    native::advanceMs(100);
+    native::pulsePin(PIN_WINDSPEED);
+    native::advanceMs(2);
+    native::pulsePin(PIN_WINDSPEED); //bounce
+  }
+  TEST_ASSERT_EQUAL(10,pulseHead - head);
+  simulate(1,0);
+}
+
+//no pulses anymore --> speed decays and is 0 after WIND_TIMEOUT, direction of the last wind is kept
+void test_wind_calm(void){
+  simulate(30,10.0);
+  simulate(3,0);
+  Weather::weatherData data;
+  weather.getValues(&data,1);
+  TEST_ASSERT_TRUE(data.WindSpeed < WIND_PULSE_FACTOR * 10.0 / 2);
+  simulate(WIND_TIMEOUT,0);
+  weather.getValues(&data,1);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,0.0,data.WindSpeed);
+  native::setAnalog(PIN_WINDDIR,0); //vane turns without wind
+  simulate(60,0);
+  weather.getValues(&data,60);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,0.0,data.WindSpeed);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,0.0,data.WindGust);
+  TEST_ASSERT_FLOAT_WITHIN(1.0,179.0,data.WindDir);
+  native::setAnalog(PIN_WINDDIR,512);
+}
+
+void test_rain(void){
+  Weather::weatherData data;
+  weather.getValues(&data);
+  float rain = data.rain1h;
+  for (int i = 0;i < 4;i++){
+    native::advanceMs(100); //debounce 15ms
+    native::pulsePin(PIN_RAIN);
+  }
+  simulate(2,0);
+  weather.getValues(&data);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,rain + 4 * Bucket_Size,data.rain1h);
+}
+
+//means over a window are differences of running sums --> compare with plain means of the samples
+void test_ring_window_mean(void){
+  WeatherRing ring;
+  TEST_ASSERT_TRUE(ring.begin());
+  WeatherRing::aggregate agg;
+  TEST_ASSERT_FALSE(ring.getAggregate(60,&agg)); //no samples
+  float speed[400];
+  float temp[400];
+  for (int i = 0;i < 400;i++){ //more than the ring holds
+    speed[i] = (i % 10) * 1.5;
+    temp[i] = -5.0 + (i % 7) * 0.25; //below 0 --> sums wrap
+    ring.addSample(speed[i],90.0,temp[i],0);
+  }
+  const uint16_t windows[] = {1,10,60,WEATHERRING_SECONDS};
+  for (int w = 0;w < 4;w++){
+    float sumSpeed = 0;
+    float sumTemp = 0;
+    for (int i = 400 - windows[w];i < 400;i++){
+      sumSpeed += speed[i];
+      sumTemp += temp[i];
+    }
+    TEST_ASSERT_TRUE(ring.getAggregate(windows[w],&agg));
+    TEST_ASSERT_EQUAL(windows[w],agg.samples);
+    TEST_ASSERT_FLOAT_WITHIN(0.05,sumSpeed / windows[w],agg.windSpeed);
+    TEST_ASSERT_FLOAT_WITHIN(0.01,sumTemp / windows[w],agg.temp);
+    TEST_ASSERT_FLOAT_WITHIN(0.5,90.0,agg.windDir);
+  }
+  TEST_ASSERT_TRUE(ring.getAggregate(600,&agg)); //longer than ring --> whole ring
+  TEST_ASSERT_EQUAL(WEATHERRING_SECONDS,agg.samples);
+}
+
+void test_ring_window_start(void){
+  WeatherRing ring;
+  ring.begin();
+  WeatherRing::aggregate agg;
+  ring.addSample(10.0,180.0,20.0,0);
+  ring.addSample(20.0,180.0,22.0,0);
+  TEST_ASSERT_TRUE(ring.getAggregate(60,&agg)); //less samples than window --> since start
+  TEST_ASSERT_EQUAL(2,agg.samples);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,15.0,agg.windSpeed);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,21.0,agg.temp);
+}
+
+//gust is the max. 3s-mean in the window, not the max. sample
+void test_ring_gust(void){
+  WeatherRing ring;
+  ring.begin();
+  WeatherRing::aggregate agg;
+  for (int i = 0;i < 60;i++) ring.addSample(10.0,270.0,15.0,0);
+  ring.addSample(30.0,270.0,15.0,0); //single spike
+  for (int i = 0;i < 10;i++) ring.addSample(10.0,270.0,15.0,0);
+  ring.getAggregate(60,&agg);
+  TEST_ASSERT_FLOAT_WITHIN(0.1,(10.0 + 10.0 + 30.0) / 3,agg.windGust); //ring stores 0.1km/h
+  for (int i = 0;i < 3;i++) ring.addSample(40.0,270.0,15.0,0); //3s gust
+  for (int i = 0;i < 20;i++) ring.addSample(10.0,270.0,15.0,0);
+  ring.getAggregate(60,&agg);
+  TEST_ASSERT_FLOAT_WITHIN(0.05,40.0,agg.windGust);
+  TEST_ASSERT_FLOAT_WITHIN(0.05,(3 * 40.0 + 30.0 + 56 * 10.0) / 60,agg.windSpeed); //spike is still in window
+  ring.getAggregate(10,&agg); //gust not in window anymore
+  TEST_ASSERT_FLOAT_WITHIN(0.05,10.0,agg.windGust);
+}
+
+//direction is the mean wind-vector, calm keeps the last direction
+void test_ring_direction(void){
+  WeatherRing ring;
+  ring.begin();
+  WeatherRing::aggregate agg;
+  for (int i = 0;i < 10;i++) ring.addSample(10.0,(i % 2) ? 350.0 : 10.0,15.0,0);
+  ring.getAggregate(10,&agg);
+  TEST_ASSERT_TRUE((agg.windDir < 0.5) || (agg.windDir > 359.5)); //north, not south
+  for (int i = 0;i < 10;i++) ring.addSample(0.0,NAN,15.0,0);
+  ring.getAggregate(10,&agg);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,0.0,agg.windSpeed);
+  TEST_ASSERT_FLOAT_WITHIN(0.5,350.0,agg.windDir);
+}
+
+//rain before start comes in whole hours from the history, 30min in ring --> last hour adds the whole hour before start
+void test_ring_rain_history(void){
+  WeatherRing ring;
+  ring.begin();
+  uint16_t hist[WEATHERRING_HISTHOURS] = {5,3};
+  hist[WEATHERRING_HISTHOURS - 1] = 2;
+  ring.setRainHistory(hist,WEATHERRING_HISTHOURS);
+  TEST_ASSERT_EQUAL(5,ring.getRainTips(60)); //no samples yet
+  for (int i = 0;i < 1800;i++) ring.addSample(0.0,NAN,15.0,i / 300); //1 tip every 5min
+  TEST_ASSERT_EQUAL(2,ring.getRainTips(10));
+  TEST_ASSERT_EQUAL(5,ring.getRainTips(30));
+  TEST_ASSERT_EQUAL(5 + 5,ring.getRainTips(60));
+  TEST_ASSERT_EQUAL(5 + 5 + 3,ring.getRainTips(120));
+  TEST_ASSERT_EQUAL(5 + 5 + 3 + 2,ring.getRainTips(1440));
+}
+
+//hours saved before deep-sleep are the history after wake-up, shifted by the hours slept
+void test_ring_rain_roundtrip(void){
+  WeatherRing ring;
+  ring.begin();
+  uint16_t hist[WEATHERRING_HISTHOURS] = {5,3};
+  hist[WEATHERRING_HISTHOURS - 1] = 2;
+  ring.setRainHistory(hist,WEATHERRING_HISTHOURS);
+  for (int i = 0;i < 1800;i++) ring.addSample(0.0,NAN,15.0,i / 300);
+  uint16_t hours[WEATHERRING_HISTHOURS];
+  ring.getRainHours(hours,WEATHERRING_HISTHOURS);
+  TEST_ASSERT_EQUAL(10,hours[0]); //ring + hour before start
+  TEST_ASSERT_EQUAL(3,hours[1]);
+  TEST_ASSERT_EQUAL(0,hours[2]);
+  TEST_ASSERT_EQUAL(2,hours[WEATHERRING_HISTHOURS - 1]);
+  WeatherRing woken;
+  woken.begin();
+  woken.setRainHistory(hours,WEATHERRING_HISTHOURS);
+  TEST_ASSERT_EQUAL(10,woken.getRainTips(60));
+  TEST_ASSERT_EQUAL(15,woken.getRainTips(1440));
+  uint16_t again[WEATHERRING_HISTHOURS];
+  woken.getRainHours(again,WEATHERRING_HISTHOURS);
+  TEST_ASSERT_EQUAL_MEMORY(hours,again,sizeof(hours));
+  //slept 3h --> 3 empty hours, the oldest hours fall out of the day
+  WeatherRing::shiftRainHours(hours,WEATHERRING_HISTHOURS,3);
+  TEST_ASSERT_EQUAL(0,hours[0]);
+  TEST_ASSERT_EQUAL(0,hours[2]);
+  TEST_ASSERT_EQUAL(10,hours[3]);
+  TEST_ASSERT_EQUAL(3,hours[4]);
+  woken.setRainHistory(hours,WEATHERRING_HISTHOURS);
+  TEST_ASSERT_EQUAL(0,woken.getRainTips(180));
+  TEST_ASSERT_EQUAL(13,woken.getRainTips(1440));
+  WeatherRing::shiftRainHours(hours,WEATHERRING_HISTHOURS,0);
+  TEST_ASSERT_EQUAL(10,hours[3]);
+  //slept longer than a day or clock went back (negative difference) --> nothing left
+  WeatherRing::shiftRainHours(hours,WEATHERRING_HISTHOURS,(uint32_t)-1);
+  for (int i = 0;i < WEATHERRING_HISTHOURS;i++) TEST_ASSERT_EQUAL(0,hours[i]);
+}
+
+void bench_weather(void){
+  Weather::weatherData data;
+  bench::result r = bench::run("Weather 1s (10Hz wind) + run",600,[&](uint32_t i){
+    simulate(1,10.0);
+  });
+  bench::print(r);
+  r = bench::run("Weather getValues(600s)",1000,[&](uint32_t i){
+    weather.getValues(&data,600);
+  });
+  bench::print(r);
+  TEST_ASSERT_EQUAL(0,r.allocsPerOp);
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_begin);
+  RUN_TEST(test_no_sensor);
+  RUN_TEST(test_constant_wind);
+  RUN_TEST(test_wind_low);
+  RUN_TEST(test_wind_high);
+  RUN_TEST(test_wind_bounce);
+  RUN_TEST(test_wind_calm);
+  RUN_TEST(test_rain);
+  RUN_TEST(test_ring_window_mean);
+  RUN_TEST(test_ring_window_start);
+  RUN_TEST(test_ring_gust);
+  RUN_TEST(test_ring_direction);
+  RUN_TEST(test_ring_rain_history);
+  RUN_TEST(test_ring_rain_roundtrip);
+  RUN_TEST(bench_weather);
+  return UNITY_END();
+}
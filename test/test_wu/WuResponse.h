@@ -0,0 +1,30 @@
+/*!
+ * @file WuResponse.h
+ *
+ * saved response of api.weather.com /v2/pws/observations/current (format=json, units=m)
+ * of a station with wind and rain-sensor (headers and 514 bytes body)
+ */
+
+#ifndef __WURESPONSE_H__
+#define __WURESPONSE_H__
+
+static const char wuResponse[] =
+  "HTTP/1.1 200 OK\r\n"
+  "Date: Mon, 19 Oct 2026 08:55:20 GMT\r\n"
+  "Content-Type: application/json; charset=UTF-8\r\n"
+  "Content-Length: 514\r\n"
+  "Connection: close\r\n"
+  "Cache-Control: max-age=0, no-cache\r\n"
+  "X-Frame-Options: SAMEORIGIN\r\n"
+  "Access-Control-Allow-Origin: *\r\n"
+  "Content-Encoding: identity\r\n"
+  "Vary: Accept-Encoding\r\n"
+  "\r\n"
+  "{\"observations\":[{\"stationID\":\"IGRAZ123\",\"obsTimeUtc\":\"2026-10-19T08:55:12Z\",\"obsTimeLoca"
+  "l\":\"2026-10-19 10:55:12\",\"neighborhood\":\"Schoeckl Nord\",\"softwareType\":\"GXAirCom-5.2.1\",\""
+  "country\":\"AT\",\"solarRadiation\":312.4,\"lon\":15.468311,\"realtimeFrequency\":null,\"epoch\":179"
+  "2400112,\"lat\":47.199482,\"uv\":2.0,\"winddir\":225,\"humidity\":67,\"qcStatus\":1,\"metric\":{\"te"
+  "mp\":12.3,\"heatIndex\":12.3,\"dewpt\":6.3,\"windChill\":10.1,\"windSpeed\":18.4,\"windGust\":27.0,\""
+  "pressure\":1013.21,\"precipRate\":0.25,\"precipTotal\":1.2,\"elev\":1445.0}}]}";
+
+#endif
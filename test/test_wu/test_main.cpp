@@ -0,0 +1,143 @@
+/*!
+ * @file test_main.cpp
+ *
+ * host-tests for WeatherUnderground getData against a saved api-response (filter, doc-size, peak heap, parse time)
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Bench.h>
+#include <WeatherUnderground.h>
+#include "WuResponse.h"
+
+WiFiClient client;
+WeatherUnderground wu;
+
+//full response with changed body
+static std::string response(const char *from,const char *to){
+  std::string ret = wuResponse;
+  size_t pos = ret.find(from);
+  ret.replace(pos,strlen(from),to);
+  char len[32];
+  sprintf(len,"Content-Length: %d",(int)(514 + strlen(to) - strlen(from)));
+  pos = ret.find("Content-Length: 514");
+  ret.replace(pos,strlen("Content-Length: 514"),len);
+  return ret;
+}
+
+void setUp(void){
+  native::realTime();
+  wu.setClient(&client);
+  client.takeOutput();
+}
+
+void tearDown(void){
+}
+
+void test_get_data(void){
+  WeatherUnderground::wData data;
+  memset(&data,0,sizeof(data));
+  client.inject(wuResponse);
+  TEST_ASSERT_TRUE(wu.getData("IGRAZ123","0123456789abcdef",&data));
+  std::string request = client.takeOutput();
+  TEST_ASSERT_TRUE(request.find("GET /v2/pws/observations/current?stationId=IGRAZ123&format=json&units=m&apiKey=0123456789abcdef") == 0);
+  TEST_ASSERT_EQUAL_STRING("api.weather.com",client.host().c_str());
+  TEST_ASSERT_FLOAT_WITHIN(0.0001,47.199482,data.lat);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001,15.468311,data.lon);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,1445.0,data.height);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,12.3,data.temp);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,67.0,data.humidity);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,1013.21,data.pressure);
+  TEST_ASSERT_TRUE(data.bWind);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,225.0,data.winddir);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,18.4,data.windspeed);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,27.0,data.windgust);
+  TEST_ASSERT_TRUE(data.bRain);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,0.25,data.rain1h);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,1.2,data.raindaily);
+}
+
+void test_wrong_station(void){
+  WeatherUnderground::wData data;
+  client.inject(wuResponse);
+  TEST_ASSERT_FALSE(wu.getData("IGRAZ999","0123456789abcdef",&data));
+}
+
+//station without anemometer and rain-gauge sends null
+void test_no_sensors(void){
+  WeatherUnderground::wData data;
+  std::string resp = response("\"winddir\":225","\"winddir\":null");
+  size_t pos = resp.find("\"precipRate\":0.25");
+  resp.replace(pos,strlen("\"precipRate\":0.25"),"\"precipRate\":null");
+  pos = resp.find("Content-Length: 515");
+  resp.replace(pos,strlen("Content-Length: 515"),"Content-Length: 517");
+  client.inject(resp);
+  TEST_ASSERT_TRUE(wu.getData("IGRAZ123","0123456789abcdef",&data));
+  TEST_ASSERT_FALSE(data.bWind);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,0.0,data.windspeed);
+  TEST_ASSERT_FALSE(data.bRain);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,12.3,data.temp);
+}
+
+void test_http_error(void){
+  WeatherUnderground::wData data;
+  client.inject("HTTP/1.1 401 Unauthorized\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+  TEST_ASSERT_FALSE(wu.getData("IGRAZ123","wrongkey",&data));
+}
+
+//the filtered observation fits into WU_JSON_SIZE, the whole response doesn't
+void test_doc_size(void){
+  const char *body = strstr(wuResponse,"\r\n\r\n") + 4;
+  DynamicJsonDocument full(2048);
+  TEST_ASSERT_FALSE(deserializeJson(full,body));
+  printf("doc full=%u bytes, WU_JSON_SIZE=%u\n",(unsigned)full.memoryUsage(),(unsigned)WU_JSON_SIZE);
+  TEST_ASSERT_TRUE(full.memoryUsage() > WU_JSON_SIZE);
+  //more fields in the response --> skipped by the filter, doc doesn't grow
+  WeatherUnderground::wData data;
+  client.inject(response("\"qcStatus\":1","\"qcStatus\":1,\"extra\":{\"a\":\"0123456789012345678901234567890123456789\",\"b\":[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16]}"));
+  TEST_ASSERT_TRUE(wu.getData("IGRAZ123","0123456789abcdef",&data));
+  TEST_ASSERT_FLOAT_WITHIN(0.01,18.4,data.windspeed);
+}
+
+//heap in use during getData: filter + filtered doc, no copy of the body
+void test_peak_heap(void){
+  WeatherUnderground::wData data;
+  client.inject(wuResponse);
+  bool bRet = false;
+  int64_t peak = bench::peakHeap([&](){
+    bRet = wu.getData("IGRAZ123","0123456789abcdef",&data);
+  });
+  TEST_ASSERT_TRUE(bRet);
+  const char *body = strstr(wuResponse,"\r\n\r\n") + 4;
+  printf("peak heap getData=%lld bytes (body=%u bytes, unfiltered doc=2048 bytes)\n",(long long)peak,(unsigned)strlen(body));
+  TEST_ASSERT_TRUE(peak < 2048 + (int64_t)strlen(body)); //body as String + unfiltered doc
+  TEST_ASSERT_TRUE(peak < WU_FILTER_SIZE + WU_JSON_SIZE + 512);
+}
+
+void bench_get_data(void){
+  WeatherUnderground::wData data;
+  const char *body = strstr(wuResponse,"\r\n\r\n") + 4;
+  bench::result r = bench::run("WU getData (saved response)",1000,[&](uint32_t i){
+    client.inject(wuResponse);
+    wu.getData("IGRAZ123","0123456789abcdef",&data);
+  });
+  bench::print(r);
+  DynamicJsonDocument full(2048);
+  r = bench::run("deserializeJson body, unfiltered",1000,[&](uint32_t i){
+    deserializeJson(full,body);
+  });
+  bench::print(r);
+  TEST_ASSERT_FLOAT_WITHIN(0.01,18.4,data.windspeed);
+}
+
+int main(int argc,char **argv){
+  UNITY_BEGIN();
+  RUN_TEST(test_get_data);
+  RUN_TEST(test_wrong_station);
+  RUN_TEST(test_no_sensors);
+  RUN_TEST(test_http_error);
+  RUN_TEST(test_doc_size);
+  RUN_TEST(test_peak_heap);
+  RUN_TEST(bench_get_data);
+  return UNITY_END();
+}